@@ -168,6 +168,55 @@ public:
         cubeEntity.get<MaterialComponent>().tint = glm::vec4{ 0.9, 0.4, 0.3, 1.0 };
     }
 
+    /**
+     * @brief Stress scene for the software occlusion culler: a grid of vases hidden behind walls.
+     * All the vases share one mesh and material, walls are occluders rasterized from their own mesh.
+     * Added to the scene when the application is started with --occlusion-benchmark.
+     */
+    void createOcclusionBenchmark(int rows, int columns) {
+        auto& rm = getResourceManager();
+        auto vaseMesh = rm.get<Mesh>(MODELS_PATH + "smooth_vase.obj");
+        auto cubeMesh = rm.get<Mesh>(MODELS_PATH + "cube.obj");
+
+        auto vaseMaterial = Material::Builder()
+            .setRoughnessMap(rm.get<Image>(TEXTURES_PATH + "/gold/roughness.png"))
+            .setMetallicMap(rm.get<Image>(TEXTURES_PATH + "/gold/metallic.png"))
+            .build();
+        rm.add(vaseMaterial, "benchmark_vase_material");
+
+        auto wallMaterial = Material::Builder()
+            .setRoughnessMap(rm.get<Image>(TEXTURES_PATH + "white_pixel.png"))
+            .build();
+        rm.add(wallMaterial, "benchmark_wall_material");
+
+        // two walls, the second one hides what the first one leaves visible from the side
+        const glm::vec3 wallPositions[] = { { 0.0f, 0.4f, 1.5f }, { 0.0f, 0.4f, 4.0f } };
+        for (const auto& position : wallPositions) {
+            getScene().createEntity("wall")
+                .add<TransformComponent>(position, glm::vec3{ 2.5f, 0.6f, 0.02f }, glm::vec3{ 0.0f })
+                .add<MeshComponent>(cubeMesh)
+                .add<MaterialComponent>(MaterialComponent::Builder()
+                    .setMaterial(wallMaterial).build())
+                .add<OccluderComponent>();
+        }
+
+        for (int row = 0; row < rows; row++) {
+            for (int column = 0; column < columns; column++) {
+                const glm::vec3 position{
+                    -2.0f + 4.0f * (column + 0.5f) / columns,
+                    1.0f,
+                    1.7f + 5.0f * (row + 0.5f) / rows
+                };
+
+                getScene().createEntity("benchmark_vase")
+                    .add<TransformComponent>(position, glm::vec3{ 0.4f }, glm::vec3{ 0.0f })
+                    .add<MeshComponent>(vaseMesh)
+                    .add<MaterialComponent>(MaterialComponent::Builder()
+                        .setMaterial(vaseMaterial).build());
+            }
+        }
+    }
+
     void createLights() {
         //entity = createPointLightEntity(0.25f, 0.02f, glm::vec3{1.f, 1.f, 1.f});
         //entity.get<TransformComponent>().translation = glm::vec3{0.0f, 0.0f, 0.0f};
@@ -195,6 +244,9 @@ public:
         createRubikCube();
         createBigCube();
         createLights();
+        if (hasArgument("--occlusion-benchmark")) {
+            createOcclusionBenchmark(50, 60);
+        }
 
         auto& rm = getResourceManager();
 
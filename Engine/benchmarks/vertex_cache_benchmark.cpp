@@ -0,0 +1,75 @@
+#include "core/constants.hpp"
+#include "resources/importers/mesh_importer.hpp"
+#include "resources/importers/mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace PXTEngine;
+
+/**
+ * Reports the post-transform cache statistics of the bundled models before and after the import
+ * reordering (vertex cache, then overdraw), for the cache size the importer targets.
+ *
+ * Usage: PXT_Vertex_Cache_Benchmark [models directory], the default is the assets models directory
+ * relative to the out directory.
+ */
+int main(int argc, char** argv) {
+	const std::filesystem::path modelsPath = argc > 1 ? std::filesystem::path(argv[1]) : std::filesystem::path(MODELS_PATH);
+
+	std::vector<std::filesystem::path> files;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(modelsPath, error)) {
+		if (entry.is_regular_file() && entry.path().extension() == ".obj") {
+			files.push_back(entry.path());
+		}
+	}
+
+	if (error || files.empty()) {
+		std::cerr << "no .obj file found in " << modelsPath << "\n";
+		return EXIT_FAILURE;
+	}
+
+	std::sort(files.begin(), files.end());
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << std::left << std::setw(24) << "model" << std::right
+		<< std::setw(10) << "vertices" << std::setw(11) << "triangles"
+		<< std::setw(13) << "ACMR before" << std::setw(12) << "ACMR after"
+		<< std::setw(13) << "ATVR before" << std::setw(12) << "ATVR after"
+		<< std::setw(11) << "time (ms)" << "\n";
+
+	for (const std::filesystem::path& file : files) {
+		MeshImporter::MeshData mesh;
+		try {
+			mesh = MeshImporter::loadObj(file);
+		} catch (const std::exception& e) {
+			std::cerr << file.filename().string() << ": " << e.what() << "\n";
+			continue;
+		}
+
+		const auto before = MeshOptimizer::analyzeVertexCache(mesh.indices, mesh.vertices.size());
+
+		const auto start = std::chrono::high_resolution_clock::now();
+		MeshOptimizer::optimizeVertexCache(mesh.indices, mesh.vertices.size());
+		MeshOptimizer::optimizeOverdraw(mesh.indices, mesh.vertices);
+		const auto end = std::chrono::high_resolution_clock::now();
+
+		const auto after = MeshOptimizer::analyzeVertexCache(mesh.indices, mesh.vertices.size());
+		const double timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+		std::cout << std::left << std::setw(24) << file.filename().string() << std::right
+			<< std::setw(10) << mesh.vertices.size() << std::setw(11) << mesh.indices.size() / 3
+			<< std::setw(13) << before.acmr << std::setw(12) << after.acmr
+			<< std::setw(13) << before.atvr << std::setw(12) << after.atvr
+			<< std::setw(11) << timeMs << "\n";
+	}
+
+	return EXIT_SUCCESS;
+}
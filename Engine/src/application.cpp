@@ -11,6 +11,7 @@
 #include "scene/camera.hpp"
 #include "graphics/render_systems/master_render_system.hpp"
 #include "graphics/resources/texture2d.hpp"
+#include "utils/timer.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -27,6 +28,7 @@
 namespace PXTEngine {
 
     Application* Application::m_instance = nullptr;
+    std::vector<std::string> Application::m_arguments{};
 
     Application::Application() {
         m_instance = this;
@@ -50,13 +52,13 @@ namespace PXTEngine {
         createUboBuffers();
         createGlobalDescriptorSet();
 
-		// create the descriptor sets for the textures
-        m_textureRegistry.setDescriptorAllocator(m_descriptorAllocator);
+		// create the bindless descriptor set for the textures, it has its own update after bind pool
 		m_textureRegistry.createDescriptorSet();
 
 		// create the descriptor sets for the materials
 		m_materialRegistry.setDescriptorAllocator(m_descriptorAllocator);
 		m_materialRegistry.createDescriptorSet();
+		m_materialRegistry.trackMaterialComponents(m_scene);
 
 		// create descriptor set for skybox
         if (m_scene.getEnvironment()->getSkybox()) {
@@ -64,17 +66,25 @@ namespace PXTEngine {
             skybox->createDescriptorSet(m_descriptorAllocator);
         }
 
-		// create the render systems
-        m_masterRenderSystem = createUnique<MasterRenderSystem>(
-            m_context,
-            m_renderer,
-            m_descriptorAllocator,
-            m_textureRegistry,
-			m_materialRegistry,
-			m_blasRegistry,
-            m_globalSetLayout,
-            m_scene.getEnvironment()
-        );
+		// create the render systems, this is where every pipeline is requested: they compile on the
+		// job system workers while the systems create their GPU resources and build the
+		// acceleration structures, and are waited on when first recorded.
+		// Time it to compare the warm and cold pipeline cache startups
+        {
+            ProfilingTimer timer(std::string("Render systems, pipeline cache ") +
+                (m_context.isPipelineCacheWarm() ? "warm" : "cold"));
+
+            m_masterRenderSystem = createUnique<MasterRenderSystem>(
+                m_context,
+                m_renderer,
+                m_descriptorAllocator,
+                m_textureRegistry,
+                m_materialRegistry,
+                m_blasRegistry,
+                m_globalSetLayout,
+                m_scene.getEnvironment()
+            );
+        }
 
         m_window.setEventCallback([this]<typename E>(E&& event) {
             onEvent(std::forward<E>(event));
@@ -82,10 +92,12 @@ namespace PXTEngine {
     }
 
 	void Application::createDescriptorPoolAllocator() {
-		// for now we have one ubo and a lot of textures
+		// descriptors per set of the shared allocator: one ubo and a few samplers (shadow map, skybox,
+		// G-buffer inputs). The textures are not counted here, the bindless heap of the texture
+		// registry has its own update after bind pool sized from its capacity
 		std::vector<PoolSizeRatio> ratios = {
 			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f},
-			{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<float>(m_textureRegistry.getTextureCount())},
+			{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
             {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f},
             {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f}
 		};
@@ -111,6 +123,7 @@ namespace PXTEngine {
             .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 
                 VK_SHADER_STAGE_VERTEX_BIT | 
                 VK_SHADER_STAGE_FRAGMENT_BIT |
+                VK_SHADER_STAGE_COMPUTE_BIT |
                 VK_SHADER_STAGE_RAYGEN_BIT_KHR |
 				VK_SHADER_STAGE_MISS_BIT_KHR |
 				VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR)
@@ -272,20 +285,3 @@ namespace PXTEngine {
 	}
 
 }
-
-int main() {
-
-    try {
-        auto app = PXTEngine::initApplication();
-
-        app->start();
-        app->run();
-
-        delete app;
-    } catch (const std::exception& e) {
-		PXT_ERROR("Application crashed: {}", e.what());
-        return EXIT_FAILURE;
-    }
-
-    return EXIT_SUCCESS;
-}
\ No newline at end of file
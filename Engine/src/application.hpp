@@ -19,7 +19,11 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 
-int main();
+#include <algorithm>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv);
 
 namespace PXTEngine {
 
@@ -30,6 +34,15 @@ namespace PXTEngine {
 
         static Application& get() { return *m_instance; }
 
+        /**
+         * @brief The command line arguments the application was started with, without the program name.
+         */
+        static const std::vector<std::string>& getArguments() { return m_arguments; }
+
+        static bool hasArgument(const std::string& argument) {
+            return std::ranges::find(m_arguments, argument) != m_arguments.end();
+        }
+
         Scene& getScene() {
             return m_scene;
         }
@@ -87,8 +100,9 @@ namespace PXTEngine {
 		BLASRegistry m_blasRegistry{m_context};
 
         static Application* m_instance;
+        static std::vector<std::string> m_arguments;
 
-        friend int ::main();
+        friend int ::main(int argc, char** argv);
     };
 
     Application* initApplication();
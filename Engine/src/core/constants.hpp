@@ -7,6 +7,7 @@ const std::string MODELS_PATH = "../assets/models/";
 const std::string TEXTURES_PATH = "../assets/textures/";
 
 const std::string IMGUI_INI_FILEPATH = "../assets/imgui_config/imgui.ini";
+const std::string PIPELINE_CACHE_FILEPATH = "../out/pipeline_cache.bin";
 
 const std::string WHITE_PIXEL = "pixel_0xFFFFFFFF_RGBA8_SRGB";
 const std::string WHITE_PIXEL_LINEAR = "pixel_0xFFFFFFFF_RGBA8_LINEAR";
@@ -0,0 +1,145 @@
+#include "core/job_system.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace PXTEngine {
+
+	namespace {
+		thread_local uint32_t t_threadIndex = 0;
+
+		/**
+		 * @brief The shared state of a parallelFor, kept alive by the jobs that start after it returned.
+		 */
+		struct ParallelForBatch {
+			const std::function<void(uint32_t)>* function = nullptr;
+			uint32_t count = 0;
+
+			std::atomic<uint32_t> nextIndex{ 0 };
+
+			std::mutex mutex;
+			std::condition_variable finished;
+			uint32_t completedCount = 0;
+			std::exception_ptr error;
+		};
+
+		// the function is only dereferenced for a claimed index, i.e. before the caller returns
+		void runBatch(ParallelForBatch& batch) {
+			uint32_t completedCount = 0;
+			std::exception_ptr error;
+
+			for (uint32_t index = batch.nextIndex++; index < batch.count; index = batch.nextIndex++) {
+				try {
+					(*batch.function)(index);
+				} catch (...) {
+					if (!error) {
+						error = std::current_exception();
+					}
+				}
+				completedCount++;
+			}
+
+			if (completedCount == 0) return;
+
+			std::lock_guard lock(batch.mutex);
+			if (error && !batch.error) {
+				batch.error = error;
+			}
+
+			batch.completedCount += completedCount;
+			if (batch.completedCount == batch.count) {
+				batch.finished.notify_all();
+			}
+		}
+	}
+
+	JobSystem::JobSystem() {
+		// hardware_concurrency may be 0 when unknown, keep at least one worker
+		const uint32_t threadCount = std::clamp(std::thread::hardware_concurrency(), 2u, MAX_THREADS);
+
+		for (uint32_t thread = 1; thread < threadCount; thread++) {
+			m_workers.emplace_back(&JobSystem::workerLoop, this, thread);
+		}
+	}
+
+	JobSystem::~JobSystem() {
+		{
+			std::lock_guard lock(m_mutex);
+			m_isStopping = true;
+		}
+		m_jobAvailable.notify_all();
+
+		// the queued jobs are still run, their futures may be waited on
+		for (auto& worker : m_workers) {
+			worker.join();
+		}
+	}
+
+	uint32_t JobSystem::getThreadIndex() {
+		return t_threadIndex;
+	}
+
+	void JobSystem::push(std::function<void()> job) {
+		{
+			std::lock_guard lock(m_mutex);
+			m_jobs.push_back(std::move(job));
+		}
+		m_jobAvailable.notify_one();
+	}
+
+	void JobSystem::parallelFor(uint32_t count, const std::function<void(uint32_t index)>& function) {
+		if (count == 0) return;
+
+		if (count == 1) {
+			function(0);
+			return;
+		}
+
+		auto batch = createShared<ParallelForBatch>();
+		batch->function = &function;
+		batch->count = count;
+
+		// the caller takes part, one helper per remaining index at most
+		const uint32_t helperCount = std::min(count - 1, static_cast<uint32_t>(m_workers.size()));
+		{
+			std::lock_guard lock(m_mutex);
+			for (uint32_t i = 0; i < helperCount; i++) {
+				m_jobs.push_back([batch]() { runBatch(*batch); });
+			}
+		}
+		m_jobAvailable.notify_all();
+
+		runBatch(*batch);
+
+		std::unique_lock lock(batch->mutex);
+		batch->finished.wait(lock, [&batch]() { return batch->completedCount == batch->count; });
+
+		if (batch->error) {
+			std::rethrow_exception(batch->error);
+		}
+	}
+
+	void JobSystem::workerLoop(uint32_t threadIndex) {
+		t_threadIndex = threadIndex;
+
+		while (true) {
+			std::function<void()> job;
+
+			{
+				std::unique_lock lock(m_mutex);
+				m_jobAvailable.wait(lock, [this]() { return m_isStopping || !m_jobs.empty(); });
+
+				if (m_jobs.empty()) {
+					return;
+				}
+
+				job = std::move(m_jobs.front());
+				m_jobs.pop_front();
+			}
+
+			// submit jobs keep their exception in the future, parallelFor jobs in the batch
+			job();
+		}
+	}
+}
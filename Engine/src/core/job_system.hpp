@@ -0,0 +1,87 @@
+#pragma once
+
+#include "core/memory.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace PXTEngine {
+
+	/**
+	 * @class JobSystem
+	 *
+	 * @brief The engine worker threads, shared by every system that runs work in parallel.
+	 *
+	 * Jobs are run in submission order by a fixed set of workers, one per hardware thread minus
+	 * the main one. submit queues a background job (e.g. a pipeline compilation) and returns its
+	 * future; parallelFor splits frame work (culling, sorting, command recording) over the workers
+	 * and the calling thread, which takes part and returns once every index has run. As the caller
+	 * always makes progress, a parallelFor never waits on a worker busy with a long job, and it can
+	 * be nested inside a job.
+	 *
+	 * Every thread has an index, see getThreadIndex(), for the per thread resources (e.g. command pools).
+	 */
+	class JobSystem {
+	public:
+		// the main thread plus the workers
+		static constexpr uint32_t MAX_THREADS = 16;
+
+		JobSystem();
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		/**
+		 * @brief Queues a job on the workers.
+		 *
+		 * @return The future of the result, it holds the exception thrown by the job, if any.
+		 */
+		template<typename F>
+		std::future<std::invoke_result_t<F>> submit(F&& function) {
+			using Result = std::invoke_result_t<F>;
+
+			// std::function needs a copyable target
+			auto task = createShared<std::packaged_task<Result()>>(std::forward<F>(function));
+			std::future<Result> future = task->get_future();
+
+			push([task]() { (*task)(); });
+
+			return future;
+		}
+
+		/**
+		 * @brief Runs function(index) for every index in [0, count) on the workers and the calling thread.
+		 * Returns when every index has run, then rethrows the first exception thrown, if any.
+		 */
+		void parallelFor(uint32_t count, const std::function<void(uint32_t index)>& function);
+
+		/**
+		 * @brief The workers plus the calling thread.
+		 */
+		uint32_t getThreadCount() const { return static_cast<uint32_t>(m_workers.size()) + 1; }
+
+		/**
+		 * @brief The index of the calling thread: 1 to getThreadCount() - 1 on the workers,
+		 * 0 on any other thread. Only the main thread may use index 0 concurrently with the workers.
+		 */
+		static uint32_t getThreadIndex();
+
+	private:
+		void push(std::function<void()> job);
+		void workerLoop(uint32_t threadIndex);
+
+		std::vector<std::thread> m_workers;
+		std::deque<std::function<void()>> m_jobs;
+		std::mutex m_mutex;
+		std::condition_variable m_jobAvailable;
+		bool m_isStopping = false;
+	};
+}
@@ -50,3 +50,8 @@
 	defined(PXT_PLATFORM_UNIX)  || defined(PXT_PLATFORM_POSIX)
 #define PXT_PLATFORM_POSIX_LIKE
 #endif
+
+// SIMD instruction sets available at compile time
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PXT_SIMD_SSE2
+#endif
@@ -0,0 +1,24 @@
+#include "application.hpp"
+
+#include "core/diagnostics.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+int main(int argc, char** argv) {
+    PXTEngine::Application::m_arguments.assign(argv + std::min(argc, 1), argv + argc);
+
+    try {
+        auto app = PXTEngine::initApplication();
+
+        app->start();
+        app->run();
+
+        delete app;
+    } catch (const std::exception& e) {
+		PXT_ERROR("Application crashed: {}", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
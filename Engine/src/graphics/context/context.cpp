@@ -1,5 +1,9 @@
 #include "graphics/context/context.hpp"
 
+#include "core/constants.hpp"
+#include "graphics/pipeline_compiler.hpp"
+#include "graphics/shader_library.hpp"
+
 #include <stdexcept>
 
 
@@ -10,12 +14,23 @@ namespace PXTEngine {
         m_instance{ "PXT Engine" },
         m_surface{ m_window, m_instance },
         m_physicalDevice{ m_instance, m_surface },
-        m_device{ m_window, m_instance, m_surface, m_physicalDevice } {
+        m_device{ m_window, m_instance, m_surface, m_physicalDevice },
+        m_pipelineCache{ m_physicalDevice, m_device, PIPELINE_CACHE_FILEPATH },
+        m_samplerCache{ m_device } {
 
 		createCommandPool();
+
+        m_shaderLibrary = createUnique<ShaderLibrary>(m_device.getDevice(), m_device.isInlineSpirvSupported());
+        m_pipelineCompiler = createUnique<PipelineCompiler>(*this);
     }
 
 	Context::~Context() {
+        // the objects retired by the last frames, the device is idle once the application stops
+        m_deletionQueue.flush();
+
+        // finish the pending pipelines before the cache is saved and the device destroyed
+        m_pipelineCompiler.reset();
+
         vkDestroyCommandPool(m_device.getDevice(), m_commandPool, nullptr);
 	}
     
@@ -191,13 +206,8 @@ namespace PXTEngine {
 		return imageView;
 	}
 
-	VkSampler Context::createSampler(const VkSamplerCreateInfo& samplerInfo) {
-		VkSampler sampler;
-		if (vkCreateSampler(m_device.getDevice(), &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create texture sampler!");
-		}
-
-		return sampler;
+	VkSampler Context::getSampler(const VkSamplerCreateInfo& samplerInfo) {
+		return m_samplerCache.get(samplerInfo);
 	}
 
 	VkFormat Context::findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling,
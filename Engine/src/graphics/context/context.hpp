@@ -4,6 +4,11 @@
 #include "graphics/context/surface.hpp"
 #include "graphics/context/physical_device.hpp"
 #include "graphics/context/logical_device.hpp"
+#include "graphics/context/pipeline_cache.hpp"
+#include "graphics/context/sampler_cache.hpp"
+#include "graphics/context/deletion_queue.hpp"
+#include "core/job_system.hpp"
+#include "core/memory.hpp"
 
 // IMGUI
 #define IMGUI_DEFINE_MATH_OPERATORS
@@ -15,6 +20,9 @@
 
 namespace PXTEngine {
 
+	class PipelineCompiler;
+	class ShaderLibrary;
+
 	/**
 	 * @class Context
 	 * 
@@ -36,6 +44,38 @@ namespace PXTEngine {
 
 		VkCommandPool getCommandPool() { return m_commandPool; }
 
+		/**
+		 * @brief The pipeline cache every pipeline is created with, persisted between runs.
+		 */
+		VkPipelineCache getPipelineCache() { return m_pipelineCache.getPipelineCache(); }
+		bool isPipelineCacheWarm() const { return m_pipelineCache.isWarm(); }
+
+		/**
+		 * @brief The worker threads shared by the engine, see JobSystem.
+		 */
+		JobSystem& getJobSystem() { return m_jobSystem; }
+
+		/**
+		 * @brief The samplers shared by the images, see SamplerCache.
+		 */
+		SamplerCache& getSamplerCache() { return m_samplerCache; }
+
+		/**
+		 * @brief The SPIR-V modules shared by the pipelines, see ShaderLibrary.
+		 */
+		ShaderLibrary& getShaderLibrary() { return *m_shaderLibrary; }
+
+		/**
+		 * @brief Compiles the pipelines on the job system, see PipelineCompiler.
+		 */
+		PipelineCompiler& getPipelineCompiler() { return *m_pipelineCompiler; }
+
+		/**
+		 * @brief Where the objects still in use by the frames in flight are pushed instead of
+		 * being destroyed, see DeletionQueue.
+		 */
+		DeletionQueue& getDeletionQueue() { return m_deletionQueue; }
+
 		VkPhysicalDeviceProperties getPhysicalDeviceProperties() {
 			return m_physicalDevice.properties;
 		}
@@ -53,6 +93,8 @@ namespace PXTEngine {
 		VkQueue getGraphicsQueue() { return m_device.getGraphicsQueue(); }
 		VkQueue getPresentQueue() { return m_device.getPresentQueue(); }
 
+		bool isDrawIndirectCountSupported() const { return m_device.isDrawIndirectCountSupported(); }
+
 		/* ----------------------- Buffer Helper Functions ----------------------- */
 
 		/**
@@ -147,14 +189,15 @@ namespace PXTEngine {
 		VkImageView createImageView(const VkImageViewCreateInfo& viewInfo);
 
 		/**
-		* @brief Creates a sampler for an image.
+		* @brief Gets a sampler for an image.
 		* 
-		* This function creates a sampler for an image, which is used to sample the image data.
+		* This function returns the sampler matching the create info from the sampler cache,
+		* creating it on the first request. The sampler is shared and must not be destroyed.
 		* 
 		* @param samplerInfo The sampler create info.
 		* @return The sampler handle.
 		*/
-		VkSampler createSampler(const VkSamplerCreateInfo& samplerInfo);
+		VkSampler getSampler(const VkSamplerCreateInfo& samplerInfo);
 
 		/**
 		 * @brief Finds a supported format for an image.
@@ -192,10 +235,17 @@ namespace PXTEngine {
 		void createCommandPool();
 
 		Window& m_window;
+		// first in, last out: the other members may queue jobs until they are destroyed
+		JobSystem m_jobSystem;
 		Instance m_instance;
 		Surface m_surface;
 		PhysicalDevice m_physicalDevice;
 		LogicalDevice m_device;
+		PipelineCache m_pipelineCache;
+		SamplerCache m_samplerCache;
+		Unique<ShaderLibrary> m_shaderLibrary;
+		Unique<PipelineCompiler> m_pipelineCompiler;
+		DeletionQueue m_deletionQueue;
 
 		VkCommandPool m_commandPool;
 
@@ -0,0 +1,51 @@
+#include "graphics/context/deletion_queue.hpp"
+
+#include <vector>
+
+namespace PXTEngine {
+
+    DeletionQueue::~DeletionQueue() {
+        flush();
+    }
+
+    void DeletionQueue::push(std::function<void()> deleter) {
+        std::lock_guard lock(m_mutex);
+        m_entries.push_back({ m_frame, std::move(deleter) });
+    }
+
+    void DeletionQueue::beginFrame(uint32_t framesInFlight) {
+        std::vector<Entry> retired;
+        {
+            std::lock_guard lock(m_mutex);
+            m_frame++;
+
+            // the frames up to m_frame - framesInFlight have completed
+            while (!m_entries.empty() && m_entries.front().frame + framesInFlight <= m_frame) {
+                retired.push_back(std::move(m_entries.front()));
+                m_entries.pop_front();
+            }
+        }
+
+        // outside of the lock, destroying an owner may push new entries
+        for (Entry& entry : retired) {
+            entry.deleter();
+        }
+    }
+
+    void DeletionQueue::flush() {
+        std::deque<Entry> entries;
+        {
+            std::lock_guard lock(m_mutex);
+            entries.swap(m_entries);
+        }
+
+        for (Entry& entry : entries) {
+            entry.deleter();
+        }
+    }
+
+    size_t DeletionQueue::size() const {
+        std::lock_guard lock(m_mutex);
+        return m_entries.size();
+    }
+}
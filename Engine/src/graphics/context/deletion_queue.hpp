@@ -0,0 +1,73 @@
+#pragma once
+
+#include "core/memory.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace PXTEngine {
+
+    /**
+     * @class DeletionQueue
+     *
+     * @brief Destroys the Vulkan objects replaced while frames using them may still be in flight.
+     *
+     * Every entry is tagged with the frame being recorded when it was pushed; it is destroyed once
+     * the fence of that frame has been waited on, i.e. when the frame slot is begun again
+     * (see Renderer::beginFrame). An entry is either a deleter, called when the frame retires,
+     * or an owner (VulkanImage, VulkanBuffer, FrameBuffer...) kept alive until then.
+     * Whatever is left is destroyed with the queue, the device must be idle by then.
+     */
+    class DeletionQueue {
+    public:
+        DeletionQueue() = default;
+        ~DeletionQueue();
+
+        DeletionQueue(const DeletionQueue&) = delete;
+        DeletionQueue& operator=(const DeletionQueue&) = delete;
+
+        void push(std::function<void()> deleter);
+
+        template<typename T>
+        void push(Shared<T> resource) {
+            if (resource == nullptr) return;
+
+            // the capture is released with the entry
+            push([resource = std::move(resource)]() {});
+        }
+
+        template<typename T>
+        void push(Unique<T> resource) {
+            push(Shared<T>(std::move(resource)));
+        }
+
+        /**
+         * @brief Starts a new frame and destroys the entries of the frames that retired.
+         * Must be called once the fence of the frame slot has been waited on.
+         *
+         * @param framesInFlight Frames recorded before the fence wait that may still be executing.
+         */
+        void beginFrame(uint32_t framesInFlight);
+
+        /**
+         * @brief Destroys every entry, the device must be idle.
+         */
+        void flush();
+
+        size_t size() const;
+
+    private:
+        struct Entry {
+            uint64_t frame = 0;
+            std::function<void()> deleter;
+        };
+
+        // entries are pushed in frame order, the oldest at the front
+        std::deque<Entry> m_entries;
+        uint64_t m_frame = 0;
+
+        mutable std::mutex m_mutex;
+    };
+}
@@ -35,27 +35,42 @@ namespace PXTEngine {
 
         // --- Feature Structures ---
 
-        // Buffer Device Address Features (Required for RT)
-        VkPhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddressFeatures{};
-        bufferDeviceAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
-        bufferDeviceAddressFeatures.bufferDeviceAddress = VK_TRUE;
+        // Vulkan 1.2 Features: buffer device address, descriptor indexing, indirect count and layer output
+        // (the individual feature structures must not be chained together with this one)
+        VkPhysicalDeviceVulkan12Features vulkan12Features{};
+        vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
 
-		// Descriptor Indexing Features
-        VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
-        indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        // Buffer device address (Required for RT)
+        vulkan12Features.bufferDeviceAddress = VK_TRUE;
 
         // This enables the ability to use non-uniform indexing for sampled image arrays within shaders.
         // Non-uniform indexing means that the index used to access an array can be dynamically calculated within 
         // the shader, rather than being a constant. 
-        indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
 
         // This allows descriptor sets to have some bindings that are not bound to any resources.
         // This is useful for situations where you don't need to bind all resources in a descriptor set.
-        indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+        vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
 
         // This enables runtime-sized descriptor arrays, 
         // which means that the size of descriptor arrays can be determined dynamically at runtime.
-        indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+        vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+
+        // The bindless texture heap is written while bound: a texture registered at runtime writes
+        // its slot in place, as long as the frames in flight do not sample that slot
+        vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        vulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+
+        // Optional: draw count read from a buffer, used by GPU driven culling
+        vulkan12Features.drawIndirectCount = VK_TRUE;
+
+        // gl_Layer written from the vertex shader, used to render the 6 shadow cube faces in one pass
+        vulkan12Features.shaderOutputLayer = VK_TRUE;
+
+        // Vulkan 1.3 Features: the render graph records its barriers with vkCmdPipelineBarrier2
+        VkPhysicalDeviceVulkan13Features vulkan13Features{};
+        vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+        vulkan13Features.synchronization2 = VK_TRUE;
 
         // Acceleration Structure Features
         VkPhysicalDeviceAccelerationStructureFeaturesKHR accelStructFeatures{};
@@ -73,13 +88,37 @@ namespace PXTEngine {
 
         // --- Feature Chaining ---
         // Chain the features in this order 
-        // BDA -> Descriptor Indexing -> Accel Struct -> RT Pipeline
-        bufferDeviceAddressFeatures.pNext = &indexingFeatures;
-        indexingFeatures.pNext = &accelStructFeatures;
+        // Vulkan 1.2 -> Vulkan 1.3 -> Accel Struct -> RT Pipeline
+        vulkan12Features.pNext = &vulkan13Features;
+        vulkan13Features.pNext = &accelStructFeatures;
         accelStructFeatures.pNext = &rtPipelineFeatures;
         rtPipelineFeatures.pNext = &rayTracingValidationFeatures;
         rayTracingValidationFeatures.pNext = nullptr; // Make sure the last one points to nullptr
 
+        // Optional: SPIR-V handed inline to the pipeline creation, see ShaderLibrary.
+        // These go in front of the chain, it ends with the required features above
+        std::vector<const char*> deviceExtensions = m_physicalDevice.deviceExtensions;
+        void* optionalFeaturesChain = &vulkan12Features;
+
+        VkPhysicalDeviceMaintenance5FeaturesKHR maintenance5Features{};
+        maintenance5Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_5_FEATURES_KHR;
+
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibraryFeatures{};
+        pipelineLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+
+        if (m_physicalDevice.isExtensionSupported(VK_KHR_MAINTENANCE_5_EXTENSION_NAME)) {
+            deviceExtensions.push_back(VK_KHR_MAINTENANCE_5_EXTENSION_NAME);
+            maintenance5Features.pNext = optionalFeaturesChain;
+            optionalFeaturesChain = &maintenance5Features;
+        }
+        else if (m_physicalDevice.isExtensionSupported(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+                 m_physicalDevice.isExtensionSupported(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME)) {
+            deviceExtensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+            deviceExtensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+            pipelineLibraryFeatures.pNext = optionalFeaturesChain;
+            optionalFeaturesChain = &pipelineLibraryFeatures;
+        }
+
         // This structure holds the physical device features that are required for the logical device.
         VkPhysicalDeviceFeatures2 deviceFeatures2{};
         deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
@@ -90,27 +129,49 @@ namespace PXTEngine {
 
 		// Enable fill mode non solid for wireframe support
 		deviceFeatures2.features.fillModeNonSolid = VK_TRUE;
+
+		// Enable cube map arrays, one cube per shadowed point light
+		deviceFeatures2.features.imageCubeArray = VK_TRUE;
+
+        // Optional: multiple draws per indirect call, with a per draw first instance
+        deviceFeatures2.features.multiDrawIndirect = VK_TRUE;
+        deviceFeatures2.features.drawIndirectFirstInstance = VK_TRUE;
   
-        // Enable the descriptor indexing features
-        deviceFeatures2.pNext = &bufferDeviceAddressFeatures;
+        // Enable the Vulkan 1.2 features (and the optional ones)
+        deviceFeatures2.pNext = optionalFeaturesChain;
 
         // Fetch the physical device features
         vkGetPhysicalDeviceFeatures2(m_physicalDevice.getDevice(), &deviceFeatures2);
 
         // Check if the required features are supported
-        if (!indexingFeatures.shaderSampledImageArrayNonUniformIndexing ||
-            !indexingFeatures.descriptorBindingPartiallyBound ||
-            !indexingFeatures.runtimeDescriptorArray) {
+        if (!vulkan12Features.shaderSampledImageArrayNonUniformIndexing ||
+            !vulkan12Features.descriptorBindingPartiallyBound ||
+            !vulkan12Features.runtimeDescriptorArray ||
+            !vulkan12Features.descriptorBindingSampledImageUpdateAfterBind ||
+            !vulkan12Features.descriptorBindingUpdateUnusedWhilePending) {
 
             throw std::runtime_error("Required descriptor indexing features are not supported!");
         }
 
 		// Check if the required features are supported
 		if (!deviceFeatures2.features.samplerAnisotropy ||
-            !deviceFeatures2.features.fillModeNonSolid) {
+            !deviceFeatures2.features.fillModeNonSolid ||
+            !deviceFeatures2.features.imageCubeArray) {
 			throw std::runtime_error("Required features are not supported!");
 		}
 
+        if (!vulkan12Features.bufferDeviceAddress) {
+            throw std::runtime_error("Required bufferDeviceAddress feature is not supported!");
+        }
+
+        if (!vulkan12Features.shaderOutputLayer) {
+            throw std::runtime_error("Required shaderOutputLayer feature is not supported!");
+        }
+
+        if (!vulkan13Features.synchronization2) {
+            throw std::runtime_error("Required synchronization2 feature is not supported!");
+        }
+
         if (!accelStructFeatures.accelerationStructure) {
             throw std::runtime_error("Required accelerationStructure feature is not supported!");
         }
@@ -125,6 +186,22 @@ namespace PXTEngine {
             rtPipelineFeatures.pNext = nullptr;
         }
 
+        // optional features are left enabled only when supported, the queried values are used as is
+        m_isDrawIndirectCountSupported = vulkan12Features.drawIndirectCount &&
+            deviceFeatures2.features.multiDrawIndirect &&
+            deviceFeatures2.features.drawIndirectFirstInstance;
+
+        if (!m_isDrawIndirectCountSupported) {
+            std::cout << "Indirect count drawing not supported, GPU driven culling disabled." << std::endl;
+        }
+
+        m_isInlineSpirvSupported = maintenance5Features.maintenance5 ||
+            pipelineLibraryFeatures.graphicsPipelineLibrary;
+
+        if (!m_isInlineSpirvSupported) {
+            std::cout << "Inline SPIR-V not supported, shader modules are created." << std::endl;
+        }
+
         VkDeviceCreateInfo createInfo = {};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 
@@ -143,8 +220,8 @@ namespace PXTEngine {
         createInfo.pEnabledFeatures = nullptr;
 
         // Device extensions provide additional functionality beyond the core Vulkan specification.
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(m_physicalDevice.deviceExtensions.size());
-        createInfo.ppEnabledExtensionNames = m_physicalDevice.deviceExtensions.data();
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
         
         if (vkCreateDevice(m_physicalDevice.getDevice(), &createInfo, nullptr,&m_device) != VK_SUCCESS) {
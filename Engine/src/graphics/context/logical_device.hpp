@@ -36,6 +36,17 @@ namespace PXTEngine {
         VkQueue getGraphicsQueue() { return m_graphicsQueue; }
         VkQueue getPresentQueue() { return m_presentQueue; }
 
+        /**
+         * @brief Whether vkCmdDrawIndexedIndirectCount can be used with multiple draws and per draw first instance.
+         */
+        bool isDrawIndirectCountSupported() const { return m_isDrawIndirectCountSupported; }
+
+        /**
+         * @brief Whether pipeline stages can take their SPIR-V inline, without a VkShaderModule
+         * (VK_KHR_maintenance5 or VK_EXT_graphics_pipeline_library).
+         */
+        bool isInlineSpirvSupported() const { return m_isInlineSpirvSupported; }
+
     private:
         /**
          * @brief Creates a logical device.
@@ -54,6 +65,9 @@ namespace PXTEngine {
         
         VkQueue m_graphicsQueue;
         VkQueue m_presentQueue;
+
+        bool m_isDrawIndirectCountSupported = false;
+        bool m_isInlineSpirvSupported = false;
     };
 
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "graphics/context/physical_device.hpp"
 
+#include <algorithm>
+#include <string>
 #include <vector>
 #include <iostream>
 #include <set>
@@ -142,6 +144,19 @@ namespace PXTEngine {
         return indices.isComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
     }
 
+    bool PhysicalDevice::isExtensionSupported(const char* extensionName) const {
+        uint32_t extensionCount;
+        vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, nullptr);
+
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+
+        return std::any_of(availableExtensions.begin(), availableExtensions.end(),
+            [&](const VkExtensionProperties& extension) {
+                return std::string(extension.extensionName) == extensionName;
+            });
+    }
+
     bool PhysicalDevice::checkDeviceExtensionSupport(const VkPhysicalDevice device) {
         uint32_t extensionCount;
 
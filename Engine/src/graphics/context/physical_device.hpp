@@ -127,6 +127,11 @@ namespace PXTEngine {
             return querySwapChainSupportForDevice(m_physicalDevice);
         }
 
+        /**
+         * @brief Whether the picked device supports the extension, for the optional ones.
+         */
+        bool isExtensionSupported(const char* extensionName) const;
+
         VkPhysicalDeviceProperties properties;
 
         std::vector<const char*> deviceExtensions = {
@@ -0,0 +1,142 @@
+#include "graphics/context/pipeline_cache.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace PXTEngine {
+
+    /**
+     * @struct PipelineCacheFileHeader
+     *
+     * @brief Written before the cache data, identifies the device and driver the data belongs to.
+     */
+    struct PipelineCacheFileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+        uint32_t reserved;      // keeps dataSize aligned without padding, the header is compared bytewise
+        uint64_t dataSize;
+    };
+
+    static constexpr uint32_t PIPELINE_CACHE_MAGIC = 0x43505850; // "PXPC"
+    static constexpr uint32_t PIPELINE_CACHE_VERSION = 1;
+
+    static PipelineCacheFileHeader makeHeader(const VkPhysicalDeviceProperties& properties, uint64_t dataSize) {
+        PipelineCacheFileHeader header{};
+        header.magic = PIPELINE_CACHE_MAGIC;
+        header.version = PIPELINE_CACHE_VERSION;
+        header.vendorID = properties.vendorID;
+        header.deviceID = properties.deviceID;
+        header.driverVersion = properties.driverVersion;
+        std::memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+        header.dataSize = dataSize;
+
+        return header;
+    }
+
+    PipelineCache::PipelineCache(PhysicalDevice& physicalDevice, LogicalDevice& device, std::string filePath)
+        : m_physicalDevice(physicalDevice), m_device(device), m_filePath(std::move(filePath)) {
+        std::vector<char> data = load();
+        m_isWarm = !data.empty();
+
+        VkPipelineCacheCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        createInfo.initialDataSize = data.size();
+        createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+        if (vkCreatePipelineCache(m_device.getDevice(), &createInfo, nullptr, &m_pipelineCache) != VK_SUCCESS) {
+            // the driver may still refuse data that passed our header checks, start cold then
+            createInfo.initialDataSize = 0;
+            createInfo.pInitialData = nullptr;
+            m_isWarm = false;
+
+            if (vkCreatePipelineCache(m_device.getDevice(), &createInfo, nullptr, &m_pipelineCache) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create pipeline cache!");
+            }
+        }
+
+        std::cout << "Pipeline cache " << (m_isWarm ? "warm" : "cold")
+            << " (" << data.size() << " bytes loaded)" << std::endl;
+    }
+
+    PipelineCache::~PipelineCache() {
+        // saving must never throw out of a destructor, a lost cache only costs a cold start
+        try {
+            save();
+        } catch (const std::exception& e) {
+            std::cerr << "failed to save pipeline cache: " << e.what() << std::endl;
+        }
+
+        vkDestroyPipelineCache(m_device.getDevice(), m_pipelineCache, nullptr);
+    }
+
+    std::vector<char> PipelineCache::load() {
+        std::ifstream file{ m_filePath, std::ios::binary };
+        if (!file.is_open()) {
+            return {};
+        }
+
+        PipelineCacheFileHeader header{};
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            return {};
+        }
+
+        const PipelineCacheFileHeader expected = makeHeader(m_physicalDevice.properties, header.dataSize);
+        if (std::memcmp(&header, &expected, sizeof(header)) != 0) {
+            std::cout << "Pipeline cache written by another device or driver, discarding it." << std::endl;
+            return {};
+        }
+
+        std::vector<char> data(header.dataSize);
+        if (!file.read(data.data(), static_cast<std::streamsize>(data.size()))) {
+            return {};
+        }
+
+        return data;
+    }
+
+    void PipelineCache::save() {
+        size_t dataSize = 0;
+        if (vkGetPipelineCacheData(m_device.getDevice(), m_pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+            return;
+        }
+
+        std::vector<char> data(dataSize);
+        if (vkGetPipelineCacheData(m_device.getDevice(), m_pipelineCache, &dataSize, data.data()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to get pipeline cache data!");
+        }
+
+        const PipelineCacheFileHeader header = makeHeader(m_physicalDevice.properties, dataSize);
+
+        // write next to the cache and swap it in, the rename replaces the old file in one step
+        const std::filesystem::path path{ m_filePath };
+        const std::filesystem::path tempPath{ m_filePath + ".tmp" };
+
+        if (path.has_parent_path()) {
+            std::filesystem::create_directories(path.parent_path());
+        }
+
+        {
+            std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+            if (!file.is_open()) {
+                throw std::runtime_error("failed to open file: " + tempPath.string());
+            }
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(data.data(), static_cast<std::streamsize>(dataSize));
+
+            if (!file.flush()) {
+                throw std::runtime_error("failed to write file: " + tempPath.string());
+            }
+        }
+
+        std::filesystem::rename(tempPath, path);
+    }
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "graphics/context/physical_device.hpp"
+#include "graphics/context/logical_device.hpp"
+
+#include <string>
+#include <vector>
+
+namespace PXTEngine {
+
+    /**
+     * @class PipelineCache
+     *
+     * @brief Engine wide VkPipelineCache, persisted on disk between runs.
+     *
+     * The cache data is loaded at startup and handed to every pipeline creation, so the driver
+     * can skip the shader compilation of the pipelines it has already seen. The file starts with
+     * a header holding the vendor, device, driver version and pipeline cache UUID of the device
+     * that wrote it; a file written by another device or driver is discarded and the cache starts cold.
+     *
+     * The cache is saved when it is destroyed, to a temporary file that then replaces the
+     * previous one, so an interrupted save never leaves a truncated cache behind.
+     */
+    class PipelineCache {
+    public:
+        PipelineCache(PhysicalDevice& physicalDevice, LogicalDevice& device, std::string filePath);
+        ~PipelineCache();
+
+        PipelineCache(const PipelineCache&) = delete;
+        PipelineCache& operator=(const PipelineCache&) = delete;
+
+        VkPipelineCache getPipelineCache() const { return m_pipelineCache; }
+
+        /**
+         * @brief Whether valid data of a previous run was loaded at startup.
+         */
+        bool isWarm() const { return m_isWarm; }
+
+        /**
+         * @brief Writes the current cache data to disk.
+         */
+        void save();
+
+    private:
+        /**
+         * @brief Reads and validates the cache file, returns the cache data or nothing when it can't be used.
+         */
+        std::vector<char> load();
+
+        PhysicalDevice& m_physicalDevice;
+        LogicalDevice& m_device;
+        std::string m_filePath;
+
+        VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+        bool m_isWarm = false;
+    };
+
+}
@@ -0,0 +1,91 @@
+#include "graphics/context/sampler_cache.hpp"
+
+#include "core/diagnostics.hpp"
+#include "utils/hash_func.hpp"
+
+#include <stdexcept>
+
+namespace PXTEngine {
+
+    SamplerCache::SamplerCache(LogicalDevice& device) : m_device(device) {}
+
+    SamplerCache::~SamplerCache() {
+        for (auto& [key, sampler] : m_samplers) {
+            vkDestroySampler(m_device.getDevice(), sampler, nullptr);
+        }
+    }
+
+    VkSampler SamplerCache::get(const VkSamplerCreateInfo& samplerInfo) {
+        PXT_ASSERT(samplerInfo.pNext == nullptr, "Sampler create info extensions are not cached");
+
+        std::lock_guard lock(m_mutex);
+
+        Key key{ samplerInfo };
+        if (auto it = m_samplers.find(key); it != m_samplers.end()) {
+            return it->second;
+        }
+
+        VkSampler sampler;
+        if (vkCreateSampler(m_device.getDevice(), &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create texture sampler!");
+        }
+
+        m_samplers.emplace(key, sampler);
+
+        return sampler;
+    }
+
+    size_t SamplerCache::size() const {
+        std::lock_guard lock(m_mutex);
+        return m_samplers.size();
+    }
+
+    bool SamplerCache::Key::operator==(const Key& other) const {
+        // compared field by field, the padding of the struct is not initialized
+        const VkSamplerCreateInfo& a = info;
+        const VkSamplerCreateInfo& b = other.info;
+
+        return a.flags == b.flags &&
+            a.magFilter == b.magFilter &&
+            a.minFilter == b.minFilter &&
+            a.mipmapMode == b.mipmapMode &&
+            a.addressModeU == b.addressModeU &&
+            a.addressModeV == b.addressModeV &&
+            a.addressModeW == b.addressModeW &&
+            a.mipLodBias == b.mipLodBias &&
+            a.anisotropyEnable == b.anisotropyEnable &&
+            a.maxAnisotropy == b.maxAnisotropy &&
+            a.compareEnable == b.compareEnable &&
+            a.compareOp == b.compareOp &&
+            a.minLod == b.minLod &&
+            a.maxLod == b.maxLod &&
+            a.borderColor == b.borderColor &&
+            a.unnormalizedCoordinates == b.unnormalizedCoordinates;
+    }
+
+    size_t SamplerCache::KeyHash::operator()(const Key& key) const {
+        const VkSamplerCreateInfo& info = key.info;
+
+        size_t seed = 0;
+        hashCombine(seed,
+            info.flags,
+            static_cast<uint32_t>(info.magFilter),
+            static_cast<uint32_t>(info.minFilter),
+            static_cast<uint32_t>(info.mipmapMode),
+            static_cast<uint32_t>(info.addressModeU),
+            static_cast<uint32_t>(info.addressModeV),
+            static_cast<uint32_t>(info.addressModeW),
+            info.mipLodBias,
+            info.anisotropyEnable,
+            info.maxAnisotropy,
+            info.compareEnable,
+            static_cast<uint32_t>(info.compareOp),
+            info.minLod,
+            info.maxLod,
+            static_cast<uint32_t>(info.borderColor),
+            info.unnormalizedCoordinates);
+
+        return seed;
+    }
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "graphics/context/logical_device.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace PXTEngine {
+
+    /**
+     * @class SamplerCache
+     *
+     * @brief Engine wide cache of the VkSamplers, one sampler per distinct VkSamplerCreateInfo.
+     *
+     * Samplers hold no image, every texture sampled the same way shares one; drivers cap the
+     * samplers alive at maxSamplerAllocationCount (4000 on many), far less than the textures
+     * a scene can load. The samplers are owned by the cache and destroyed with it.
+     */
+    class SamplerCache {
+    public:
+        explicit SamplerCache(LogicalDevice& device);
+        ~SamplerCache();
+
+        SamplerCache(const SamplerCache&) = delete;
+        SamplerCache& operator=(const SamplerCache&) = delete;
+
+        /**
+         * @brief Returns the sampler created with the given info, creating it on the first request.
+         *
+         * @param samplerInfo The sampler create info, extension structures (pNext) are not supported.
+         * @return The shared sampler handle, not to be destroyed by the caller.
+         */
+        VkSampler get(const VkSamplerCreateInfo& samplerInfo);
+
+        size_t size() const;
+
+    private:
+        struct Key {
+            VkSamplerCreateInfo info;
+
+            bool operator==(const Key& other) const;
+        };
+
+        struct KeyHash {
+            size_t operator()(const Key& key) const;
+        };
+
+        LogicalDevice& m_device;
+
+        std::unordered_map<Key, VkSampler, KeyHash> m_samplers;
+        mutable std::mutex m_mutex;
+    };
+
+}
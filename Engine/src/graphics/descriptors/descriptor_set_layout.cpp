@@ -24,24 +24,53 @@ namespace PXTEngine {
         return *this;
     }
 
+    DescriptorSetLayout::Builder& DescriptorSetLayout::Builder::setBindingFlags(
+        const uint32_t binding,
+        const VkDescriptorBindingFlags flags) {
+
+        PXT_ASSERT(m_bindings.contains(binding), "Binding not added to the layout");
+
+        m_bindingFlags[binding] = flags;
+        return *this;
+    }
+
+    DescriptorSetLayout::Builder& DescriptorSetLayout::Builder::setLayoutFlags(const VkDescriptorSetLayoutCreateFlags flags) {
+        m_layoutFlags = flags;
+        return *this;
+    }
+
     Unique<DescriptorSetLayout> DescriptorSetLayout::Builder::build() const {
-        return createUnique<DescriptorSetLayout>(m_context, m_bindings);
+        return createUnique<DescriptorSetLayout>(m_context, m_bindings, m_bindingFlags, m_layoutFlags);
     }
 
     DescriptorSetLayout::DescriptorSetLayout(Context& context,
-        std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings) :
+        std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+        const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags,
+        const VkDescriptorSetLayoutCreateFlags layoutFlags) :
     m_context{context},
     m_bindings{std::move(bindings)} {
 
         std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings{};
+        std::vector<VkDescriptorBindingFlags> setLayoutBindingFlags{};
         for (auto val: m_bindings | std::views::values) {
             setLayoutBindings.push_back(val);
+
+            // one entry per binding, in the same order
+            auto it = bindingFlags.find(val.binding);
+            setLayoutBindingFlags.push_back(it != bindingFlags.end() ? it->second : 0);
         }
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+        bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        bindingFlagsInfo.bindingCount = static_cast<uint32_t>(setLayoutBindingFlags.size());
+        bindingFlagsInfo.pBindingFlags = setLayoutBindingFlags.data();
         
         VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo{};
         descriptorSetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
         descriptorSetLayoutInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
         descriptorSetLayoutInfo.pBindings = setLayoutBindings.data();
+        descriptorSetLayoutInfo.flags = layoutFlags;
+        descriptorSetLayoutInfo.pNext = bindingFlags.empty() ? nullptr : &bindingFlagsInfo;
         
         if (vkCreateDescriptorSetLayout(
                 m_context.getDevice(),
@@ -40,6 +40,23 @@ namespace PXTEngine {
                 VkShaderStageFlags stageFlags,
                 uint32_t count = 1);
 
+            /**
+             * @brief Sets the binding flags (e.g. partially bound, update after bind) of a binding.
+             *
+             * @param binding Binding index, must have been added.
+             * @param flags Flags chained to the layout with VkDescriptorSetLayoutBindingFlagsCreateInfo.
+             * @return Reference to the Builder for chaining.
+             */
+            Builder& setBindingFlags(uint32_t binding, VkDescriptorBindingFlags flags);
+
+            /**
+             * @brief Sets the creation flags of the layout.
+             *
+             * @param flags Vulkan descriptor set layout creation flags.
+             * @return Reference to the Builder for chaining.
+             */
+            Builder& setLayoutFlags(VkDescriptorSetLayoutCreateFlags flags);
+
             /**
              * @brief Finalizes and builds the DescriptorSetLayout.
              *
@@ -52,9 +69,13 @@ namespace PXTEngine {
         private:
             Context& m_context;
             std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> m_bindings{};
+            std::unordered_map<uint32_t, VkDescriptorBindingFlags> m_bindingFlags{};
+            VkDescriptorSetLayoutCreateFlags m_layoutFlags = 0;
         };
 
-        DescriptorSetLayout(Context& context, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings);
+        DescriptorSetLayout(Context& context, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+                            const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags = {},
+                            VkDescriptorSetLayoutCreateFlags layoutFlags = 0);
         ~DescriptorSetLayout();
         
         DescriptorSetLayout(const DescriptorSetLayout &) = delete;
@@ -4,6 +4,8 @@
 #include "graphics/descriptors/descriptor_set_layout.hpp"
 #include "graphics/descriptors/descriptor_pool.hpp"
 
+#include <optional>
+
 
 namespace PXTEngine {
     class DescriptorWriter {
@@ -61,6 +63,20 @@ namespace PXTEngine {
             return write(binding, imagesInfo, count);
         }
 
+        /**
+         * @brief Writes a single image descriptor to one element of an array binding,
+         * leaving the other elements untouched.
+         * 
+         * @param binding The binding index.
+         * @param arrayElement The element of the array to write.
+         * @param imageInfo Pointer to the image descriptor info.
+         * 
+         * @return Reference to the DescriptorWriter instance.
+         */
+        DescriptorWriter& writeImageAt(uint32_t binding, uint32_t arrayElement, VkDescriptorImageInfo* imageInfo) {
+            return write(binding, imageInfo, 1, arrayElement);
+        }
+
 		/**
 		 * @brief Writes a single acceleration structure descriptor to the specified binding.
 		 *
@@ -88,23 +104,29 @@ namespace PXTEngine {
          * @param binding The binding index.
          * @param info Pointer to descriptor info.
          * @param count Number of descriptors.
+         * @param arrayElement First array element written, the whole binding is written when not given.
          * 
          * @return Reference to the DescriptorWriter instance.
          */
         template <typename T>
-        DescriptorWriter& write(uint32_t binding, T* info, uint32_t count) {
+        DescriptorWriter& write(uint32_t binding, T* info, uint32_t count, std::optional<uint32_t> arrayElement = {}) {
 			size_t bindingCount = m_setLayout.m_bindings.count(binding);
 
             PXT_ASSERT(bindingCount == 1, "Layout does not contain specified binding");
             
             auto& bindingDescription = m_setLayout.m_bindings[binding];
             
-            PXT_ASSERT(bindingDescription.descriptorCount == count, "Binding descriptor info count mismatch");
+            if (arrayElement) {
+                PXT_ASSERT(*arrayElement + count <= bindingDescription.descriptorCount, "Array element out of the binding");
+            } else {
+                PXT_ASSERT(bindingDescription.descriptorCount == count, "Binding descriptor info count mismatch");
+            }
             
             VkWriteDescriptorSet write{};
             write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
             write.descriptorType = bindingDescription.descriptorType;
             write.dstBinding = binding;
+            write.dstArrayElement = arrayElement.value_or(0);
             write.descriptorCount = count;
             
             if constexpr (std::is_same_v<T, VkDescriptorBufferInfo>) {
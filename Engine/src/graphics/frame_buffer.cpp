@@ -16,8 +16,8 @@ namespace PXTEngine {
 
         std::cout << "[FrameBuffer] Creating VkFrameBuffer: " + m_name << std::endl;
 
-        if (!m_colorAttachment) {
-            throw std::runtime_error("[FrameBuffer] Color attachment cannot be null for FrameBuffer: " + m_name);
+        if (!m_colorAttachment && !m_depthAttachment) {
+            throw std::runtime_error("[FrameBuffer] Color and depth attachments cannot both be null for FrameBuffer: " + m_name);
         }
 
         if (createInfo.pAttachments == nullptr || createInfo.attachmentCount == 0) {
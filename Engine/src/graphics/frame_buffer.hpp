@@ -23,6 +23,7 @@ namespace PXTEngine {
         const Context& getContext() const { return m_context; }
         const Shared<VulkanImage>& getColorAttachment() const { return m_colorAttachment; }
         const Shared<VulkanImage>& getDepthAttachment() const { return m_depthAttachment; }
+        bool hasColorAttachment() const { return (bool)m_colorAttachment; }
         bool hasDepthAttachment() const { return (bool)m_depthAttachment; }
 
     private:
@@ -30,7 +31,7 @@ namespace PXTEngine {
         std::string m_name;
         VkFramebufferCreateInfo m_createInfo;
         VkFramebuffer m_FrameBuffer = VK_NULL_HANDLE; // Vulkan handle
-        Shared<VulkanImage> m_colorAttachment; // Shared pointer to the color attachment image
+        Shared<VulkanImage> m_colorAttachment; // Shared pointer to the color attachment image (optional for depth only passes)
         Shared<VulkanImage> m_depthAttachment; // Shared pointer to the depth attachment image (optional)
     };
 }
\ No newline at end of file
@@ -19,11 +19,14 @@ namespace PXTEngine {
         glm::mat4 view{1.f};
         glm::mat4 inverseView{1.f};
         glm::vec4 ambientLightColor{0.67f, 0.85f, 0.9f, .02f};
-        PointLight pointLights[MAX_LIGHTS];
+        PointLight pointLights[MAX_LIGHTS]; // first lights only, the rasterized passes read LightClusterSystem's buffer
         int numLights;
         uint32_t frameCount;
         uint32_t ptAccumulationCount;
         bool accumulationEnabled;
+        float shadowNear;   // point light shadow projection range, see ShadowMapRenderSystem
+        float shadowFar;
+        int shadowQuality;  // 0 = 1 hardware PCF tap, 1 = 8 taps, 2 = 16 taps
     };
 
     struct FrameInfo {
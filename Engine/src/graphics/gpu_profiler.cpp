@@ -0,0 +1,128 @@
+#include "graphics/gpu_profiler.hpp"
+
+#include "core/diagnostics.hpp"
+
+#include <stdexcept>
+
+namespace PXTEngine {
+
+	GpuProfiler::GpuProfiler(Context& context) : m_context(context) {
+		const VkPhysicalDeviceProperties properties = m_context.getPhysicalDeviceProperties();
+
+		// timestampComputeAndGraphics guarantees the timestamps on every graphics and compute queue
+		m_isSupported = properties.limits.timestampComputeAndGraphics == VK_TRUE;
+		m_timestampPeriod = properties.limits.timestampPeriod;
+
+		if (!m_isSupported) return;
+
+		VkQueryPoolCreateInfo queryPoolInfo{};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = MAX_SCOPES * 2;
+
+		for (FrameQueries& frame : m_frames) {
+			if (vkCreateQueryPool(m_context.getDevice(), &queryPoolInfo, nullptr, &frame.queryPool) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create timestamp query pool!");
+			}
+		}
+	}
+
+	GpuProfiler::~GpuProfiler() {
+		for (FrameQueries& frame : m_frames) {
+			vkDestroyQueryPool(m_context.getDevice(), frame.queryPool, nullptr);
+		}
+	}
+
+	void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, int frameIndex) {
+		if (!m_isSupported) return;
+
+		PXT_ASSERT(m_openScopes.empty(), "GPU profiler scope left open in the previous frame");
+
+		m_frameIndex = frameIndex;
+		FrameQueries& frame = m_frames[frameIndex];
+
+		readBack(frame);
+
+		frame.scopes.clear();
+		vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, MAX_SCOPES * 2);
+	}
+
+	void GpuProfiler::readBack(FrameQueries& frame) {
+		if (frame.scopes.empty()) return;
+
+		const uint32_t queryCount = static_cast<uint32_t>(frame.scopes.size()) * 2;
+		std::vector<uint64_t> timestamps(queryCount);
+
+		// the fence of the slot has been waited on, the results are available
+		const VkResult result = vkGetQueryPoolResults(
+			m_context.getDevice(),
+			frame.queryPool,
+			0,
+			queryCount,
+			timestamps.size() * sizeof(uint64_t),
+			timestamps.data(),
+			sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT
+		);
+
+		if (result != VK_SUCCESS) return;
+
+		// the scope list changes when passes are toggled, the smoothing restarts with it
+		const bool isSameLayout = m_timings.size() == frame.scopes.size();
+		if (!isSameLayout) {
+			m_timings.resize(frame.scopes.size());
+		}
+
+		for (size_t i = 0; i < frame.scopes.size(); i++) {
+			const uint64_t ticks = timestamps[2 * i + 1] - timestamps[2 * i];
+			const float milliseconds = static_cast<float>(static_cast<double>(ticks) * m_timestampPeriod * 1e-6);
+
+			Timing& timing = m_timings[i];
+			if (!isSameLayout || timing.name != frame.scopes[i].name) {
+				timing.name = frame.scopes[i].name;
+				timing.depth = frame.scopes[i].depth;
+				timing.milliseconds = milliseconds;
+			} else {
+				timing.milliseconds += (milliseconds - timing.milliseconds) * 0.1f;
+			}
+		}
+	}
+
+	void GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const std::string& name) {
+		if (!m_isSupported) return;
+
+		FrameQueries& frame = m_frames[m_frameIndex];
+		PXT_ASSERT(frame.scopes.size() < MAX_SCOPES, "Too many GPU profiler scopes in a frame");
+
+		const uint32_t scope = static_cast<uint32_t>(frame.scopes.size());
+		frame.scopes.push_back({ name, static_cast<uint32_t>(m_openScopes.size()) });
+		m_openScopes.push_back(scope);
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, scope * 2);
+	}
+
+	void GpuProfiler::endScope(VkCommandBuffer commandBuffer) {
+		if (!m_isSupported) return;
+
+		PXT_ASSERT(!m_openScopes.empty(), "GPU profiler scope ended without being begun");
+
+		const uint32_t scope = m_openScopes.back();
+		m_openScopes.pop_back();
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_frames[m_frameIndex].queryPool, scope * 2 + 1);
+	}
+
+	void GpuProfiler::updateUi() {
+		ImGui::Begin("GPU Timings");
+
+		if (!m_isSupported) {
+			ImGui::Text("Timestamp queries are not supported by the device");
+		} else {
+			for (const Timing& timing : m_timings) {
+				ImGui::Text("%*s%s: %.3f ms", static_cast<int>(timing.depth * 2), "", timing.name.c_str(), timing.milliseconds);
+			}
+		}
+
+		ImGui::End();
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "graphics/context/context.hpp"
+#include "graphics/swap_chain.hpp"
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace PXTEngine {
+
+	/**
+	 * @class GpuProfiler
+	 *
+	 * @brief Measures the GPU time of named scopes of the frame with timestamp queries.
+	 *
+	 * Every frame in flight has its own query pool. The timestamps of a frame slot are read back
+	 * when the slot is recorded again, after its fence has been waited on, so reading never stalls;
+	 * the timings shown are MAX_FRAMES_IN_FLIGHT frames old and smoothed over a few frames.
+	 * Scopes can nest and can be recorded inside or outside render passes.
+	 * Nothing is recorded when the graphics queue does not support timestamps.
+	 */
+	class GpuProfiler {
+	public:
+		static constexpr uint32_t MAX_SCOPES = 32;
+
+		struct Timing {
+			std::string name;
+			uint32_t depth = 0;			// nesting level
+			float milliseconds = 0.0f;	// smoothed
+		};
+
+		GpuProfiler(Context& context);
+		~GpuProfiler();
+
+		GpuProfiler(const GpuProfiler&) = delete;
+		GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+		/**
+		 * @brief Reads back the timestamps of the previous use of the frame slot and resets its queries.
+		 * Must be recorded outside of a render pass, before any scope of the frame.
+		 */
+		void beginFrame(VkCommandBuffer commandBuffer, int frameIndex);
+
+		void beginScope(VkCommandBuffer commandBuffer, const std::string& name);
+		void endScope(VkCommandBuffer commandBuffer);
+
+		const std::vector<Timing>& getTimings() const { return m_timings; }
+
+		void updateUi();
+
+	private:
+		struct Scope {
+			std::string name;
+			uint32_t depth = 0;
+		};
+
+		struct FrameQueries {
+			VkQueryPool queryPool = VK_NULL_HANDLE;
+			std::vector<Scope> scopes; // scope i owns the queries 2 * i and 2 * i + 1
+		};
+
+		void readBack(FrameQueries& frame);
+
+		Context& m_context;
+
+		bool m_isSupported = false;
+		float m_timestampPeriod = 1.0f; // nanoseconds per tick
+
+		std::array<FrameQueries, SwapChain::MAX_FRAMES_IN_FLIGHT> m_frames{};
+		int m_frameIndex = 0;
+		std::vector<uint32_t> m_openScopes;
+
+		std::vector<Timing> m_timings;
+	};
+}
@@ -0,0 +1,143 @@
+#include "graphics/parallel_command_recorder.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace PXTEngine {
+
+	ParallelCommandRecorder::ParallelCommandRecorder(Context& context)
+		: m_context(context), m_jobSystem(context.getJobSystem()) {
+		// any thread of the job system may pick up a chunk
+		const uint32_t threadCount = m_jobSystem.getThreadCount();
+
+		QueueFamilyIndices queueFamilyIndices = m_context.findPhysicalQueueFamilies();
+
+		VkCommandPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		for (auto& threadPools : m_threadPools) {
+			threadPools.resize(threadCount);
+
+			for (ThreadPool& threadPool : threadPools) {
+				if (vkCreateCommandPool(m_context.getDevice(), &poolInfo, nullptr, &threadPool.commandPool) != VK_SUCCESS) {
+					throw std::runtime_error("failed to create secondary command pool!");
+				}
+			}
+		}
+	}
+
+	ParallelCommandRecorder::~ParallelCommandRecorder() {
+		// the buffers are freed with their pool
+		for (auto& threadPools : m_threadPools) {
+			for (ThreadPool& threadPool : threadPools) {
+				vkDestroyCommandPool(m_context.getDevice(), threadPool.commandPool, nullptr);
+			}
+		}
+	}
+
+	uint32_t ParallelCommandRecorder::getThreadCount() const {
+		return std::min(m_jobSystem.getThreadCount(), MAX_RECORD_THREADS);
+	}
+
+	void ParallelCommandRecorder::beginFrame(int frameIndex) {
+		m_frameIndex = frameIndex;
+
+		for (ThreadPool& threadPool : m_threadPools[frameIndex]) {
+			if (threadPool.usedCount == 0) continue;
+
+			vkResetCommandPool(m_context.getDevice(), threadPool.commandPool, 0);
+			threadPool.usedCount = 0;
+		}
+
+		m_lastSecondaryBufferCount = m_secondaryBufferCount;
+		m_secondaryBufferCount = 0;
+	}
+
+	VkCommandBuffer ParallelCommandRecorder::beginSecondary(uint32_t thread, const PassInfo& passInfo) {
+		ThreadPool& threadPool = m_threadPools[m_frameIndex][thread];
+
+		if (threadPool.usedCount == threadPool.commandBuffers.size()) {
+			VkCommandBufferAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.commandPool = threadPool.commandPool;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+			allocInfo.commandBufferCount = 1;
+
+			VkCommandBuffer commandBuffer;
+			if (vkAllocateCommandBuffers(m_context.getDevice(), &allocInfo, &commandBuffer) != VK_SUCCESS) {
+				throw std::runtime_error("failed to allocate secondary command buffer!");
+			}
+			threadPool.commandBuffers.push_back(commandBuffer);
+		}
+
+		VkCommandBuffer commandBuffer = threadPool.commandBuffers[threadPool.usedCount++];
+
+		VkCommandBufferInheritanceInfo inheritanceInfo{};
+		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.renderPass = passInfo.renderPass;
+		inheritanceInfo.subpass = passInfo.subpass;
+		inheritanceInfo.framebuffer = passInfo.framebuffer;
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+			throw std::runtime_error("failed to begin recording secondary command buffer!");
+		}
+
+		// the dynamic state of the primary buffer is not inherited
+		VkViewport viewport{};
+		viewport.width = static_cast<float>(passInfo.extent.width);
+		viewport.height = static_cast<float>(passInfo.extent.height);
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+		VkRect2D scissor{ {0, 0}, passInfo.extent };
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+		return commandBuffer;
+	}
+
+	void ParallelCommandRecorder::record(FrameInfo& frameInfo, const PassInfo& passInfo, uint32_t count,
+		uint32_t minChunkSize, const RecordFunction& recordFunction) {
+		if (count == 0) return;
+
+		minChunkSize = std::max(minChunkSize, 1u);
+		const uint32_t chunkCount = std::clamp((count + minChunkSize - 1) / minChunkSize, 1u, getThreadCount());
+		const uint32_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+		std::vector<VkCommandBuffer> secondaries(chunkCount, VK_NULL_HANDLE);
+
+		// a thread records its chunks one after the other, so its pool is never used concurrently
+		m_jobSystem.parallelFor(chunkCount, [&](uint32_t chunk) {
+			const uint32_t begin = chunk * chunkSize;
+			const uint32_t end = std::min(count, begin + chunkSize);
+
+			VkCommandBuffer commandBuffer = beginSecondary(JobSystem::getThreadIndex(), passInfo);
+
+			FrameInfo chunkFrameInfo = frameInfo;
+			chunkFrameInfo.commandBuffer = commandBuffer;
+			recordFunction(chunkFrameInfo, begin, end);
+
+			if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+				throw std::runtime_error("failed to record secondary command buffer!");
+			}
+
+			secondaries[chunk] = commandBuffer;
+		});
+
+		vkCmdExecuteCommands(frameInfo.commandBuffer, chunkCount, secondaries.data());
+		m_secondaryBufferCount += chunkCount;
+	}
+
+	void ParallelCommandRecorder::record(FrameInfo& frameInfo, const PassInfo& passInfo,
+		const std::function<void(FrameInfo& frameInfo)>& recordFunction) {
+		record(frameInfo, passInfo, 1, 1, [&](FrameInfo& chunkFrameInfo, uint32_t, uint32_t) {
+			recordFunction(chunkFrameInfo);
+		});
+	}
+}
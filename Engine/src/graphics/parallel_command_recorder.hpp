@@ -0,0 +1,104 @@
+#pragma once
+
+#include "graphics/context/context.hpp"
+#include "graphics/frame_info.hpp"
+#include "graphics/swap_chain.hpp"
+
+#include <array>
+#include <functional>
+#include <vector>
+
+namespace PXTEngine {
+
+	/**
+	 * @class ParallelCommandRecorder
+	 *
+	 * @brief Records the draws of a render pass into secondary command buffers on several threads.
+	 *
+	 * The chunks are recorded on the context JobSystem. Every thread of the job system has a command
+	 * pool per frame in flight, picked with JobSystem::getThreadIndex(), its secondary buffers are
+	 * reused once the pool is reset in beginFrame. A range of draws is split in chunks, each chunk is recorded into its own secondary buffer inheriting the render
+	 * pass, then the buffers are executed in chunk order in the primary one, so the draws keep the
+	 * order of the range.
+	 *
+	 * The render pass must be begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS and everything
+	 * recorded in it must go through the recorder. A secondary buffer inherits no state: the record
+	 * functions bind their pipeline, descriptor sets and buffers themselves, the recorder sets the
+	 * viewport and scissor. They run concurrently and must only read the shared state, e.g. the
+	 * pipelines must be waited on before (see PendingPipeline).
+	 */
+	class ParallelCommandRecorder {
+	public:
+		// the gain flattens past a few threads, the submission is still serial
+		static constexpr uint32_t MAX_RECORD_THREADS = 8;
+		// below it a thread costs more to wake up than the draws take to record
+		static constexpr uint32_t DEFAULT_MIN_CHUNK_SIZE = 128;
+
+		struct PassInfo {
+			VkRenderPass renderPass = VK_NULL_HANDLE;
+			VkFramebuffer framebuffer = VK_NULL_HANDLE;
+			VkExtent2D extent{};
+			uint32_t subpass = 0;
+		};
+
+		/**
+		 * @brief Records the items [begin, end) with frameInfo.commandBuffer set to the chunk secondary buffer.
+		 */
+		using RecordFunction = std::function<void(FrameInfo& frameInfo, uint32_t begin, uint32_t end)>;
+
+		ParallelCommandRecorder(Context& context);
+		~ParallelCommandRecorder();
+
+		ParallelCommandRecorder(const ParallelCommandRecorder&) = delete;
+		ParallelCommandRecorder& operator=(const ParallelCommandRecorder&) = delete;
+
+		/**
+		 * @brief Resets the command pools of the frame slot, its fence must have been waited on.
+		 */
+		void beginFrame(int frameIndex);
+
+		/**
+		 * @brief Records count items split in chunks of at least minChunkSize items and executes them
+		 * in frameInfo.commandBuffer. Returns when every chunk has been recorded.
+		 */
+		void record(FrameInfo& frameInfo, const PassInfo& passInfo, uint32_t count, uint32_t minChunkSize,
+			const RecordFunction& recordFunction);
+
+		/**
+		 * @brief Records a single secondary buffer on the calling thread, for the small parts of a pass.
+		 */
+		void record(FrameInfo& frameInfo, const PassInfo& passInfo, const std::function<void(FrameInfo& frameInfo)>& recordFunction);
+
+		/**
+		 * @brief The threads a range is split over at most.
+		 */
+		uint32_t getThreadCount() const;
+
+		/**
+		 * @brief The secondary buffers recorded in the last frame.
+		 */
+		uint32_t getSecondaryBufferCount() const { return m_lastSecondaryBufferCount; }
+
+	private:
+		struct ThreadPool {
+			VkCommandPool commandPool = VK_NULL_HANDLE;
+			std::vector<VkCommandBuffer> commandBuffers;
+			uint32_t usedCount = 0;
+		};
+
+		/**
+		 * @brief Returns a secondary buffer of the pool of the thread, begun for the pass.
+		 */
+		VkCommandBuffer beginSecondary(uint32_t thread, const PassInfo& passInfo);
+
+		Context& m_context;
+		JobSystem& m_jobSystem;
+
+		// [frame][job system thread index], thread 0 is the main thread
+		std::array<std::vector<ThreadPool>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_threadPools;
+		int m_frameIndex = 0;
+
+		uint32_t m_secondaryBufferCount = 0;
+		uint32_t m_lastSecondaryBufferCount = 0;
+	};
+}
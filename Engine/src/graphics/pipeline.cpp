@@ -4,16 +4,11 @@
 #include "graphics/resources/vk_mesh.hpp"
 #include "graphics/frame_info.hpp"
 
-#include <fstream>
 #include <iostream>
 #include <stdexcept>
 
 namespace PXTEngine {
 
-    struct SpecializationData {
-        int32_t maxLights;
-    };
-
     Pipeline::Pipeline(Context& context, const std::vector<std::pair<VkShaderStageFlagBits, std::string>>& shaderFilePaths,
                        const RasterizationPipelineConfigInfo& configInfo) : m_context(context) {
         createGraphicsPipeline(shaderFilePaths, configInfo);
@@ -24,42 +19,15 @@ namespace PXTEngine {
 		createRayTracingPipeline(configInfo);
 	}
 
+	Pipeline::Pipeline(Context& context, const ComputePipelineConfigInfo& configInfo)
+		: m_context(context) {
+		createComputePipeline(configInfo);
+	}
+
 	Pipeline::~Pipeline() {
-		for (const auto shaderModule : m_shaderModules) {
-			vkDestroyShaderModule(m_context.getDevice(), shaderModule, nullptr);
-		}
         vkDestroyPipeline(m_context.getDevice(), m_pipeline, nullptr);
     }
 
-    std::vector<char> Pipeline::readFile(const std::string& filename) {
-        std::ifstream file{filename, std::ios::ate | std::ios::binary};
-
-        if (!file.is_open()) {
-            throw std::runtime_error("failed to open file: " + filename);
-        }
-
-        size_t fileSize = (size_t)file.tellg();
-        std::vector<char> buffer(fileSize);
-
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
-
-        file.close();
-
-        return buffer;
-    }
-
-	void Pipeline::createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule) {
-		VkShaderModuleCreateInfo createInfo{};
-		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		createInfo.codeSize = code.size();
-		createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
-
-		if (vkCreateShaderModule(m_context.getDevice(), &createInfo, nullptr, shaderModule) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create shader module!");
-		}
-	}
-
 	void Pipeline::createGraphicsPipeline(
 		const std::vector<std::pair<VkShaderStageFlagBits, std::string>>& shaderFilePaths,
 		const RasterizationPipelineConfigInfo& configInfo
@@ -71,18 +39,22 @@ namespace PXTEngine {
 		PXT_ASSERT(configInfo.renderPass != nullptr,
 			"Cannot create graphics pipeline: no renderPass provided in config info");
 
-		// --- SPECIALIZATION CONSTANT SETUP (if needed for all shaders) ---
-		SpecializationData specializationData = { MAX_LIGHTS };
+		// --- SPECIALIZATION CONSTANT SETUP (shared by all shaders) ---
+		// constant_id 0 is maxLights, the constants of the config follow with consecutive ids
+		std::vector<uint32_t> specializationData = { static_cast<uint32_t>(MAX_LIGHTS) };
+		specializationData.insert(specializationData.end(),
+			configInfo.specializationConstants.begin(), configInfo.specializationConstants.end());
 
-		VkSpecializationMapEntry mapEntries[1] = {
-			{ 0, offsetof(SpecializationData, maxLights), sizeof(int32_t) }
-		};
+		std::vector<VkSpecializationMapEntry> mapEntries;
+		for (uint32_t i = 0; i < specializationData.size(); i++) {
+			mapEntries.push_back({ i, i * static_cast<uint32_t>(sizeof(uint32_t)), sizeof(uint32_t) });
+		}
 
 		VkSpecializationInfo specializationInfo{};
-		specializationInfo.mapEntryCount = 1;
-		specializationInfo.pMapEntries = mapEntries;
-		specializationInfo.dataSize = sizeof(SpecializationData);
-		specializationInfo.pData = &specializationData;
+		specializationInfo.mapEntryCount = static_cast<uint32_t>(mapEntries.size());
+		specializationInfo.pMapEntries = mapEntries.data();
+		specializationInfo.dataSize = specializationData.size() * sizeof(uint32_t);
+		specializationInfo.pData = specializationData.data();
 
 		// --- Prepare shader stages ---
 		// Container to keep created shader stage infos.
@@ -90,23 +62,19 @@ namespace PXTEngine {
 
 		// Loop through each provided shader stage.
 		for (const auto& [stage, filepath] : shaderFilePaths) {
-			// Read the shader binary code from the file.
-			auto shaderCode = readFile(filepath);
-
-			// Create the shader module.
-			VkShaderModule shaderModule;
-			createShaderModule(shaderCode, &shaderModule);
+			// Get the (possibly shared) module of the shader binary.
+			Shared<ShaderModule> shaderModule = m_context.getShaderLibrary().load(filepath);
 			m_shaderModules.push_back(shaderModule);
 
 			// Prepare the shader stage create info.
 			VkPipelineShaderStageCreateInfo shaderStageInfo{};
 			shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 			shaderStageInfo.stage = stage;
-			shaderStageInfo.module = shaderModule;
 			shaderStageInfo.pName = "main";
 			shaderStageInfo.flags = 0;
 			shaderStageInfo.pNext = nullptr;
 			shaderStageInfo.pSpecializationInfo = &specializationInfo;
+			shaderModule->fillStageInfo(shaderStageInfo);
 			shaderStages.push_back(shaderStageInfo);
 		}
 
@@ -142,20 +110,13 @@ namespace PXTEngine {
 
 		if (vkCreateGraphicsPipelines(
 			m_context.getDevice(),
-			VK_NULL_HANDLE,
+			m_context.getPipelineCache(),
 			1,
 			&pipelineInfo,
 			nullptr,
 			&m_pipeline) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create graphics pipeline!");
 		}
-
-		// --- Clean up: Destroy the shader modules ---
-		for (auto& shaderModule : m_shaderModules) {
-			vkDestroyShaderModule(m_context.getDevice(), shaderModule, nullptr);
-			shaderModule = VK_NULL_HANDLE;
-		}
-		m_shaderModules.clear();
 	}
 
 	void Pipeline::createRayTracingPipeline(const RayTracingPipelineConfigInfo& configInfo) {
@@ -179,22 +140,18 @@ namespace PXTEngine {
 			shaderGroupInfo.pShaderGroupCaptureReplayHandle = nullptr; // Optional
 
 			for (const auto& [stage, filepath] : group.stages) {
-				// Read the shader binary code from the file.
-				auto shaderCode = readFile(filepath);
-
-				// Create the shader module.
-				VkShaderModule shaderModule;
-				createShaderModule(shaderCode, &shaderModule);
+				// Get the (possibly shared) module of the shader binary.
+				Shared<ShaderModule> shaderModule = m_context.getShaderLibrary().load(filepath);
 				m_shaderModules.push_back(shaderModule);
 
 				// Prepare the shader stage create info.
 				VkPipelineShaderStageCreateInfo shaderStageInfo{};
 				shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 				shaderStageInfo.stage = stage;
-				shaderStageInfo.module = shaderModule;
 				shaderStageInfo.pName = "main";
 				shaderStageInfo.flags = 0;
 				shaderStageInfo.pNext = nullptr;
+				shaderModule->fillStageInfo(shaderStageInfo);
 				shaderStages.push_back(shaderStageInfo);
 
 				uint32_t currentStageIndex = static_cast<uint32_t>(shaderStages.size() - 1);
@@ -250,18 +207,40 @@ namespace PXTEngine {
 		// pipelineInfo.pLibraryInterface = ...; // For pipeline libraries
 		// pipelineInfo.pDynamicState = ...; // For dynamic states
 
-		if (vkCreateRayTracingPipelinesKHR(m_context.getDevice(), VK_NULL_HANDLE, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline) != VK_SUCCESS) {
+		if (vkCreateRayTracingPipelinesKHR(m_context.getDevice(), VK_NULL_HANDLE, m_context.getPipelineCache(), 1, &pipelineInfo, nullptr, &m_pipeline) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create ray tracing pipeline!");
 		}
 
 		m_pipelineBindPoint = VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR;
+	}
+
+	void Pipeline::createComputePipeline(const ComputePipelineConfigInfo& configInfo) {
+		PXT_ASSERT(configInfo.pipelineLayout != nullptr,
+			"Cannot create compute pipeline: no pipelineLayout provided in config info");
+
+		Shared<ShaderModule> shaderModule = m_context.getShaderLibrary().load(configInfo.shaderFilePath);
+		m_shaderModules.push_back(shaderModule);
 
-		// --- Clean up: Destroy the shader modules ---
-		for (auto& shaderModule : m_shaderModules) {
-			vkDestroyShaderModule(m_context.getDevice(), shaderModule, nullptr);
-			shaderModule = VK_NULL_HANDLE;
+		VkPipelineShaderStageCreateInfo shaderStageInfo{};
+		shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		shaderStageInfo.pName = "main";
+		shaderModule->fillStageInfo(shaderStageInfo);
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage = shaderStageInfo;
+		pipelineInfo.layout = configInfo.pipelineLayout;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+		pipelineInfo.basePipelineIndex = -1;
+
+		VkResult result = vkCreateComputePipelines(m_context.getDevice(), m_context.getPipelineCache(), 1, &pipelineInfo, nullptr, &m_pipeline);
+
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create compute pipeline!");
 		}
-		m_shaderModules.clear();
+
+		m_pipelineBindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
 	}
 
 	void Pipeline::bind(VkCommandBuffer commandBuffer) {
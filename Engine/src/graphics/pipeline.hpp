@@ -3,7 +3,9 @@
 #include <string>
 #include <vector>
 
+#include "core/memory.hpp"
 #include "graphics/context/context.hpp"
+#include "graphics/shader_library.hpp"
 
 namespace PXTEngine {
 
@@ -29,6 +31,21 @@ namespace PXTEngine {
         uint32_t maxPipelineRayRecursionDepth = 1;
     };
 
+    /**
+     * @struct ComputePipelineConfigInfo
+     * @brief Configuration information for the COMPUTE pipeline.
+     *
+     * A compute pipeline only needs its shader and its pipeline layout.
+     */
+    struct ComputePipelineConfigInfo {
+        ComputePipelineConfigInfo() = default;
+        ComputePipelineConfigInfo(const ComputePipelineConfigInfo&) = delete;
+        ComputePipelineConfigInfo& operator=(const ComputePipelineConfigInfo&) = delete;
+
+        std::string shaderFilePath{};
+        VkPipelineLayout pipelineLayout = nullptr;
+    };
+
     /**
      * @struct RasterizationPipelineConfigInfo
      * @brief Configuration information for the GRAPHICS pipeline.
@@ -55,6 +72,9 @@ namespace PXTEngine {
         VkPipelineLayout pipelineLayout = nullptr;
         VkRenderPass renderPass = nullptr;
         uint32_t subpass = 0;
+
+        // specialization constants of every stage, from constant_id 1 (0 is MAX_LIGHTS)
+        std::vector<uint32_t> specializationConstants{};
     };
 
     /**
@@ -69,6 +89,7 @@ namespace PXTEngine {
         Pipeline(Context& context, const std::vector<std::pair<VkShaderStageFlagBits, std::string>>& shaderFilePaths,
                  const RasterizationPipelineConfigInfo& configInfo);
 		Pipeline(Context& context, const RayTracingPipelineConfigInfo& configInfo);
+		Pipeline(Context& context, const ComputePipelineConfigInfo& configInfo);
                  
         ~Pipeline();
 
@@ -83,20 +104,19 @@ namespace PXTEngine {
 		VkPipeline getHandle() const { return m_pipeline; }
 
        private:
-        static std::vector<char> readFile(const std::string& filename);
-
         void createGraphicsPipeline(
             const std::vector<std::pair<VkShaderStageFlagBits, std::string>>& shaderFilePaths,
             const RasterizationPipelineConfigInfo& configInfo);
 
 		void createRayTracingPipeline(const RayTracingPipelineConfigInfo& configInfo);
 
-        void createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule);
+		void createComputePipeline(const ComputePipelineConfigInfo& configInfo);
 
         Context& m_context;
         VkPipeline m_pipeline;
 
-        std::vector<VkShaderModule> m_shaderModules{};
+        // kept while the pipeline lives, the modules are shared through the ShaderLibrary
+        std::vector<Shared<ShaderModule>> m_shaderModules{};
 		VkPipelineBindPoint m_pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     };
 }
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "graphics/pipeline_compiler.hpp"
+
+#include <exception>
+
+namespace PXTEngine {
+
+	PendingPipeline::~PendingPipeline() {
+		wait();
+	}
+
+	PendingPipeline& PendingPipeline::operator=(PendingPipeline&& other) noexcept {
+		if (this != &other) {
+			wait();
+			m_future = std::move(other.m_future);
+			m_pipeline = std::move(other.m_pipeline);
+		}
+
+		return *this;
+	}
+
+	Pipeline& PendingPipeline::get() {
+		if (!m_pipeline) {
+			m_pipeline = m_future.get();
+		}
+
+		return *m_pipeline;
+	}
+
+	bool PendingPipeline::isReady() const {
+		return m_pipeline || (m_future.valid() && m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+	}
+
+	void PendingPipeline::wait() {
+		if (m_future.valid()) {
+			m_future.wait();
+		}
+	}
+
+	/**
+	 * @brief Copies a graphics config to the heap, the create infos pointing inside the config are
+	 * pointed to the copy.
+	 */
+	static Shared<RasterizationPipelineConfigInfo> copyConfigInfo(const RasterizationPipelineConfigInfo& configInfo) {
+		auto copy = createShared<RasterizationPipelineConfigInfo>();
+
+		copy->bindingDescriptions = configInfo.bindingDescriptions;
+		copy->attributeDescriptions = configInfo.attributeDescriptions;
+		copy->viewportInfo = configInfo.viewportInfo;
+		copy->inputAssemblyInfo = configInfo.inputAssemblyInfo;
+		copy->rasterizationInfo = configInfo.rasterizationInfo;
+		copy->multisampleInfo = configInfo.multisampleInfo;
+		copy->colorBlendAttachment = configInfo.colorBlendAttachment;
+		copy->colorBlendInfo = configInfo.colorBlendInfo;
+		copy->depthStencilInfo = configInfo.depthStencilInfo;
+		copy->dynamicStateEnables = configInfo.dynamicStateEnables;
+		copy->dynamicStateInfo = configInfo.dynamicStateInfo;
+		copy->pipelineLayout = configInfo.pipelineLayout;
+		copy->renderPass = configInfo.renderPass;
+		copy->subpass = configInfo.subpass;
+		copy->specializationConstants = configInfo.specializationConstants;
+
+		if (configInfo.colorBlendInfo.pAttachments == &configInfo.colorBlendAttachment) {
+			copy->colorBlendInfo.pAttachments = &copy->colorBlendAttachment;
+		}
+
+		if (configInfo.dynamicStateInfo.pDynamicStates == configInfo.dynamicStateEnables.data()) {
+			copy->dynamicStateInfo.pDynamicStates = copy->dynamicStateEnables.data();
+		}
+
+		return copy;
+	}
+
+	PipelineCompiler::PipelineCompiler(Context& context) : m_context(context) {}
+
+	PipelineCompiler::~PipelineCompiler() {
+		// the queued pipelines are still created, their futures may be waited on
+		waitIdle();
+	}
+
+	PendingPipeline PipelineCompiler::compile(
+		const std::vector<std::pair<VkShaderStageFlagBits, std::string>>& shaderFilePaths,
+		const RasterizationPipelineConfigInfo& configInfo) {
+		Shared<RasterizationPipelineConfigInfo> config = copyConfigInfo(configInfo);
+
+		return enqueue([this, shaderFilePaths, config]() {
+			return createUnique<Pipeline>(m_context, shaderFilePaths, *config);
+		});
+	}
+
+	PendingPipeline PipelineCompiler::compile(const RayTracingPipelineConfigInfo& configInfo) {
+		auto config = createShared<RayTracingPipelineConfigInfo>();
+		config->shaderGroups = configInfo.shaderGroups;
+		config->pipelineLayout = configInfo.pipelineLayout;
+		config->maxPipelineRayRecursionDepth = configInfo.maxPipelineRayRecursionDepth;
+
+		return enqueue([this, config]() {
+			return createUnique<Pipeline>(m_context, *config);
+		});
+	}
+
+	PendingPipeline PipelineCompiler::compile(const ComputePipelineConfigInfo& configInfo) {
+		auto config = createShared<ComputePipelineConfigInfo>();
+		config->shaderFilePath = configInfo.shaderFilePath;
+		config->pipelineLayout = configInfo.pipelineLayout;
+
+		return enqueue([this, config]() {
+			return createUnique<Pipeline>(m_context, *config);
+		});
+	}
+
+	PendingPipeline PipelineCompiler::enqueue(std::function<Unique<Pipeline>()> createPipeline) {
+		{
+			std::lock_guard lock(m_mutex);
+			m_pendingCount++;
+		}
+
+		std::future<Unique<Pipeline>> future = m_context.getJobSystem().submit(
+			[this, createPipeline = std::move(createPipeline)]() {
+				Unique<Pipeline> pipeline;
+				std::exception_ptr error;
+				try {
+					pipeline = createPipeline();
+				} catch (...) {
+					error = std::current_exception();
+				}
+
+				// notified under the lock, the compiler may be destroyed as soon as it is released
+				{
+					std::lock_guard lock(m_mutex);
+					m_pendingCount--;
+					m_idle.notify_all();
+				}
+
+				// rethrown on the thread that first uses the pipeline
+				if (error) {
+					std::rethrow_exception(error);
+				}
+
+				return pipeline;
+			});
+
+		return PendingPipeline(std::move(future));
+	}
+
+	void PipelineCompiler::waitIdle() {
+		std::unique_lock lock(m_mutex);
+		m_idle.wait(lock, [this]() { return m_pendingCount == 0; });
+	}
+}
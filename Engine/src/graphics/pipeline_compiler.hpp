@@ -0,0 +1,97 @@
+#pragma once
+
+#include "core/memory.hpp"
+#include "graphics/pipeline.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace PXTEngine {
+
+	/**
+	 * @class PendingPipeline
+	 *
+	 * @brief A pipeline that may still be compiling on a job system worker, see PipelineCompiler.
+	 *
+	 * It is used like a Unique<Pipeline>: the first access waits for the compilation to end
+	 * (and rethrows its error, if any), the following ones are free. Render systems keep one
+	 * per pipeline and only block when they first record with it.
+	 */
+	class PendingPipeline {
+	public:
+		PendingPipeline() = default;
+		explicit PendingPipeline(std::future<Unique<Pipeline>> future) : m_future(std::move(future)) {}
+		~PendingPipeline();
+
+		PendingPipeline(PendingPipeline&&) = default;
+		PendingPipeline& operator=(PendingPipeline&& other) noexcept;
+
+		PendingPipeline(const PendingPipeline&) = delete;
+		PendingPipeline& operator=(const PendingPipeline&) = delete;
+
+		Pipeline* operator->() { return &get(); }
+		Pipeline& operator*() { return get(); }
+
+		/**
+		 * @brief Waits for the compilation if needed and returns the pipeline.
+		 */
+		Pipeline& get();
+
+		/**
+		 * @brief Whether the pipeline can be used without waiting.
+		 */
+		bool isReady() const;
+
+	private:
+		/**
+		 * @brief Waits for an unfinished compilation, its pipeline layout and render pass must outlive it.
+		 */
+		void wait();
+
+		std::future<Unique<Pipeline>> m_future;
+		Unique<Pipeline> m_pipeline;
+	};
+
+	/**
+	 * @class PipelineCompiler
+	 *
+	 * @brief Creates pipelines as jobs of the context JobSystem.
+	 *
+	 * The config infos are copied when the compilation is requested, so the caller can reuse or
+	 * modify its config right away; the pipeline layouts, render passes and shader files they refer
+	 * to must stay valid until the pipeline is ready. The pipelines are created with the context
+	 * pipeline cache, vkCreate*Pipelines and the cache are safe to use from several threads.
+	 */
+	class PipelineCompiler {
+	public:
+		PipelineCompiler(Context& context);
+		~PipelineCompiler();
+
+		PipelineCompiler(const PipelineCompiler&) = delete;
+		PipelineCompiler& operator=(const PipelineCompiler&) = delete;
+
+		PendingPipeline compile(const std::vector<std::pair<VkShaderStageFlagBits, std::string>>& shaderFilePaths,
+			const RasterizationPipelineConfigInfo& configInfo);
+		PendingPipeline compile(const RayTracingPipelineConfigInfo& configInfo);
+		PendingPipeline compile(const ComputePipelineConfigInfo& configInfo);
+
+		/**
+		 * @brief Blocks until every requested pipeline has been created.
+		 */
+		void waitIdle();
+
+	private:
+		PendingPipeline enqueue(std::function<Unique<Pipeline>()> createPipeline);
+
+		Context& m_context;
+
+		// the jobs refer to the compiler, it waits for them before being destroyed
+		std::mutex m_mutex;
+		std::condition_variable m_idle;
+		uint32_t m_pendingCount = 0;
+	};
+}
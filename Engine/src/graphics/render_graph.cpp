@@ -0,0 +1,686 @@
+#include "graphics/render_graph.hpp"
+
+#include "core/diagnostics.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace PXTEngine {
+
+	namespace {
+		// imported resources not seen for this many frames are forgotten
+		constexpr uint64_t IMPORTED_STATE_LIFETIME = 8;
+
+		struct UsageInfo {
+			VkPipelineStageFlags2 stages;
+			VkAccessFlags2 readAccess;
+			VkAccessFlags2 writeAccess;
+			VkImageLayout layout;
+		};
+
+		UsageInfo getUsageInfo(RenderGraph::ImageUsage usage) {
+			switch (usage) {
+			case RenderGraph::ImageUsage::ColorAttachment:
+				return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+					VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+					VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+			case RenderGraph::ImageUsage::DepthAttachment:
+				return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+					VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+					VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+			case RenderGraph::ImageUsage::SampledFragment:
+				return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+					VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, 0,
+					VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+			case RenderGraph::ImageUsage::SampledCompute:
+				return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+					VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, 0,
+					VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+			case RenderGraph::ImageUsage::StorageCompute:
+				return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+					VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+					VK_IMAGE_LAYOUT_GENERAL };
+			case RenderGraph::ImageUsage::StorageRayTracing:
+				return { VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR,
+					VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+					VK_IMAGE_LAYOUT_GENERAL };
+			}
+
+			throw std::runtime_error("unknown render graph image usage!");
+		}
+
+		UsageInfo getUsageInfo(RenderGraph::BufferUsage usage) {
+			switch (usage) {
+			case RenderGraph::BufferUsage::IndirectRead:
+				return { VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+					VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED };
+			case RenderGraph::BufferUsage::StorageGraphics:
+				return { VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+					VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED };
+			case RenderGraph::BufferUsage::StorageCompute:
+				return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+					VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED };
+			case RenderGraph::BufferUsage::TransferDst:
+				return { VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+					0, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED };
+			}
+
+			throw std::runtime_error("unknown render graph buffer usage!");
+		}
+
+		VkImageCreateInfo makeImageInfo(const RenderGraph::ImageDesc& desc) {
+			VkImageCreateInfo imageInfo{};
+			imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageInfo.extent.width = desc.extent.width;
+			imageInfo.extent.height = desc.extent.height;
+			imageInfo.extent.depth = 1;
+			imageInfo.mipLevels = 1;
+			imageInfo.arrayLayers = 1;
+			imageInfo.format = desc.format;
+			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			imageInfo.usage = desc.usage;
+			imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			return imageInfo;
+		}
+
+		bool isLifetimeOverlapping(uint32_t firstA, uint32_t lastA, uint32_t firstB, uint32_t lastB) {
+			return firstA <= lastB && firstB <= lastA;
+		}
+	}
+
+	RenderGraph::PassBuilder& RenderGraph::PassBuilder::read(ImageHandle image, ImageUsage usage) {
+		const UsageInfo info = getUsageInfo(usage);
+		m_graph.addAccess(m_passIndex, image.index, info.stages, info.readAccess, 0, info.layout, false);
+		return *this;
+	}
+
+	RenderGraph::PassBuilder& RenderGraph::PassBuilder::write(ImageHandle image, ImageUsage usage) {
+		const UsageInfo info = getUsageInfo(usage);
+		PXT_ASSERT(info.writeAccess != 0, "Image usage is read only");
+		m_graph.addAccess(m_passIndex, image.index, info.stages, info.writeAccess, info.writeAccess, info.layout, true);
+		return *this;
+	}
+
+	RenderGraph::PassBuilder& RenderGraph::PassBuilder::read(BufferHandle buffer, BufferUsage usage) {
+		const UsageInfo info = getUsageInfo(usage);
+		PXT_ASSERT(info.readAccess != 0, "Buffer usage is write only");
+		m_graph.addAccess(m_passIndex, buffer.index, info.stages, info.readAccess, 0, info.layout, false);
+		return *this;
+	}
+
+	RenderGraph::PassBuilder& RenderGraph::PassBuilder::write(BufferHandle buffer, BufferUsage usage) {
+		const UsageInfo info = getUsageInfo(usage);
+		PXT_ASSERT(info.writeAccess != 0, "Buffer usage is read only");
+		m_graph.addAccess(m_passIndex, buffer.index, info.stages, info.writeAccess, info.writeAccess, info.layout, true);
+		return *this;
+	}
+
+	RenderGraph::PassBuilder& RenderGraph::PassBuilder::setSideEffect() {
+		m_graph.m_passes[m_passIndex].hasSideEffect = true;
+		return *this;
+	}
+
+	RenderGraph::RenderGraph(Context& context) : m_context(&context) {}
+
+	RenderGraph::~RenderGraph() {
+		destroyTransientImages();
+	}
+
+	void RenderGraph::reset() {
+		m_passes.clear();
+		m_resources.clear();
+		m_frameCounter++;
+	}
+
+	RenderGraph::ImageHandle RenderGraph::importImage(const std::string& name, Shared<VulkanImage> image,
+		VkImageAspectFlags aspect, uint32_t layerCount) {
+		PXT_ASSERT(image != nullptr, "Cannot import a null image");
+
+		Resource& resource = m_resources.emplace_back();
+		resource.name = name;
+		resource.isImage = true;
+		resource.image = std::move(image);
+		resource.range = { aspect, 0, 1, 0, layerCount };
+
+		return { static_cast<uint32_t>(m_resources.size() - 1) };
+	}
+
+	RenderGraph::BufferHandle RenderGraph::importBuffer(const std::string& name, VkBuffer buffer) {
+		PXT_ASSERT(buffer != VK_NULL_HANDLE, "Cannot import a null buffer");
+
+		Resource& resource = m_resources.emplace_back();
+		resource.name = name;
+		resource.isImage = false;
+		resource.buffer = buffer;
+
+		return { static_cast<uint32_t>(m_resources.size() - 1) };
+	}
+
+	RenderGraph::ImageHandle RenderGraph::createImage(const std::string& name, const ImageDesc& desc) {
+		Resource& resource = m_resources.emplace_back();
+		resource.name = name;
+		resource.isImage = true;
+		resource.isTransient = true;
+		resource.desc = desc;
+		resource.range = { desc.aspect, 0, 1, 0, 1 };
+
+		return { static_cast<uint32_t>(m_resources.size() - 1) };
+	}
+
+	void RenderGraph::markOutput(ImageHandle image) {
+		m_resources[image.index].isOutput = true;
+	}
+
+	void RenderGraph::markOutput(BufferHandle buffer) {
+		m_resources[buffer.index].isOutput = true;
+	}
+
+	void RenderGraph::addPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute) {
+		Pass& pass = m_passes.emplace_back();
+		pass.name = name;
+		pass.execute = std::move(execute);
+
+		PassBuilder builder(*this, static_cast<uint32_t>(m_passes.size() - 1));
+		setup(builder);
+	}
+
+	void RenderGraph::addAccess(uint32_t passIndex, uint32_t resource, VkPipelineStageFlags2 stages,
+		VkAccessFlags2 access, VkAccessFlags2 writeAccess, VkImageLayout layout, bool isWrite) {
+		PXT_ASSERT(resource < m_resources.size(), "Unknown render graph resource");
+
+		std::vector<ResourceAccess>& accesses = m_passes[passIndex].accesses;
+		auto it = std::find_if(accesses.begin(), accesses.end(),
+			[resource](const ResourceAccess& access) { return access.resource == resource; });
+
+		if (it == accesses.end()) {
+			ResourceAccess& newAccess = accesses.emplace_back();
+			newAccess.resource = resource;
+			newAccess.layout = layout;
+			it = accesses.end() - 1;
+		}
+
+		// a single barrier covers every usage of the pass, they must agree on the layout
+		PXT_ASSERT(!m_resources[resource].isImage || it->layout == layout,
+			"The usages of an image in a pass must share its layout");
+
+		it->stages |= stages;
+		it->access |= access;
+		it->writeAccess |= writeAccess;
+		it->isRead |= !isWrite;
+		it->isWrite |= isWrite;
+	}
+
+	void RenderGraph::compile() {
+		m_stats = {};
+		m_stats.passCount = static_cast<uint32_t>(m_passes.size());
+
+		cullPasses();
+		placeTransientImages();
+		buildBarriers();
+
+		for (const Pass& pass : m_passes) {
+			if (pass.isCulled) {
+				m_stats.culledPassCount++;
+				continue;
+			}
+
+			if (!pass.imageBarriers.empty() || !pass.bufferBarriers.empty()) {
+				m_stats.barrierBatchCount++;
+			}
+			m_stats.imageBarrierCount += static_cast<uint32_t>(pass.imageBarriers.size());
+			m_stats.bufferBarrierCount += static_cast<uint32_t>(pass.bufferBarriers.size());
+		}
+	}
+
+	void RenderGraph::cullPasses() {
+		// walk back from the outputs, a pass is kept when it writes something a later kept pass reads
+		std::vector<bool> isNeeded(m_resources.size());
+		for (size_t i = 0; i < m_resources.size(); i++) {
+			isNeeded[i] = m_resources[i].isOutput;
+		}
+
+		for (size_t i = m_passes.size(); i-- > 0;) {
+			Pass& pass = m_passes[i];
+
+			bool isUsed = pass.hasSideEffect;
+			for (const ResourceAccess& access : pass.accesses) {
+				isUsed |= access.isWrite && isNeeded[access.resource];
+			}
+
+			pass.isCulled = !isUsed;
+			if (!isUsed) continue;
+
+			// an image written without being read is replaced, the earlier writers are not needed for it;
+			// buffers may be written partially, they keep their writers
+			for (const ResourceAccess& access : pass.accesses) {
+				if (access.isWrite && !access.isRead && m_resources[access.resource].isImage) {
+					isNeeded[access.resource] = false;
+				}
+			}
+
+			for (const ResourceAccess& access : pass.accesses) {
+				if (access.isRead) {
+					isNeeded[access.resource] = true;
+				}
+			}
+		}
+	}
+
+	void RenderGraph::placeTransientImages() {
+		for (uint32_t passIndex = 0; passIndex < m_passes.size(); passIndex++) {
+			const Pass& pass = m_passes[passIndex];
+			if (pass.isCulled) continue;
+
+			for (const ResourceAccess& access : pass.accesses) {
+				Resource& resource = m_resources[access.resource];
+				if (!resource.isTransient) continue;
+
+				resource.firstPass = std::min(resource.firstPass, passIndex);
+				resource.lastPass = std::max(resource.lastPass, passIndex);
+			}
+		}
+
+		struct Placement {
+			uint32_t resource;
+			VkMemoryRequirements requirements;
+		};
+
+		std::vector<Placement> placements;
+		for (uint32_t i = 0; i < m_resources.size(); i++) {
+			const Resource& resource = m_resources[i];
+			// transient images of culled passes only are never created
+			if (!resource.isTransient || resource.firstPass > resource.lastPass) continue;
+
+			const VkImageCreateInfo imageInfo = makeImageInfo(resource.desc);
+
+			VkDeviceImageMemoryRequirements requirementsInfo{};
+			requirementsInfo.sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS;
+			requirementsInfo.pCreateInfo = &imageInfo;
+
+			VkMemoryRequirements2 requirements{};
+			requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+
+			vkGetDeviceImageMemoryRequirements(getContext().getDevice(), &requirementsInfo, &requirements);
+
+			placements.push_back({ i, requirements.memoryRequirements });
+			m_stats.unaliasedTransientMemory += requirements.memoryRequirements.size;
+		}
+
+		// largest first, every image goes to the first block whose images all live in other passes;
+		// the images of a block all start at its beginning, the block is as large as the largest one
+		std::stable_sort(placements.begin(), placements.end(),
+			[](const Placement& a, const Placement& b) { return a.requirements.size > b.requirements.size; });
+
+		std::vector<MemoryBlock> memoryBlocks;
+		std::vector<std::vector<uint32_t>> blockResources;
+
+		for (const Placement& placement : placements) {
+			Resource& resource = m_resources[placement.resource];
+
+			uint32_t blockIndex = 0;
+			for (; blockIndex < memoryBlocks.size(); blockIndex++) {
+				if ((memoryBlocks[blockIndex].memoryTypeBits & placement.requirements.memoryTypeBits) == 0) continue;
+
+				const bool isOverlapping = std::any_of(blockResources[blockIndex].begin(), blockResources[blockIndex].end(),
+					[&](uint32_t other) {
+						return isLifetimeOverlapping(resource.firstPass, resource.lastPass,
+							m_resources[other].firstPass, m_resources[other].lastPass);
+					});
+
+				if (!isOverlapping) break;
+			}
+
+			if (blockIndex == memoryBlocks.size()) {
+				memoryBlocks.push_back({ VK_NULL_HANDLE, 0, placement.requirements.memoryTypeBits });
+				blockResources.emplace_back();
+			}
+
+			MemoryBlock& block = memoryBlocks[blockIndex];
+			block.size = std::max(block.size, placement.requirements.size);
+			block.memoryTypeBits &= placement.requirements.memoryTypeBits;
+			blockResources[blockIndex].push_back(placement.resource);
+
+			resource.memoryBlock = blockIndex;
+		}
+
+		std::vector<TransientImage> transientImages;
+		for (const Resource& resource : m_resources) {
+			if (resource.memoryBlock == std::numeric_limits<uint32_t>::max()) continue;
+
+			transientImages.push_back({ resource.name, resource.desc, resource.memoryBlock, nullptr });
+		}
+
+		for (const MemoryBlock& block : memoryBlocks) {
+			m_stats.transientMemory += block.size;
+		}
+
+		// the same images in the same blocks, keep the previous frame ones
+		bool isSamePlacement = transientImages.size() == m_transientImages.size() &&
+			memoryBlocks.size() == m_memoryBlocks.size();
+
+		for (size_t i = 0; isSamePlacement && i < transientImages.size(); i++) {
+			isSamePlacement = transientImages[i].isSamePlacement(m_transientImages[i]);
+		}
+		for (size_t i = 0; isSamePlacement && i < memoryBlocks.size(); i++) {
+			isSamePlacement = memoryBlocks[i].size == m_memoryBlocks[i].size &&
+				memoryBlocks[i].memoryTypeBits == m_memoryBlocks[i].memoryTypeBits;
+		}
+
+		if (!isSamePlacement) {
+			// the frames in flight may still use the previous images
+			retireTransientImages();
+
+			allocateTransientImages(transientImages, memoryBlocks);
+
+			m_transientImages = std::move(transientImages);
+			m_memoryBlocks = std::move(memoryBlocks);
+		}
+
+		size_t transientIndex = 0;
+		for (Resource& resource : m_resources) {
+			if (resource.memoryBlock == std::numeric_limits<uint32_t>::max()) continue;
+
+			resource.image = m_transientImages[transientIndex++].image;
+		}
+	}
+
+	void RenderGraph::allocateTransientImages(std::vector<TransientImage>& transientImages,
+		std::vector<MemoryBlock>& memoryBlocks) {
+		for (MemoryBlock& block : memoryBlocks) {
+			VkMemoryAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocInfo.allocationSize = block.size;
+			allocInfo.memoryTypeIndex = getContext().findMemoryType(block.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+			if (vkAllocateMemory(getContext().getDevice(), &allocInfo, nullptr, &block.memory) != VK_SUCCESS) {
+				throw std::runtime_error("failed to allocate render graph transient memory!");
+			}
+		}
+
+		for (TransientImage& transientImage : transientImages) {
+			const ImageDesc& desc = transientImage.desc;
+
+			transientImage.image = createShared<VulkanImage>(
+				getContext(),
+				makeImageInfo(desc),
+				memoryBlocks[transientImage.memoryBlock].memory,
+				0
+			);
+
+			VkImageViewCreateInfo viewInfo{};
+			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			viewInfo.image = transientImage.image->getVkImage();
+			viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			viewInfo.format = desc.format;
+			viewInfo.subresourceRange.aspectMask = desc.aspect;
+			viewInfo.subresourceRange.baseMipLevel = 0;
+			viewInfo.subresourceRange.levelCount = 1;
+			viewInfo.subresourceRange.baseArrayLayer = 0;
+			viewInfo.subresourceRange.layerCount = 1;
+
+			transientImage.image->createImageView(viewInfo);
+		}
+	}
+
+	void RenderGraph::destroyTransientImages() {
+		// the images still held elsewhere (e.g. by a framebuffer) are only destroyed with their last owner,
+		// they are not used after this point
+		m_transientImages.clear();
+
+		for (MemoryBlock& block : m_memoryBlocks) {
+			vkFreeMemory(getContext().getDevice(), block.memory, nullptr);
+		}
+		m_memoryBlocks.clear();
+	}
+
+	void RenderGraph::retireTransientImages() {
+		DeletionQueue& deletionQueue = getContext().getDeletionQueue();
+
+		for (TransientImage& transientImage : m_transientImages) {
+			deletionQueue.push(std::move(transientImage.image));
+		}
+		m_transientImages.clear();
+
+		std::vector<VkDeviceMemory> memories;
+		for (const MemoryBlock& block : m_memoryBlocks) {
+			memories.push_back(block.memory);
+		}
+		m_memoryBlocks.clear();
+
+		deletionQueue.push([device = getContext().getDevice(), memories = std::move(memories)]() {
+			for (VkDeviceMemory memory : memories) {
+				vkFreeMemory(device, memory, nullptr);
+			}
+		});
+	}
+
+	Context& RenderGraph::getContext() const {
+		PXT_ASSERT(m_context != nullptr, "The transient images of a render graph need a context");
+		return *m_context;
+	}
+
+	uint64_t RenderGraph::getResourceKey(const Resource& resource) const {
+		return resource.isImage ? (uint64_t)resource.image->getVkImage() : (uint64_t)resource.buffer;
+	}
+
+	void RenderGraph::buildBarriers() {
+		std::vector<ResourceState> states(m_resources.size());
+
+		for (size_t i = 0; i < m_resources.size(); i++) {
+			const Resource& resource = m_resources[i];
+			if (resource.isTransient) continue;
+
+			// a resource the graph never saw may have been written by anything before
+			auto it = m_importedStates.find(getResourceKey(resource));
+			if (it != m_importedStates.end()) {
+				states[i] = it->second.state;
+			} else {
+				states[i].writeStages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+				states[i].writeAccess = VK_ACCESS_2_MEMORY_WRITE_BIT;
+			}
+
+			if (resource.isImage) {
+				states[i].layout = resource.image->getCurrentLayout();
+			}
+		}
+
+		for (uint32_t passIndex = 0; passIndex < m_passes.size(); passIndex++) {
+			Pass& pass = m_passes[passIndex];
+			pass.imageBarriers.clear();
+			pass.bufferBarriers.clear();
+
+			if (pass.isCulled) continue;
+
+			for (const ResourceAccess& access : pass.accesses) {
+				Resource& resource = m_resources[access.resource];
+				ResourceState& state = states[access.resource];
+
+				// the first use of a transient image waits for the previous image of its memory
+				if (resource.isTransient && passIndex == resource.firstPass) {
+					state = m_memoryBlocks[resource.memoryBlock].state;
+					state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+				}
+
+				const bool isLayoutChanged = resource.isImage && state.layout != access.layout;
+				const bool isDiscarded = access.isWrite && !access.isRead;
+
+				// writes and layout changes wait for every previous access, reads only for the last write
+				bool isBarrierNeeded;
+				VkPipelineStageFlags2 srcStages;
+				if (isLayoutChanged || access.isWrite) {
+					srcStages = state.writeStages | state.readStages;
+					isBarrierNeeded = isLayoutChanged || srcStages != 0;
+				} else {
+					srcStages = state.writeStages;
+					isBarrierNeeded = state.writeStages != 0 && (access.stages & ~state.readStages) != 0;
+				}
+
+				if (isBarrierNeeded) {
+					if (resource.isImage) {
+						VkImageMemoryBarrier2& barrier = pass.imageBarriers.emplace_back();
+						barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+						barrier.srcStageMask = srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_2_NONE;
+						barrier.srcAccessMask = state.writeAccess;
+						barrier.dstStageMask = access.stages;
+						barrier.dstAccessMask = access.access;
+						barrier.oldLayout = isLayoutChanged && isDiscarded ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+						barrier.newLayout = access.layout;
+						barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+						barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+						barrier.image = resource.image->getVkImage();
+						barrier.subresourceRange = resource.range;
+					} else {
+						VkBufferMemoryBarrier2& barrier = pass.bufferBarriers.emplace_back();
+						barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+						barrier.srcStageMask = srcStages;
+						barrier.srcAccessMask = state.writeAccess;
+						barrier.dstStageMask = access.stages;
+						barrier.dstAccessMask = access.access;
+						barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+						barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+						barrier.buffer = resource.buffer;
+						barrier.offset = 0;
+						barrier.size = VK_WHOLE_SIZE;
+					}
+				}
+
+				if (access.isWrite) {
+					state.writeStages = access.stages;
+					state.writeAccess = access.writeAccess;
+					state.readStages = 0;
+				} else if (isLayoutChanged) {
+					// the transition is a write of its own, only the stages it waited for can see it
+					state.writeStages = access.stages;
+					state.writeAccess = 0;
+					state.readStages = access.stages;
+				} else {
+					state.readStages |= access.stages;
+				}
+
+				if (resource.isImage) {
+					state.layout = access.layout;
+				}
+			}
+
+			// the next image placed in the same memory waits for the last use of this one
+			for (const ResourceAccess& access : pass.accesses) {
+				const Resource& resource = m_resources[access.resource];
+				if (resource.isTransient && passIndex == resource.lastPass) {
+					m_memoryBlocks[resource.memoryBlock].state = states[access.resource];
+				}
+			}
+		}
+
+		for (size_t i = 0; i < m_resources.size(); i++) {
+			Resource& resource = m_resources[i];
+			if (resource.isTransient) continue;
+
+			resource.finalLayout = states[i].layout;
+			m_importedStates[getResourceKey(resource)] = { states[i], m_frameCounter };
+		}
+
+		std::erase_if(m_importedStates, [this](const auto& entry) {
+			return entry.second.lastFrame + IMPORTED_STATE_LIFETIME < m_frameCounter;
+		});
+	}
+
+	void RenderGraph::execute(FrameInfo& frameInfo, GpuProfiler* profiler) {
+		for (Pass& pass : m_passes) {
+			if (pass.isCulled) continue;
+
+			if (!pass.imageBarriers.empty() || !pass.bufferBarriers.empty()) {
+				VkDependencyInfo dependencyInfo{};
+				dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+				dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(pass.imageBarriers.size());
+				dependencyInfo.pImageMemoryBarriers = pass.imageBarriers.data();
+				dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(pass.bufferBarriers.size());
+				dependencyInfo.pBufferMemoryBarriers = pass.bufferBarriers.data();
+
+				vkCmdPipelineBarrier2(frameInfo.commandBuffer, &dependencyInfo);
+			}
+
+			if (profiler) profiler->beginScope(frameInfo.commandBuffer, pass.name);
+			pass.execute(frameInfo);
+			if (profiler) profiler->endScope(frameInfo.commandBuffer);
+		}
+
+		for (Resource& resource : m_resources) {
+			if (resource.isImage && !resource.isTransient) {
+				resource.image->setImageLayout(resource.finalLayout);
+			}
+		}
+	}
+
+	const Shared<VulkanImage>& RenderGraph::getImage(ImageHandle image) const {
+		PXT_ASSERT(image.index < m_resources.size() && m_resources[image.index].isImage, "Unknown render graph image");
+		return m_resources[image.index].image;
+	}
+
+	std::string RenderGraph::exportGraphviz() const {
+		std::ostringstream dot;
+		dot << "digraph RenderGraph {\n";
+		dot << "\trankdir=LR;\n";
+
+		for (size_t i = 0; i < m_passes.size(); i++) {
+			const Pass& pass = m_passes[i];
+
+			dot << "\tpass" << i << " [shape=box, style=rounded, label=\"" << pass.name;
+			if (pass.isCulled) {
+				dot << "\\n(culled)\", color=gray, fontcolor=gray];\n";
+			} else {
+				dot << "\\n" << pass.imageBarriers.size() << " image, " << pass.bufferBarriers.size()
+					<< " buffer barriers\"" << (pass.hasSideEffect ? ", peripheries=2" : "") << "];\n";
+			}
+		}
+
+		for (size_t i = 0; i < m_resources.size(); i++) {
+			const Resource& resource = m_resources[i];
+
+			dot << "\tresource" << i << " [shape=" << (resource.isImage ? "ellipse" : "note") << ", label=\"" << resource.name;
+			if (resource.isTransient) {
+				dot << "\\ntransient";
+				if (resource.memoryBlock != std::numeric_limits<uint32_t>::max()) {
+					dot << ", memory block " << resource.memoryBlock;
+				}
+			}
+			dot << "\"" << (resource.isOutput ? ", peripheries=2" : "") << "];\n";
+		}
+
+		// reads go from the resource to the pass, writes from the pass to the resource
+		for (size_t i = 0; i < m_passes.size(); i++) {
+			for (const ResourceAccess& access : m_passes[i].accesses) {
+				if (access.isRead) {
+					dot << "\tresource" << access.resource << " -> pass" << i << ";\n";
+				}
+				if (access.isWrite) {
+					dot << "\tpass" << i << " -> resource" << access.resource << " [color=red];\n";
+				}
+			}
+		}
+
+		dot << "}\n";
+		return dot.str();
+	}
+
+	VkImageAspectFlags RenderGraph::getAspectFlags(VkFormat format) {
+		switch (format) {
+		case VK_FORMAT_D16_UNORM:
+		case VK_FORMAT_X8_D24_UNORM_PACK32:
+		case VK_FORMAT_D32_SFLOAT:
+			return VK_IMAGE_ASPECT_DEPTH_BIT;
+		case VK_FORMAT_S8_UINT:
+			return VK_IMAGE_ASPECT_STENCIL_BIT;
+		case VK_FORMAT_D16_UNORM_S8_UINT:
+		case VK_FORMAT_D24_UNORM_S8_UINT:
+		case VK_FORMAT_D32_SFLOAT_S8_UINT:
+			// layout transitions of depth/stencil images must include both aspects
+			return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+		default:
+			return VK_IMAGE_ASPECT_COLOR_BIT;
+		}
+	}
+}
@@ -0,0 +1,285 @@
+#pragma once
+
+#include "core/memory.hpp"
+#include "graphics/context/context.hpp"
+#include "graphics/frame_info.hpp"
+#include "graphics/gpu_profiler.hpp"
+#include "graphics/resources/vk_image.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace PXTEngine {
+
+	/**
+	 * @class RenderGraph
+	 *
+	 * @brief Orders the synchronization of the passes of a frame from the resources they declare.
+	 *
+	 * The graph is rebuilt every frame: the images and buffers are imported (or, for the transient
+	 * ones, described), then every pass declares how it reads and writes them and records its
+	 * commands in an execute function. compile culls the passes that contribute neither to an
+	 * output nor to a side effect, derives the layout transitions and the memory dependencies
+	 * between the passes and places the transient images with disjoint lifetimes in the same
+	 * memory; execute records, before every pass, its barriers in a single vkCmdPipelineBarrier2.
+	 *
+	 * Writing an image without reading it in the same pass discards its content (e.g. a cleared
+	 * attachment), a pass loading an attachment must declare the read too. The render passes
+	 * recorded by the passes must keep their attachments in the layout of the declared usage, the
+	 * graph does every transition. The imported resources keep their last state between frames,
+	 * the layout of the imported images is written back to them (see VulkanImage::getCurrentLayout).
+	 *
+	 * The transient images and their memory belong to the graph, they are only recreated when the
+	 * transient descriptions or their placement change; the previous ones go to the deletion queue.
+	 */
+	class RenderGraph {
+	public:
+		enum class ImageUsage {
+			ColorAttachment,
+			DepthAttachment,
+			SampledFragment,
+			SampledCompute,
+			StorageCompute,
+			StorageRayTracing
+		};
+
+		enum class BufferUsage {
+			IndirectRead,
+			StorageGraphics,
+			StorageCompute,
+			TransferDst
+		};
+
+		struct ImageHandle {
+			uint32_t index = std::numeric_limits<uint32_t>::max();
+		};
+
+		struct BufferHandle {
+			uint32_t index = std::numeric_limits<uint32_t>::max();
+		};
+
+		/**
+		 * @brief A single mip, single layer 2D transient image.
+		 */
+		struct ImageDesc {
+			VkFormat format = VK_FORMAT_UNDEFINED;
+			VkExtent2D extent{};
+			VkImageUsageFlags usage = 0;
+			VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+
+			bool operator==(const ImageDesc& other) const = default;
+		};
+
+		struct Stats {
+			uint32_t passCount = 0;
+			uint32_t culledPassCount = 0;
+			uint32_t barrierBatchCount = 0;	// vkCmdPipelineBarrier2 calls
+			uint32_t imageBarrierCount = 0;
+			uint32_t bufferBarrierCount = 0;
+			VkDeviceSize transientMemory = 0;
+			VkDeviceSize unaliasedTransientMemory = 0; // what the transient images would take without aliasing
+		};
+
+		/**
+		 * @class PassBuilder
+		 *
+		 * @brief Declares the resources of a pass, given to its setup function.
+		 * A resource can be declared several times, the usages of an image must share the layout.
+		 */
+		class PassBuilder {
+		public:
+			PassBuilder& read(ImageHandle image, ImageUsage usage);
+			PassBuilder& write(ImageHandle image, ImageUsage usage);
+			PassBuilder& read(BufferHandle buffer, BufferUsage usage);
+			PassBuilder& write(BufferHandle buffer, BufferUsage usage);
+
+			/**
+			 * @brief The pass changes state the graph does not track, it is never culled.
+			 */
+			PassBuilder& setSideEffect();
+
+		private:
+			friend class RenderGraph;
+
+			PassBuilder(RenderGraph& graph, uint32_t passIndex) : m_graph(graph), m_passIndex(passIndex) {}
+
+			RenderGraph& m_graph;
+			uint32_t m_passIndex;
+		};
+
+		using SetupFunction = std::function<void(PassBuilder& builder)>;
+		using ExecuteFunction = std::function<void(FrameInfo& frameInfo)>;
+
+		RenderGraph(Context& context);
+		/**
+		 * @brief A graph without a device, it cannot describe transient images (e.g. for the tests).
+		 */
+		RenderGraph() = default;
+		~RenderGraph();
+
+		RenderGraph(const RenderGraph&) = delete;
+		RenderGraph& operator=(const RenderGraph&) = delete;
+
+		/**
+		 * @brief Drops the passes and resources of the previous frame, the transient memory is kept.
+		 */
+		void reset();
+
+		/**
+		 * @brief Imports an image the graph does not own, over its first mip and layerCount layers.
+		 */
+		ImageHandle importImage(const std::string& name, Shared<VulkanImage> image, VkImageAspectFlags aspect,
+			uint32_t layerCount = 1);
+		BufferHandle importBuffer(const std::string& name, VkBuffer buffer);
+
+		/**
+		 * @brief Describes an image that only lives within the frame, its content is undefined at its first use.
+		 */
+		ImageHandle createImage(const std::string& name, const ImageDesc& desc);
+
+		/**
+		 * @brief The passes writing an output (or a resource they depend on) are never culled.
+		 */
+		void markOutput(ImageHandle image);
+		void markOutput(BufferHandle buffer);
+
+		void addPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute);
+
+		/**
+		 * @brief Culls the passes, places the transient images and builds the barriers of every pass.
+		 */
+		void compile();
+
+		/**
+		 * @brief Records the passes left by compile, each one in its own profiler scope when a profiler is given.
+		 */
+		void execute(FrameInfo& frameInfo, GpuProfiler* profiler = nullptr);
+
+		/**
+		 * @brief The image of a handle, the transient ones are only available after compile.
+		 */
+		const Shared<VulkanImage>& getImage(ImageHandle image) const;
+
+		const Stats& getStats() const { return m_stats; }
+
+		/**
+		 * @brief The passes, resources and barriers of the last compiled frame in Graphviz dot format.
+		 */
+		std::string exportGraphviz() const;
+
+		/**
+		 * @brief The aspects a layout transition of an image of the format must cover.
+		 */
+		static VkImageAspectFlags getAspectFlags(VkFormat format);
+
+	private:
+		struct ResourceState {
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags2 writeStages = 0;
+			VkAccessFlags2 writeAccess = 0;
+			VkPipelineStageFlags2 readStages = 0; // readers made visible since the last write
+		};
+
+		struct Resource {
+			std::string name;
+			bool isImage = true;
+			bool isTransient = false;
+			bool isOutput = false;
+
+			Shared<VulkanImage> image;
+			VkImageSubresourceRange range{};
+			ImageDesc desc{};
+			VkBuffer buffer = VK_NULL_HANDLE;
+
+			// executed passes of the first and last use, for the transient images
+			uint32_t firstPass = std::numeric_limits<uint32_t>::max();
+			uint32_t lastPass = 0;
+			uint32_t memoryBlock = std::numeric_limits<uint32_t>::max();
+
+			// written back to the imported image once the frame is recorded
+			VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		};
+
+		struct ResourceAccess {
+			uint32_t resource = 0;
+			VkPipelineStageFlags2 stages = 0;
+			VkAccessFlags2 access = 0;
+			VkAccessFlags2 writeAccess = 0;
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			bool isRead = false;
+			bool isWrite = false;
+		};
+
+		struct Pass {
+			std::string name;
+			ExecuteFunction execute;
+			std::vector<ResourceAccess> accesses;
+			bool hasSideEffect = false;
+			bool isCulled = false;
+
+			std::vector<VkImageMemoryBarrier2> imageBarriers;
+			std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+		};
+
+		/**
+		 * @brief A memory allocation shared by the transient images whose lifetimes do not overlap.
+		 */
+		struct MemoryBlock {
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkDeviceSize size = 0;
+			uint32_t memoryTypeBits = 0;
+			ResourceState state; // of the last image used in it, the next one waits for it
+		};
+
+		/**
+		 * @brief A transient image of the graph, reused by the next frames while its placement is the same.
+		 */
+		struct TransientImage {
+			std::string name;
+			ImageDesc desc;
+			uint32_t memoryBlock = 0;
+			Shared<VulkanImage> image;
+
+			bool isSamePlacement(const TransientImage& other) const {
+				return name == other.name && desc == other.desc && memoryBlock == other.memoryBlock;
+			}
+		};
+
+		struct ImportedState {
+			ResourceState state;
+			uint64_t lastFrame = 0;
+		};
+
+		void addAccess(uint32_t passIndex, uint32_t resource, VkPipelineStageFlags2 stages, VkAccessFlags2 access,
+			VkAccessFlags2 writeAccess, VkImageLayout layout, bool isWrite);
+		void cullPasses();
+		void placeTransientImages();
+		void allocateTransientImages(std::vector<TransientImage>& transientImages, std::vector<MemoryBlock>& memoryBlocks);
+		void destroyTransientImages();
+		/**
+		 * @brief Hands the transient images and their memory to the deletion queue, the frames in flight may still use them.
+		 */
+		void retireTransientImages();
+		void buildBarriers();
+		uint64_t getResourceKey(const Resource& resource) const;
+		Context& getContext() const;
+
+		Context* m_context = nullptr;
+
+		std::vector<Pass> m_passes;
+		std::vector<Resource> m_resources;
+
+		std::vector<TransientImage> m_transientImages;
+		std::vector<MemoryBlock> m_memoryBlocks;
+
+		// state of the imported resources at the end of their last frame, keyed by handle
+		std::unordered_map<uint64_t, ImportedState> m_importedStates;
+		uint64_t m_frameCounter = 0;
+
+		Stats m_stats;
+	};
+}
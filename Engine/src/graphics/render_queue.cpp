@@ -0,0 +1,170 @@
+#include "graphics/render_queue.hpp"
+
+#include "core/diagnostics.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace PXTEngine {
+
+	static constexpr uint32_t DEPTH_SHIFT = 0;
+	static constexpr uint32_t MESH_SHIFT = DEPTH_SHIFT + RenderQueue::DEPTH_BITS;
+	static constexpr uint32_t MATERIAL_SHIFT = MESH_SHIFT + RenderQueue::MESH_BITS;
+	static constexpr uint32_t PIPELINE_SHIFT = MATERIAL_SHIFT + RenderQueue::MATERIAL_BITS;
+	static constexpr uint32_t PASS_SHIFT = PIPELINE_SHIFT + RenderQueue::PIPELINE_BITS;
+
+	static_assert(PASS_SHIFT + RenderQueue::PASS_BITS == 64, "the sort key fields must fill 64 bits");
+
+	static constexpr uint64_t fieldMask(uint32_t bits) {
+		return (uint64_t(1) << bits) - 1;
+	}
+
+	static uint32_t getField(uint64_t key, uint32_t shift, uint32_t bits) {
+		return static_cast<uint32_t>((key >> shift) & fieldMask(bits));
+	}
+
+	uint64_t RenderQueue::makeKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth) {
+		PXT_ASSERT(pass <= fieldMask(PASS_BITS) && pipeline <= fieldMask(PIPELINE_BITS) &&
+			material <= fieldMask(MATERIAL_BITS) && mesh <= fieldMask(MESH_BITS) && depth <= fieldMask(DEPTH_BITS),
+			"Sort key field out of range");
+
+		return (uint64_t(pass) << PASS_SHIFT) |
+			(uint64_t(pipeline) << PIPELINE_SHIFT) |
+			(uint64_t(material) << MATERIAL_SHIFT) |
+			(uint64_t(mesh) << MESH_SHIFT) |
+			(uint64_t(depth) << DEPTH_SHIFT);
+	}
+
+	uint32_t RenderQueue::quantizeDepth(float distance) {
+		const float normalized = std::log2(1.0f + std::max(distance, 0.0f)) / std::log2(1.0f + MAX_SORT_DISTANCE);
+		const float maxDepth = static_cast<float>(fieldMask(DEPTH_BITS));
+
+		return static_cast<uint32_t>(std::min(normalized, 1.0f) * maxDepth);
+	}
+
+	uint32_t RenderQueue::getPass(uint64_t key) { return getField(key, PASS_SHIFT, PASS_BITS); }
+	uint32_t RenderQueue::getPipeline(uint64_t key) { return getField(key, PIPELINE_SHIFT, PIPELINE_BITS); }
+	uint32_t RenderQueue::getMaterial(uint64_t key) { return getField(key, MATERIAL_SHIFT, MATERIAL_BITS); }
+	uint32_t RenderQueue::getMesh(uint64_t key) { return getField(key, MESH_SHIFT, MESH_BITS); }
+
+	void RenderQueue::clear() {
+		m_items.clear();
+
+		m_lastStats = m_stats;
+		m_stats = {};
+	}
+
+	void RenderQueue::sort() {
+		const size_t count = m_items.size();
+		if (count < 2) return;
+
+		m_sortScratch.resize(count);
+
+		const uint32_t chunkCount = count >= PARALLEL_SORT_THRESHOLD
+			? std::min(m_jobSystem.getThreadCount(), MAX_SORT_THREADS)
+			: 1u;
+		const size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+		// every job owns a contiguous chunk of the items, it counts its digits then scatters them
+		auto forEachChunk = [&](const std::function<void(uint32_t chunk)>& function) {
+			m_jobSystem.parallelFor(chunkCount, function);
+		};
+
+		std::vector<std::array<uint32_t, 256>> histograms(chunkCount);
+
+		Item* source = m_items.data();
+		Item* destination = m_sortScratch.data();
+
+		for (uint32_t shift = 0; shift < 64; shift += 8) {
+			forEachChunk([&](uint32_t chunk) {
+				auto& histogram = histograms[chunk];
+				histogram.fill(0);
+
+				const size_t end = std::min(count, (chunk + 1) * chunkSize);
+				for (size_t i = chunk * chunkSize; i < end; i++) {
+					histogram[(source[i].key >> shift) & 0xFF]++;
+				}
+			});
+
+			// the high digits are often the same for every key (one pass, few pipelines), skip them
+			const uint32_t firstDigit = (source[0].key >> shift) & 0xFF;
+			uint32_t firstDigitCount = 0;
+			for (const auto& histogram : histograms) {
+				firstDigitCount += histogram[firstDigit];
+			}
+			if (firstDigitCount == count) continue;
+
+			// digit major then chunk order keeps the sort stable
+			uint32_t offset = 0;
+			for (uint32_t digit = 0; digit < 256; digit++) {
+				for (auto& histogram : histograms) {
+					const uint32_t digitCount = histogram[digit];
+					histogram[digit] = offset;
+					offset += digitCount;
+				}
+			}
+
+			forEachChunk([&](uint32_t chunk) {
+				auto& offsets = histograms[chunk];
+
+				const size_t end = std::min(count, (chunk + 1) * chunkSize);
+				for (size_t i = chunk * chunkSize; i < end; i++) {
+					destination[offsets[(source[i].key >> shift) & 0xFF]++] = source[i];
+				}
+			});
+
+			std::swap(source, destination);
+		}
+
+		if (source != m_items.data()) {
+			m_items.swap(m_sortScratch);
+		}
+	}
+
+	void RenderQueue::record(const RecordCallbacks& callbacks, uint32_t begin, uint32_t end) {
+		end = std::min(end, static_cast<uint32_t>(m_items.size()));
+
+		Stats stats;
+		uint64_t previousKey = 0;
+		bool isFirst = true;
+
+		for (uint32_t i = begin; i < end; i++) {
+			const Item& item = m_items[i];
+
+			if (callbacks.skip && callbacks.skip(item)) continue;
+
+			const bool isPipelineChanged = isFirst ||
+				getField(item.key, PIPELINE_SHIFT, PIPELINE_BITS + PASS_BITS) !=
+				getField(previousKey, PIPELINE_SHIFT, PIPELINE_BITS + PASS_BITS);
+
+			if (isPipelineChanged && callbacks.bindPipeline) {
+				callbacks.bindPipeline(item);
+				stats.pipelineBinds++;
+			}
+
+			// a new pipeline may use another layout, rebind the rest along with it
+			if ((isPipelineChanged || getMaterial(item.key) != getMaterial(previousKey)) && callbacks.bindMaterial) {
+				callbacks.bindMaterial(item);
+				stats.materialBinds++;
+			}
+
+			if ((isPipelineChanged || getMesh(item.key) != getMesh(previousKey)) && callbacks.bindMesh) {
+				callbacks.bindMesh(item);
+				stats.meshBinds++;
+			}
+
+			callbacks.draw(item);
+			stats.draws++;
+
+			previousKey = item.key;
+			isFirst = false;
+		}
+
+		std::lock_guard lock(m_statsMutex);
+		m_stats.draws += stats.draws;
+		m_stats.pipelineBinds += stats.pipelineBinds;
+		m_stats.materialBinds += stats.materialBinds;
+		m_stats.meshBinds += stats.meshBinds;
+	}
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "core/job_system.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace PXTEngine {
+
+	/**
+	 * @class RenderQueue
+	 *
+	 * @brief Orders the draws of a render system by 64 bit sort keys and records them with the
+	 * redundant binds removed.
+	 *
+	 * A key packs, from the most significant bits: the pass, the pipeline (or permutation), the
+	 * material, the mesh and the quantized view depth, so sorting the keys groups the draws by
+	 * state, most expensive change first, and draws each group front to back. The indices are the
+	 * ones of the emitting system (e.g. its batch or mesh lookup), they only have to be stable
+	 * within a frame. The payload is opaque to the queue, usually the index of the draw data.
+	 *
+	 * The keys are sorted with an LSD radix sort, split over the job system for large queues.
+	 * Recording calls the bind callbacks only when their field of the key changes and counts the
+	 * binds and draws; the counts of the last cleared frame are kept for the stats overlay.
+	 */
+	class RenderQueue {
+	public:
+		static constexpr uint32_t PASS_BITS = 4;
+		static constexpr uint32_t PIPELINE_BITS = 8;
+		static constexpr uint32_t MATERIAL_BITS = 16;
+		static constexpr uint32_t MESH_BITS = 16;
+		static constexpr uint32_t DEPTH_BITS = 20;
+
+		// view distance mapped to the full depth range, farther draws share the last value
+		static constexpr float MAX_SORT_DISTANCE = 4096.0f;
+
+		struct Item {
+			uint64_t key = 0;
+			uint32_t payload = 0;
+		};
+
+		struct Stats {
+			uint32_t draws = 0;
+			uint32_t pipelineBinds = 0;
+			uint32_t materialBinds = 0;
+			uint32_t meshBinds = 0;
+		};
+
+		/**
+		 * @brief Called by record, an empty bind callback is never called nor counted.
+		 * The pipeline callback is also called when the pass changes. The items skip returns true
+		 * for are left out, as if they were not in the queue.
+		 */
+		struct RecordCallbacks {
+			std::function<bool(const Item&)> skip;
+			std::function<void(const Item&)> bindPipeline;
+			std::function<void(const Item&)> bindMaterial;
+			std::function<void(const Item&)> bindMesh;
+			std::function<void(const Item&)> draw;
+		};
+
+		explicit RenderQueue(JobSystem& jobSystem) : m_jobSystem(jobSystem) {}
+
+		static uint64_t makeKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth);
+
+		/**
+		 * @brief Quantizes a view distance on a logarithmic scale, so the near draws keep more precision.
+		 */
+		static uint32_t quantizeDepth(float distance);
+
+		static uint32_t getPass(uint64_t key);
+		static uint32_t getPipeline(uint64_t key);
+		static uint32_t getMaterial(uint64_t key);
+		static uint32_t getMesh(uint64_t key);
+
+		/**
+		 * @brief Empties the queue and keeps the stats of the frame that ends.
+		 */
+		void clear();
+
+		void push(uint64_t key, uint32_t payload) { m_items.push_back({ key, payload }); }
+
+		/**
+		 * @brief Sorts the items by key, items with the same key keep the order they were pushed in.
+		 */
+		void sort();
+
+		/**
+		 * @brief Walks the sorted items [begin, end), binding only what changed since the previous item.
+		 * The first item binds everything; several records in a frame add up in the stats.
+		 * Disjoint ranges can be recorded from several threads, e.g. into secondary command buffers.
+		 */
+		void record(const RecordCallbacks& callbacks, uint32_t begin = 0, uint32_t end = std::numeric_limits<uint32_t>::max());
+
+		const std::vector<Item>& getItems() const { return m_items; }
+		uint32_t getSize() const { return static_cast<uint32_t>(m_items.size()); }
+
+		/**
+		 * @brief The binds and draws recorded between the last two clears.
+		 */
+		const Stats& getStats() const { return m_lastStats; }
+
+	private:
+		// below this many items the sort stays on the calling thread
+		static constexpr size_t PARALLEL_SORT_THRESHOLD = 1 << 15;
+		static constexpr uint32_t MAX_SORT_THREADS = 8;
+
+		JobSystem& m_jobSystem;
+
+		std::vector<Item> m_items;
+		std::vector<Item> m_sortScratch;
+
+		Stats m_stats;
+		Stats m_lastStats;
+		std::mutex m_statsMutex;
+	};
+}
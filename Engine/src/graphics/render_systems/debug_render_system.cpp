@@ -7,6 +7,7 @@
 #include "scene/ecs/entity.hpp"
 
 #include <stdexcept>
+#include <unordered_map>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -15,20 +16,16 @@
 
 namespace PXTEngine {
 
-    struct DebugPushConstantData {
-        glm::mat4 modelMatrix{1.f};
-        glm::mat4 normalMatrix{1.f};
-		glm::vec4 color{ 1.f };
-        uint32_t enableWireframe{0};
-		uint32_t enableNormals{0};
-		int textureIndex = 0;
-		int normalMapIndex = 1;
-		int ambientOcclusionMapIndex = 0;
-		float tilingFactor = 1.0f;
-    };
-
-    DebugRenderSystem::DebugRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, TextureRegistry& textureRegistry, VkRenderPass renderPass, DescriptorSetLayout& globalSetLayout)
-		: m_context(context), m_descriptorAllocator(descriptorAllocator), m_textureRegistry(textureRegistry) {
+	// mirrored in debug_shader.frag
+	enum DebugMap : uint32_t {
+		DEBUG_ALBEDO_MAP = 1 << 0,
+		DEBUG_NORMAL_MAP = 1 << 1,
+		DEBUG_AO_MAP = 1 << 2
+	};
+
+    DebugRenderSystem::DebugRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, TextureRegistry& textureRegistry, MaterialRegistry& materialRegistry, VkRenderPass renderPass, DescriptorSetLayout& globalSetLayout, LightClusterSystem& lightClusterSystem)
+		: m_context(context), m_descriptorAllocator(descriptorAllocator), m_textureRegistry(textureRegistry), m_materialRegistry(materialRegistry), m_lightClusterSystem(lightClusterSystem),
+		  m_queue(context.getJobSystem()) {
         createPipelineLayout(globalSetLayout);
         createPipelines(renderPass);
     }
@@ -45,7 +42,9 @@ namespace PXTEngine {
 
         std::vector<VkDescriptorSetLayout> descriptorSetLayouts{
             globalSetLayout.getDescriptorSetLayout(),
-			m_textureRegistry.getDescriptorSetLayout()
+			m_textureRegistry.getDescriptorSetLayout(),
+			m_lightClusterSystem.getDescriptorSetLayout().getDescriptorSetLayout(),
+			m_materialRegistry.getDescriptorSetLayout()
         };
 
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
@@ -74,8 +73,7 @@ namespace PXTEngine {
 			{VK_SHADER_STAGE_FRAGMENT_BIT, SPV_SHADERS_PATH + "debug_shader.frag.spv"}
 		};
 
-        m_pipelineSolid = createUnique<Pipeline>(
-            m_context,
+        m_pipelineSolid = m_context.getPipelineCompiler().compile(
             shaderFilePaths,
             pipelineConfig
         );
@@ -83,69 +81,121 @@ namespace PXTEngine {
 		// Wireframe Pipeline
 		pipelineConfig.rasterizationInfo.polygonMode = VK_POLYGON_MODE_LINE;
 
-		m_pipelineWireframe = createUnique<Pipeline>(
-			m_context,
+		m_pipelineWireframe = m_context.getPipelineCompiler().compile(
 			shaderFilePaths,
 			pipelineConfig
 		);
     }
 
-    void DebugRenderSystem::render(FrameInfo& frameInfo) {
-		if (m_renderMode == Wireframe) {
-			m_pipelineWireframe->bind(frameInfo.commandBuffer);
-		}
-		else {
-			m_pipelineSolid->bind(frameInfo.commandBuffer);
-		}
+    void DebugRenderSystem::prepare(FrameInfo& frameInfo, const std::vector<entt::entity>& visibleEntities) {
+		uint32_t enabledMaps = 0;
+		if (m_isAlbedoMapEnabled) enabledMaps |= DEBUG_ALBEDO_MAP;
+		if (m_isNormalMapEnabled) enabledMaps |= DEBUG_NORMAL_MAP;
+		if (m_isAOMapEnabled) enabledMaps |= DEBUG_AO_MAP;
 
-        std::array<VkDescriptorSet, 2> descriptorSets = {frameInfo.globalDescriptorSet, m_textureRegistry.getDescriptorSet()};
+        const glm::vec3 eye = frameInfo.camera.getPosition();
+        const float projectionScale = glm::abs(frameInfo.camera.getProjectionMatrix()[1][1]);
 
-        vkCmdBindDescriptorSets(
-            frameInfo.commandBuffer,
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            m_pipelineLayout,
-            0,
-            static_cast<uint32_t>(descriptorSets.size()),
-            descriptorSets.data(),
-            0,
-            nullptr
-        );
+        auto view = frameInfo.scene.getEntitiesWith<TransformComponent, MeshComponent, MaterialComponent, WorldBoundsComponent>();
+
+        // sorted by material, then mesh, then front to back
+        std::unordered_map<const Mesh*, uint32_t> meshLookup;
+        m_drawMeshes.clear();
+        m_drawPushConstants.clear();
+        m_drawLods.clear();
+        m_queue.clear();
 
-        auto view = frameInfo.scene.getEntitiesWith<TransformComponent, MeshComponent, MaterialComponent>();
-        for (auto entity : view) {
+        for (auto entity : visibleEntities) {
+            if (!view.contains(entity)) continue;
 
-            const auto&[transform, meshComponent, materialComponent] = view.get<TransformComponent, MeshComponent, MaterialComponent>(entity);
+            const auto&[transform, meshComponent, materialComponent, worldBounds] =
+                view.get<TransformComponent, MeshComponent, MaterialComponent, WorldBoundsComponent>(entity);
 
-			auto material = materialComponent.material;
-            auto vulkanMesh = std::static_pointer_cast<VulkanMesh>(meshComponent.mesh);
+            auto [it, isNew] = meshLookup.try_emplace(meshComponent.mesh.get(), static_cast<uint32_t>(m_drawMeshes.size()));
+            if (isNew) {
+                m_drawMeshes.push_back(static_cast<VulkanMesh*>(meshComponent.mesh.get()));
+            }
+
+            const float distance = glm::length(worldBounds.bounds.sphere.center - eye) - worldBounds.bounds.sphere.radius;
+            m_queue.push(RenderQueue::makeKey(0, 0, materialComponent.materialIndex, it->second, RenderQueue::quantizeDepth(distance)),
+                static_cast<uint32_t>(m_drawPushConstants.size()));
 
             DebugPushConstantData push{};
             push.modelMatrix = transform.mat4();
             push.normalMatrix = transform.normalMatrix();
-			push.color = material->getAlbedoColor() * glm::vec4(materialComponent.tint, 1.0f);
-			push.textureIndex = m_isAlbedoMapEnabled ? m_textureRegistry.getIndex(material->getAlbedoMap()->id) : -1;
-			push.normalMapIndex = m_isNormalMapEnabled ? m_textureRegistry.getIndex(material->getNormalMap()->id) : -1;
-			push.ambientOcclusionMapIndex = m_isAOMapEnabled ? m_textureRegistry.getIndex(material->getAmbientOcclusionMap()->id) : -1;
-			push.tilingFactor = materialComponent.tilingFactor;
+            push.tint = glm::vec4(materialComponent.tint, 1.0f);
+            push.materialIndex = materialComponent.materialIndex;
+            push.tilingFactor = materialComponent.tilingFactor;
+            push.enabledMaps = enabledMaps;
 
             push.enableWireframe = (uint32_t)(m_renderMode == Wireframe);
-			push.enableNormals = (uint32_t)m_isNormalColorEnabled;
-            
-
-            vkCmdPushConstants(
-                frameInfo.commandBuffer,
-                m_pipelineLayout,
-                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                0,
-                sizeof(DebugPushConstantData),
-                &push);
-            
-            vulkanMesh->bind(frameInfo.commandBuffer);
-            vulkanMesh->draw(frameInfo.commandBuffer);
+            push.enableNormals = (uint32_t)m_isNormalColorEnabled;
+            m_drawPushConstants.push_back(push);
+
+            const uint32_t lod = m_isLodEnabled
+                ? m_drawMeshes[it->second]->selectLod(worldBounds.bounds.sphere, transform.maxScale(), eye, projectionScale,
+                    Mesh::DEFAULT_LOD_ERROR_THRESHOLD, static_cast<uint32_t>(m_lodBias))
+                : 0;
+            m_drawLods.push_back(lod);
+        }
 
+        m_queue.sort();
+
+        // render only reads the pipelines, wait for them here
+        if (m_renderMode == Wireframe) {
+            m_pipelineWireframe.get();
+        }
+        else {
+            m_pipelineSolid.get();
         }
     }
 
+    void DebugRenderSystem::render(FrameInfo& frameInfo, uint32_t begin, uint32_t end) {
+        std::array<VkDescriptorSet, 4> descriptorSets = {
+			frameInfo.globalDescriptorSet,
+			m_textureRegistry.getDescriptorSet(),
+			m_lightClusterSystem.getDescriptorSet(frameInfo.frameIndex),
+			m_materialRegistry.getDescriptorSet()
+		};
+
+        vkCmdBindDescriptorSets(
+            frameInfo.commandBuffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            m_pipelineLayout,
+            0,
+            static_cast<uint32_t>(descriptorSets.size()),
+            descriptorSets.data(),
+            0,
+            nullptr
+        );
+
+        // the material is pushed with the transform, there is one pipeline and the meshes to bind
+        m_queue.record({
+            .bindPipeline = [&](const RenderQueue::Item&) {
+                if (m_renderMode == Wireframe) {
+                    m_pipelineWireframe->bind(frameInfo.commandBuffer);
+                }
+                else {
+                    m_pipelineSolid->bind(frameInfo.commandBuffer);
+                }
+            },
+            .bindMesh = [&](const RenderQueue::Item& item) {
+                m_drawMeshes[RenderQueue::getMesh(item.key)]->bind(frameInfo.commandBuffer);
+            },
+            .draw = [&](const RenderQueue::Item& item) {
+                vkCmdPushConstants(
+                    frameInfo.commandBuffer,
+                    m_pipelineLayout,
+                    VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                    0,
+                    sizeof(DebugPushConstantData),
+                    &m_drawPushConstants[item.payload]);
+
+                m_drawMeshes[RenderQueue::getMesh(item.key)]->draw(frameInfo.commandBuffer, m_drawLods[item.payload]);
+            }
+        }, begin, end);
+    }
+
     void DebugRenderSystem::updateUi() {
 		ImGui::Text("Render Mode:");
 		ImGui::RadioButton("Wireframe", &m_renderMode, Wireframe);
@@ -156,5 +206,9 @@ namespace PXTEngine {
 		ImGui::Checkbox("Show Normal Map", &m_isNormalMapEnabled);
 		ImGui::Checkbox("Show Ambient Occlusion Map", &m_isAOMapEnabled);
 		ImGui::EndDisabled();
+		ImGui::Checkbox("Enable LODs", &m_isLodEnabled);
+		ImGui::BeginDisabled(!m_isLodEnabled);
+		ImGui::SliderInt("LOD Bias", &m_lodBias, 0, 3);
+		ImGui::EndDisabled();
     }
 }
\ No newline at end of file
@@ -2,48 +2,96 @@
 
 #include "core/memory.hpp"
 #include "graphics/pipeline.hpp"
+#include "graphics/pipeline_compiler.hpp"
 #include "graphics/swap_chain.hpp"
 #include "graphics/context/context.hpp"
 #include "graphics/frame_info.hpp"
+#include "graphics/render_queue.hpp"
 #include "graphics/descriptors/descriptors.hpp"
 #include "graphics/resources/texture_registry.hpp"
+#include "graphics/resources/material_registry.hpp"
+#include "graphics/resources/vk_mesh.hpp"
+#include "graphics/render_systems/light_cluster_system.hpp"
 #include "scene/scene.hpp"
 
+#include <limits>
+
 namespace PXTEngine {
 	enum RenderMode {
 		Fill = 0,
 		Wireframe = 1
 	};
 
+    struct DebugPushConstantData {
+        glm::mat4 modelMatrix{1.f};
+        glm::mat4 normalMatrix{1.f};
+		glm::vec4 tint{ 1.f };
+        uint32_t enableWireframe{0};
+		uint32_t enableNormals{0};
+		uint32_t materialIndex = 0;
+		float tilingFactor = 1.0f;
+		uint32_t enabledMaps = 0;
+    };
+
     class DebugRenderSystem {
     public:
-        DebugRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, TextureRegistry& textureRegistry, VkRenderPass renderPass, DescriptorSetLayout& globalSetLayout);
+        DebugRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, TextureRegistry& textureRegistry, MaterialRegistry& materialRegistry, VkRenderPass renderPass, DescriptorSetLayout& globalSetLayout, LightClusterSystem& lightClusterSystem);
         ~DebugRenderSystem();
 
         DebugRenderSystem(const DebugRenderSystem&) = delete;
         DebugRenderSystem& operator=(const DebugRenderSystem&) = delete;
 
-        void render(FrameInfo& frameInfo);
+        /**
+         * @brief Sorts the visible entities that have a material and resolves their draw data and
+         * the pipelines, on the recording thread. Must be called before render.
+         *
+         * @param frameInfo The frame info.
+         * @param visibleEntities The entities that passed camera culling.
+         */
+        void prepare(FrameInfo& frameInfo, const std::vector<entt::entity>& visibleEntities);
+
+        /**
+         * @brief Draws the prepared draws [begin, end). Only reads the system, so disjoint ranges
+         * can be recorded concurrently (see ParallelCommandRecorder).
+         */
+        void render(FrameInfo& frameInfo, uint32_t begin = 0, uint32_t end = std::numeric_limits<uint32_t>::max());
+
+        uint32_t getDrawCount() const { return m_queue.getSize(); }
+
         void updateUi();
 
+        const RenderQueue::Stats& getQueueStats() const { return m_queue.getStats(); }
+
     private:
         void createPipelineLayout(DescriptorSetLayout& globalSetLayout);
         void createPipelines(VkRenderPass renderPass);  
         
         Context& m_context;
 		TextureRegistry& m_textureRegistry;
+		MaterialRegistry& m_materialRegistry;
+		LightClusterSystem& m_lightClusterSystem;
 
-        Unique<Pipeline> m_pipelineWireframe;
-		Unique<Pipeline> m_pipelineSolid;
+        PendingPipeline m_pipelineWireframe;
+		PendingPipeline m_pipelineSolid;
         VkPipelineLayout m_pipelineLayout;
 
 		Shared<DescriptorAllocatorGrowable> m_descriptorAllocator;
 
+		// rebuilt every frame, the mesh field of the sort keys indexes m_drawMeshes,
+		// the payload the draw data
+		RenderQueue m_queue;
+		std::vector<VulkanMesh*> m_drawMeshes;
+		std::vector<DebugPushConstantData> m_drawPushConstants;
+		std::vector<uint32_t> m_drawLods;
+
 		int m_renderMode = Fill;
 
         bool m_isNormalColorEnabled = false;
 		bool m_isAlbedoMapEnabled = true;
 		bool m_isNormalMapEnabled = true;
 		bool m_isAOMapEnabled = true;
+
+		bool m_isLodEnabled = true;
+		int m_lodBias = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,264 @@
+#include "graphics/render_systems/deferred_render_system.hpp"
+
+#include "core/constants.hpp"
+#include "core/diagnostics.hpp"
+
+#include <array>
+#include <stdexcept>
+
+namespace PXTEngine {
+
+	DeferredRenderSystem::DeferredRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator,
+		DescriptorSetLayout& globalSetLayout, LightClusterSystem& lightClusterSystem,
+		VkDescriptorImageInfo shadowMapImageInfo, Shared<VulkanImage> sceneImage, Shared<VulkanImage> depthImage)
+		: m_context(context),
+		m_descriptorAllocator(std::move(descriptorAllocator)),
+		m_lightClusterSystem(lightClusterSystem),
+		m_shadowMapImageInfo(shadowMapImageInfo),
+		m_sceneImage(std::move(sceneImage)),
+		m_depthImage(std::move(depthImage))
+	{
+		createGBufferRenderPass();
+		createSampler();
+		createDescriptorSet();
+		createPipelineLayout(globalSetLayout);
+		createPipeline();
+	}
+
+	DeferredRenderSystem::~DeferredRenderSystem() {
+		vkDestroyPipelineLayout(m_context.getDevice(), m_pipelineLayout, nullptr);
+	}
+
+	void DeferredRenderSystem::createGBufferRenderPass() {
+		VkAttachmentDescription colorAttachment{};
+		colorAttachment.format = GBUFFER_FORMAT;
+		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE; // the lighting skips the texels left uncovered
+		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		// the render graph transitions the attachments before and after the pass
+		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentDescription depthAttachment{};
+		depthAttachment.format = m_context.findDepthFormat();
+		depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentReference colorAttachmentRef{};
+		colorAttachmentRef.attachment = 0;
+		colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentReference depthAttachmentRef{};
+		depthAttachmentRef.attachment = 1;
+		depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		VkSubpassDescription subpass{};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = 1;
+		subpass.pColorAttachments = &colorAttachmentRef;
+		subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+		std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
+
+		VkRenderPassCreateInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+		renderPassInfo.pAttachments = attachments.data();
+		renderPassInfo.subpassCount = 1;
+		renderPassInfo.pSubpasses = &subpass;
+		renderPassInfo.dependencyCount = 0;
+		renderPassInfo.pDependencies = nullptr;
+
+		m_gBufferRenderPass = createUnique<RenderPass>(
+			m_context,
+			renderPassInfo,
+			colorAttachment,
+			depthAttachment,
+			"DeferredRenderSystem G-Buffer Render Pass"
+		);
+	}
+
+	RenderGraph::ImageDesc DeferredRenderSystem::getGBufferDesc() const {
+		RenderGraph::ImageDesc desc{};
+		desc.format = GBUFFER_FORMAT;
+		desc.extent = m_sceneImage->getExtent();
+		desc.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		desc.aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+		return desc;
+	}
+
+	void DeferredRenderSystem::setGBufferImage(const Shared<VulkanImage>& gBufferImage) {
+		if (gBufferImage == m_gBufferImage) return;
+
+		m_gBufferImage = gBufferImage;
+
+		// the frames in flight may still render with the previous framebuffer and sets
+		m_context.getDeletionQueue().push(std::move(m_gBufferFrameBuffer));
+		createGBufferFrameBuffer();
+		m_isLightingSetOutdated.fill(true);
+	}
+
+	void DeferredRenderSystem::createGBufferFrameBuffer() {
+		const VkExtent2D extent = m_gBufferImage->getExtent();
+
+		// the depth attachment is the offscreen depth image, shared with the offscreen pass
+		std::array<VkImageView, 2> attachments = { m_gBufferImage->getImageView(), m_depthImage->getImageView() };
+
+		VkFramebufferCreateInfo framebufferInfo{};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = m_gBufferRenderPass->getHandle();
+		framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+		framebufferInfo.pAttachments = attachments.data();
+		framebufferInfo.width = extent.width;
+		framebufferInfo.height = extent.height;
+		framebufferInfo.layers = 1;
+
+		m_gBufferFrameBuffer = createUnique<FrameBuffer>(
+			m_context,
+			framebufferInfo,
+			"DeferredRenderSystem G-Buffer Framebuffer",
+			m_gBufferImage,
+			m_depthImage
+		);
+	}
+
+	void DeferredRenderSystem::createSampler() {
+		// the lighting pass fetches texels, no filtering
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_NEAREST;
+		samplerInfo.minFilter = VK_FILTER_NEAREST;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.anisotropyEnable = VK_FALSE;
+		samplerInfo.maxAnisotropy = 1.0f;
+		samplerInfo.compareEnable = VK_FALSE;
+		samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = 0.0f;
+		samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+		samplerInfo.unnormalizedCoordinates = VK_FALSE;
+
+		m_sampler = m_context.getSampler(samplerInfo);
+	}
+
+	void DeferredRenderSystem::createDescriptorSet() {
+		m_lightingSetLayout = DescriptorSetLayout::Builder(m_context)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+			.build();
+
+		// written once the render graph hands over the G-buffer
+		for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+			m_descriptorAllocator->allocate(m_lightingSetLayout->getDescriptorSetLayout(), m_lightingSets[i]);
+		}
+	}
+
+	void DeferredRenderSystem::writeDescriptorSet(int frameIndex) {
+		VkDescriptorImageInfo gBufferInfo{};
+		gBufferInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		gBufferInfo.imageView = m_gBufferImage->getImageView();
+		gBufferInfo.sampler = m_sampler;
+
+		VkDescriptorImageInfo depthInfo{};
+		depthInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		depthInfo.imageView = m_depthImage->getImageView();
+		depthInfo.sampler = m_sampler;
+
+		VkDescriptorImageInfo sceneInfo{};
+		sceneInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		sceneInfo.imageView = m_sceneImage->getImageView();
+		sceneInfo.sampler = VK_NULL_HANDLE;
+
+		DescriptorWriter(m_context, *m_lightingSetLayout)
+			.writeImage(0, &gBufferInfo)
+			.writeImage(1, &depthInfo)
+			.writeImage(2, &m_shadowMapImageInfo)
+			.writeImage(3, &sceneInfo)
+			.updateSet(m_lightingSets[frameIndex]);
+	}
+
+	void DeferredRenderSystem::createPipelineLayout(DescriptorSetLayout& globalSetLayout) {
+		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{
+			globalSetLayout.getDescriptorSetLayout(),
+			m_lightingSetLayout->getDescriptorSetLayout(),
+			m_lightClusterSystem.getDescriptorSetLayout().getDescriptorSetLayout()
+		};
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+		pipelineLayoutInfo.pushConstantRangeCount = 0;
+		pipelineLayoutInfo.pPushConstantRanges = nullptr;
+
+		if (vkCreatePipelineLayout(m_context.getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create deferred lighting pipeline layout!");
+		}
+	}
+
+	void DeferredRenderSystem::createPipeline() {
+		ComputePipelineConfigInfo config{};
+		config.shaderFilePath = SPV_SHADERS_PATH + "deferred_lighting.comp.spv";
+		config.pipelineLayout = m_pipelineLayout;
+
+		m_pipeline = m_context.getPipelineCompiler().compile(config);
+	}
+
+	void DeferredRenderSystem::updateViewportResources(Shared<VulkanImage> sceneImage, Shared<VulkanImage> depthImage) {
+		m_sceneImage = std::move(sceneImage);
+		m_depthImage = std::move(depthImage);
+
+		// the framebuffer and the descriptors are rebuilt with the next G-buffer
+		m_gBufferImage = nullptr;
+		m_context.getDeletionQueue().push(std::move(m_gBufferFrameBuffer));
+	}
+
+	void DeferredRenderSystem::renderLighting(FrameInfo& frameInfo) {
+		VkCommandBuffer commandBuffer = frameInfo.commandBuffer;
+
+		// the previous use of this frame slot has completed, its set can be rewritten
+		if (m_isLightingSetOutdated[frameInfo.frameIndex]) {
+			writeDescriptorSet(frameInfo.frameIndex);
+			m_isLightingSetOutdated[frameInfo.frameIndex] = false;
+		}
+
+		m_pipeline->bind(commandBuffer);
+
+		std::array<VkDescriptorSet, 3> descriptorSets = {
+			frameInfo.globalDescriptorSet,
+			m_lightingSets[frameInfo.frameIndex],
+			m_lightClusterSystem.getDescriptorSet(frameInfo.frameIndex)
+		};
+
+		vkCmdBindDescriptorSets(
+			commandBuffer,
+			VK_PIPELINE_BIND_POINT_COMPUTE,
+			m_pipelineLayout,
+			0,
+			static_cast<uint32_t>(descriptorSets.size()),
+			descriptorSets.data(),
+			0,
+			nullptr
+		);
+
+		const VkExtent2D extent = m_sceneImage->getExtent();
+		vkCmdDispatch(
+			commandBuffer,
+			(extent.width + GROUP_SIZE - 1) / GROUP_SIZE,
+			(extent.height + GROUP_SIZE - 1) / GROUP_SIZE,
+			1
+		);
+	}
+}
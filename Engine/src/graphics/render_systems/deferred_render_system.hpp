@@ -0,0 +1,106 @@
+#pragma once
+
+#include "core/memory.hpp"
+#include "graphics/pipeline.hpp"
+#include "graphics/pipeline_compiler.hpp"
+#include "graphics/swap_chain.hpp"
+#include "graphics/context/context.hpp"
+#include "graphics/frame_info.hpp"
+#include "graphics/render_pass.hpp"
+#include "graphics/render_graph.hpp"
+#include "graphics/frame_buffer.hpp"
+#include "graphics/resources/vk_image.hpp"
+#include "graphics/descriptors/descriptors.hpp"
+#include "graphics/render_systems/light_cluster_system.hpp"
+
+#include <array>
+
+namespace PXTEngine {
+
+	/**
+	 * @class DeferredRenderSystem
+	 *
+	 * @brief Deferred shading path of the raster renderer.
+	 *
+	 * The geometry pass writes the surfaces in a compact G-buffer (see gbuffer.glsl): one R32G32B32A32_UINT
+	 * target with the albedo and ambient occlusion, the octahedral normal, the specular parameters and
+	 * the emissive radiance, plus the depth of the offscreen depth image. The lighting pass is a compute dispatch that shades
+	 * every covered pixel once, with the clustered light lists and the shadow cube maps, straight into
+	 * the scene image. The pixels without geometry keep the depth clear value, the skybox fills them.
+	 *
+	 * The materials are drawn by MaterialRenderSystem with its G-buffer pipeline, in the render pass
+	 * returned by getGBufferRenderPass. The G-buffer only lives within the frame, it is a transient
+	 * image of the render graph (see getGBufferDesc) handed over with setGBufferImage.
+	 */
+	class DeferredRenderSystem {
+	public:
+		DeferredRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator,
+			DescriptorSetLayout& globalSetLayout, LightClusterSystem& lightClusterSystem,
+			VkDescriptorImageInfo shadowMapImageInfo, Shared<VulkanImage> sceneImage, Shared<VulkanImage> depthImage);
+		~DeferredRenderSystem();
+
+		DeferredRenderSystem(const DeferredRenderSystem&) = delete;
+		DeferredRenderSystem& operator=(const DeferredRenderSystem&) = delete;
+
+		/**
+		 * @brief Takes the new viewport images, the G-buffer of the next frame must match them.
+		 */
+		void updateViewportResources(Shared<VulkanImage> sceneImage, Shared<VulkanImage> depthImage);
+
+		/**
+		 * @brief The G-buffer the render graph must create for the current viewport.
+		 */
+		RenderGraph::ImageDesc getGBufferDesc() const;
+
+		/**
+		 * @brief Uses the image for the G-buffer, the framebuffer and the lighting descriptors are
+		 * only rebuilt when the image changed. Must be called before the G-buffer pass is recorded.
+		 * The descriptors of a frame slot are rewritten by the next renderLighting of that slot.
+		 */
+		void setGBufferImage(const Shared<VulkanImage>& gBufferImage);
+
+		/**
+		 * @brief Shades the G-buffer into the scene image, must be recorded after the geometry pass
+		 * and outside of a render pass. The G-buffer and the depth must be in shader read only layout,
+		 * the scene image in general layout.
+		 */
+		void renderLighting(FrameInfo& frameInfo);
+
+		RenderPass& getGBufferRenderPass() const { return *m_gBufferRenderPass; }
+		FrameBuffer& getGBufferFrameBuffer() const { return *m_gBufferFrameBuffer; }
+
+	private:
+		void createGBufferRenderPass();
+		void createGBufferFrameBuffer();
+		void createSampler();
+		void createDescriptorSet();
+		void writeDescriptorSet(int frameIndex);
+		void createPipelineLayout(DescriptorSetLayout& globalSetLayout);
+		void createPipeline();
+
+		static constexpr uint32_t GROUP_SIZE = 8; // mirrored in deferred_lighting.comp
+		static constexpr VkFormat GBUFFER_FORMAT = VK_FORMAT_R32G32B32A32_UINT;
+
+		Context& m_context;
+		Shared<DescriptorAllocatorGrowable> m_descriptorAllocator;
+		LightClusterSystem& m_lightClusterSystem;
+
+		VkDescriptorImageInfo m_shadowMapImageInfo;
+		Shared<VulkanImage> m_sceneImage;
+		Shared<VulkanImage> m_depthImage;
+		Shared<VulkanImage> m_gBufferImage;
+
+		Unique<RenderPass> m_gBufferRenderPass;
+		Unique<FrameBuffer> m_gBufferFrameBuffer;
+
+		VkSampler m_sampler = VK_NULL_HANDLE;
+
+		Unique<DescriptorSetLayout> m_lightingSetLayout;
+		// one per frame slot, an outdated set is rewritten once the frames in flight no longer use it
+		std::array<VkDescriptorSet, SwapChain::MAX_FRAMES_IN_FLIGHT> m_lightingSets{};
+		std::array<bool, SwapChain::MAX_FRAMES_IN_FLIGHT> m_isLightingSetOutdated{};
+
+		VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+		PendingPipeline m_pipeline;
+	};
+}
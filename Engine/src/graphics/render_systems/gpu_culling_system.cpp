@@ -0,0 +1,536 @@
+#include "graphics/render_systems/gpu_culling_system.hpp"
+
+#include "core/constants.hpp"
+#include "core/diagnostics.hpp"
+#include "scene/frustum.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace PXTEngine {
+
+	/**
+	 * @struct CullUniforms
+	 *
+	 * @brief std140 layout shared with occlusion_culling.comp.
+	 */
+	struct CullUniforms {
+		glm::mat4 depthPyramidViewProjection{ 1.0f };
+		glm::vec4 frustumPlanes[6];
+		glm::vec2 depthPyramidSize{ 0.0f };
+		uint32_t instanceCount = 0;
+		uint32_t occlusionEnabled = 0;
+	};
+
+	struct DepthPyramidPushConstantData {
+		glm::ivec2 srcSize;
+		glm::ivec2 dstSize;
+	};
+
+	GpuCullingSystem::GpuCullingSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator,
+		Shared<VulkanImage> depthImage)
+		: m_context(context),
+		m_descriptorAllocator(std::move(descriptorAllocator)),
+		m_depthImage(std::move(depthImage))
+	{
+		createDescriptorSetLayouts();
+		createPipelineLayouts();
+		createPipelines();
+		createDepthPyramid();
+		createFrameResources();
+	}
+
+	GpuCullingSystem::~GpuCullingSystem() {
+		retireDepthPyramid();
+		vkDestroyPipelineLayout(m_context.getDevice(), m_cullPipelineLayout, nullptr);
+		vkDestroyPipelineLayout(m_context.getDevice(), m_depthPyramidPipelineLayout, nullptr);
+	}
+
+	void GpuCullingSystem::updateDepthImage(Shared<VulkanImage> depthImage) {
+		m_depthImage = std::move(depthImage);
+
+		retireDepthPyramid();
+		createDepthPyramid();
+	}
+
+	void GpuCullingSystem::createDepthPyramid() {
+		const VkExtent2D depthExtent = m_depthImage->getExtent();
+
+		// a power of two pyramid halves exactly at every level, so a texel of level n
+		// always covers 2^n texels of level 0 and the footprint test stays conservative
+		m_depthPyramidExtent = {
+			std::bit_floor(std::max(depthExtent.width, 1u)),
+			std::bit_floor(std::max(depthExtent.height, 1u))
+		};
+		m_depthPyramidMipCount = std::bit_width(std::max(m_depthPyramidExtent.width, m_depthPyramidExtent.height));
+
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.extent.width = m_depthPyramidExtent.width;
+		imageInfo.extent.height = m_depthPyramidExtent.height;
+		imageInfo.extent.depth = 1;
+		imageInfo.mipLevels = m_depthPyramidMipCount;
+		imageInfo.arrayLayers = 1;
+		imageInfo.format = VK_FORMAT_R32_SFLOAT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT |	// written by the reduction
+						  VK_IMAGE_USAGE_SAMPLED_BIT;	// read by the reduction and the culling
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		m_depthPyramid = createUnique<VulkanImage>(m_context, imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		VkImageSubresourceRange pyramidRange{};
+		pyramidRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		pyramidRange.baseMipLevel = 0;
+		pyramidRange.levelCount = m_depthPyramidMipCount;
+		pyramidRange.baseArrayLayer = 0;
+		pyramidRange.layerCount = 1;
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = m_depthPyramid->getVkImage();
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = VK_FORMAT_R32_SFLOAT;
+		viewInfo.subresourceRange = pyramidRange;
+
+		m_depthPyramid->createImageView(viewInfo);
+
+		// one view per level for the reduction
+		for (uint32_t mip = 0; mip < m_depthPyramidMipCount; mip++) {
+			viewInfo.subresourceRange.baseMipLevel = mip;
+			viewInfo.subresourceRange.levelCount = 1;
+			m_depthPyramidMipViews.push_back(m_context.createImageView(viewInfo));
+		}
+
+		// nearest filtering: the culling reads exact texels of a chosen level
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_NEAREST;
+		samplerInfo.minFilter = VK_FILTER_NEAREST;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.anisotropyEnable = VK_FALSE;
+		samplerInfo.maxAnisotropy = 1.0f;
+		samplerInfo.unnormalizedCoordinates = VK_FALSE;
+		samplerInfo.compareEnable = VK_FALSE;
+		samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+		samplerInfo.mipLodBias = 0.0f;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = static_cast<float>(m_depthPyramidMipCount);
+
+		m_depthPyramid->createSampler(samplerInfo);
+
+		samplerInfo.maxLod = 0.0f;
+		m_depthSampler = m_context.getSampler(samplerInfo);
+
+		// the sets of a frame slot are rewritten when the slot is updated again, the frames
+		// in flight still use the ones of the previous pyramid
+		m_isDescriptorSetOutdated.fill(true);
+
+		// the new pyramid holds no depth yet
+		m_isDepthPyramidValid = false;
+	}
+
+	void GpuCullingSystem::retireDepthPyramid() {
+		if (m_depthPyramid == nullptr) return;
+
+		// the pyramid can still be in use by frames in flight
+		DeletionQueue& deletionQueue = m_context.getDeletionQueue();
+
+		deletionQueue.push([device = m_context.getDevice(), views = std::move(m_depthPyramidMipViews)]() {
+			for (VkImageView view : views) {
+				vkDestroyImageView(device, view, nullptr);
+			}
+		});
+		deletionQueue.push(std::move(m_depthPyramid));
+
+		m_depthPyramidMipViews.clear();
+		m_depthPyramid = nullptr;
+	}
+
+	void GpuCullingSystem::initializeDepthPyramidLayout(VkCommandBuffer commandBuffer) {
+		if (m_depthPyramid->getCurrentLayout() != VK_IMAGE_LAYOUT_UNDEFINED) return;
+
+		VkImageSubresourceRange pyramidRange{};
+		pyramidRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		pyramidRange.baseMipLevel = 0;
+		pyramidRange.levelCount = m_depthPyramidMipCount;
+		pyramidRange.baseArrayLayer = 0;
+		pyramidRange.layerCount = 1;
+
+		// the pyramid stays in the general layout, it is both a storage and a sampled image
+		m_depthPyramid->transitionImageLayout(
+			commandBuffer,
+			VK_IMAGE_LAYOUT_GENERAL,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			pyramidRange
+		);
+	}
+
+	void GpuCullingSystem::createDescriptorSetLayouts() {
+		m_cullSetLayout = DescriptorSetLayout::Builder(m_context)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.build();
+
+		m_depthPyramidSetLayout = DescriptorSetLayout::Builder(m_context)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+			.build();
+	}
+
+	void GpuCullingSystem::createPipelineLayouts() {
+		VkDescriptorSetLayout cullSetLayout = m_cullSetLayout->getDescriptorSetLayout();
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &cullSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 0;
+		pipelineLayoutInfo.pPushConstantRanges = nullptr;
+
+		if (vkCreatePipelineLayout(m_context.getDevice(), &pipelineLayoutInfo, nullptr, &m_cullPipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create culling pipeline layout!");
+		}
+
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(DepthPyramidPushConstantData);
+
+		VkDescriptorSetLayout depthPyramidSetLayout = m_depthPyramidSetLayout->getDescriptorSetLayout();
+
+		pipelineLayoutInfo.pSetLayouts = &depthPyramidSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(m_context.getDevice(), &pipelineLayoutInfo, nullptr, &m_depthPyramidPipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create depth pyramid pipeline layout!");
+		}
+	}
+
+	void GpuCullingSystem::createPipelines() {
+		ComputePipelineConfigInfo cullConfig{};
+		cullConfig.shaderFilePath = SPV_SHADERS_PATH + "occlusion_culling.comp.spv";
+		cullConfig.pipelineLayout = m_cullPipelineLayout;
+
+		m_cullPipeline = m_context.getPipelineCompiler().compile(cullConfig);
+
+		ComputePipelineConfigInfo depthPyramidConfig{};
+		depthPyramidConfig.shaderFilePath = SPV_SHADERS_PATH + "depth_pyramid.comp.spv";
+		depthPyramidConfig.pipelineLayout = m_depthPyramidPipelineLayout;
+
+		m_depthPyramidPipeline = m_context.getPipelineCompiler().compile(depthPyramidConfig);
+	}
+
+	void GpuCullingSystem::createFrameResources() {
+		for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+			m_uniformBuffers[i] = createUnique<VulkanBuffer>(
+				m_context,
+				sizeof(CullUniforms),
+				1,
+				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+			);
+			m_uniformBuffers[i]->map();
+
+			m_descriptorAllocator->allocate(m_cullSetLayout->getDescriptorSetLayout(), m_cullDescriptorSets[i]);
+
+			// start with room for a small scene, buffers grow on demand
+			ensureFrameCapacity(i, 256, 16);
+		}
+	}
+
+	void GpuCullingSystem::ensureFrameCapacity(int frameIndex, uint32_t instanceCount, uint32_t batchCount) {
+		bool isResized = false;
+
+		if (m_instanceBuffers[frameIndex] == nullptr || m_instanceBuffers[frameIndex]->getInstanceCount() < instanceCount) {
+			const uint32_t capacity = std::bit_ceil(std::max(instanceCount, 1u));
+
+			m_instanceBuffers[frameIndex] = createUnique<VulkanBuffer>(
+				m_context,
+				sizeof(CullInstance),
+				capacity,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+			);
+			m_instanceBuffers[frameIndex]->map();
+
+			// at most one draw command per instance
+			m_drawCommandBuffers[frameIndex] = createUnique<VulkanBuffer>(
+				m_context,
+				sizeof(VkDrawIndexedIndirectCommand),
+				capacity,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			);
+
+			isResized = true;
+		}
+
+		if (m_drawCountBuffers[frameIndex] == nullptr || m_drawCountBuffers[frameIndex]->getInstanceCount() < batchCount) {
+			// host visible to read back the draw counts for the stats
+			m_drawCountBuffers[frameIndex] = createUnique<VulkanBuffer>(
+				m_context,
+				sizeof(uint32_t),
+				std::bit_ceil(std::max(batchCount, 1u)),
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+			);
+			m_drawCountBuffers[frameIndex]->map();
+
+			// the new buffer holds no counts of a previous use
+			m_batchCounts[frameIndex] = 0;
+
+			isResized = true;
+		}
+
+		if (isResized) {
+			writeCullDescriptorSet(frameIndex);
+		}
+	}
+
+	void GpuCullingSystem::writeCullDescriptorSet(int frameIndex) {
+		if (m_drawCountBuffers[frameIndex] == nullptr || m_depthPyramid == nullptr) {
+			return;
+		}
+
+		VkDescriptorBufferInfo uniformInfo = m_uniformBuffers[frameIndex]->descriptorInfo();
+		VkDescriptorBufferInfo instanceInfo = m_instanceBuffers[frameIndex]->descriptorInfo();
+		VkDescriptorBufferInfo drawCommandInfo = m_drawCommandBuffers[frameIndex]->descriptorInfo();
+		VkDescriptorBufferInfo drawCountInfo = m_drawCountBuffers[frameIndex]->descriptorInfo();
+
+		VkDescriptorImageInfo depthPyramidInfo{};
+		depthPyramidInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		depthPyramidInfo.imageView = m_depthPyramid->getImageView();
+		depthPyramidInfo.sampler = m_depthPyramid->getImageSampler();
+
+		DescriptorWriter(m_context, *m_cullSetLayout)
+			.writeBuffer(0, &uniformInfo)
+			.writeBuffer(1, &instanceInfo)
+			.writeBuffer(2, &drawCommandInfo)
+			.writeBuffer(3, &drawCountInfo)
+			.writeImage(4, &depthPyramidInfo)
+			.updateSet(m_cullDescriptorSets[frameIndex]);
+	}
+
+	void GpuCullingSystem::writeDepthPyramidDescriptorSets(int frameIndex) {
+		std::vector<VkDescriptorSet>& sets = m_depthPyramidDescriptorSets[frameIndex];
+
+		// sets are reused across resizes, only allocate the missing ones
+		while (sets.size() < m_depthPyramidMipCount) {
+			VkDescriptorSet set;
+			m_descriptorAllocator->allocate(m_depthPyramidSetLayout->getDescriptorSetLayout(), set);
+			sets.push_back(set);
+		}
+
+		for (uint32_t mip = 0; mip < m_depthPyramidMipCount; mip++) {
+			// level 0 reduces the depth buffer, every other level the one above it
+			VkDescriptorImageInfo srcInfo{};
+			if (mip == 0) {
+				srcInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				srcInfo.imageView = m_depthImage->getImageView();
+				srcInfo.sampler = m_depthSampler;
+			} else {
+				srcInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+				srcInfo.imageView = m_depthPyramidMipViews[mip - 1];
+				srcInfo.sampler = m_depthPyramid->getImageSampler();
+			}
+
+			VkDescriptorImageInfo dstInfo{};
+			dstInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			dstInfo.imageView = m_depthPyramidMipViews[mip];
+			dstInfo.sampler = VK_NULL_HANDLE;
+
+			DescriptorWriter(m_context, *m_depthPyramidSetLayout)
+				.writeImage(0, &srcInfo)
+				.writeImage(1, &dstInfo)
+				.updateSet(sets[mip]);
+		}
+	}
+
+	void GpuCullingSystem::update(FrameInfo& frameInfo, const glm::mat4& viewProjection,
+		const std::vector<CullInstance>& instances, uint32_t batchCount) {
+		const int frameIndex = frameInfo.frameIndex;
+
+		// the fence of this frame slot has been waited on, its counts are final
+		const auto* counts = static_cast<const uint32_t*>(m_drawCountBuffers[frameIndex]->getMappedMemory());
+
+		m_stats.instances = m_instanceCounts[frameIndex];
+		m_stats.drawn = 0;
+		for (uint32_t batch = 0; batch < m_batchCounts[frameIndex]; batch++) {
+			m_stats.drawn += counts[batch];
+		}
+
+		ensureFrameCapacity(frameIndex, static_cast<uint32_t>(instances.size()), batchCount);
+
+		// no frame in flight uses the sets of this slot anymore, see createDepthPyramid
+		if (m_isDescriptorSetOutdated[frameIndex]) {
+			writeCullDescriptorSet(frameIndex);
+			writeDepthPyramidDescriptorSets(frameIndex);
+			m_isDescriptorSetOutdated[frameIndex] = false;
+		}
+
+		if (!instances.empty()) {
+			m_instanceBuffers[frameIndex]->writeToBuffer(
+				const_cast<CullInstance*>(instances.data()),
+				instances.size() * sizeof(CullInstance)
+			);
+		}
+
+		m_instanceCounts[frameIndex] = static_cast<uint32_t>(instances.size());
+		m_batchCounts[frameIndex] = batchCount;
+		m_viewProjection = viewProjection;
+
+		const Frustum frustum = Frustum::fromMatrix(viewProjection);
+
+		CullUniforms uniforms{};
+		uniforms.depthPyramidViewProjection = m_depthPyramidViewProjection;
+		for (int i = 0; i < 6; i++) {
+			uniforms.frustumPlanes[i] = frustum.getPlane(i);
+		}
+		uniforms.depthPyramidSize = glm::vec2(m_depthPyramidExtent.width, m_depthPyramidExtent.height);
+		uniforms.instanceCount = m_instanceCounts[frameIndex];
+		uniforms.occlusionEnabled = m_isOcclusionEnabled && m_isDepthPyramidValid ? 1 : 0;
+
+		m_uniformBuffers[frameIndex]->writeToBuffer(&uniforms);
+	}
+
+	void GpuCullingSystem::cull(FrameInfo& frameInfo) {
+		const int frameIndex = frameInfo.frameIndex;
+		VkCommandBuffer commandBuffer = frameInfo.commandBuffer;
+
+		if (m_batchCounts[frameIndex] == 0) {
+			return;
+		}
+
+		initializeDepthPyramidLayout(commandBuffer);
+
+		vkCmdFillBuffer(commandBuffer, m_drawCountBuffers[frameIndex]->getBuffer(), 0,
+			m_batchCounts[frameIndex] * sizeof(uint32_t), 0);
+
+		// counts cleared and the pyramid of the previous frame written before the culling reads them
+		VkMemoryBarrier clearBarrier{};
+		clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0,
+			1, &clearBarrier,
+			0, nullptr,
+			0, nullptr
+		);
+
+		m_cullPipeline->bind(commandBuffer);
+
+		vkCmdBindDescriptorSets(
+			commandBuffer,
+			VK_PIPELINE_BIND_POINT_COMPUTE,
+			m_cullPipelineLayout,
+			0,
+			1,
+			&m_cullDescriptorSets[frameIndex],
+			0,
+			nullptr
+		);
+
+		const uint32_t groupCount = (m_instanceCounts[frameIndex] + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE;
+		vkCmdDispatch(commandBuffer, groupCount, 1, 1);
+	}
+
+	void GpuCullingSystem::buildDepthPyramid(FrameInfo& frameInfo) {
+		VkCommandBuffer commandBuffer = frameInfo.commandBuffer;
+		const std::vector<VkDescriptorSet>& sets = m_depthPyramidDescriptorSets[frameInfo.frameIndex];
+
+		initializeDepthPyramidLayout(commandBuffer);
+
+		m_depthPyramidPipeline->bind(commandBuffer);
+
+		VkExtent2D srcExtent = m_depthImage->getExtent();
+		VkExtent2D dstExtent = m_depthPyramidExtent;
+
+		for (uint32_t mip = 0; mip < m_depthPyramidMipCount; mip++) {
+			vkCmdBindDescriptorSets(
+				commandBuffer,
+				VK_PIPELINE_BIND_POINT_COMPUTE,
+				m_depthPyramidPipelineLayout,
+				0,
+				1,
+				&sets[mip],
+				0,
+				nullptr
+			);
+
+			DepthPyramidPushConstantData push{};
+			push.srcSize = glm::ivec2(srcExtent.width, srcExtent.height);
+			push.dstSize = glm::ivec2(dstExtent.width, dstExtent.height);
+
+			vkCmdPushConstants(
+				commandBuffer,
+				m_depthPyramidPipelineLayout,
+				VK_SHADER_STAGE_COMPUTE_BIT,
+				0,
+				sizeof(DepthPyramidPushConstantData),
+				&push
+			);
+
+			vkCmdDispatch(
+				commandBuffer,
+				(dstExtent.width + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE,
+				(dstExtent.height + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE,
+				1
+			);
+
+			// the next level reads this one
+			VkImageMemoryBarrier mipBarrier{};
+			mipBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			mipBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			mipBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			mipBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+			mipBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+			mipBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			mipBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			mipBarrier.image = m_depthPyramid->getVkImage();
+			mipBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			mipBarrier.subresourceRange.baseMipLevel = mip;
+			mipBarrier.subresourceRange.levelCount = 1;
+			mipBarrier.subresourceRange.baseArrayLayer = 0;
+			mipBarrier.subresourceRange.layerCount = 1;
+
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				0,
+				0, nullptr,
+				0, nullptr,
+				1, &mipBarrier
+			);
+
+			srcExtent = dstExtent;
+			dstExtent = { std::max(dstExtent.width / 2, 1u), std::max(dstExtent.height / 2, 1u) };
+		}
+
+		m_depthPyramidViewProjection = m_viewProjection;
+		m_isDepthPyramidValid = true;
+	}
+
+	void GpuCullingSystem::updateUi() {
+		ImGui::Checkbox("Occlusion Culling", &m_isOcclusionEnabled);
+		ImGui::Text("GPU culling: %u drawn, %u culled", m_stats.drawn, m_stats.instances - m_stats.drawn);
+	}
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "core/memory.hpp"
+#include "graphics/pipeline.hpp"
+#include "graphics/pipeline_compiler.hpp"
+#include "graphics/swap_chain.hpp"
+#include "graphics/context/context.hpp"
+#include "graphics/frame_info.hpp"
+#include "graphics/resources/vk_buffer.hpp"
+#include "graphics/resources/vk_image.hpp"
+#include "graphics/descriptors/descriptors.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <array>
+#include <vector>
+
+namespace PXTEngine {
+
+	/**
+	 * @class GpuCullingSystem
+	 *
+	 * @brief Culls draw instances in a compute pass against the view frustum and against a
+	 * hierarchical depth (Hi-Z) pyramid, writing a compacted indirect draw buffer and draw counts.
+	 *
+	 * Instances are grouped in batches (one per vertex/index buffer pair): every batch owns a
+	 * contiguous range of draw commands and one draw count, consumed by vkCmdDrawIndexedIndirectCount.
+	 * The depth pyramid is built from the depth buffer at the end of the frame and used for the
+	 * occlusion test of the next frame, reprojected with the view projection it was rendered with.
+	 * Only core compute features are used.
+	 */
+	class GpuCullingSystem {
+	public:
+		/**
+		 * @struct CullInstance
+		 *
+		 * @brief Per instance bounds and draw range, std430 layout shared with occlusion_culling.comp.
+		 * The instance index (position in the buffer) is written as firstInstance of the draw.
+		 */
+		struct CullInstance {
+			glm::vec4 sphere{ 0.0f };	// world center, radius
+			glm::vec4 boxMin{ 0.0f };	// world AABB, w unused
+			glm::vec4 boxMax{ 0.0f };
+			uint32_t firstIndex = 0;
+			uint32_t indexCount = 0;
+			uint32_t batchIndex = 0;
+			uint32_t commandOffset = 0;	// first draw command of the batch
+		};
+
+		struct Stats {
+			uint32_t instances = 0;
+			uint32_t drawn = 0;
+		};
+
+		GpuCullingSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator,
+			Shared<VulkanImage> depthImage);
+		~GpuCullingSystem();
+
+		GpuCullingSystem(const GpuCullingSystem&) = delete;
+		GpuCullingSystem& operator=(const GpuCullingSystem&) = delete;
+
+		/**
+		 * @brief Recreates the depth pyramid for a new depth image (e.g. after a resize).
+		 * The depth image must have been created with VK_IMAGE_USAGE_SAMPLED_BIT.
+		 * The previous pyramid goes to the deletion queue, nothing waits for the frames in flight.
+		 */
+		void updateDepthImage(Shared<VulkanImage> depthImage);
+
+		/**
+		 * @brief Uploads the instances and the culling uniforms of the frame.
+		 *
+		 * @param frameInfo The frame info.
+		 * @param viewProjection The camera projection * view matrix of the frame.
+		 * @param instances The instances to cull, sorted by batch.
+		 * @param batchCount The number of batches referenced by the instances.
+		 */
+		void update(FrameInfo& frameInfo, const glm::mat4& viewProjection,
+			const std::vector<CullInstance>& instances, uint32_t batchCount);
+
+		/**
+		 * @brief Records the culling dispatch, must be recorded outside of a render pass.
+		 * The caller makes the draw buffers visible to the indirect draws (see RenderGraph).
+		 */
+		void cull(FrameInfo& frameInfo);
+
+		/**
+		 * @brief Records the depth pyramid build from the depth image, after the pass that wrote it.
+		 * The depth image must be in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, the caller transitions it.
+		 */
+		void buildDepthPyramid(FrameInfo& frameInfo);
+
+		/**
+		 * @brief Marks the depth pyramid as stale, e.g. when the raster passes were skipped.
+		 * Occlusion culling is skipped until the next buildDepthPyramid.
+		 */
+		void invalidateDepthPyramid() { m_isDepthPyramidValid = false; }
+
+		VkBuffer getDrawCommandBuffer(int frameIndex) const { return m_drawCommandBuffers[frameIndex]->getBuffer(); }
+		VkBuffer getDrawCountBuffer(int frameIndex) const { return m_drawCountBuffers[frameIndex]->getBuffer(); }
+
+		/**
+		 * @brief Instances and draws of the last completed use of a frame slot, read back from the counts.
+		 */
+		Stats getStats() const { return m_stats; }
+
+		void updateUi();
+
+	private:
+		void createDepthPyramid();
+		/**
+		 * @brief Hands the pyramid and its views to the deletion queue, the frames in flight may still read it.
+		 */
+		void retireDepthPyramid();
+		/**
+		 * @brief Moves a new pyramid out of the undefined layout, recorded in the frame instead of a blocking submit.
+		 */
+		void initializeDepthPyramidLayout(VkCommandBuffer commandBuffer);
+		void createDescriptorSetLayouts();
+		void createPipelineLayouts();
+		void createPipelines();
+		void createFrameResources();
+		void ensureFrameCapacity(int frameIndex, uint32_t instanceCount, uint32_t batchCount);
+		void writeCullDescriptorSet(int frameIndex);
+		void writeDepthPyramidDescriptorSets(int frameIndex);
+
+		static constexpr uint32_t CULL_GROUP_SIZE = 64;
+		static constexpr uint32_t PYRAMID_GROUP_SIZE = 8;
+
+		Context& m_context;
+		Shared<DescriptorAllocatorGrowable> m_descriptorAllocator;
+
+		Shared<VulkanImage> m_depthImage;
+
+		// Hi-Z pyramid, level 0 is the depth buffer reduced to the previous power of two
+		Unique<VulkanImage> m_depthPyramid;
+		std::vector<VkImageView> m_depthPyramidMipViews;
+		VkSampler m_depthSampler = VK_NULL_HANDLE;
+		VkExtent2D m_depthPyramidExtent{ 0, 0 };
+		uint32_t m_depthPyramidMipCount = 0;
+		bool m_isDepthPyramidValid = false;
+		glm::mat4 m_depthPyramidViewProjection{ 1.0f };
+
+		Unique<DescriptorSetLayout> m_cullSetLayout;
+		Unique<DescriptorSetLayout> m_depthPyramidSetLayout;
+		std::array<VkDescriptorSet, SwapChain::MAX_FRAMES_IN_FLIGHT> m_cullDescriptorSets{};
+		// one set per pyramid level and frame slot, a slot is rewritten by update once its frame retired
+		std::array<std::vector<VkDescriptorSet>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_depthPyramidDescriptorSets;
+		std::array<bool, SwapChain::MAX_FRAMES_IN_FLIGHT> m_isDescriptorSetOutdated{};
+
+		VkPipelineLayout m_cullPipelineLayout = VK_NULL_HANDLE;
+		VkPipelineLayout m_depthPyramidPipelineLayout = VK_NULL_HANDLE;
+		PendingPipeline m_cullPipeline;
+		PendingPipeline m_depthPyramidPipeline;
+
+		std::array<Unique<VulkanBuffer>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_uniformBuffers;
+		std::array<Unique<VulkanBuffer>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_instanceBuffers;
+		std::array<Unique<VulkanBuffer>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_drawCommandBuffers;
+		std::array<Unique<VulkanBuffer>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_drawCountBuffers;
+		std::array<uint32_t, SwapChain::MAX_FRAMES_IN_FLIGHT> m_instanceCounts{};
+		std::array<uint32_t, SwapChain::MAX_FRAMES_IN_FLIGHT> m_batchCounts{};
+
+		glm::mat4 m_viewProjection{ 1.0f };
+		Stats m_stats{};
+
+		bool m_isOcclusionEnabled = true;
+	};
+}
@@ -0,0 +1,199 @@
+#include "graphics/render_systems/light_cluster_system.hpp"
+
+#include "core/constants.hpp"
+#include "core/diagnostics.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#include <imgui.h>
+
+namespace PXTEngine {
+
+	/**
+	 * @struct ClusterUniforms
+	 *
+	 * @brief std140 layout shared with light_clusters.glsl.
+	 */
+	struct ClusterUniforms {
+		glm::mat4 view{ 1.0f };
+		glm::vec4 projection{ 0.0f };	// x, y: projection scale, z, w: near and far planes of the slices
+		glm::vec2 viewportSize{ 0.0f };
+		uint32_t lightCount = 0;
+		float sliceScale = 0.0f;		// CLUSTER_COUNT_Z / log(far / near)
+	};
+
+	LightClusterSystem::LightClusterSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator)
+		: m_context(context),
+		m_descriptorAllocator(std::move(descriptorAllocator))
+	{
+		createDescriptorSetLayout();
+		createPipelineLayout();
+		createPipeline();
+		createFrameResources();
+	}
+
+	LightClusterSystem::~LightClusterSystem() {
+		vkDestroyPipelineLayout(m_context.getDevice(), m_pipelineLayout, nullptr);
+	}
+
+	void LightClusterSystem::createDescriptorSetLayout() {
+		// written by the binning pass, read by the lit fragment shaders
+		const VkShaderStageFlags stages = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		m_setLayout = DescriptorSetLayout::Builder(m_context)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, stages)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, stages)
+			.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, stages)
+			.addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, stages)
+			.build();
+	}
+
+	void LightClusterSystem::createPipelineLayout() {
+		VkDescriptorSetLayout setLayout = m_setLayout->getDescriptorSetLayout();
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &setLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 0;
+		pipelineLayoutInfo.pPushConstantRanges = nullptr;
+
+		if (vkCreatePipelineLayout(m_context.getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create light culling pipeline layout!");
+		}
+	}
+
+	void LightClusterSystem::createPipeline() {
+		ComputePipelineConfigInfo config{};
+		config.shaderFilePath = SPV_SHADERS_PATH + "light_culling.comp.spv";
+		config.pipelineLayout = m_pipelineLayout;
+
+		m_pipeline = m_context.getPipelineCompiler().compile(config);
+	}
+
+	void LightClusterSystem::createFrameResources() {
+		for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+			m_uniformBuffers[i] = createUnique<VulkanBuffer>(
+				m_context,
+				sizeof(ClusterUniforms),
+				1,
+				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+			);
+			m_uniformBuffers[i]->map();
+
+			// the grid has a fixed size, every cluster owns MAX_LIGHTS_PER_CLUSTER index slots
+			m_clusterLightCountBuffers[i] = createUnique<VulkanBuffer>(
+				m_context,
+				sizeof(uint32_t),
+				CLUSTER_COUNT,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			);
+
+			m_clusterLightIndexBuffers[i] = createUnique<VulkanBuffer>(
+				m_context,
+				sizeof(uint32_t),
+				CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			);
+
+			m_descriptorAllocator->allocate(m_setLayout->getDescriptorSetLayout(), m_descriptorSets[i]);
+
+			// start with room for a small scene, buffers grow on demand
+			ensureLightCapacity(i, 64);
+		}
+	}
+
+	void LightClusterSystem::ensureLightCapacity(int frameIndex, uint32_t lightCount) {
+		if (m_lightBuffers[frameIndex] != nullptr && m_lightBuffers[frameIndex]->getInstanceCount() >= lightCount) {
+			return;
+		}
+
+		// the fence of this frame slot has been waited on, its buffer is no longer in use
+		m_lightBuffers[frameIndex] = createUnique<VulkanBuffer>(
+			m_context,
+			sizeof(PointLight),
+			std::bit_ceil(std::max(lightCount, 1u)),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		);
+		m_lightBuffers[frameIndex]->map();
+
+		writeDescriptorSet(frameIndex);
+	}
+
+	void LightClusterSystem::writeDescriptorSet(int frameIndex) {
+		VkDescriptorBufferInfo uniformInfo = m_uniformBuffers[frameIndex]->descriptorInfo();
+		VkDescriptorBufferInfo lightInfo = m_lightBuffers[frameIndex]->descriptorInfo();
+		VkDescriptorBufferInfo countInfo = m_clusterLightCountBuffers[frameIndex]->descriptorInfo();
+		VkDescriptorBufferInfo indexInfo = m_clusterLightIndexBuffers[frameIndex]->descriptorInfo();
+
+		DescriptorWriter(m_context, *m_setLayout)
+			.writeBuffer(0, &uniformInfo)
+			.writeBuffer(1, &lightInfo)
+			.writeBuffer(2, &countInfo)
+			.writeBuffer(3, &indexInfo)
+			.updateSet(m_descriptorSets[frameIndex]);
+	}
+
+	void LightClusterSystem::update(FrameInfo& frameInfo, const std::vector<PointLight>& lights, VkExtent2D viewportExtent) {
+		const int frameIndex = frameInfo.frameIndex;
+
+		m_lightCount = static_cast<uint32_t>(lights.size());
+		ensureLightCapacity(frameIndex, m_lightCount);
+
+		if (!lights.empty()) {
+			m_lightBuffers[frameIndex]->writeToBuffer(
+				const_cast<PointLight*>(lights.data()),
+				lights.size() * sizeof(PointLight)
+			);
+		}
+
+		// the camera projection keeps no planes, recover them from the depth terms
+		// (Camera::setPerspective: [2][2] = f / (f - n), [3][2] = -f * n / (f - n))
+		const glm::mat4& projection = frameInfo.camera.getProjectionMatrix();
+		m_clusterNear = -projection[3][2] / projection[2][2];
+		m_clusterFar = projection[2][2] * m_clusterNear / (projection[2][2] - 1.0f);
+
+		ClusterUniforms uniforms{};
+		uniforms.view = frameInfo.camera.getViewMatrix();
+		uniforms.projection = glm::vec4(projection[0][0], projection[1][1], m_clusterNear, m_clusterFar);
+		uniforms.viewportSize = glm::vec2(viewportExtent.width, viewportExtent.height);
+		uniforms.lightCount = m_lightCount;
+		uniforms.sliceScale = static_cast<float>(CLUSTER_COUNT_Z) / glm::log(m_clusterFar / m_clusterNear);
+
+		m_uniformBuffers[frameIndex]->writeToBuffer(&uniforms);
+	}
+
+	void LightClusterSystem::cull(FrameInfo& frameInfo) {
+		const int frameIndex = frameInfo.frameIndex;
+		VkCommandBuffer commandBuffer = frameInfo.commandBuffer;
+
+		m_pipeline->bind(commandBuffer);
+
+		vkCmdBindDescriptorSets(
+			commandBuffer,
+			VK_PIPELINE_BIND_POINT_COMPUTE,
+			m_pipelineLayout,
+			0,
+			1,
+			&m_descriptorSets[frameIndex],
+			0,
+			nullptr
+		);
+
+		// one invocation per cluster, the lights are streamed through shared memory
+		vkCmdDispatch(commandBuffer, (CLUSTER_COUNT + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+	}
+
+	void LightClusterSystem::updateUi() {
+		ImGui::Text("Point lights: %u", m_lightCount);
+		ImGui::Text("Clusters: %ux%ux%u, up to %u lights each", CLUSTER_COUNT_X, CLUSTER_COUNT_Y, CLUSTER_COUNT_Z,
+			MAX_LIGHTS_PER_CLUSTER);
+		ImGui::Text("Depth slices: %.2f to %.2f", m_clusterNear, m_clusterFar);
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "core/memory.hpp"
+#include "graphics/pipeline.hpp"
+#include "graphics/pipeline_compiler.hpp"
+#include "graphics/swap_chain.hpp"
+#include "graphics/context/context.hpp"
+#include "graphics/frame_info.hpp"
+#include "graphics/resources/vk_buffer.hpp"
+#include "graphics/descriptors/descriptors.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <array>
+#include <vector>
+
+namespace PXTEngine {
+
+	/**
+	 * @class LightClusterSystem
+	 *
+	 * @brief Clustered forward lighting: bins the point lights into a 3D grid of view space clusters
+	 * (froxels) in a compute pass, so that fragments only iterate the lights of their cluster.
+	 *
+	 * The grid splits the screen in CLUSTER_COUNT_X * CLUSTER_COUNT_Y tiles and the view depth in
+	 * CLUSTER_COUNT_Z exponential slices between the camera near and far planes. Every cluster keeps
+	 * up to MAX_LIGHTS_PER_CLUSTER light indices, the lights past it are dropped for that cluster.
+	 * The light range is where the light falls under LIGHT_ATTENUATION_CUTOFF (see point_light.glsl).
+	 *
+	 * The descriptor set (light_clusters.glsl) holds the cluster uniforms, the lights and the cluster
+	 * light lists, bound by the fragment shaders that light with clusters.
+	 */
+	class LightClusterSystem {
+	public:
+		// mirrored in light_clusters.glsl
+		static constexpr uint32_t CLUSTER_COUNT_X = 16;
+		static constexpr uint32_t CLUSTER_COUNT_Y = 9;
+		static constexpr uint32_t CLUSTER_COUNT_Z = 24;
+		static constexpr uint32_t CLUSTER_COUNT = CLUSTER_COUNT_X * CLUSTER_COUNT_Y * CLUSTER_COUNT_Z;
+		static constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 128;
+
+		LightClusterSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator);
+		~LightClusterSystem();
+
+		LightClusterSystem(const LightClusterSystem&) = delete;
+		LightClusterSystem& operator=(const LightClusterSystem&) = delete;
+
+		/**
+		 * @brief Uploads the lights and the cluster uniforms of the frame.
+		 *
+		 * @param frameInfo The frame info, its camera gives the view, the projection and the depth range.
+		 * @param lights Every point light of the scene.
+		 * @param viewportExtent The size of the render target the clusters tile.
+		 */
+		void update(FrameInfo& frameInfo, const std::vector<PointLight>& lights, VkExtent2D viewportExtent);
+
+		/**
+		 * @brief Records the light binning dispatch, must be recorded outside of a render pass.
+		 * The caller orders it after the previous reads of the cluster lists and before the next
+		 * ones (see RenderGraph).
+		 */
+		void cull(FrameInfo& frameInfo);
+
+		DescriptorSetLayout& getDescriptorSetLayout() const { return *m_setLayout; }
+		VkDescriptorSet getDescriptorSet(int frameIndex) const { return m_descriptorSets[frameIndex]; }
+
+		VkBuffer getClusterLightCountBuffer(int frameIndex) const { return m_clusterLightCountBuffers[frameIndex]->getBuffer(); }
+		VkBuffer getClusterLightIndexBuffer(int frameIndex) const { return m_clusterLightIndexBuffers[frameIndex]->getBuffer(); }
+
+		uint32_t getLightCount() const { return m_lightCount; }
+
+		void updateUi();
+
+	private:
+		void createDescriptorSetLayout();
+		void createPipelineLayout();
+		void createPipeline();
+		void createFrameResources();
+		void ensureLightCapacity(int frameIndex, uint32_t lightCount);
+		void writeDescriptorSet(int frameIndex);
+
+		static constexpr uint32_t GROUP_SIZE = 64;
+
+		Context& m_context;
+		Shared<DescriptorAllocatorGrowable> m_descriptorAllocator;
+
+		Unique<DescriptorSetLayout> m_setLayout;
+		std::array<VkDescriptorSet, SwapChain::MAX_FRAMES_IN_FLIGHT> m_descriptorSets{};
+
+		VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+		PendingPipeline m_pipeline;
+
+		std::array<Unique<VulkanBuffer>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_uniformBuffers;
+		std::array<Unique<VulkanBuffer>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_lightBuffers;
+		std::array<Unique<VulkanBuffer>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_clusterLightCountBuffers;
+		std::array<Unique<VulkanBuffer>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_clusterLightIndexBuffers;
+
+		uint32_t m_lightCount = 0;
+		float m_clusterNear = 0.0f;
+		float m_clusterFar = 0.0f;
+	};
+}
@@ -1,5 +1,8 @@
 #include "graphics/render_systems/master_render_system.hpp"
 
+#include <fstream>
+#include <optional>
+
 namespace PXTEngine {
 	MasterRenderSystem::MasterRenderSystem(Context& context, Renderer& renderer, 
 			Shared<DescriptorAllocatorGrowable> descriptorAllocator, 
@@ -14,7 +17,9 @@ namespace PXTEngine {
 		    m_materialRegistry(materialRegistry),
 			m_blasRegistry(blasRegistry),
 			m_globalSetLayout(std::move(globalSetLayout)),
-			m_environment(std::move(environment))
+			m_environment(std::move(environment)),
+			m_frustumCuller(context.getJobSystem()),
+			m_occlusionCuller(context.getJobSystem())
 	{
 		m_offscreenColorFormat = m_context.findSupportedFormat(
 			{ VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_R8G8B8A8_UNORM },
@@ -30,6 +35,8 @@ namespace PXTEngine {
 			throw std::runtime_error("Failed to find a suitable offscreen color format for MasterRenderSystem's render target!");
 		}
 
+		m_isDeferredSupported = m_offscreenColorFormat == VK_FORMAT_R16G16B16A16_SFLOAT;
+
 		// to handle viewport resizing
 		VkExtent2D swapChainExtent = m_renderer.getSwapChainExtent();
 		m_lastFrameSwapChainExtent = swapChainExtent;
@@ -43,21 +50,32 @@ namespace PXTEngine {
 		createDescriptorSetsImGui();
 	}
 
-	MasterRenderSystem::~MasterRenderSystem() {};
+	MasterRenderSystem::~MasterRenderSystem() {
+		// the render systems destroy their pipeline layouts before their pending pipelines,
+		// a pipeline never recorded with may still be compiling
+		m_context.getPipelineCompiler().waitIdle();
+	};
 
 	void MasterRenderSystem::recreateViewportResources() {
-		// wait for the device to be idle
-		vkDeviceWaitIdle(m_context.getDevice());
-
-		// destroy old resources: FrameBuffer will be destroyed by reassigning the unique_ptr
-
-		VkExtent2D swapChainExtent = m_renderer.getSwapChainExtent();
+		// the frames in flight still render into the old resources, they are destroyed once
+		// those frames retired instead of waiting for the device
+		DeletionQueue& deletionQueue = m_context.getDeletionQueue();
+		deletionQueue.push(std::move(m_offscreenFb));
+		deletionQueue.push(m_sceneImage);
+		deletionQueue.push(m_offscreenDepthImage);
 
 		createSceneImage();
 		createOffscreenDepthResources();
 		createOffscreenFrameBuffer();
 
-		updateImguiDescriptorSet();
+		if (m_gpuCullingSystem) {
+			m_gpuCullingSystem->updateDepthImage(m_offscreenDepthImage);
+		}
+
+		m_deferredRenderSystem->updateViewportResources(m_sceneImage, m_offscreenDepthImage);
+
+		// rewritten by onUpdate when their frame slot comes back
+		m_isSceneDescriptorSetOutdated.fill(true);
 	}
 
 	void MasterRenderSystem::createRenderPass() {
@@ -68,7 +86,8 @@ namespace PXTEngine {
 		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		// the render graph transitions the attachments before and after the pass
+		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
 		VkAttachmentReference depthAttachmentRef{};
@@ -82,8 +101,8 @@ namespace PXTEngine {
 		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
 		VkAttachmentReference colorAttachmentRef = {};
 		colorAttachmentRef.attachment = 0;
@@ -95,26 +114,7 @@ namespace PXTEngine {
 		subpass.pColorAttachments = &colorAttachmentRef;
 		subpass.pDepthStencilAttachment = &depthAttachmentRef;
 
-		VkSubpassDependency dependency = {};
-		dependency.dstSubpass = 0;
-		dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependency.srcAccessMask = 0;
-		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-
-		// A second dependency for the transition to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-		// This ensures that when the render pass finishes, the image is ready for sampling.
-		VkSubpassDependency readDependency{};
-		readDependency.srcSubpass = 0;
-		readDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
-		readDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		readDependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT; // Read in fragment shader
-		readDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		readDependency.dstAccessMask = VK_ACCESS_SHADER_READ_BIT; // Read by shader
-
 		std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
-		std::array<VkSubpassDependency, 2> dependencies = { dependency, readDependency };
 
 		VkRenderPassCreateInfo renderPassInfo = {};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -122,8 +122,8 @@ namespace PXTEngine {
 		renderPassInfo.pAttachments = attachments.data();
 		renderPassInfo.subpassCount = 1;
 		renderPassInfo.pSubpasses = &subpass;
-		renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
-		renderPassInfo.pDependencies = dependencies.data();
+		renderPassInfo.dependencyCount = 0;
+		renderPassInfo.pDependencies = nullptr;
 
 		m_offscreenRenderPass = createUnique<RenderPass>(
 			m_context,
@@ -132,6 +132,19 @@ namespace PXTEngine {
 			depthAttachment,
 			"MasterRenderSystem Offscreen Render Pass"
 		);
+
+		// deferred path: the G-buffer pass wrote the depth and the lighting pass the color,
+		// the skybox and the billboards are drawn over them. Compatible with the same framebuffer.
+		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		attachments = { colorAttachment, depthAttachment };
+
+		m_deferredOffscreenRenderPass = createUnique<RenderPass>(
+			m_context,
+			renderPassInfo,
+			colorAttachment,
+			depthAttachment,
+			"MasterRenderSystem Deferred Offscreen Render Pass"
+		);
 	}
 
 	void MasterRenderSystem::createSceneImage() {
@@ -154,19 +167,13 @@ namespace PXTEngine {
 		sceneImageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 		sceneImageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+		// left in the undefined layout, the render graph transitions it at its first use
 		m_sceneImage = createShared<VulkanImage>(
 			m_context,
 			sceneImageInfo,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
 		);
 
-		// transition once to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL layout
-		m_sceneImage->transitionImageLayoutSingleTimeCmd(
-			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
-		);
-
 		VkImageViewCreateInfo colorViewInfo{};
 		colorViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 		colorViewInfo.image = m_sceneImage->getVkImage();
@@ -222,7 +229,8 @@ namespace PXTEngine {
 		imageInfo.format = depthFormat;
 		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
 		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+		imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+						  VK_IMAGE_USAGE_SAMPLED_BIT; // read to build the depth pyramid of GPU culling
 		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
@@ -270,6 +278,10 @@ namespace PXTEngine {
 	}
 
 	void MasterRenderSystem::createRenderSystems() {
+		m_gpuProfiler = createUnique<GpuProfiler>(m_context);
+		m_commandRecorder = createUnique<ParallelCommandRecorder>(m_context);
+		m_renderGraph = createUnique<RenderGraph>(m_context);
+
 		m_pointLightSystem = createUnique<PointLightSystem>(
 			m_context,
 			m_offscreenRenderPass->getHandle(),
@@ -282,21 +294,41 @@ namespace PXTEngine {
 			*m_globalSetLayout
 		);
 
+		m_lightClusterSystem = createUnique<LightClusterSystem>(
+			m_context,
+			m_descriptorAllocator
+		);
+
+		m_deferredRenderSystem = createUnique<DeferredRenderSystem>(
+			m_context,
+			m_descriptorAllocator,
+			*m_globalSetLayout,
+			*m_lightClusterSystem,
+			m_shadowMapRenderSystem->getShadowMapImageInfo(),
+			m_sceneImage,
+			m_offscreenDepthImage
+		);
+
 		m_materialRenderSystem = createUnique<MaterialRenderSystem>(
 			m_context,
 			m_descriptorAllocator,
 			m_textureRegistry,
+			m_materialRegistry,
 			*m_globalSetLayout,
 			m_offscreenRenderPass->getHandle(),
-			m_shadowMapRenderSystem->getShadowMapImageInfo()
+			m_deferredRenderSystem->getGBufferRenderPass().getHandle(),
+			m_shadowMapRenderSystem->getShadowMapImageInfo(),
+			*m_lightClusterSystem
 		);
 
 		m_debugRenderSystem = createUnique<DebugRenderSystem>(
 			m_context,
 			m_descriptorAllocator,
 			m_textureRegistry,
+			m_materialRegistry,
 			m_offscreenRenderPass->getHandle(),
-			*m_globalSetLayout
+			*m_globalSetLayout,
+			*m_lightClusterSystem
 		);
 
 		m_uiRenderSystem = createUnique<UiRenderSystem>(
@@ -321,6 +353,14 @@ namespace PXTEngine {
 			*m_globalSetLayout,
 			m_sceneImage
 		);
+
+		if (m_context.isDrawIndirectCountSupported()) {
+			m_gpuCullingSystem = createUnique<GpuCullingSystem>(
+				m_context,
+				m_descriptorAllocator,
+				m_offscreenDepthImage
+			);
+		}
 	}
 
 	void MasterRenderSystem::onUpdate(FrameInfo& frameInfo, GlobalUbo& ubo) {
@@ -334,6 +374,11 @@ namespace PXTEngine {
 			m_rayTracingRenderSystem->updateSceneImage(m_sceneImage);
 			m_lastFrameSwapChainExtent = swapChainExtent;
 		}
+
+		// the previous use of this frame slot has completed, its viewport set can be rewritten
+		if (m_isSceneDescriptorSetOutdated[frameInfo.frameIndex]) {
+			updateImguiDescriptorSet(frameInfo.frameIndex);
+		}
 		
 		// update ubo buffer
 		ubo.projection = frameInfo.camera.getProjectionMatrix();
@@ -343,8 +388,37 @@ namespace PXTEngine {
 		// update light values into ubo
 		m_pointLightSystem->update(frameInfo, ubo);
 
-		// update shadow map
-		m_shadowMapRenderSystem->update(frameInfo, ubo);
+		// cull the renderables for the raster passes
+		m_frustumCuller.gather(frameInfo.scene);
+		const glm::mat4 viewProjection = ubo.projection * ubo.view;
+		const Frustum cameraFrustum = Frustum::fromMatrix(viewProjection);
+		m_cameraCullingStats = m_frustumCuller.cull(cameraFrustum, m_cameraVisibleEntities);
+
+		// CPU occlusion culling of the camera list, no GPU readback involved
+		if (m_isSoftwareOcclusionEnabled && !m_isRaytracingEnabled) {
+			m_occlusionCuller.render(frameInfo.scene, viewProjection);
+			m_cameraOcclusionStats = m_occlusionCuller.cull(frameInfo.scene, m_cameraVisibleEntities);
+		}
+
+		// GPU culling takes every renderable, the compute pass does its own frustum test
+		if (!m_isRaytracingEnabled && !m_isDebugEnabled) {
+			if (isGpuCullingActive()) {
+				m_materialRenderSystem->prepare(frameInfo, m_frustumCuller.getRenderables());
+				m_gpuCullingSystem->update(frameInfo, viewProjection,
+					m_materialRenderSystem->getCullInstances(), m_materialRenderSystem->getBatchCount());
+			} else {
+				m_materialRenderSystem->prepare(frameInfo, m_cameraVisibleEntities);
+			}
+		}
+
+		// update shadow map, it writes the shadow slot of every light
+		std::vector<PointLight>& lights = m_pointLightSystem->getLights();
+		m_shadowMapRenderSystem->update(frameInfo, ubo, lights, m_frustumCuller, cameraFrustum);
+
+		// upload every light for the clustered shading of the raster passes
+		if (!m_isRaytracingEnabled) {
+			m_lightClusterSystem->update(frameInfo, lights, swapChainExtent);
+		}
 
 		// update raytracing scene
 		if (m_isRaytracingEnabled) {
@@ -364,55 +438,286 @@ namespace PXTEngine {
 		// begin new frame imgui
 		m_uiRenderSystem->beginBuildingUi();
 
-		// render to offscreen main render pass
-		if (m_isRaytracingEnabled) {
-			m_rayTracingRenderSystem->render(frameInfo, m_renderer);
-			// this transitions the scene image back to shader_read_only_optimal for the next
-			// renderpass (for now only point light billboards)
-			m_rayTracingRenderSystem->transitionImageToShaderReadOnlyOptimal(frameInfo);
+		m_gpuProfiler->beginFrame(frameInfo.commandBuffer, frameInfo.frameIndex);
 
-			//begin offscreen render pass for point light billboards
-			/*m_renderer.beginRenderPass(frameInfo.commandBuffer, m_offscreenRenderPass->getVkRenderPass(),
-				m_offscreenFb, m_renderer.getSwapChainExtent());
+		// the material pass is the only consumer of the GPU culling
+		const bool isGpuCullingUsed = !m_isRaytracingEnabled && !m_isDebugEnabled && isGpuCullingActive();
 
-			//m_pointLightSystem->render(frameInfo);
+		// a pass recorded in parallel is made of secondary buffers only: everything in it goes
+		// through the recorder and no timestamp can be written inside it
+		m_commandRecorder->beginFrame(frameInfo.frameIndex);
+		ParallelCommandRecorder* recorder = m_isParallelRecordingEnabled ? m_commandRecorder.get() : nullptr;
+		const VkSubpassContents subpassContents = recorder
+			? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+			: VK_SUBPASS_CONTENTS_INLINE;
 
-			m_renderer.endRenderPass(frameInfo.commandBuffer);*/
+		// records a small part of a pass inline, or in a single secondary buffer
+		auto recordInPass = [&](const ParallelCommandRecorder::PassInfo& passInfo,
+			const std::function<void(FrameInfo&)>& recordFunction) {
+			if (recorder) {
+				recorder->record(frameInfo, passInfo, recordFunction);
+			} else {
+				recordFunction(frameInfo);
+			}
+		};
+
+		// a subpass recorded in secondary buffers only takes vkCmdExecuteCommands from the primary one,
+		// the timestamps of the profiler scopes inside it are recorded in a secondary buffer of their own
+		auto beginScopeInPass = [&](const ParallelCommandRecorder::PassInfo& passInfo, const std::string& name) {
+			recordInPass(passInfo, [&](FrameInfo& recordFrameInfo) {
+				m_gpuProfiler->beginScope(recordFrameInfo.commandBuffer, name);
+			});
+		};
+
+		auto endScopeInPass = [&](const ParallelCommandRecorder::PassInfo& passInfo) {
+			recordInPass(passInfo, [&](FrameInfo& recordFrameInfo) {
+				m_gpuProfiler->endScope(recordFrameInfo.commandBuffer);
+			});
+		};
+
+		// draws the prepared materials, GPU culled or not, split over the recording threads
+		auto renderMaterials = [&](MaterialRenderSystem::MaterialPass pass, const ParallelCommandRecorder::PassInfo& passInfo) {
+			m_materialRenderSystem->preparePass(pass, isGpuCullingUsed);
+
+			auto recordDraws = [&](FrameInfo& drawFrameInfo, uint32_t begin, uint32_t end) {
+				if (isGpuCullingUsed) {
+					m_materialRenderSystem->renderIndirect(drawFrameInfo,
+						m_gpuCullingSystem->getDrawCommandBuffer(drawFrameInfo.frameIndex),
+						m_gpuCullingSystem->getDrawCountBuffer(drawFrameInfo.frameIndex),
+						pass, begin, end);
+				} else {
+					m_materialRenderSystem->render(drawFrameInfo, pass, begin, end);
+				}
+			};
+
+			const uint32_t drawCount = m_materialRenderSystem->getDrawCount(isGpuCullingUsed);
+			if (recorder) {
+				recorder->record(frameInfo, passInfo, drawCount, ParallelCommandRecorder::DEFAULT_MIN_CHUNK_SIZE, recordDraws);
+			} else {
+				recordDraws(frameInfo, 0, drawCount);
+			}
+		};
+
+		// the passes declare what they read and write, the graph orders the barriers between them;
+		// the execute functions are recorded by execute at the end of this function
+		m_renderGraph->reset();
+
+		const RenderGraph::ImageHandle sceneImage = m_renderGraph->importImage("Scene Color", m_sceneImage,
+			VK_IMAGE_ASPECT_COLOR_BIT);
+		m_renderGraph->markOutput(sceneImage);
+
+		// the ui window shows the scene and the shadow faces, it is the last pass of every frame
+		auto addUiPass = [&](std::optional<RenderGraph::ImageHandle> shadowMap) {
+			m_renderGraph->addPass("UI", [&](RenderGraph::PassBuilder& builder) {
+				builder.read(sceneImage, RenderGraph::ImageUsage::SampledFragment);
+				if (shadowMap) {
+					builder.read(*shadowMap, RenderGraph::ImageUsage::SampledFragment);
+				}
+				builder.setSideEffect();
+			}, [&](FrameInfo& passFrameInfo) {
+				// update scene ui
+				this->updateUi();
+
+				// render imgui and present
+				m_renderer.beginSwapChainRenderPass(passFrameInfo.commandBuffer);
+
+				// render ui and end imgui frame
+				m_uiRenderSystem->render(passFrameInfo);
+
+				m_renderer.endSwapChainRenderPass(passFrameInfo.commandBuffer);
+			});
+		};
+
+		if (m_isRaytracingEnabled) {
+			// accumulation reads the previous frame
+			m_renderGraph->addPass("Ray Tracing", [&](RenderGraph::PassBuilder& builder) {
+				builder.read(sceneImage, RenderGraph::ImageUsage::StorageRayTracing);
+				builder.write(sceneImage, RenderGraph::ImageUsage::StorageRayTracing);
+			}, [&](FrameInfo& passFrameInfo) {
+				m_rayTracingRenderSystem->render(passFrameInfo, m_renderer);
+			});
+
+			addUiPass(std::nullopt);
 		} else {
-			// render shadow cube map
-			// the render function of the shadow map render system will
-			// do how many passes it needs to do (6 in this case - 1 point light)
-			m_shadowMapRenderSystem->render(frameInfo, m_renderer);
+			const bool isDeferred = isDeferredActive();
+			const bool isDepthPrepassUsed = isDepthPrepassActive();
+
+			const RenderGraph::ImageHandle depthImage = m_renderGraph->importImage("Depth", m_offscreenDepthImage,
+				RenderGraph::getAspectFlags(m_context.findDepthFormat()));
+			const RenderGraph::ImageHandle shadowMap = m_renderGraph->importImage("Shadow Cube Array",
+				m_shadowMapRenderSystem->getShadowMapImage(), VK_IMAGE_ASPECT_DEPTH_BIT,
+				m_shadowMapRenderSystem->getShadowMapLayerCount());
+
+			const RenderGraph::BufferHandle clusterLightCounts = m_renderGraph->importBuffer("Cluster Light Counts",
+				m_lightClusterSystem->getClusterLightCountBuffer(frameInfo.frameIndex));
+			const RenderGraph::BufferHandle clusterLightIndices = m_renderGraph->importBuffer("Cluster Light Indices",
+				m_lightClusterSystem->getClusterLightIndexBuffer(frameInfo.frameIndex));
+
+			RenderGraph::BufferHandle drawCommands;
+			RenderGraph::BufferHandle drawCounts;
+			if (isGpuCullingUsed) {
+				drawCommands = m_renderGraph->importBuffer("Draw Commands",
+					m_gpuCullingSystem->getDrawCommandBuffer(frameInfo.frameIndex));
+				drawCounts = m_renderGraph->importBuffer("Draw Counts",
+					m_gpuCullingSystem->getDrawCountBuffer(frameInfo.frameIndex));
+
+				// cull the material draws against the frustum and the previous frame depth
+				m_renderGraph->addPass("GPU Culling", [&](RenderGraph::PassBuilder& builder) {
+					builder.write(drawCommands, RenderGraph::BufferUsage::StorageCompute);
+					builder.write(drawCounts, RenderGraph::BufferUsage::TransferDst);
+					builder.write(drawCounts, RenderGraph::BufferUsage::StorageCompute);
+				}, [&](FrameInfo& passFrameInfo) {
+					m_gpuCullingSystem->cull(passFrameInfo);
+				});
+			}
 
-			//begin offscreen render pass
-			m_renderer.beginRenderPass(frameInfo.commandBuffer, *m_offscreenRenderPass,
-				*m_offscreenFb, m_renderer.getSwapChainExtent());
+			auto readDrawBuffers = [&](RenderGraph::PassBuilder& builder) {
+				if (isGpuCullingUsed) {
+					builder.read(drawCommands, RenderGraph::BufferUsage::IndirectRead);
+					builder.read(drawCounts, RenderGraph::BufferUsage::IndirectRead);
+				}
+			};
+
+			// render the shadow cube map faces scheduled this frame, in a single layered pass;
+			// it loads the array, the faces not rendered keep their content
+			if (m_shadowMapRenderSystem->isShadowMapDirty()) {
+				m_renderGraph->addPass("Shadow Maps", [&](RenderGraph::PassBuilder& builder) {
+					builder.read(shadowMap, RenderGraph::ImageUsage::DepthAttachment);
+					builder.write(shadowMap, RenderGraph::ImageUsage::DepthAttachment);
+				}, [&](FrameInfo& passFrameInfo) {
+					m_shadowMapRenderSystem->render(passFrameInfo, m_renderer, recorder);
+				});
+			}
 
-			m_skyboxRenderSystem->render(frameInfo);
+			// bin the lights into the clusters read by the material, debug and deferred lighting passes
+			m_renderGraph->addPass("Light Clusters", [&](RenderGraph::PassBuilder& builder) {
+				builder.write(clusterLightCounts, RenderGraph::BufferUsage::StorageCompute);
+				builder.write(clusterLightIndices, RenderGraph::BufferUsage::StorageCompute);
+			}, [&](FrameInfo& passFrameInfo) {
+				m_lightClusterSystem->cull(passFrameInfo);
+			});
+
+			if (isDeferred) {
+				// the G-buffer only lives between the geometry and the lighting passes
+				const RenderGraph::ImageHandle gBuffer = m_renderGraph->createImage("G-Buffer",
+					m_deferredRenderSystem->getGBufferDesc());
+
+				// geometry pass into the G-buffer, then one lighting dispatch over the covered pixels
+				m_renderGraph->addPass("G-Buffer", [&](RenderGraph::PassBuilder& builder) {
+					builder.write(gBuffer, RenderGraph::ImageUsage::ColorAttachment);
+					builder.write(depthImage, RenderGraph::ImageUsage::DepthAttachment);
+					readDrawBuffers(builder);
+				}, [&](FrameInfo& passFrameInfo) {
+					m_deferredRenderSystem->setGBufferImage(m_renderGraph->getImage(gBuffer));
+
+					RenderPass& gBufferRenderPass = m_deferredRenderSystem->getGBufferRenderPass();
+					FrameBuffer& gBufferFrameBuffer = m_deferredRenderSystem->getGBufferFrameBuffer();
+
+					m_renderer.beginRenderPass(passFrameInfo.commandBuffer, gBufferRenderPass, gBufferFrameBuffer,
+						m_renderer.getSwapChainExtent(), subpassContents);
+
+					renderMaterials(MaterialRenderSystem::MaterialPass::GBuffer,
+						{ gBufferRenderPass.getHandle(), gBufferFrameBuffer.getHandle(), m_renderer.getSwapChainExtent() });
+
+					m_renderer.endRenderPass(passFrameInfo.commandBuffer, gBufferRenderPass, gBufferFrameBuffer);
+				});
+
+				m_renderGraph->addPass("Deferred Lighting", [&](RenderGraph::PassBuilder& builder) {
+					builder.read(gBuffer, RenderGraph::ImageUsage::SampledCompute);
+					builder.read(depthImage, RenderGraph::ImageUsage::SampledCompute);
+					builder.read(shadowMap, RenderGraph::ImageUsage::SampledCompute);
+					builder.read(clusterLightCounts, RenderGraph::BufferUsage::StorageCompute);
+					builder.read(clusterLightIndices, RenderGraph::BufferUsage::StorageCompute);
+					builder.write(sceneImage, RenderGraph::ImageUsage::StorageCompute);
+				}, [&](FrameInfo& passFrameInfo) {
+					m_deferredRenderSystem->renderLighting(passFrameInfo);
+				});
+			}
 
-			// choose if debug or not
+			// sorted on this thread, the recording threads only read the draws
 			if (m_isDebugEnabled) {
-				m_debugRenderSystem->render(frameInfo);
-			}
-			else {
-				m_materialRenderSystem->render(frameInfo);
+				m_debugRenderSystem->prepare(frameInfo, m_cameraVisibleEntities);
 			}
 
-			m_pointLightSystem->render(frameInfo);
+			// the offscreen pass loads the color, and in the deferred path the depth of the G-buffer pass
+			m_renderGraph->addPass("Offscreen Pass", [&](RenderGraph::PassBuilder& builder) {
+				builder.read(sceneImage, RenderGraph::ImageUsage::ColorAttachment);
+				builder.write(sceneImage, RenderGraph::ImageUsage::ColorAttachment);
+				if (isDeferred) {
+					builder.read(depthImage, RenderGraph::ImageUsage::DepthAttachment);
+				}
+				builder.write(depthImage, RenderGraph::ImageUsage::DepthAttachment);
+				builder.read(shadowMap, RenderGraph::ImageUsage::SampledFragment);
+				builder.read(clusterLightCounts, RenderGraph::BufferUsage::StorageGraphics);
+				builder.read(clusterLightIndices, RenderGraph::BufferUsage::StorageGraphics);
+				readDrawBuffers(builder);
+			}, [&](FrameInfo& passFrameInfo) {
+				RenderPass& offscreenRenderPass = isDeferred ? *m_deferredOffscreenRenderPass : *m_offscreenRenderPass;
+				const ParallelCommandRecorder::PassInfo offscreenPassInfo{
+					offscreenRenderPass.getHandle(), m_offscreenFb->getHandle(), m_renderer.getSwapChainExtent()
+				};
+
+				m_renderer.beginRenderPass(passFrameInfo.commandBuffer, offscreenRenderPass, *m_offscreenFb,
+					m_renderer.getSwapChainExtent(), subpassContents);
+
+				// the final depth first: the skybox and the materials are then only shaded where visible
+				if (isDepthPrepassUsed) {
+					beginScopeInPass(offscreenPassInfo, "Depth Prepass");
+					renderMaterials(MaterialRenderSystem::MaterialPass::DepthPrepass, offscreenPassInfo);
+					endScopeInPass(offscreenPassInfo);
+				}
+
+				recordInPass(offscreenPassInfo, [&](FrameInfo& recordFrameInfo) {
+					m_skyboxRenderSystem->render(recordFrameInfo);
+				});
+
+				// choose if debug or not, the deferred path already shaded the materials
+				beginScopeInPass(offscreenPassInfo, "Materials");
+				if (m_isDebugEnabled) {
+					if (recorder) {
+						recorder->record(passFrameInfo, offscreenPassInfo, m_debugRenderSystem->getDrawCount(),
+							ParallelCommandRecorder::DEFAULT_MIN_CHUNK_SIZE,
+							[&](FrameInfo& drawFrameInfo, uint32_t begin, uint32_t end) {
+								m_debugRenderSystem->render(drawFrameInfo, begin, end);
+							});
+					} else {
+						m_debugRenderSystem->render(passFrameInfo);
+					}
+				}
+				else if (!isDeferred) {
+					renderMaterials(isDepthPrepassUsed
+						? MaterialRenderSystem::MaterialPass::ForwardDepthEqual
+						: MaterialRenderSystem::MaterialPass::Forward,
+						offscreenPassInfo);
+				}
+				endScopeInPass(offscreenPassInfo);
+
+				recordInPass(offscreenPassInfo, [&](FrameInfo& recordFrameInfo) {
+					m_pointLightSystem->render(recordFrameInfo);
+				});
+
+				m_renderer.endRenderPass(passFrameInfo.commandBuffer, offscreenRenderPass, *m_offscreenFb);
+			});
+
+			// the depth of this frame is the occluder of the next one
+			if (isGpuCullingUsed) {
+				m_renderGraph->addPass("Depth Pyramid", [&](RenderGraph::PassBuilder& builder) {
+					builder.read(depthImage, RenderGraph::ImageUsage::SampledCompute);
+					builder.setSideEffect();
+				}, [&](FrameInfo& passFrameInfo) {
+					m_gpuCullingSystem->buildDepthPyramid(passFrameInfo);
+				});
+			}
 
-			m_renderer.endRenderPass(frameInfo.commandBuffer, *m_offscreenRenderPass, *m_offscreenFb);
+			addUiPass(shadowMap);
 		}
 
-		// update scene ui
-		this->updateUi();
-
-		// render imgui and present
-		m_renderer.beginSwapChainRenderPass(frameInfo.commandBuffer);
-
-		// render ui and end imgui frame
-		m_uiRenderSystem->render(frameInfo);
+		if (m_gpuCullingSystem && !isGpuCullingUsed) {
+			m_gpuCullingSystem->invalidateDepthPyramid();
+		}
 
-		m_renderer.endSwapChainRenderPass(frameInfo.commandBuffer);
+		m_renderGraph->compile();
+		m_renderGraph->execute(frameInfo, m_gpuProfiler.get());
 	}
 
 	void MasterRenderSystem::createDescriptorSetsImGui() {
@@ -421,19 +726,14 @@ namespace PXTEngine {
 			.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 1)
 			.build();
 
-		VkDescriptorImageInfo imageInfo;
-		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		imageInfo.imageView = m_sceneImage->getImageView();
-		imageInfo.sampler = m_sceneImage->getImageSampler();
-
-		m_descriptorAllocator->allocate(m_sceneDescriptorSetLayout->getDescriptorSetLayout(), m_sceneDescriptorSet);
-
-		DescriptorWriter(m_context, *m_sceneDescriptorSetLayout)
-			.writeImage(0, &imageInfo)
-			.updateSet(m_sceneDescriptorSet);
+		// one per frame slot, written by onUpdate
+		for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+			m_descriptorAllocator->allocate(m_sceneDescriptorSetLayout->getDescriptorSetLayout(), m_sceneDescriptorSets[i]);
+		}
+		m_isSceneDescriptorSetOutdated.fill(true);
 	}
 
-	void MasterRenderSystem::updateImguiDescriptorSet() {
+	void MasterRenderSystem::updateImguiDescriptorSet(int frameIndex) {
 		VkDescriptorImageInfo imageInfo;
 		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		imageInfo.imageView = m_sceneImage->getImageView();
@@ -441,7 +741,9 @@ namespace PXTEngine {
 
 		DescriptorWriter(m_context, *m_sceneDescriptorSetLayout)
 			.writeImage(0, &imageInfo)
-			.updateSet(m_sceneDescriptorSet);
+			.updateSet(m_sceneDescriptorSets[frameIndex]);
+
+		m_isSceneDescriptorSetOutdated[frameIndex] = false;
 	}
 
 	ImVec2 MasterRenderSystem::getImageSizeWithAspectRatioForImGuiWindow(
@@ -467,7 +769,7 @@ namespace PXTEngine {
 	}
 
 	void MasterRenderSystem::updateSceneUi() {
-		ImTextureID scene = (ImTextureID) m_sceneDescriptorSet;
+		ImTextureID scene = (ImTextureID) m_sceneDescriptorSets[m_renderer.getFrameIndex()];
 
 		// we push a style var to remove the viewpoer window padding
 		ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
@@ -501,6 +803,26 @@ namespace PXTEngine {
 		
 		ImGui::End();
 
+		ImGui::Begin("Raster Renderer");
+		ImGui::BeginDisabled(!m_isDeferredSupported);
+		ImGui::Checkbox("Deferred Shading", &m_isDeferredEnabled);
+		ImGui::EndDisabled();
+		if (!m_isDeferredSupported) {
+			ImGui::Text("Deferred shading needs an rgba16f storage scene image");
+		}
+		ImGui::Text(isDeferredActive() ? "G-buffer and compute lighting pass" : "Forward shading");
+		ImGui::Checkbox("Depth Prepass", &m_isDepthPrepassEnabled);
+		if (m_isDepthPrepassEnabled && isDeferredActive()) {
+			ImGui::Text("The depth prepass only applies to forward shading");
+		}
+		ImGui::Checkbox("Parallel Command Recording", &m_isParallelRecordingEnabled);
+		if (m_isParallelRecordingEnabled) {
+			ImGui::Text("%u recording threads, %u secondary buffers", m_commandRecorder->getThreadCount(),
+				m_commandRecorder->getSecondaryBufferCount());
+			ImGui::Text("The passes recorded in parallel have no nested profiler scopes");
+		}
+		ImGui::End();
+
 		ImGui::Begin("Debug Renderer");
 		ImGui::Checkbox("Enable Debug", &m_isDebugEnabled);
 
@@ -513,8 +835,89 @@ namespace PXTEngine {
 		ImGui::End();
 	}
 
+	void MasterRenderSystem::updateStatsUi() {
+		ImGui::Begin("Render Stats");
+
+		ImGui::Text("Renderables: %u", m_frustumCuller.getRenderableCount());
+		ImGui::Text("Material batches: %u, pipelines: %u", m_materialRenderSystem->getBatchCount(),
+			m_materialRenderSystem->getPipelineCount());
+
+		if (m_isRaytracingEnabled) {
+			ImGui::Text("Frustum culling is only used by the raster passes");
+		} else {
+			const FrustumCuller::Stats shadowStats = m_shadowMapRenderSystem->getCullingStats();
+
+			ImGui::Separator();
+			ImGui::Text("Frustum Culling");
+			ImGui::Text("Camera: %u visible, %u culled", m_cameraCullingStats.visible, m_cameraCullingStats.culled);
+			ImGui::Text("Shadow (rendered faces): %u visible, %u culled", shadowStats.visible, shadowStats.culled);
+
+			// binds issued by the render queues last frame, all the passes of a system add up
+			auto queueStatsText = [](const char* name, const RenderQueue::Stats& stats) {
+				ImGui::Text("%s: %u draws, %u pipeline binds, %u mesh binds", name, stats.draws, stats.pipelineBinds,
+					stats.meshBinds);
+			};
+
+			ImGui::Separator();
+			ImGui::Text("Render Queues");
+			if (m_isDebugEnabled) {
+				queueStatsText("Debug", m_debugRenderSystem->getQueueStats());
+			} else {
+				queueStatsText("Materials", m_materialRenderSystem->getQueueStats());
+			}
+			queueStatsText("Shadows", m_shadowMapRenderSystem->getQueueStats());
+
+			ImGui::Separator();
+			ImGui::Checkbox("Software Occlusion Culling", &m_isSoftwareOcclusionEnabled);
+			if (m_isSoftwareOcclusionEnabled) {
+				if (isGpuCullingActive()) {
+					ImGui::Text("Only the debug pass uses it while GPU culling is on");
+				}
+				ImGui::Text("Occluders: %u (%u triangles)", m_cameraOcclusionStats.occluders, m_cameraOcclusionStats.triangles);
+				ImGui::Text("Camera: %u visible, %u occluded", m_cameraOcclusionStats.visible, m_cameraOcclusionStats.occluded);
+			}
+
+			ImGui::Separator();
+			ImGui::Text("Light Clusters");
+			m_lightClusterSystem->updateUi();
+
+			ImGui::Separator();
+			if (m_gpuCullingSystem) {
+				ImGui::Checkbox("GPU Culling", &m_isGpuCullingEnabled);
+				if (m_isGpuCullingEnabled) {
+					m_gpuCullingSystem->updateUi();
+				}
+			} else {
+				ImGui::Text("GPU culling is not supported by the device");
+			}
+		}
+
+		// the graph of this frame, it is being recorded
+		const RenderGraph::Stats& graphStats = m_renderGraph->getStats();
+
+		ImGui::Separator();
+		ImGui::Text("Render Graph");
+		ImGui::Text("Passes: %u, culled: %u", graphStats.passCount, graphStats.culledPassCount);
+		ImGui::Text("Barriers: %u image, %u buffer in %u batches", graphStats.imageBarrierCount,
+			graphStats.bufferBarrierCount, graphStats.barrierBatchCount);
+		ImGui::Text("Transient memory: %.2f MB (%.2f MB without aliasing)",
+			graphStats.transientMemory / (1024.0f * 1024.0f), graphStats.unaliasedTransientMemory / (1024.0f * 1024.0f));
+		if (ImGui::Button("Export Render Graph")) {
+			std::ofstream file{ RENDER_GRAPH_EXPORT_PATH, std::ios::trunc };
+			file << m_renderGraph->exportGraphviz();
+		}
+		ImGui::SameLine();
+		ImGui::Text("to %s", RENDER_GRAPH_EXPORT_PATH);
+		ImGui::Text("Deferred deletions: %zu", m_context.getDeletionQueue().size());
+		ImGui::Text("Samplers: %zu", m_context.getSamplerCache().size());
+
+		ImGui::End();
+	}
+
 	void MasterRenderSystem::updateUi() {
 		updateSceneUi();
+		updateStatsUi();
+		m_gpuProfiler->updateUi();
 
 		if (!m_isRaytracingEnabled) {
 			m_shadowMapRenderSystem->updateUi();
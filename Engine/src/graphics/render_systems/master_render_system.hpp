@@ -16,16 +16,26 @@
 #include "graphics/render_systems/debug_render_system.hpp"
 #include "graphics/render_systems/skybox_render_system.hpp"
 #include "graphics/render_systems/raytracing_render_system.hpp"
+#include "graphics/render_systems/gpu_culling_system.hpp"
+#include "graphics/render_systems/light_cluster_system.hpp"
+#include "graphics/render_systems/deferred_render_system.hpp"
 #include "graphics/render_pass.hpp"
+#include "graphics/render_graph.hpp"
+#include "graphics/gpu_profiler.hpp"
+#include "graphics/parallel_command_recorder.hpp"
 #include "graphics/frame_buffer.hpp"
 
 #include "scene/environment.hpp"
+#include "scene/frustum_culler.hpp"
+#include "scene/occlusion_culler.hpp"
 
 
 namespace PXTEngine {
 
 	class MasterRenderSystem {
 	public:
+		static constexpr const char* RENDER_GRAPH_EXPORT_PATH = "render_graph.dot";
+
 		MasterRenderSystem(Context& context, Renderer& renderer, 
 						   Shared<DescriptorAllocatorGrowable> descriptorAllocator,
 						   TextureRegistry& textureRegistry,
@@ -53,12 +63,17 @@ namespace PXTEngine {
 		void createRenderSystems();
 
 		void createDescriptorSetsImGui();
-		void updateImguiDescriptorSet();
+		void updateImguiDescriptorSet(int frameIndex);
 
 		ImVec2 getImageSizeWithAspectRatioForImGuiWindow(ImVec2 windowSize, float aspectRatio);
 		void updateSceneUi();
+		void updateStatsUi();
 		void updateUi();
 
+		bool isGpuCullingActive() const { return m_gpuCullingSystem != nullptr && m_isGpuCullingEnabled; }
+		bool isDeferredActive() const { return m_isDeferredSupported && m_isDeferredEnabled && !m_isRaytracingEnabled && !m_isDebugEnabled; }
+		bool isDepthPrepassActive() const { return m_isDepthPrepassEnabled && !m_isRaytracingEnabled && !m_isDebugEnabled && !isDeferredActive(); }
+
 		Context& m_context;
 		Renderer& m_renderer;
 		TextureRegistry& m_textureRegistry;
@@ -73,29 +88,58 @@ namespace PXTEngine {
 
 		std::array<Unique<VulkanBuffer>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_uboBuffers;
 
+		Unique<GpuProfiler> m_gpuProfiler = nullptr;
+		Unique<ParallelCommandRecorder> m_commandRecorder = nullptr;
+		// rebuilt every frame by doRenderPasses, keeps the transient images between frames
+		Unique<RenderGraph> m_renderGraph = nullptr;
+
 		Unique<MaterialRenderSystem> m_materialRenderSystem = nullptr;
 		Unique<PointLightSystem> m_pointLightSystem = nullptr;
+		Unique<LightClusterSystem> m_lightClusterSystem = nullptr;
+		Unique<DeferredRenderSystem> m_deferredRenderSystem = nullptr;
 		Unique<ShadowMapRenderSystem> m_shadowMapRenderSystem = nullptr;
 		Unique<UiRenderSystem> m_uiRenderSystem = nullptr;
 		Unique<DebugRenderSystem> m_debugRenderSystem = nullptr;
 		Unique<SkyboxRenderSystem> m_skyboxRenderSystem = nullptr;
 		Unique<RayTracingRenderSystem> m_rayTracingRenderSystem = nullptr;
+		// only created when the device supports indirect count draws
+		Unique<GpuCullingSystem> m_gpuCullingSystem = nullptr;
 
 		Unique<RenderPass> m_offscreenRenderPass;
+		// same attachments, loads the depth and color written by the deferred passes
+		Unique<RenderPass> m_deferredOffscreenRenderPass;
 		Unique<FrameBuffer> m_offscreenFb;
 
 		Shared<VulkanImage> m_sceneImage;
 		VkFormat m_offscreenColorFormat;
 		Shared<VulkanImage> m_offscreenDepthImage;
 
-		VkDescriptorSet m_sceneDescriptorSet = VK_NULL_HANDLE;
+		// the viewport image shown by ImGui, one set per frame slot so that a resize never
+		// rewrites a set used by a frame in flight
+		std::array<VkDescriptorSet, SwapChain::MAX_FRAMES_IN_FLIGHT> m_sceneDescriptorSets{};
+		std::array<bool, SwapChain::MAX_FRAMES_IN_FLIGHT> m_isSceneDescriptorSetOutdated{};
 		Unique<DescriptorSetLayout> m_sceneDescriptorSetLayout = nullptr;
 
+		FrustumCuller m_frustumCuller;
+		std::vector<entt::entity> m_cameraVisibleEntities;
+		FrustumCuller::Stats m_cameraCullingStats{};
+
+		OcclusionCuller m_occlusionCuller;
+		OcclusionCuller::Stats m_cameraOcclusionStats{};
+
 		VkExtent2D m_lastFrameSwapChainExtent;
 		ImVec2 m_sceneImageExtentInWindow = { 960, 540 };
 
 		bool m_isDebugEnabled = false;
 		bool m_isRaytracingEnabled = true;
 		bool m_isAccumulationEnabled = false;
+		bool m_isDeferredEnabled = false;
+		// the deferred lighting pass writes the scene image as rgba16f, so it needs that format
+		bool m_isDeferredSupported = false;
+		bool m_isDepthPrepassEnabled = false;
+		bool m_isGpuCullingEnabled = true;
+		bool m_isSoftwareOcclusionEnabled = false;
+		// the material, debug and shadow draws are recorded into secondary buffers on worker threads
+		bool m_isParallelRecordingEnabled = true;
 	};
 }
\ No newline at end of file
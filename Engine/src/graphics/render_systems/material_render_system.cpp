@@ -4,9 +4,14 @@
 #include "core/diagnostics.hpp"
 #include "core/constants.hpp"
 #include "graphics/resources/vk_mesh.hpp"
+#include "resources/resource_manager.hpp"
 #include "scene/ecs/entity.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <map>
 #include <stdexcept>
+#include <unordered_map>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -15,30 +20,43 @@
 
 namespace PXTEngine {
 
-    struct MaterialPushConstantData {
+    // std430 layout shared with material/material_instance.glsl, the material itself is
+    // read from the MaterialRegistry buffer
+    struct MaterialInstanceData {
         glm::mat4 modelMatrix{1.f};
         glm::mat4 normalMatrix{1.f};
-        glm::vec4 color{1.f};
-        float specularIntensity = 0.0f;
-        float shininess = 1.0f;
-        int textureIndex = 0;
-        int normalMapIndex = 1;
-        int ambientOcclusionMapIndex = 0;
-        int metallicMapIndex = 0;
-		int roughnessMapIndex = 0;
-		float tilingFactor = 1.0f;
+        glm::vec3 tint{1.f};
+        uint32_t materialIndex = 0;
+        float tilingFactor = 1.0f;
+        float padding[3]{};
     };
 
+    // pipelines are keyed by pass in the high bits and permutation in the low ones
+    static uint32_t pipelineKey(MaterialRenderSystem::MaterialPass pass, MaterialRenderSystem::MaterialFeatures features) {
+        return (static_cast<uint32_t>(pass) << 8) | features;
+    }
+
     MaterialRenderSystem::MaterialRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator,
-    	TextureRegistry& textureRegistry, DescriptorSetLayout& globalSetLayout,
-    	VkRenderPass renderPass, VkDescriptorImageInfo shadowMapImageInfo)
+    	TextureRegistry& textureRegistry, MaterialRegistry& materialRegistry, DescriptorSetLayout& globalSetLayout,
+    	VkRenderPass renderPass, VkRenderPass gBufferRenderPass, VkDescriptorImageInfo shadowMapImageInfo,
+    	LightClusterSystem& lightClusterSystem)
         : m_context(context),
         m_descriptorAllocator(descriptorAllocator),
-        m_textureRegistry(textureRegistry)
+        m_textureRegistry(textureRegistry),
+        m_materialRegistry(materialRegistry),
+        m_lightClusterSystem(lightClusterSystem),
+        m_renderPass(renderPass),
+        m_gBufferRenderPass(gBufferRenderPass),
+        m_batchQueue(context.getJobSystem()),
+        m_instanceQueue(context.getJobSystem())
     {
 		createDescriptorSets(shadowMapImageInfo);
         createPipelineLayout(globalSetLayout);
-        createPipeline(renderPass);
+
+        updateMaterialFeatures();
+
+        // the permutation of the default material is ready before the first scene shows up
+        getPipeline(MaterialPass::Forward, 0);
     }
 
     MaterialRenderSystem::~MaterialRenderSystem() {
@@ -56,56 +74,305 @@ namespace PXTEngine {
 		DescriptorWriter(m_context, *m_shadowMapDescriptorSetLayout)
 			.writeImage(0, &shadowMapImageInfo)
 			.updateSet(m_shadowMapDescriptorSet);
+
+        // INSTANCE DATA DESCRIPTOR SETS
+        m_instanceDescriptorSetLayout = DescriptorSetLayout::Builder(m_context)
+            .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
+            .build();
+
+        for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+            m_descriptorAllocator->allocate(m_instanceDescriptorSetLayout->getDescriptorSetLayout(), m_instanceDescriptorSets[i]);
+
+            // start with room for a small scene, buffers grow on demand
+            ensureInstanceCapacity(i, 256);
+        }
     }
 
-    void MaterialRenderSystem::createPipelineLayout(DescriptorSetLayout& globalSetLayout) {
-        VkPushConstantRange pushConstantRange{};
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-        pushConstantRange.offset = 0;
-        pushConstantRange.size = sizeof(MaterialPushConstantData);
+    void MaterialRenderSystem::ensureInstanceCapacity(int frameIndex, uint32_t instanceCount) {
+        if (m_instanceBuffers[frameIndex] != nullptr && m_instanceBuffers[frameIndex]->getInstanceCount() >= instanceCount) {
+            return;
+        }
+
+        // the fence of this frame slot has been waited on, its buffer is no longer in use
+        m_instanceBuffers[frameIndex] = createUnique<VulkanBuffer>(
+            m_context,
+            sizeof(MaterialInstanceData),
+            std::bit_ceil(std::max(instanceCount, 1u)),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+        m_instanceBuffers[frameIndex]->map();
+
+        auto bufferInfo = m_instanceBuffers[frameIndex]->descriptorInfo();
+
+        DescriptorWriter(m_context, *m_instanceDescriptorSetLayout)
+            .writeBuffer(0, &bufferInfo)
+            .updateSet(m_instanceDescriptorSets[frameIndex]);
+    }
 
+    void MaterialRenderSystem::createPipelineLayout(DescriptorSetLayout& globalSetLayout) {
         std::vector<VkDescriptorSetLayout> descriptorSetLayouts{
             globalSetLayout.getDescriptorSetLayout(),
             m_textureRegistry.getDescriptorSetLayout(),
-            m_shadowMapDescriptorSetLayout->getDescriptorSetLayout()
+            m_shadowMapDescriptorSetLayout->getDescriptorSetLayout(),
+            m_instanceDescriptorSetLayout->getDescriptorSetLayout(),
+            m_lightClusterSystem.getDescriptorSetLayout().getDescriptorSetLayout(),
+            m_materialRegistry.getDescriptorSetLayout()
         };
 
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
         pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-        pipelineLayoutInfo.pushConstantRangeCount = 1;
-        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        pipelineLayoutInfo.pushConstantRangeCount = 0;
+        pipelineLayoutInfo.pPushConstantRanges = nullptr;
 
         if (vkCreatePipelineLayout(m_context.getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
             throw std::runtime_error("failed to create pipeline layout!");
         }
     }
 
-    void MaterialRenderSystem::createPipeline(VkRenderPass renderPass) {
+    MaterialRenderSystem::MaterialFeatures MaterialRenderSystem::getMaterialFeatures(const Material& material) {
+        const auto& defaultMaterial = ResourceManager::defaultMaterial;
+        MaterialFeatures features = 0;
+
+        if (material.getAlbedoMap() != defaultMaterial->getAlbedoMap()) {
+            features |= ALBEDO_MAP;
+        }
+        if (material.getNormalMap() != defaultMaterial->getNormalMap()) {
+            features |= NORMAL_MAP;
+        }
+        if (material.getAmbientOcclusionMap() != defaultMaterial->getAmbientOcclusionMap()) {
+            features |= AMBIENT_OCCLUSION_MAP;
+        }
+
+        // the emission is the map modulated by the color, scaled by the alpha
+        const glm::vec4& emissiveColor = material.getEmissiveColor();
+        if (material.getEmissiveMap() != defaultMaterial->getEmissiveMap() &&
+            emissiveColor.a > 0.0f && glm::vec3(emissiveColor) != glm::vec3(0.0f)) {
+            features |= EMISSIVE;
+        }
+
+        if (material.getAlphaMode() == Material::AlphaMode::Mask) {
+            features |= ALPHA_MASK;
+        }
+
+        return features;
+    }
+
+    void MaterialRenderSystem::resolvePermutation(MaterialPass& pass, MaterialFeatures& features) {
+        // the depth pre-pass has no fragment stage, masked materials are not drawn in it
+        if (pass == MaterialPass::DepthPrepass) {
+            features = 0;
+        }
+
+        // so the masked materials write their own depth after it
+        if (pass == MaterialPass::ForwardDepthEqual && (features & ALPHA_MASK)) {
+            pass = MaterialPass::Forward;
+        }
+    }
+
+    PendingPipeline& MaterialRenderSystem::getPipeline(MaterialPass pass, MaterialFeatures features) {
+        resolvePermutation(pass, features);
+
+        auto [it, isNew] = m_pipelines.try_emplace(pipelineKey(pass, features));
+        if (!isNew) {
+            return it->second;
+        }
+
         PXT_ASSERT(m_pipelineLayout != nullptr, "Cannot create pipeline before pipelineLayout");
 
         RasterizationPipelineConfigInfo pipelineConfig{};
         Pipeline::defaultPipelineConfigInfo(pipelineConfig);
-        pipelineConfig.renderPass = renderPass;
+        pipelineConfig.renderPass = m_renderPass;
         pipelineConfig.pipelineLayout = m_pipelineLayout;
+        pipelineConfig.specializationConstants = { features };
 
-		const std::vector<std::pair<VkShaderStageFlagBits, std::string>>& shaderFilePaths = {
+		std::vector<std::pair<VkShaderStageFlagBits, std::string>> shaderFilePaths = {
 			{VK_SHADER_STAGE_VERTEX_BIT, SPV_SHADERS_PATH + "material_shader.vert.spv"},
 			{VK_SHADER_STAGE_FRAGMENT_BIT, SPV_SHADERS_PATH + "material_shader.frag.spv"}
 		};
 
-        m_pipeline = createUnique<Pipeline>(
-            m_context,
+        switch (pass) {
+        case MaterialPass::ForwardDepthEqual:
+            // shades the pixels the depth pre-pass kept, the depth is already final
+            pipelineConfig.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_EQUAL;
+            pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
+            break;
+        case MaterialPass::DepthPrepass:
+            // depth only, from the position stream; the color attachment of the pass is left untouched
+            pipelineConfig.bindingDescriptions = VulkanMesh::getPositionBindingDescriptions();
+            pipelineConfig.attributeDescriptions = VulkanMesh::getPositionAttributeDescriptions();
+            pipelineConfig.colorBlendAttachment.colorWriteMask = 0;
+            shaderFilePaths = {
+                {VK_SHADER_STAGE_VERTEX_BIT, SPV_SHADERS_PATH + "material_depth.vert.spv"}
+            };
+            break;
+        case MaterialPass::GBuffer:
+            // same vertex stage and layout, the fragment shader packs the surface into the G-buffer
+            pipelineConfig.renderPass = m_gBufferRenderPass;
+            shaderFilePaths[1].second = SPV_SHADERS_PATH + "material_gbuffer.frag.spv";
+            break;
+        default:
+            break;
+        }
+
+        it->second = m_context.getPipelineCompiler().compile(
             shaderFilePaths,
             pipelineConfig
         );
+
+        return it->second;
+    }
+
+    void MaterialRenderSystem::updateMaterialFeatures() {
+        // the registry only grows, the materials already resolved keep their permutation
+        const uint32_t materialCount = m_materialRegistry.getMaterialCount();
+        for (uint32_t i = static_cast<uint32_t>(m_materialFeatures.size()); i < materialCount; i++) {
+            m_materialFeatures.push_back(getMaterialFeatures(*m_materialRegistry.getMaterial(i)));
+        }
+    }
+
+    void MaterialRenderSystem::requestPipelines() {
+        // the feature bits fit in 5 bits, one bit per permutation
+        uint32_t requestedFeatures = 0;
+
+        for (const auto& batch : m_batches) {
+            if (requestedFeatures & (1u << batch.features)) continue;
+            requestedFeatures |= 1u << batch.features;
+
+            for (uint32_t pass = 0; pass <= static_cast<uint32_t>(MaterialPass::GBuffer); pass++) {
+                if (m_recordedPasses & (1u << pass)) {
+                    getPipeline(static_cast<MaterialPass>(pass), batch.features);
+                }
+            }
+        }
     }
 
-    void MaterialRenderSystem::render(FrameInfo& frameInfo) {
-        m_pipeline->bind(frameInfo.commandBuffer);
+    void MaterialRenderSystem::bindPipeline(FrameInfo& frameInfo, MaterialPass pass, MaterialFeatures features) {
+        // resolved by preparePass, the lookup must not insert while other threads record
+        resolvePermutation(pass, features);
+        m_pipelines.at(pipelineKey(pass, features))->bind(frameInfo.commandBuffer);
+    }
+
+    bool MaterialRenderSystem::isBatchSkipped(const DrawBatch& batch, MaterialPass pass) {
+        return pass == MaterialPass::DepthPrepass && (batch.features & ALPHA_MASK);
+    }
+
+    void MaterialRenderSystem::bindMesh(FrameInfo& frameInfo, const DrawBatch& batch, MaterialPass pass) {
+        if (pass == MaterialPass::DepthPrepass) {
+            batch.mesh->bindPositions(frameInfo.commandBuffer);
+        } else {
+            batch.mesh->bind(frameInfo.commandBuffer);
+        }
+    }
+
+    void MaterialRenderSystem::prepare(FrameInfo& frameInfo, const std::vector<entt::entity>& entities) {
+        updateMaterialFeatures();
+
+        const glm::vec3 eye = frameInfo.camera.getPosition();
+        const float projectionScale = glm::abs(frameInfo.camera.getProjectionMatrix()[1][1]);
+
+        auto view = frameInfo.scene.getEntitiesWith<TransformComponent, MeshComponent, MaterialComponent, WorldBoundsComponent>();
+
+        // group the entities by permutation and mesh, the render queues order the batches
+        std::map<std::pair<MaterialFeatures, const Mesh*>, uint32_t> batchLookup;
+        std::vector<std::pair<uint32_t, entt::entity>> drawEntities;
+        drawEntities.reserve(entities.size());
+
+        m_batches.clear();
+
+        for (auto entity : entities) {
+            if (!view.contains(entity)) continue;
+
+            const auto& meshComponent = view.get<MeshComponent>(entity);
+            const uint32_t materialIndex = view.get<MaterialComponent>(entity).materialIndex;
+            PXT_ASSERT(materialIndex < m_materialFeatures.size(), "Material index out of the registry range");
+            const MaterialFeatures features = m_materialFeatures[materialIndex];
+
+            auto [it, isNew] = batchLookup.try_emplace({ features, meshComponent.mesh.get() }, static_cast<uint32_t>(m_batches.size()));
+            if (isNew) {
+                m_batches.push_back({ std::static_pointer_cast<VulkanMesh>(meshComponent.mesh), features, 0, 0 });
+            }
+
+            m_batches[it->second].instanceCount++;
+            drawEntities.emplace_back(it->second, entity);
+        }
+
+        std::stable_sort(drawEntities.begin(), drawEntities.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        requestPipelines();
+
+        PXT_ASSERT(m_batches.size() <= (1u << RenderQueue::MESH_BITS), "Too many material batches for the sort keys");
+
+        m_batchQueue.clear();
+        m_instanceQueue.clear();
+
+        uint32_t firstInstance = 0;
+        for (uint32_t batchIndex = 0; batchIndex < m_batches.size(); batchIndex++) {
+            DrawBatch& batch = m_batches[batchIndex];
+            batch.firstInstance = firstInstance;
+            firstInstance += batch.instanceCount;
+
+            // the materials are read from the registry buffer, there is nothing to bind for them
+            m_batchQueue.push(RenderQueue::makeKey(0, batch.features, 0, batchIndex, 0), batchIndex);
+        }
+
+        m_batchQueue.sort();
 
-        std::array<VkDescriptorSet, 3> descriptorSets = { frameInfo.globalDescriptorSet, m_textureRegistry.getDescriptorSet(), m_shadowMapDescriptorSet};
+        const int frameIndex = frameInfo.frameIndex;
+        ensureInstanceCapacity(frameIndex, static_cast<uint32_t>(drawEntities.size()));
+
+        auto* instances = static_cast<MaterialInstanceData*>(m_instanceBuffers[frameIndex]->getMappedMemory());
+        m_cullInstances.resize(drawEntities.size());
+
+        for (size_t i = 0; i < drawEntities.size(); i++) {
+            const auto [batchIndex, entity] = drawEntities[i];
+            const auto&[transform, materialComponent, worldBounds] =
+                view.get<TransformComponent, MaterialComponent, WorldBoundsComponent>(entity);
+
+            const DrawBatch& batch = m_batches[batchIndex];
+
+            MaterialInstanceData& instance = instances[i];
+            instance.modelMatrix = transform.mat4();
+            instance.normalMatrix = transform.normalMatrix();
+            instance.tint = materialComponent.tint;
+            instance.materialIndex = materialComponent.materialIndex;
+            instance.tilingFactor = materialComponent.tilingFactor;
+
+            const uint32_t lodIndex = batch.mesh->selectLod(worldBounds.bounds.sphere, transform.maxScale(), eye,
+                projectionScale, m_lodErrorThreshold, m_lodBias);
+            const Mesh::Lod& lod = batch.mesh->getLods()[lodIndex];
+
+            GpuCullingSystem::CullInstance& cullInstance = m_cullInstances[i];
+            cullInstance.sphere = glm::vec4(worldBounds.bounds.sphere.center, worldBounds.bounds.sphere.radius);
+            cullInstance.boxMin = glm::vec4(worldBounds.bounds.box.min, 0.0f);
+            cullInstance.boxMax = glm::vec4(worldBounds.bounds.box.max, 0.0f);
+            cullInstance.firstIndex = lod.firstIndex;
+            cullInstance.indexCount = lod.indexCount;
+            cullInstance.batchIndex = batchIndex;
+            cullInstance.commandOffset = batch.firstInstance;
+
+            // front to back within a batch, for the direct draws
+            const float distance = glm::length(worldBounds.bounds.sphere.center - eye) - worldBounds.bounds.sphere.radius;
+            m_instanceQueue.push(RenderQueue::makeKey(0, batch.features, 0, batchIndex, RenderQueue::quantizeDepth(distance)),
+                static_cast<uint32_t>(i));
+        }
+
+        // only the direct path needs it sorted, see render
+        m_isInstanceQueueSorted = false;
+    }
+
+    void MaterialRenderSystem::bindDescriptorSets(FrameInfo& frameInfo) {
+        std::array<VkDescriptorSet, 6> descriptorSets = {
+            frameInfo.globalDescriptorSet,
+            m_textureRegistry.getDescriptorSet(),
+            m_shadowMapDescriptorSet,
+            m_instanceDescriptorSets[frameInfo.frameIndex],
+            m_lightClusterSystem.getDescriptorSet(frameInfo.frameIndex),
+            m_materialRegistry.getDescriptorSet()
+        };
 
         vkCmdBindDescriptorSets(
             frameInfo.commandBuffer,
@@ -117,39 +384,77 @@ namespace PXTEngine {
             0,
             nullptr
         );
+    }
+
+    void MaterialRenderSystem::preparePass(MaterialPass pass, bool isIndirect) {
+        if (!isIndirect && !m_isInstanceQueueSorted) {
+            m_instanceQueue.sort();
+            m_isInstanceQueueSorted = true;
+        }
 
-        auto view = frameInfo.scene.getEntitiesWith<TransformComponent, MeshComponent, MaterialComponent>();
-        for (auto entity : view) {
-
-            const auto&[transform, meshComponent, materialComponent] = view.get<TransformComponent, MeshComponent, MaterialComponent>(entity);
-
-			auto material = materialComponent.material;
-            auto vulkanMesh = std::static_pointer_cast<VulkanMesh>(meshComponent.mesh);
-
-            MaterialPushConstantData push{};
-            push.modelMatrix = transform.mat4();
-            push.normalMatrix = transform.normalMatrix();
-            push.color = material->getAlbedoColor() * glm::vec4(materialComponent.tint, 1.0f);
-            push.specularIntensity = 0.0f;
-            push.shininess = 1.0f;
-            push.textureIndex = m_textureRegistry.getIndex(material->getAlbedoMap()->id);
-            push.normalMapIndex = m_textureRegistry.getIndex(material->getNormalMap()->id);
-			//push.metallicMapIndex = m_textureRegistry.getIndex(material->getMetallicMap()->id);
-			//push.roughnessMapIndex = m_textureRegistry.getIndex(material->getRoughnessMap()->id);
-            push.ambientOcclusionMapIndex = m_textureRegistry.getIndex(material->getAmbientOcclusionMap()->id);
-            push.tilingFactor = materialComponent.tilingFactor;
-
-            vkCmdPushConstants(
-                frameInfo.commandBuffer,
-                m_pipelineLayout,
-                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                0,
-                sizeof(MaterialPushConstantData),
-                &push);
-            
-            vulkanMesh->bind(frameInfo.commandBuffer);
-            vulkanMesh->draw(frameInfo.commandBuffer);
+        // the permutations of the pass are requested from now on, see prepare
+        m_recordedPasses |= 1u << static_cast<uint32_t>(pass);
 
+        uint32_t resolvedFeatures = 0;
+        for (const auto& batch : m_batches) {
+            if (resolvedFeatures & (1u << batch.features)) continue;
+            resolvedFeatures |= 1u << batch.features;
+
+            if (!isBatchSkipped(batch, pass)) {
+                getPipeline(pass, batch.features).get();
+            }
         }
     }
+
+    void MaterialRenderSystem::render(FrameInfo& frameInfo, MaterialPass pass, uint32_t begin, uint32_t end) {
+        bindDescriptorSets(frameInfo);
+
+        m_instanceQueue.record({
+            .skip = [&](const RenderQueue::Item& item) {
+                return isBatchSkipped(m_batches[RenderQueue::getMesh(item.key)], pass);
+            },
+            .bindPipeline = [&](const RenderQueue::Item& item) {
+                bindPipeline(frameInfo, pass, RenderQueue::getPipeline(item.key));
+            },
+            .bindMesh = [&](const RenderQueue::Item& item) {
+                bindMesh(frameInfo, m_batches[RenderQueue::getMesh(item.key)], pass);
+            },
+            .draw = [&](const RenderQueue::Item& item) {
+                const auto& cullInstance = m_cullInstances[item.payload];
+
+                // the instance index reaches the shaders as gl_InstanceIndex
+                vkCmdDrawIndexed(frameInfo.commandBuffer, cullInstance.indexCount, 1, cullInstance.firstIndex, 0, item.payload);
+            }
+        }, begin, end);
+    }
+
+    void MaterialRenderSystem::renderIndirect(FrameInfo& frameInfo, VkBuffer drawCommandBuffer, VkBuffer drawCountBuffer,
+        MaterialPass pass, uint32_t begin, uint32_t end) {
+        bindDescriptorSets(frameInfo);
+
+        m_batchQueue.record({
+            .skip = [&](const RenderQueue::Item& item) {
+                return isBatchSkipped(m_batches[item.payload], pass);
+            },
+            .bindPipeline = [&](const RenderQueue::Item& item) {
+                bindPipeline(frameInfo, pass, RenderQueue::getPipeline(item.key));
+            },
+            .bindMesh = [&](const RenderQueue::Item& item) {
+                bindMesh(frameInfo, m_batches[item.payload], pass);
+            },
+            .draw = [&](const RenderQueue::Item& item) {
+                const DrawBatch& batch = m_batches[item.payload];
+
+                vkCmdDrawIndexedIndirectCount(
+                    frameInfo.commandBuffer,
+                    drawCommandBuffer,
+                    batch.firstInstance * sizeof(VkDrawIndexedIndirectCommand),
+                    drawCountBuffer,
+                    item.payload * sizeof(uint32_t),
+                    batch.instanceCount,
+                    sizeof(VkDrawIndexedIndirectCommand)
+                );
+            }
+        }, begin, end);
+    }
 }
\ No newline at end of file
@@ -2,39 +2,200 @@
 
 #include "core/memory.hpp"
 #include "graphics/pipeline.hpp"
+#include "graphics/pipeline_compiler.hpp"
 #include "graphics/swap_chain.hpp"
 #include "graphics/context/context.hpp"
 #include "graphics/frame_info.hpp"
+#include "graphics/render_queue.hpp"
 #include "graphics/descriptors/descriptors.hpp"
 #include "graphics/resources/texture_registry.hpp"
+#include "graphics/resources/material_registry.hpp"
+#include "graphics/resources/vk_buffer.hpp"
+#include "graphics/resources/vk_mesh.hpp"
+#include "graphics/render_systems/gpu_culling_system.hpp"
+#include "graphics/render_systems/light_cluster_system.hpp"
+#include "resources/types/mesh.hpp"
+#include "resources/types/material.hpp"
 #include "scene/scene.hpp"
 
+#include <limits>
+#include <unordered_map>
+
 namespace PXTEngine {
 
     class MaterialRenderSystem {
     public:
-        MaterialRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, TextureRegistry& textureRegistry, DescriptorSetLayout& globalSetLayout, VkRenderPass renderPass, VkDescriptorImageInfo shadowMapImageInfo);
+        MaterialRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, TextureRegistry& textureRegistry, MaterialRegistry& materialRegistry, DescriptorSetLayout& globalSetLayout, VkRenderPass renderPass, VkRenderPass gBufferRenderPass, VkDescriptorImageInfo shadowMapImageInfo, LightClusterSystem& lightClusterSystem);
         ~MaterialRenderSystem();
 
         MaterialRenderSystem(const MaterialRenderSystem&) = delete;
         MaterialRenderSystem& operator=(const MaterialRenderSystem&) = delete;
 
-        void render(FrameInfo& frameInfo);
+        /**
+         * @brief The forward pass shades the materials, the G-buffer pass only writes their surface
+         * for the deferred lighting (see DeferredRenderSystem).
+         * The depth pre-pass writes the depth from the position-only vertex stream, the forward pass
+         * that follows it tests EQUAL without writing, so every pixel is shaded once.
+         */
+        enum class MaterialPass {
+            Forward,
+            DepthPrepass,
+            ForwardDepthEqual,
+            GBuffer
+        };
+
+        /**
+         * @brief Material feature bits, mirrored in material/material_features.glsl.
+         *
+         * Every combination is a permutation of the material pipelines, specialized with the
+         * MATERIAL_FEATURES constant: the stages skip the maps a material does not use.
+         */
+        enum MaterialFeature : uint32_t {
+            ALBEDO_MAP = 1 << 0,
+            NORMAL_MAP = 1 << 1,
+            AMBIENT_OCCLUSION_MAP = 1 << 2,
+            EMISSIVE = 1 << 3,
+            ALPHA_MASK = 1 << 4
+        };
+        using MaterialFeatures = uint32_t;
+
+        /**
+         * @brief The features a material needs, the maps left to the default material ones are skipped.
+         */
+        static MaterialFeatures getMaterialFeatures(const Material& material);
+
+        /**
+         * @struct DrawBatch
+         *
+         * @brief A contiguous range of instances sharing the same mesh buffers and material permutation.
+         */
+        struct DrawBatch {
+            Shared<VulkanMesh> mesh;
+            MaterialFeatures features = 0;
+            uint32_t firstInstance = 0;
+            uint32_t instanceCount = 0;
+        };
+
+        /**
+         * @brief Selects the LODs, groups the entities that have a material by permutation and mesh
+         * and uploads their instance data. Must be called before render or renderIndirect.
+         * The pipelines of new permutations start compiling here, for the passes already recorded.
+         *
+         * @param frameInfo The frame info.
+         * @param entities The entities to draw (CPU culled) or to cull on the GPU.
+         */
+        void prepare(FrameInfo& frameInfo, const std::vector<entt::entity>& entities);
+
+        /**
+         * @brief Sorts the draws of the pass and waits for its pipelines, on the recording thread.
+         * After it, render and renderIndirect only read the system, so disjoint draw ranges of the
+         * pass can be recorded concurrently (see ParallelCommandRecorder).
+         *
+         * @param pass The pass the draws will be recorded in.
+         * @param isIndirect Whether the draws go through renderIndirect.
+         */
+        void preparePass(MaterialPass pass, bool isIndirect);
+
+        /**
+         * @brief The draws of the direct or indirect path, the range bounds of render and renderIndirect.
+         */
+        uint32_t getDrawCount(bool isIndirect) const {
+            return isIndirect ? m_batchQueue.getSize() : m_instanceQueue.getSize();
+        }
+
+        /**
+         * @brief Draws the prepared instances [begin, end), one direct draw each.
+         * preparePass must have been called for the pass.
+         */
+        void render(FrameInfo& frameInfo, MaterialPass pass = MaterialPass::Forward,
+            uint32_t begin = 0, uint32_t end = std::numeric_limits<uint32_t>::max());
+
+        /**
+         * @brief Draws the prepared instances that passed GPU culling, one indirect count draw per batch.
+         *
+         * @param frameInfo The frame info.
+         * @param drawCommandBuffer The draw commands written by the culling, batches at their firstInstance.
+         * @param drawCountBuffer The draw count of every batch.
+         * @param pass The pass the draws are recorded in, preparePass must have been called for it.
+         * @param begin The first batch draw to record.
+         * @param end The batch draw past the last one to record.
+         */
+        void renderIndirect(FrameInfo& frameInfo, VkBuffer drawCommandBuffer, VkBuffer drawCountBuffer,
+            MaterialPass pass = MaterialPass::Forward, uint32_t begin = 0, uint32_t end = std::numeric_limits<uint32_t>::max());
+
+        /**
+         * @brief Bounds and draw ranges of the prepared instances, in instance order.
+         */
+        const std::vector<GpuCullingSystem::CullInstance>& getCullInstances() const { return m_cullInstances; }
+
+        uint32_t getBatchCount() const { return static_cast<uint32_t>(m_batches.size()); }
+
+        uint32_t getPipelineCount() const { return static_cast<uint32_t>(m_pipelines.size()); }
+
+        /**
+         * @brief The binds and draws of the last frame, of the direct or indirect path it used.
+         */
+        RenderQueue::Stats getQueueStats() const {
+            return m_instanceQueue.getStats().draws > 0 ? m_instanceQueue.getStats() : m_batchQueue.getStats();
+        }
 
     private:
         void createDescriptorSets(VkDescriptorImageInfo shadowMapImageInfo);
+        void ensureInstanceCapacity(int frameIndex, uint32_t instanceCount);
+        void bindDescriptorSets(FrameInfo& frameInfo);
         void createPipelineLayout(DescriptorSetLayout& globalSetLayout);
-        void createPipeline(VkRenderPass renderPass);
+        /**
+         * @brief Returns the pipeline of a pass and permutation, its compilation is requested the first time.
+         */
+        PendingPipeline& getPipeline(MaterialPass pass, MaterialFeatures features);
+        /**
+         * @brief Maps a pass and permutation to the ones of the pipeline actually drawing it.
+         */
+        static void resolvePermutation(MaterialPass& pass, MaterialFeatures& features);
+        /**
+         * @brief Resolves the permutations of the materials registered since the last call.
+         */
+        void updateMaterialFeatures();
+        void requestPipelines();
+        void bindPipeline(FrameInfo& frameInfo, MaterialPass pass, MaterialFeatures features);
+        void bindMesh(FrameInfo& frameInfo, const DrawBatch& batch, MaterialPass pass);
+        static bool isBatchSkipped(const DrawBatch& batch, MaterialPass pass);
         
         Context& m_context;
         TextureRegistry& m_textureRegistry;
+        MaterialRegistry& m_materialRegistry;
+        LightClusterSystem& m_lightClusterSystem;
 
-        Unique<Pipeline> m_pipeline;
+        VkRenderPass m_renderPass;
+        VkRenderPass m_gBufferRenderPass;
+
+        // built lazily, keyed by pass and permutation
+        std::unordered_map<uint32_t, PendingPipeline> m_pipelines;
+        uint32_t m_recordedPasses = 1u << static_cast<uint32_t>(MaterialPass::Forward);
         VkPipelineLayout m_pipelineLayout;
 
 		Shared<DescriptorAllocatorGrowable> m_descriptorAllocator;
 
         Unique<DescriptorSetLayout> m_shadowMapDescriptorSetLayout{};
         VkDescriptorSet m_shadowMapDescriptorSet{};
+
+        Unique<DescriptorSetLayout> m_instanceDescriptorSetLayout{};
+        std::array<Unique<VulkanBuffer>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_instanceBuffers;
+        std::array<VkDescriptorSet, SwapChain::MAX_FRAMES_IN_FLIGHT> m_instanceDescriptorSets{};
+
+        // permutation of every material of the registry, by material index
+        std::vector<MaterialFeatures> m_materialFeatures;
+
+        std::vector<DrawBatch> m_batches;
+
+        // keyed by permutation and batch: one item per batch for the indirect draws,
+        // one per instance, front to back, for the direct ones
+        RenderQueue m_batchQueue;
+        RenderQueue m_instanceQueue;
+        bool m_isInstanceQueueSorted = false;
+        std::vector<GpuCullingSystem::CullInstance> m_cullInstances;
+
+        float m_lodErrorThreshold = Mesh::DEFAULT_LOD_ERROR_THRESHOLD;
+        uint32_t m_lodBias = 0;
     };
 }
\ No newline at end of file
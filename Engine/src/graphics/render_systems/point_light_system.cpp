@@ -4,6 +4,7 @@
 #include "core/constants.hpp"
 #include "scene/ecs/entity.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <ranges>
 #include <stdexcept>
@@ -71,29 +72,31 @@ namespace PXTEngine {
 			{VK_SHADER_STAGE_FRAGMENT_BIT, SPV_SHADERS_PATH + "point_light_billboard.frag.spv"}
 		};
 
-		m_pipeline = createUnique<Pipeline>(
-			m_context,
-            shaderFilePaths,
+		m_pipeline = m_context.getPipelineCompiler().compile(
+			shaderFilePaths,
 			pipelineConfig
 		);
     }
 
     void PointLightSystem::update(FrameInfo& frameInfo, GlobalUbo& ubo) {
-        int lightIndex = 0;
+        m_lights.clear();
 
         auto view = frameInfo.scene.getEntitiesWith<PointLightComponent, ColorComponent, TransformComponent>();
         for (auto entity : view) {
 
             const auto&[light, color, transform] = view.get<PointLightComponent, ColorComponent, TransformComponent>(entity);
 
-            //update lights in the ubo
-            ubo.pointLights[lightIndex].position = glm::vec4(transform.translation, 1.f);
-            ubo.pointLights[lightIndex].color = glm::vec4((glm::vec3) color, light.lightIntensity);
-
-            lightIndex += 1;
+            // w is the shadow slot, assigned by the shadow map render system
+            PointLight& pointLight = m_lights.emplace_back();
+            pointLight.position = glm::vec4(transform.translation, -1.f);
+            pointLight.color = glm::vec4((glm::vec3) color, light.lightIntensity);
         }
 
-        ubo.numLights = lightIndex;
+        // the ray tracing shaders still read the lights from the ubo, it only has room for MAX_LIGHTS
+        const size_t uboLightCount = std::min<size_t>(m_lights.size(), MAX_LIGHTS);
+        std::copy_n(m_lights.begin(), uboLightCount, ubo.pointLights);
+
+        ubo.numLights = static_cast<int>(uboLightCount);
     }
 
     void PointLightSystem::render(FrameInfo& frameInfo) {
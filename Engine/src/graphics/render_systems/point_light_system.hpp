@@ -3,11 +3,14 @@
 #include "core/memory.hpp"
 #include "scene/camera.hpp"
 #include "graphics/pipeline.hpp"
+#include "graphics/pipeline_compiler.hpp"
 #include "graphics/swap_chain.hpp"
 #include "graphics/context/context.hpp"
 #include "graphics/frame_info.hpp"
 #include "scene/scene.hpp"
 
+#include <vector>
+
 namespace PXTEngine {
 
     class PointLightSystem {
@@ -18,16 +21,26 @@ namespace PXTEngine {
         PointLightSystem(const PointLightSystem&) = delete;
         PointLightSystem& operator=(const PointLightSystem&) = delete;
 
+        /**
+         * @brief Gathers the point lights of the scene and copies the first MAX_LIGHTS of them to the ubo.
+         */
         void update(FrameInfo& frameInfo, GlobalUbo& ubo);
         void render(FrameInfo& frameInfo);
 
+        /**
+         * @brief Every point light of the scene, gathered by the last update.
+         */
+        std::vector<PointLight>& getLights() { return m_lights; }
+
     private:
         void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
         void createPipeline(VkRenderPass renderPass);  
         
         Context& m_context;
 
-        Unique<Pipeline> m_pipeline;
+        PendingPipeline m_pipeline;
         VkPipelineLayout m_pipelineLayout;
+
+        std::vector<PointLight> m_lights;
     };
 }
\ No newline at end of file
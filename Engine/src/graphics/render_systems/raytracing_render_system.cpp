@@ -38,29 +38,31 @@ namespace PXTEngine {
 				1)
 			.build();
 
-		VkDescriptorImageInfo descriptorImageInfo;
-		descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-		descriptorImageInfo.imageView = m_sceneImage->getImageView();
-		descriptorImageInfo.sampler = VK_NULL_HANDLE;
+		// written by render, once per scene image and frame slot
+		for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+			m_descriptorAllocator->allocate(m_storageImageDescriptorSetLayout->getDescriptorSetLayout(), m_storageImageDescriptorSets[i]);
+		}
+		m_isStorageImageDescriptorSetOutdated.fill(true);
+	}
 
-		m_descriptorAllocator->allocate(m_storageImageDescriptorSetLayout->getDescriptorSetLayout(), m_storageImageDescriptorSet);
+	void RayTracingRenderSystem::updateSceneImage(Shared<VulkanImage> sceneImage) {
+		m_sceneImage = sceneImage;
 
-		DescriptorWriter(m_context, *m_storageImageDescriptorSetLayout)
-			.writeImage(0, &descriptorImageInfo)
-			.updateSet(m_storageImageDescriptorSet);
+		// the frames in flight still write the previous image through the sets of their slots
+		m_isStorageImageDescriptorSetOutdated.fill(true);
 	}
 
-	void RayTracingRenderSystem::updateSceneImage(Shared<VulkanImage> sceneImage) {
+	void RayTracingRenderSystem::writeStorageImageDescriptorSet(int frameIndex) {
 		VkDescriptorImageInfo descriptorImageInfo;
 		descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-		descriptorImageInfo.imageView = sceneImage->getImageView();
+		descriptorImageInfo.imageView = m_sceneImage->getImageView();
 		descriptorImageInfo.sampler = VK_NULL_HANDLE;
 
 		DescriptorWriter(m_context, *m_storageImageDescriptorSetLayout)
 			.writeImage(0, &descriptorImageInfo)
-			.updateSet(m_storageImageDescriptorSet);
-		
-		m_sceneImage = sceneImage;
+			.updateSet(m_storageImageDescriptorSets[frameIndex]);
+
+		m_isStorageImageDescriptorSetOutdated[frameIndex] = false;
 	}
 
 	uint32_t RayTracingRenderSystem::incrementAndGetPathTracingAccumulationFrameCount() {
@@ -139,8 +141,7 @@ namespace PXTEngine {
 		pipelineConfig.shaderGroups = m_shaderGroups;
 		pipelineConfig.pipelineLayout = m_pipelineLayout;
 		pipelineConfig.maxPipelineRayRecursionDepth = 2; // for now
-		m_pipeline = createUnique<Pipeline>(
-			m_context,
+		m_pipeline = m_context.getPipelineCompiler().compile(
 			pipelineConfig
 		);
 	}
@@ -316,26 +317,23 @@ namespace PXTEngine {
 	
 	void RayTracingRenderSystem::update(FrameInfo& frameInfo) {
 		m_rtSceneManager.createTLAS(frameInfo);
-
-		m_sceneImage->transitionImageLayout(
-			frameInfo.commandBuffer,
-			VK_IMAGE_LAYOUT_GENERAL,
-			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-			VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR
-		);
 	}
 
 	void RayTracingRenderSystem::render(FrameInfo& frameInfo, Renderer& renderer) {
+		if (m_isStorageImageDescriptorSetOutdated[frameInfo.frameIndex]) {
+			writeStorageImageDescriptorSet(frameInfo.frameIndex);
+		}
+
 		m_pipeline->bind(frameInfo.commandBuffer);
 
 		std::array<VkDescriptorSet, 7> descriptorSets = { 
 			frameInfo.globalDescriptorSet, 
-			m_rtSceneManager.getTLASDescriptorSet(), 
+			m_rtSceneManager.getTLASDescriptorSet(frameInfo.frameIndex),
 			m_textureRegistry.getDescriptorSet(),
-			m_storageImageDescriptorSet,
+			m_storageImageDescriptorSets[frameInfo.frameIndex],
 			m_materialRegistry.getDescriptorSet(),
 			m_skybox->getDescriptorSet(),
-			m_rtSceneManager.getMeshInstanceDescriptorSet()
+			m_rtSceneManager.getMeshInstanceDescriptorSet(frameInfo.frameIndex)
 		};
 	
 		vkCmdBindDescriptorSets(
@@ -360,14 +358,4 @@ namespace PXTEngine {
 			1
 		);
 	}
-
-	void RayTracingRenderSystem::transitionImageToShaderReadOnlyOptimal(FrameInfo& frameInfo) {
-		// transition output image to shader read only layout for imgui
-		m_sceneImage->transitionImageLayout(
-			frameInfo.commandBuffer,
-			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-			VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
-			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
-		);
-	}
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 
 #include "core/memory.hpp"
 #include "graphics/pipeline.hpp"
+#include "graphics/pipeline_compiler.hpp"
 #include "graphics/swap_chain.hpp"
 #include "graphics/frame_info.hpp"
 #include "graphics/descriptors/descriptors.hpp"
@@ -24,9 +25,10 @@ namespace PXTEngine {
         RayTracingRenderSystem& operator=(const RayTracingRenderSystem&) = delete;
 
         void update(FrameInfo& frameInfo);
+        // the scene image must be in VK_IMAGE_LAYOUT_GENERAL, the caller transitions it
         void render(FrameInfo& frameInfo, Renderer& renderer);
-		void transitionImageToShaderReadOnlyOptimal(FrameInfo& frameInfo);
 
+        // the storage image set of a frame slot is rewritten by the next render of that slot
         void updateSceneImage(Shared<VulkanImage> sceneImage);
 
         void resetPathTracingAccumulationFrameCount() { m_ptAccumulationFrameCount = 0; }
@@ -34,6 +36,7 @@ namespace PXTEngine {
 
     private:
 		void createDescriptorSets();
+		void writeStorageImageDescriptorSet(int frameIndex);
 		void defineShaderGroups();
         void createPipelineLayout(DescriptorSetLayout& setLayout);
         void createPipeline();
@@ -50,7 +53,7 @@ namespace PXTEngine {
         
         RayTracingSceneManagerSystem m_rtSceneManager{m_context, m_materialRegistry, m_blasRegistry, m_descriptorAllocator};
 
-        Unique<Pipeline> m_pipeline;
+        PendingPipeline m_pipeline;
         VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
 
         std::vector<ShaderGroupInfo> m_shaderGroups{};
@@ -61,7 +64,8 @@ namespace PXTEngine {
         VkStridedDeviceAddressRegionKHR m_callableRegion; // empty for now
 
         Shared<VulkanImage> m_sceneImage = nullptr;
-		VkDescriptorSet m_storageImageDescriptorSet = VK_NULL_HANDLE;
+		std::array<VkDescriptorSet, SwapChain::MAX_FRAMES_IN_FLIGHT> m_storageImageDescriptorSets{};
+		std::array<bool, SwapChain::MAX_FRAMES_IN_FLIGHT> m_isStorageImageDescriptorSetOutdated{};
 		Unique<DescriptorSetLayout> m_storageImageDescriptorSetLayout = nullptr;
 
         uint32_t m_ptAccumulationFrameCount = 0;
@@ -2,7 +2,18 @@
 
 #include "scene/ecs/component.hpp"
 
+#include <cstring>
+
 namespace PXTEngine {
+
+	namespace {
+		// the instances are plain data fully written by createTLAS, they compare bytewise
+		bool isSameInstances(const std::vector<VkAccelerationStructureInstanceKHR>& a,
+			const std::vector<VkAccelerationStructureInstanceKHR>& b) {
+			return a.size() == b.size() &&
+				(a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(VkAccelerationStructureInstanceKHR)) == 0);
+		}
+	}
 	RayTracingSceneManagerSystem::RayTracingSceneManagerSystem(Context& context, MaterialRegistry& materialRegistry, 
 		BLASRegistry& blasRegistry, Shared<DescriptorAllocatorGrowable> allocator)
 		: m_context(context), 
@@ -19,12 +30,11 @@ namespace PXTEngine {
 
 
 	void RayTracingSceneManagerSystem::createTLAS(FrameInfo& frameInfo) {
-		if (m_tlas != VK_NULL_HANDLE) return;
-
 		VkAccelerationStructureKHR newTlas = VK_NULL_HANDLE;
 
 		//  Create a acceleration structure instance vector 
 		std::vector<VkAccelerationStructureInstanceKHR> instances;
+		std::vector<MeshInstanceData> meshInstanceData;
 	
 		//  Get all BLAS and components from entities that have transform & mesh components 
 		auto view = frameInfo.scene.getEntitiesWith<TransformComponent, MeshComponent, MaterialComponent>();
@@ -33,7 +43,6 @@ namespace PXTEngine {
 		for (auto entity : view) {
 			const auto& [transformComponent, meshComponent, materialComponent] = view.get<TransformComponent, MeshComponent, MaterialComponent>(entity);
 			
-			auto material = materialComponent.material;
 			auto mesh = meshComponent.mesh;
 
 			Shared<BLAS> blas = m_blasRegistry.getOrCreateBLAS(mesh);
@@ -52,14 +61,14 @@ namespace PXTEngine {
 
 			auto vkMesh = static_pointer_cast<VulkanMesh>(mesh);
 
-			MeshInstanceData meshInstanceData{};
-			meshInstanceData.vertexBufferAddress = vkMesh->getVertexBufferDeviceAddress();
-			meshInstanceData.indexBufferAddress = vkMesh->getIndexBufferDeviceAddress();
-			meshInstanceData.materialIndex = m_materialRegistry.getIndex(material->id);
-			meshInstanceData.textureTintColor = glm::vec4(materialComponent.tint, 1.0f);
-			meshInstanceData.textureTilingFactor = materialComponent.tilingFactor;
+			MeshInstanceData instanceData{};
+			instanceData.vertexBufferAddress = vkMesh->getVertexBufferDeviceAddress();
+			instanceData.indexBufferAddress = vkMesh->getIndexBufferDeviceAddress();
+			instanceData.materialIndex = materialComponent.materialIndex;
+			instanceData.textureTintColor = glm::vec4(materialComponent.tint, 1.0f);
+			instanceData.textureTilingFactor = materialComponent.tilingFactor;
 
-			m_meshInstanceData.push_back(meshInstanceData);
+			meshInstanceData.push_back(instanceData);
 
 			// we can get it in the shader via InstanceCustomIndexKHR
 			instance.instanceCustomIndex = instanceIndex++; // Unique index for each instance
@@ -75,6 +84,15 @@ namespace PXTEngine {
 			instances.push_back(instance);
 		}
 
+		// rebuilt only when an instance was added, removed, moved or changed its mesh or material
+		if (m_tlas != VK_NULL_HANDLE && isSameInstances(instances, m_instances) && meshInstanceData == m_meshInstanceData) {
+			writeOutdatedDescriptorSets(frameInfo.frameIndex);
+			return;
+		}
+
+		m_instances = instances;
+		m_meshInstanceData = std::move(meshInstanceData);
+
 		//TODO: remove
 		updateMeshInstanceDescriptorSet();
 
@@ -144,7 +162,7 @@ namespace PXTEngine {
 
 
 		// 4. Allocate BLAS Buffer and Scratch Buffer
-		m_tlasBuffer = createUnique<VulkanBuffer>(
+		Unique<VulkanBuffer> tlasBuffer = createUnique<VulkanBuffer>(
 			m_context, 
 			m_buildSizeInfo.accelerationStructureSize,
 			1,
@@ -165,7 +183,7 @@ namespace PXTEngine {
 		//  5. Create TLAS Object 
 		VkAccelerationStructureCreateInfoKHR m_createInfo{};
 		m_createInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
-		m_createInfo.buffer = m_tlasBuffer->getBuffer();
+		m_createInfo.buffer = tlasBuffer->getBuffer();
 		m_createInfo.offset = 0;
 		m_createInfo.size = m_buildSizeInfo.accelerationStructureSize;
 		m_createInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
@@ -221,17 +239,15 @@ namespace PXTEngine {
 		// instance buffer or staging buffer. we can potentially keep the instance buffer for reuse.
 		// Buffers will be deleted after end of this function cause they are Unique.
 
-		// Update descriptor set for TLAS
-		updateTLASDescriptorSet(newTlas);
-
-		// Then destroy old one and assign the new one
-		destroyTLAS();
-
-		// If not done in this order it will give a validation error
-		// because the TLAS is still in use by the descriptor when we destroy it.
-		// TODO: add a list of SWAPCHAIN::MAX_FRAMES_IN_FLIGHT tlases with their descriptor sets
+		// The frames in flight may still trace the old TLAS through the sets of their slots,
+		// it is destroyed once they retired and every set is rewritten when its slot comes back
+		retireTLAS();
 
 		m_tlas = newTlas;
+		m_tlasBuffer = std::move(tlasBuffer);
+
+		m_isTLASDescriptorSetOutdated.fill(true);
+		writeOutdatedDescriptorSets(frameInfo.frameIndex);
 	}
 
 	VkTransformMatrixKHR RayTracingSceneManagerSystem::glmToVkTransformMatrix(const glm::mat4& glmMatrix) {
@@ -260,18 +276,48 @@ namespace PXTEngine {
 			.addBinding(0, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR)
 			.build();
 
-		m_descriptorAllocator->allocate(m_tlasDescriptorSetLayout->getDescriptorSetLayout(), m_tlasDescriptorSet);
+		for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+			m_descriptorAllocator->allocate(m_tlasDescriptorSetLayout->getDescriptorSetLayout(), m_tlasDescriptorSets[i]);
+		}
 	}
 
-	void RayTracingSceneManagerSystem::updateTLASDescriptorSet(VkAccelerationStructureKHR& newTlas) {
-		VkWriteDescriptorSetAccelerationStructureKHR tlasInfo{};
-		tlasInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
-		tlasInfo.accelerationStructureCount = 1;
-		tlasInfo.pAccelerationStructures = &newTlas;
+	void RayTracingSceneManagerSystem::writeOutdatedDescriptorSets(int frameIndex) {
+		if (m_isTLASDescriptorSetOutdated[frameIndex]) {
+			VkWriteDescriptorSetAccelerationStructureKHR tlasInfo{};
+			tlasInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
+			tlasInfo.accelerationStructureCount = 1;
+			tlasInfo.pAccelerationStructures = &m_tlas;
+
+			DescriptorWriter(m_context, *m_tlasDescriptorSetLayout)
+				.writeTLAS(0, tlasInfo)
+				.updateSet(m_tlasDescriptorSets[frameIndex]);
 
-		DescriptorWriter(m_context, *m_tlasDescriptorSetLayout)
-			.writeTLAS(0, tlasInfo)
-			.updateSet(m_tlasDescriptorSet);
+			m_isTLASDescriptorSetOutdated[frameIndex] = false;
+		}
+
+		if (m_isMeshInstanceDescriptorSetOutdated[frameIndex]) {
+			auto bufferInfo = m_meshInstanceBuffer->descriptorInfo();
+
+			DescriptorWriter(m_context, *m_meshInstanceDescriptorSetLayout)
+				.writeBuffer(0, &bufferInfo)
+				.updateSet(m_meshInstanceDescriptorSets[frameIndex]);
+
+			m_isMeshInstanceDescriptorSetOutdated[frameIndex] = false;
+		}
+	}
+
+	void RayTracingSceneManagerSystem::retireTLAS() {
+		if (m_tlas == VK_NULL_HANDLE) return;
+
+		DeletionQueue& deletionQueue = m_context.getDeletionQueue();
+
+		// the structure before the buffer backing it
+		deletionQueue.push([device = m_context.getDevice(), tlas = m_tlas]() {
+			vkDestroyAccelerationStructureKHR(device, tlas, nullptr);
+		});
+		deletionQueue.push(std::move(m_tlasBuffer));
+
+		m_tlas = VK_NULL_HANDLE;
 	}
 
 	void RayTracingSceneManagerSystem::destroyTLAS() {
@@ -287,15 +333,18 @@ namespace PXTEngine {
 			.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, 1)
 			.build();
 
-		m_descriptorAllocator->allocate(
-			m_meshInstanceDescriptorSetLayout->getDescriptorSetLayout(),
-			m_meshInstanceDescriptorSet
-		);
+		for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+			m_descriptorAllocator->allocate(
+				m_meshInstanceDescriptorSetLayout->getDescriptorSetLayout(),
+				m_meshInstanceDescriptorSets[i]
+			);
+		}
 	}
 
 	void RayTracingSceneManagerSystem::updateMeshInstanceDescriptorSet() {
+		// the frames in flight may still read the previous instances through the sets of their slots
 		if (m_meshInstanceBuffer != nullptr) {
-			return;
+			m_context.getDeletionQueue().push(std::move(m_meshInstanceBuffer));
 		}
 
 		VkDeviceSize bufferSize = sizeof(MeshInstanceData) * m_meshInstanceData.size();
@@ -321,10 +370,7 @@ namespace PXTEngine {
 
 		m_context.copyBuffer(stagingBuffer->getBuffer(), m_meshInstanceBuffer->getBuffer(), bufferSize);
 
-		auto bufferInfo = m_meshInstanceBuffer->descriptorInfo();
-
-		DescriptorWriter(m_context, *m_meshInstanceDescriptorSetLayout)
-			.writeBuffer(0, &bufferInfo)
-			.updateSet(m_meshInstanceDescriptorSet);
+		// every set is rewritten when its slot comes back
+		m_isMeshInstanceDescriptorSetOutdated.fill(true);
 	}
 }
\ No newline at end of file
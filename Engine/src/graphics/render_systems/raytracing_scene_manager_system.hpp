@@ -5,6 +5,9 @@
 #include "graphics/resources/vk_buffer.hpp"
 #include "graphics/frame_info.hpp"
 #include "graphics/descriptors/descriptors.hpp"
+#include "graphics/swap_chain.hpp"
+
+#include <array>
 
 namespace PXTEngine {
 	struct alignas(16) MeshInstanceData {
@@ -14,6 +17,8 @@ namespace PXTEngine {
 		float textureTilingFactor;					// offset 20, size 4
 													// offset 24 -> 8 bit padding 
 		alignas(16) glm::vec4 textureTintColor;		// offset 32, size 16
+
+		bool operator==(const MeshInstanceData& other) const = default;
 	};
 
 	class RayTracingSceneManagerSystem {
@@ -26,19 +31,26 @@ namespace PXTEngine {
 		RayTracingSceneManagerSystem(const RayTracingSceneManagerSystem&) = delete;
 		RayTracingSceneManagerSystem& operator=(const RayTracingSceneManagerSystem&) = delete;
 
+		/**
+		 * @brief Rebuilds the TLAS and the mesh instances when the instances of the scene changed
+		 * since the last build (added, removed, moved or with another mesh or material), then brings
+		 * the descriptor sets of the frame slot up to date. The replaced TLAS and instance buffer go
+		 * to the deletion queue.
+		 */
 		void createTLAS(FrameInfo& frameInfo);
 		void updateTLAS() {} // to implement later
-		VkDescriptorSet getTLASDescriptorSet() const { return m_tlasDescriptorSet; }
+		VkDescriptorSet getTLASDescriptorSet(int frameIndex) const { return m_tlasDescriptorSets[frameIndex]; }
 		VkDescriptorSetLayout getTLASDescriptorSetLayout() const { return m_tlasDescriptorSetLayout->getDescriptorSetLayout(); }
 
-		VkDescriptorSet getMeshInstanceDescriptorSet() const { return m_meshInstanceDescriptorSet; }
+		VkDescriptorSet getMeshInstanceDescriptorSet(int frameIndex) const { return m_meshInstanceDescriptorSets[frameIndex]; }
 		VkDescriptorSetLayout getMeshInstanceDescriptorSetLayout() const { return m_meshInstanceDescriptorSetLayout->getDescriptorSetLayout(); }
 	private:
 		void destroyTLAS();
+		void retireTLAS();
 		VkTransformMatrixKHR glmToVkTransformMatrix(const glm::mat4& glmMatrix);
 
 		void createTLASDescriptorSet();
-		void updateTLASDescriptorSet(VkAccelerationStructureKHR& newTlas);
+		void writeOutdatedDescriptorSets(int frameIndex);
 
 		void createMeshInstanceDescriptorSet();
 		void updateMeshInstanceDescriptorSet();
@@ -47,6 +59,9 @@ namespace PXTEngine {
 		MaterialRegistry& m_materialRegistry;
 		BLASRegistry& m_blasRegistry;
 
+		// the instances of the last build, compared to the scene every frame
+		std::vector<VkAccelerationStructureInstanceKHR> m_instances;
+
 		VkAccelerationStructureKHR m_tlas = VK_NULL_HANDLE;
 		Unique<VulkanBuffer> m_tlasBuffer;
 		VkAccelerationStructureBuildSizesInfoKHR m_buildSizeInfo{};
@@ -54,11 +69,14 @@ namespace PXTEngine {
 
 		Shared<DescriptorAllocatorGrowable> m_descriptorAllocator;
 		Shared<DescriptorSetLayout> m_tlasDescriptorSetLayout = nullptr;
-		VkDescriptorSet m_tlasDescriptorSet = VK_NULL_HANDLE;
+		// one per frame slot, a slot still points to the previous TLAS until its frame retired
+		std::array<VkDescriptorSet, SwapChain::MAX_FRAMES_IN_FLIGHT> m_tlasDescriptorSets{};
+		std::array<bool, SwapChain::MAX_FRAMES_IN_FLIGHT> m_isTLASDescriptorSetOutdated{};
 
 		std::vector<MeshInstanceData> m_meshInstanceData;
 		Shared<DescriptorSetLayout> m_meshInstanceDescriptorSetLayout = nullptr;
 		Unique<VulkanBuffer> m_meshInstanceBuffer = nullptr;
-		VkDescriptorSet m_meshInstanceDescriptorSet = VK_NULL_HANDLE;
+		std::array<VkDescriptorSet, SwapChain::MAX_FRAMES_IN_FLIGHT> m_meshInstanceDescriptorSets{};
+		std::array<bool, SwapChain::MAX_FRAMES_IN_FLIGHT> m_isMeshInstanceDescriptorSetOutdated{};
 	};
 }
\ No newline at end of file
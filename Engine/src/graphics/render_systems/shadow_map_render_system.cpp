@@ -3,10 +3,15 @@
 #include "core/memory.hpp"
 #include "core/diagnostics.hpp"
 #include "core/constants.hpp"
+#include "utils/hash_func.hpp"
 #include "scene/ecs/entity.hpp"
 #include "graphics/resources/vk_mesh.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <limits>
 #include <stdexcept>
+#include <unordered_map>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -15,23 +20,28 @@
 
 namespace PXTEngine {
 
-    struct ShadowMapPushConstantData {
-		// it will be modified to translate the object to the light position (i think so?)
-        glm::mat4 modelMatrix{ 1.f };
-		// it will be modified to render the different faces
-		glm::mat4 cubeFaceView{ 1.f };
-    };
+	// std430 layout shared with cube_shadow_map_creation.vert
+	struct ShadowInstanceData {
+		glm::mat4 modelMatrix{ 1.f };
+		uint32_t layer = 0; // slot * 6 + face
+		uint32_t padding[3]{};
+	};
 
+	// std140 layout shared with shadow_ubo.glsl
 	struct ShadowUbo {
 		glm::mat4 projection{ 1.f };
-		// this is a matrix that translates model coordinates to light coordinates
-		glm::mat4 lightOriginModel{ 1.f };
-		PointLight pointLights[MAX_LIGHTS];
-		int numLights;
+		// view matrix of each cube face, indexed by the face of the instance
+		glm::mat4 faceViews[6];
+		// world position of the light of each slot, the vertex shader moves the vertices to the light origin
+		glm::vec4 lightPositions[ShadowMapRenderSystem::MAX_SHADOWED_LIGHTS];
 	};
 
+	// weight of a light that just moved over a static one, fades over the next frames
+	static constexpr float MOVED_LIGHT_PRIORITY_BOOST = 4.0f;
+
     ShadowMapRenderSystem::ShadowMapRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, DescriptorSetLayout& setLayout)
-		: m_context(context),
+		: m_queue(context.getJobSystem()),
+		  m_context(context),
 		  m_descriptorAllocator(std::move(descriptorAllocator)) {
 		createUniformBuffers();
 		createDescriptorSets(setLayout);
@@ -74,186 +84,178 @@ namespace PXTEngine {
 				.writeBuffer(0, &bufferInfo)
 				.updateSet(m_lightDescriptorSets[i]);
 		}
+
+		m_instanceDescriptorSetLayout = DescriptorSetLayout::Builder(m_context)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+			.build();
+
+		for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+			m_descriptorAllocator->allocate(m_instanceDescriptorSetLayout->getDescriptorSetLayout(), m_instanceDescriptorSets[i]);
+
+			// start with room for a small scene, buffers grow on demand
+			ensureInstanceCapacity(i, 256);
+		}
+	}
+
+	void ShadowMapRenderSystem::ensureInstanceCapacity(int frameIndex, uint32_t instanceCount) {
+		if (m_instanceBuffers[frameIndex] != nullptr && m_instanceBuffers[frameIndex]->getInstanceCount() >= instanceCount) {
+			return;
+		}
+
+		// the fence of this frame slot has been waited on, its buffer is no longer in use
+		m_instanceBuffers[frameIndex] = createUnique<VulkanBuffer>(
+			m_context,
+			sizeof(ShadowInstanceData),
+			std::bit_ceil(std::max(instanceCount, 1u)),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		);
+		m_instanceBuffers[frameIndex]->map();
+
+		auto bufferInfo = m_instanceBuffers[frameIndex]->descriptorInfo();
+
+		DescriptorWriter(m_context, *m_instanceDescriptorSetLayout)
+			.writeBuffer(0, &bufferInfo)
+			.updateSet(m_instanceDescriptorSets[frameIndex]);
 	}
 
     void ShadowMapRenderSystem::createRenderPass() {
-		// offscreen attachments
-		VkAttachmentDescription osAttachments[2] = {};
-
-		// Find a suitable depth format for the offscreen render pass
-		bool isDepthFormatValid = m_context.getSupportedDepthFormat(&m_offscreenDepthFormat);
-		PXT_ASSERT(isDepthFormatValid, "No depth format available");
-
-		// Color attachment
-		osAttachments[0].format = m_offscreenColorFormat;
-		osAttachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
-		osAttachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		osAttachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		osAttachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		osAttachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		osAttachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		osAttachments[0].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-		// Depth attachment
-		osAttachments[1].format = m_offscreenDepthFormat;
-		osAttachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
-		osAttachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		osAttachments[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		osAttachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		osAttachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		osAttachments[1].initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-		osAttachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-		VkAttachmentReference colorReference = {};
-		colorReference.attachment = 0;
-		colorReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		// Depth only: the cube map stores the hardware depth of each face, compared in the
+		// material shader through a samplerCubeShadow
+		m_shadowMapFormat = m_context.findSupportedFormat(
+			{ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D16_UNORM },
+			VK_IMAGE_TILING_OPTIMAL,
+			VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+			VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+
+		VkAttachmentDescription depthAttachment = {};
+		depthAttachment.format = m_shadowMapFormat;
+		depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+		// only the scheduled faces are cleared and rendered, the others keep their content
+		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		// the render graph transitions the array around the pass
+		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
 		VkAttachmentReference depthReference = {};
-		depthReference.attachment = 1;
+		depthReference.attachment = 0;
 		depthReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
 		VkSubpassDescription subpass = {};
 		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass.colorAttachmentCount = 1;
-		subpass.pColorAttachments = &colorReference;
+		subpass.colorAttachmentCount = 0;
 		subpass.pDepthStencilAttachment = &depthReference;
 
 		VkRenderPassCreateInfo renderPassCreateInfo = {};
 		renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		renderPassCreateInfo.attachmentCount = 2;
-		renderPassCreateInfo.pAttachments = osAttachments;
+		renderPassCreateInfo.attachmentCount = 1;
+		renderPassCreateInfo.pAttachments = &depthAttachment;
 		renderPassCreateInfo.subpassCount = 1;
 		renderPassCreateInfo.pSubpasses = &subpass;
+		renderPassCreateInfo.dependencyCount = 0;
+		renderPassCreateInfo.pDependencies = nullptr;
 
 		m_renderPass = createUnique<RenderPass>(
 			m_context,
 			renderPassCreateInfo,
-			osAttachments[0],
-			osAttachments[1],
+			VkAttachmentDescription{},
+			depthAttachment,
 			"ShadowMapRenderSystem Offscreen Render Pass"
 		);
     }
 
 	void ShadowMapRenderSystem::createOffscreenFrameBuffers() {
-		// For shadow mapping here we need 6 framebuffers, one for each face of the cube map
-		// The class will handle this for us. It will create image views for each face, which
-		// we can use to then create the framebuffers for this class
+		// The cube array is the only attachment, the class creates the cube array view used for sampling,
+		// a view per layer (debug window) and the layered view the framebuffer renders to.
+		// The vertex shader picks the layer of every instance.
 		m_shadowCubeMap = createShared<CubeMap>(
 			m_context, 
 			m_shadowMapSize, 
-			m_offscreenColorFormat,
-			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+			m_shadowMapFormat,
+			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			MAX_SHADOWED_LIGHTS
 		);
 
-		// ------------- Create framebuffers for each face of the cube map -------------
-
-		// The color attachment is the cube map image view (we have 6, one for each framebuffer).
-		// While the depth stencil is the same for all framebuffers. We will create the latter now
-		// and then copy the cube face image views to the framebuffer color attachments
-
-		// Depth stencil attachment
-		VkImageCreateInfo imageCreateInfo = {};
-		imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-		imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
-		imageCreateInfo.format = m_offscreenDepthFormat;
-		imageCreateInfo.extent = { m_shadowMapSize, m_shadowMapSize, 1 };
-		imageCreateInfo.mipLevels = 1;
-		imageCreateInfo.arrayLayers = 1;
-		imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-		imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-		// Image of the framebuffer is blit source
-		imageCreateInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
-		imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-		m_depthStencilImageFb = createShared<VulkanImage>(m_context, imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-		VkImageSubresourceRange subresourceRange = {};
-		subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+		// start in the sampled layout the descriptors expect, the render graph moves it from there;
+		// a face is never sampled before being rendered (the light has no slot until then)
+		VkImageSubresourceRange subresourceRange{};
+		subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
 		subresourceRange.baseMipLevel = 0;
 		subresourceRange.levelCount = 1;
-		subresourceRange.layerCount = 1;
+		subresourceRange.baseArrayLayer = 0;
+		subresourceRange.layerCount = m_shadowCubeMap->getLayerCount();
 
-		// TODO: verify source and destination access masks
-		m_depthStencilImageFb->transitionImageLayoutSingleTimeCmd(
-			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+		m_shadowCubeMap->transitionImageLayoutSingleTimeCmd(
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
 			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-			subresourceRange);
-
-		VkImageViewCreateInfo depthStencilViewInfo = {};
-		depthStencilViewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-		depthStencilViewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-		depthStencilViewInfo.format = m_offscreenDepthFormat;
-		depthStencilViewInfo.image = m_depthStencilImageFb->getVkImage();
-		depthStencilViewInfo.flags = 0;
-		depthStencilViewInfo.subresourceRange = {};
-		depthStencilViewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-		if (m_offscreenDepthFormat >= VK_FORMAT_D16_UNORM_S8_UINT) {
-			depthStencilViewInfo.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-		}
-		depthStencilViewInfo.subresourceRange.baseMipLevel = 0;
-		depthStencilViewInfo.subresourceRange.levelCount = 1;
-		depthStencilViewInfo.subresourceRange.baseArrayLayer = 0;
-		depthStencilViewInfo.subresourceRange.layerCount = 1;
-
-		m_depthStencilImageFb->createImageView(depthStencilViewInfo);
-
-		// Create framebuffers for each face of the cube map
-		VkImageView attachments[2]{};
-		attachments[1] = m_depthStencilImageFb->getImageView();
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			subresourceRange
+		);
+
+		VkImageView attachment = m_shadowCubeMap->getLayeredImageView();
 
 		VkFramebufferCreateInfo fbufCreateInfo = {};
 		fbufCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
 		fbufCreateInfo.renderPass = m_renderPass->getHandle();
-		fbufCreateInfo.attachmentCount = 2;
-		fbufCreateInfo.pAttachments = attachments;
+		fbufCreateInfo.attachmentCount = 1;
+		fbufCreateInfo.pAttachments = &attachment;
 		fbufCreateInfo.width = m_shadowMapSize;
 		fbufCreateInfo.height = m_shadowMapSize;
-		fbufCreateInfo.layers = 1;
-
-		for (uint32_t i = 0; i < 6; i++)
-		{
-			attachments[0] = m_shadowCubeMap->getFaceImageView(i);
-			
-			m_cubeFramebuffers[i] = createUnique<FrameBuffer>(
-				m_context,
-				fbufCreateInfo,
-				"ShadowMapRenderSystem Framebuffer for Cube Face " + std::to_string(i),
-				m_shadowCubeMap,
-				m_depthStencilImageFb
-			);
-		}
+		fbufCreateInfo.layers = m_shadowCubeMap->getLayerCount();
 
-		// -----------------------------------------------------------------------------
+		m_framebuffer = createUnique<FrameBuffer>(
+			m_context,
+			fbufCreateInfo,
+			"ShadowMapRenderSystem Layered Cube Array Framebuffer",
+			nullptr,
+			m_shadowCubeMap
+		);
 
-		// Create image descriptor info for shadow map
+		// Create image descriptor info for shadow map, the cube map sampler compares depths
 		m_shadowMapDescriptorInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		m_shadowMapDescriptorInfo.imageView = m_shadowCubeMap->getImageView();
 		m_shadowMapDescriptorInfo.sampler = m_shadowCubeMap->getImageSampler();
 
+		// the debug view reads the raw depth, without comparison
+		VkSamplerCreateInfo samplerInfo = {};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_NEAREST;
+		samplerInfo.minFilter = VK_FILTER_NEAREST;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = samplerInfo.addressModeU;
+		samplerInfo.addressModeW = samplerInfo.addressModeU;
+		samplerInfo.maxAnisotropy = 1.0f;
+		samplerInfo.compareOp = VK_COMPARE_OP_NEVER;
+		samplerInfo.maxLod = 1.0f;
+		samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+
+		m_debugSampler = m_context.getSampler(samplerInfo);
+
 		// Create image descriptor info for debug view
-		for (uint16_t i = 0; i < 6; i++) {
+		m_debugImageDescriptorInfos.resize(m_shadowCubeMap->getLayerCount());
+		for (uint32_t i = 0; i < m_shadowCubeMap->getLayerCount(); i++) {
 			m_debugImageDescriptorInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 			m_debugImageDescriptorInfos[i].imageView = m_shadowCubeMap->getFaceImageView(i);
-			m_debugImageDescriptorInfos[i].sampler = m_shadowCubeMap->getImageSampler();
+			m_debugImageDescriptorInfos[i].sampler = m_debugSampler;
 		}
 	}
 
     void ShadowMapRenderSystem::createPipelineLayout(DescriptorSetLayout& setLayout) {
-        VkPushConstantRange pushConstantRange{};
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-        pushConstantRange.offset = 0;
-        pushConstantRange.size = sizeof(ShadowMapPushConstantData);
-
-        std::vector<VkDescriptorSetLayout> descriptorSetLayouts{setLayout.getDescriptorSetLayout()};
+        std::vector<VkDescriptorSetLayout> descriptorSetLayouts{
+			setLayout.getDescriptorSetLayout(),
+			m_instanceDescriptorSetLayout->getDescriptorSetLayout()
+		};
 
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
         pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-        pipelineLayoutInfo.pushConstantRangeCount = 1;
-        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        pipelineLayoutInfo.pushConstantRangeCount = 0;
+        pipelineLayoutInfo.pPushConstantRanges = nullptr;
 
         if (vkCreatePipelineLayout(m_context.getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
             throw std::runtime_error("failed to create pipeline layout for shadow render system!");
@@ -268,87 +270,463 @@ namespace PXTEngine {
         pipelineConfig.renderPass = m_renderPass->getHandle();
         pipelineConfig.pipelineLayout = m_pipelineLayout;
 
+		// depth only, no fragment shader and no color attachment
+		pipelineConfig.colorBlendInfo.attachmentCount = 0;
+		pipelineConfig.colorBlendInfo.pAttachments = nullptr;
+
+		// slope scaled bias against acne, the material shader adds a small normal offset
+		pipelineConfig.rasterizationInfo.depthBiasEnable = VK_TRUE;
+		pipelineConfig.rasterizationInfo.depthBiasConstantFactor = 1.25f;
+		pipelineConfig.rasterizationInfo.depthBiasSlopeFactor = 1.75f;
+
 		const std::vector<std::pair<VkShaderStageFlagBits, std::string>>& shaderFilePaths = {
-			{VK_SHADER_STAGE_VERTEX_BIT, SPV_SHADERS_PATH + "cube_shadow_map_creation.vert.spv"},
-			{ VK_SHADER_STAGE_FRAGMENT_BIT, SPV_SHADERS_PATH + "cube_shadow_map_creation.frag.spv" }
+			{ VK_SHADER_STAGE_VERTEX_BIT, SPV_SHADERS_PATH + "cube_shadow_map_creation.vert.spv" }
 		};
 
-        m_pipeline = createUnique<Pipeline>(
-            m_context,
-			shaderFilePaths,
+        m_pipeline = m_context.getPipelineCompiler().compile(
+            shaderFilePaths,
             pipelineConfig
         );
     }
 
-	void ShadowMapRenderSystem::update(FrameInfo& frameInfo, GlobalUbo& ubo) {
-		// Get the light position from the scene and set the other ubo values for offscreen rendering
-		glm::vec4 lightPos = ubo.pointLights[0].position;
+	void ShadowMapRenderSystem::update(FrameInfo& frameInfo, GlobalUbo& ubo, std::vector<PointLight>& lights,
+		const FrustumCuller& culler, const Frustum& cameraFrustum) {
+		m_frameCounter++;
 
 		ShadowUbo uboOffscreen{};
 		// to set the projection (square depth map)
 		uboOffscreen.projection = glm::perspective(glm::pi<float>() / 2.0f, 1.0f, zNear, zFar);
-		// this will create a translation matrix to translate the model vertices by the light position
-		uboOffscreen.lightOriginModel = glm::translate(glm::mat4(1.0f), glm::vec3(-lightPos.x, -lightPos.y, -lightPos.z));
-		uboOffscreen.numLights = ubo.numLights;
 
-		// set the light position and color
-		for (int i = 0; i < ubo.numLights; i++) {
-			uboOffscreen.pointLights[i].position = ubo.pointLights[i].position;
-			uboOffscreen.pointLights[i].color = ubo.pointLights[i].color;
+		for (uint32_t face = 0; face < 6; face++) {
+			uboOffscreen.faceViews[face] = getFaceViewMatrix(face);
+		}
+
+		// the material shader rebuilds the face depth from the light vector with the same range
+		ubo.shadowNear = zNear;
+		ubo.shadowFar = zFar;
+		ubo.shadowQuality = m_shadowQuality;
+
+		assignSlots(lights, frameInfo.camera.getPosition(), cameraFrustum);
+
+		for (uint32_t slot = 0; slot < MAX_SHADOWED_LIGHTS; slot++) {
+			uboOffscreen.lightPositions[slot] = glm::vec4(m_slots[slot].lightPosition, 1.0f);
 		}
 
 		m_lightUniformBuffers[frameInfo.frameIndex]->writeToBuffer(&uboOffscreen, sizeof(ShadowUbo), 0);
 		m_lightUniformBuffers[frameInfo.frameIndex]->flush();
+
+		std::array<glm::mat4, 6> faceViewProjections;
+		for (uint32_t face = 0; face < 6; face++) {
+			faceViewProjections[face] = uboOffscreen.projection * uboOffscreen.faceViews[face];
+		}
+
+		updateDirtyFaces(frameInfo, culler, faceViewProjections);
+		scheduleFaces();
+
+		// the render pass is only added to the frame when a face is scheduled
+		if (m_scheduledFaces.empty()) {
+			m_cachedFrameCount++;
+		}
+
+		// a light casts shadows once every face of its slot holds its depth, counting the faces of this frame
+		std::array<uint8_t, MAX_SHADOWED_LIGHTS> readyFaces{};
+		for (uint32_t slot = 0; slot < MAX_SHADOWED_LIGHTS; slot++) {
+			readyFaces[slot] = m_slots[slot].renderedFaces;
+		}
+		for (const ScheduledFace& scheduled : m_scheduledFaces) {
+			readyFaces[scheduled.slot] |= static_cast<uint8_t>(1u << scheduled.face);
+		}
+
+		for (PointLight& light : lights) {
+			light.position.w = -1.0f;
+		}
+		for (uint32_t slot = 0; slot < MAX_SHADOWED_LIGHTS; slot++) {
+			if (m_slots[slot].lightIndex >= 0 && readyFaces[slot] == 0x3F) {
+				lights[m_slots[slot].lightIndex].position.w = static_cast<float>(slot);
+			}
+		}
+
+		writeInstances(frameInfo, culler);
 	}
 
-    void ShadowMapRenderSystem::render(FrameInfo& frameInfo, Renderer& renderer) {
-        m_pipeline->bind(frameInfo.commandBuffer);
-
-        vkCmdBindDescriptorSets(
-            frameInfo.commandBuffer,
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            m_pipelineLayout,
-            0,
-            1,
-            &m_lightDescriptorSets[frameInfo.frameIndex],
-            0,
-            nullptr
-        );
+	void ShadowMapRenderSystem::assignSlots(const std::vector<PointLight>& lights, const glm::vec3& cameraPosition, const Frustum& cameraFrustum) {
+		// screen contribution estimate: light intensity times the squared ratio of the shadow range
+		// to the camera distance (the range sphere covers the screen from within), 0 out of the frustum
+		std::vector<std::pair<float, int>> candidates; // contribution, light index
+		for (int i = 0; i < static_cast<int>(lights.size()); i++) {
+			const PointLight& light = lights[i];
+			const glm::vec3 position = glm::vec3(light.position);
 
-		// get all the entities with a transform and model component (for later)
-        auto view = frameInfo.scene.getEntitiesWith<TransformComponent, MeshComponent>();
+			if (!cameraFrustum.intersects(BoundingSphere{ position, zFar })) continue;
 
-		// Loop through each face of the cube map and render the scene from that perspective
-		// we need one render pass per face of the cube map, each time we modify the view matrix
-		for (uint32_t face = 0; face < 6; face++) {
+			const float intensity = light.color.w * glm::max(light.color.r, glm::max(light.color.g, light.color.b));
+			const float distance = glm::length(position - cameraPosition);
+			const float coverage = glm::min(1.0f, (zFar * zFar) / glm::max(distance * distance, zNear * zNear));
+			const float contribution = intensity * coverage;
+
+			if (contribution > 0.0f) {
+				candidates.emplace_back(contribution, i);
+			}
+		}
+
+		std::stable_sort(candidates.begin(), candidates.end(),
+			[](const auto& a, const auto& b) { return a.first > b.first; });
+		candidates.resize(std::min<size_t>(candidates.size(), MAX_SHADOWED_LIGHTS));
+
+		// selected lights keep their slot, so that their faces stay valid
+		std::array<bool, MAX_SHADOWED_LIGHTS> isSlotKept{};
+		std::vector<std::pair<float, int>> newLights;
+		for (const auto& [contribution, lightIndex] : candidates) {
+			auto it = std::find_if(m_slots.begin(), m_slots.end(),
+				[lightIndex](const ShadowSlot& slot) { return slot.lightIndex == lightIndex; });
+
+			if (it != m_slots.end()) {
+				it->contribution = contribution;
+				isSlotKept[it - m_slots.begin()] = true;
+			} else {
+				newLights.emplace_back(contribution, lightIndex);
+			}
+		}
+
+		for (uint32_t slot = 0; slot < MAX_SHADOWED_LIGHTS; slot++) {
+			if (!isSlotKept[slot]) {
+				m_slots[slot] = ShadowSlot{};
+			}
+		}
+
+		for (const auto& [contribution, lightIndex] : newLights) {
+			auto it = std::find_if(m_slots.begin(), m_slots.end(),
+				[](const ShadowSlot& slot) { return slot.lightIndex < 0; });
+
+			it->lightIndex = lightIndex;
+			it->contribution = contribution;
+			it->lightPosition = glm::vec3(lights[lightIndex].position);
+			it->lastMoveFrame = m_frameCounter;
+		}
+
+		for (ShadowSlot& slot : m_slots) {
+			if (slot.lightIndex < 0) continue;
+
+			const glm::vec3 position = glm::vec3(lights[slot.lightIndex].position);
+			if (position != slot.lightPosition) {
+				slot.lightPosition = position;
+				slot.lastMoveFrame = m_frameCounter;
+			}
+		}
+	}
+
+	void ShadowMapRenderSystem::updateDirtyFaces(FrameInfo& frameInfo, const FrustumCuller& culler,
+		const std::array<glm::mat4, 6>& faceViewProjections) {
+		auto view = frameInfo.scene.getEntitiesWith<WorldBoundsComponent>();
+		const std::vector<entt::entity>& renderables = culler.getRenderables();
+
+		for (ShadowSlot& slot : m_slots) {
+			if (slot.lightIndex < 0) continue;
+
+			// same transform chain as the shadow vertex shader
+			const glm::mat4 lightOrigin = glm::translate(glm::mat4(1.0f), -slot.lightPosition);
+
+			std::array<Frustum, 6> faceFrusta;
+			for (uint32_t face = 0; face < 6; face++) {
+				faceFrusta[face] = Frustum::fromMatrix(faceViewProjections[face] * lightOrigin);
+			}
+
+			culler.cull(faceFrusta, slot.faceMasks);
+
+			// a face depends on the light, the depth range, the LOD bias and the casters touching it;
+			// a caster moving, entering or leaving the face changes the hash
+			std::array<size_t, 6> hashes{};
+			for (size_t& hash : hashes) {
+				hashCombine(hash, slot.lightPosition.x, slot.lightPosition.y, slot.lightPosition.z, zNear, zFar, m_lodBias);
+			}
 
-			renderer.beginRenderPass(frameInfo.commandBuffer, *m_renderPass, this->getCubeFaceFramebuffer(face), this->getExtent());
+			for (size_t i = 0; i < renderables.size(); i++) {
+				const uint8_t mask = slot.faceMasks[i];
+				if (mask == 0 || !view.contains(renderables[i])) continue;
 
-			ShadowMapPushConstantData push{};
-			push.cubeFaceView = this->getFaceViewMatrix(face);
+				const uint32_t entityId = static_cast<uint32_t>(renderables[i]);
+				const uint32_t boundsVersion = view.get<WorldBoundsComponent>(renderables[i]).version;
 
-			for (auto entity : view) {
+				for (uint32_t face = 0; face < 6; face++) {
+					if ((mask >> face) & 1u) {
+						hashCombine(hashes[face], entityId, boundsVersion);
+					}
+				}
+			}
+
+			for (uint32_t face = 0; face < 6; face++) {
+				slot.faceHashes[face] = hashes[face];
+
+				const uint8_t faceBit = static_cast<uint8_t>(1u << face);
+				const bool isDirty = !m_isCachingEnabled || !(slot.renderedFaces & faceBit) ||
+					slot.faceHashes[face] != slot.renderedFaceHashes[face];
+
+				if (!isDirty) {
+					slot.dirtyFaces &= static_cast<uint8_t>(~faceBit);
+				} else if (!(slot.dirtyFaces & faceBit)) {
+					slot.dirtyFaces |= faceBit;
+					slot.dirtySinceFrame[face] = m_frameCounter;
+				}
+			}
+		}
+	}
+
+	void ShadowMapRenderSystem::scheduleFaces() {
+		struct Candidate {
+			ScheduledFace face;
+			bool isMissing; // never rendered since the light took the slot, the light casts no shadow until then
+			float priority;
+		};
+
+		std::vector<Candidate> candidates;
+		for (uint32_t slotIndex = 0; slotIndex < MAX_SHADOWED_LIGHTS; slotIndex++) {
+			const ShadowSlot& slot = m_slots[slotIndex];
+			if (slot.lightIndex < 0) continue;
+
+			const float framesSinceMove = static_cast<float>(m_frameCounter - slot.lastMoveFrame);
+			const float motionWeight = 1.0f + MOVED_LIGHT_PRIORITY_BOOST / (1.0f + framesSinceMove);
+
+			for (uint32_t face = 0; face < 6; face++) {
+				if (!((slot.dirtyFaces >> face) & 1u)) continue;
+
+				// waiting faces gain priority, so that faces of dim lights are eventually refreshed
+				const float framesWaiting = static_cast<float>(m_frameCounter - slot.dirtySinceFrame[face]);
+
+				Candidate& candidate = candidates.emplace_back();
+				candidate.face = { slotIndex, face };
+				candidate.isMissing = !((slot.renderedFaces >> face) & 1u);
+				candidate.priority = slot.contribution * motionWeight * (1.0f + framesWaiting);
+			}
+		}
+
+		std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+			if (a.isMissing != b.isMissing) return a.isMissing;
+			return a.priority > b.priority;
+		});
+
+		m_scheduledFaces.clear();
+		const size_t budget = std::min(candidates.size(), static_cast<size_t>(std::max(m_faceBudget, 1)));
+		for (size_t i = 0; i < budget; i++) {
+			m_scheduledFaces.push_back(candidates[i].face);
+		}
+	}
+
+	void ShadowMapRenderSystem::writeInstances(FrameInfo& frameInfo, const FrustumCuller& culler) {
+		std::array<uint8_t, MAX_SHADOWED_LIGHTS> scheduledMasks{};
+		for (const ScheduledFace& scheduled : m_scheduledFaces) {
+			scheduledMasks[scheduled.slot] |= static_cast<uint8_t>(1u << scheduled.face);
+		}
+
+		const std::vector<entt::entity>& renderables = culler.getRenderables();
+		const uint32_t renderableCount = static_cast<uint32_t>(renderables.size());
+
+		m_cullingStats = {};
+		for (uint32_t slot = 0; slot < MAX_SHADOWED_LIGHTS; slot++) {
+			for (uint32_t face = 0; face < 6; face++) {
+				if (!((scheduledMasks[slot] >> face) & 1u)) continue;
 
-				const auto& [transform, meshComponent] = view.get<TransformComponent, MeshComponent>(entity);
+				uint32_t visible = 0;
+				for (uint8_t mask : m_slots[slot].faceMasks) {
+					visible += (mask >> face) & 1u;
+				}
+				m_cullingStats.visible += visible;
+				m_cullingStats.culled += renderableCount - visible;
+			}
+		}
 
-				push.modelMatrix = transform.mat4();
+		m_drawMeshes.clear();
+		m_draws.clear();
+		m_queue.clear();
 
-				vkCmdPushConstants(
-					frameInfo.commandBuffer,
-					m_pipelineLayout,
-					VK_SHADER_STAGE_VERTEX_BIT,
-					0,
-					sizeof(ShadowMapPushConstantData),
-					&push);
+		if (m_scheduledFaces.empty()) {
+			return;
+		}
 
-				auto vulkanModel = std::static_pointer_cast<VulkanMesh>(meshComponent.mesh);
+		// group the objects by mesh, then front to back from their light
+		auto view = frameInfo.scene.getEntitiesWith<TransformComponent, MeshComponent, WorldBoundsComponent>();
+
+		struct DrawRenderable {
+			uint32_t meshIndex;
+			uint32_t renderableIndex;
+			uint32_t slot;
+			uint8_t faces; // scheduled faces of the slot the renderable touches
+		};
 
-				vulkanModel->bind(frameInfo.commandBuffer);
-				vulkanModel->draw(frameInfo.commandBuffer);
+		std::unordered_map<const Mesh*, uint32_t> meshLookup;
+		std::vector<DrawRenderable> drawRenderables;
+
+		for (uint32_t slot = 0; slot < MAX_SHADOWED_LIGHTS; slot++) {
+			if (scheduledMasks[slot] == 0) continue;
+
+			const std::vector<uint8_t>& faceMasks = m_slots[slot].faceMasks;
+
+			for (uint32_t i = 0; i < renderableCount; i++) {
+				const uint8_t faces = faceMasks[i] & scheduledMasks[slot];
+				if (faces == 0 || !view.contains(renderables[i])) continue;
+
+				const auto& meshComponent = view.get<MeshComponent>(renderables[i]);
+
+				auto [it, isNew] = meshLookup.try_emplace(meshComponent.mesh.get(), static_cast<uint32_t>(m_drawMeshes.size()));
+				if (isNew) {
+					m_drawMeshes.push_back(std::static_pointer_cast<VulkanMesh>(meshComponent.mesh));
+				}
+
+				drawRenderables.push_back({ it->second, i, slot, faces });
 			}
+		}
+
+		PXT_ASSERT(m_drawMeshes.size() <= (1u << RenderQueue::MESH_BITS), "Too many shadow meshes for the sort keys");
+
+		for (uint32_t i = 0; i < drawRenderables.size(); i++) {
+			const DrawRenderable& drawRenderable = drawRenderables[i];
+			const auto& worldBounds = view.get<WorldBoundsComponent>(renderables[drawRenderable.renderableIndex]);
 
-			renderer.endRenderPass(frameInfo.commandBuffer, *m_renderPass, this->getCubeFaceFramebuffer(face));
+			const float distance = glm::length(worldBounds.bounds.sphere.center - m_slots[drawRenderable.slot].lightPosition) -
+				worldBounds.bounds.sphere.radius;
+			m_queue.push(RenderQueue::makeKey(0, 0, 0, drawRenderable.meshIndex, RenderQueue::quantizeDepth(distance)), i);
 		}
+
+		m_queue.sort();
+
+		uint32_t instanceCount = 0;
+		for (const DrawRenderable& drawRenderable : drawRenderables) {
+			instanceCount += static_cast<uint32_t>(std::popcount(drawRenderable.faces));
+		}
+
+		const int frameIndex = frameInfo.frameIndex;
+		ensureInstanceCapacity(frameIndex, instanceCount);
+
+		auto* instances = static_cast<ShadowInstanceData*>(m_instanceBuffers[frameIndex]->getMappedMemory());
+
+		// m_draws follows drawRenderables, the instances follow the sorted queue
+		m_draws.resize(drawRenderables.size());
+
+		uint32_t instanceIndex = 0;
+		for (const RenderQueue::Item& item : m_queue.getItems()) {
+			const DrawRenderable& drawRenderable = drawRenderables[item.payload];
+			const auto& [transform, worldBounds] = view.get<TransformComponent, WorldBoundsComponent>(renderables[drawRenderable.renderableIndex]);
+			const glm::mat4 modelMatrix = transform.mat4();
+
+			// 90 degrees fov, the projection scale is 1
+			const Shared<VulkanMesh>& mesh = m_drawMeshes[drawRenderable.meshIndex];
+			const uint32_t lodIndex = mesh->selectLod(worldBounds.bounds.sphere, transform.maxScale(),
+				m_slots[drawRenderable.slot].lightPosition, 1.0f, Mesh::DEFAULT_LOD_ERROR_THRESHOLD, static_cast<uint32_t>(m_lodBias));
+			const Mesh::Lod& lod = mesh->getLods()[lodIndex];
+
+			ShadowDraw& draw = m_draws[item.payload];
+			draw.meshIndex = drawRenderable.meshIndex;
+			draw.firstIndex = lod.firstIndex;
+			draw.indexCount = lod.indexCount;
+			draw.firstInstance = instanceIndex;
+
+			for (uint32_t face = 0; face < 6; face++) {
+				if ((drawRenderable.faces >> face) & 1u) {
+					instances[instanceIndex].modelMatrix = modelMatrix;
+					instances[instanceIndex].layer = drawRenderable.slot * 6 + face;
+					instanceIndex++;
+				}
+			}
+
+			draw.instanceCount = instanceIndex - draw.firstInstance;
+		}
+	}
+
+    void ShadowMapRenderSystem::render(FrameInfo& frameInfo, Renderer& renderer, ParallelCommandRecorder* recorder) {
+		// the other faces keep their content between frames
+		if (m_scheduledFaces.empty()) {
+			return;
+		}
+
+		// the pass loads the array, clear the layers rendered this frame
+		auto clearScheduledFaces = [&](VkCommandBuffer commandBuffer) {
+			VkClearAttachment clearAttachment{};
+			clearAttachment.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+			clearAttachment.clearValue.depthStencil = { 1.0f, 0 };
+
+			std::vector<VkClearRect> clearRects;
+			clearRects.reserve(m_scheduledFaces.size());
+			for (const ScheduledFace& scheduled : m_scheduledFaces) {
+				VkClearRect& rect = clearRects.emplace_back();
+				rect.rect = { { 0, 0 }, getExtent() };
+				rect.baseArrayLayer = scheduled.slot * 6 + scheduled.face;
+				rect.layerCount = 1;
+			}
+
+			vkCmdClearAttachments(commandBuffer, 1, &clearAttachment,
+				static_cast<uint32_t>(clearRects.size()), clearRects.data());
+		};
+
+		auto recordDraws = [&](FrameInfo& drawFrameInfo, uint32_t begin, uint32_t end) {
+			const std::array<VkDescriptorSet, 2> descriptorSets = {
+				m_lightDescriptorSets[drawFrameInfo.frameIndex],
+				m_instanceDescriptorSets[drawFrameInfo.frameIndex]
+			};
+
+			vkCmdBindDescriptorSets(
+				drawFrameInfo.commandBuffer,
+				VK_PIPELINE_BIND_POINT_GRAPHICS,
+				m_pipelineLayout,
+				0,
+				static_cast<uint32_t>(descriptorSets.size()),
+				descriptorSets.data(),
+				0,
+				nullptr
+			);
+
+			m_queue.record({
+				.bindPipeline = [&](const RenderQueue::Item&) {
+					m_pipeline->bind(drawFrameInfo.commandBuffer);
+				},
+				.bindMesh = [&](const RenderQueue::Item& item) {
+					m_drawMeshes[RenderQueue::getMesh(item.key)]->bind(drawFrameInfo.commandBuffer);
+				},
+				.draw = [&](const RenderQueue::Item& item) {
+					const ShadowDraw& draw = m_draws[item.payload];
+
+					vkCmdDrawIndexed(drawFrameInfo.commandBuffer, draw.indexCount, draw.instanceCount,
+						draw.firstIndex, 0, draw.firstInstance);
+				}
+			}, begin, end);
+		};
+
+		// the recording threads only read the pipeline
+		m_pipeline.get();
+
+		// a single pass over the layers of the array, each instance is routed to its face by the vertex shader
+		if (recorder) {
+			renderer.beginRenderPass(frameInfo.commandBuffer, *m_renderPass, *m_framebuffer, this->getExtent(),
+				VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+			const ParallelCommandRecorder::PassInfo passInfo{
+				m_renderPass->getHandle(), m_framebuffer->getHandle(), getExtent()
+			};
+
+			recorder->record(frameInfo, passInfo, [&](FrameInfo& clearFrameInfo) {
+				clearScheduledFaces(clearFrameInfo.commandBuffer);
+			});
+			recorder->record(frameInfo, passInfo, m_queue.getSize(), ParallelCommandRecorder::DEFAULT_MIN_CHUNK_SIZE,
+				recordDraws);
+		} else {
+			renderer.beginRenderPass(frameInfo.commandBuffer, *m_renderPass, *m_framebuffer, this->getExtent());
+
+			clearScheduledFaces(frameInfo.commandBuffer);
+			recordDraws(frameInfo, 0, m_queue.getSize());
+		}
+
+		renderer.endRenderPass(frameInfo.commandBuffer, *m_renderPass, *m_framebuffer);
+
+		// the faces are valid for the state they were scheduled with
+		for (const ScheduledFace& scheduled : m_scheduledFaces) {
+			ShadowSlot& slot = m_slots[scheduled.slot];
+			const uint8_t faceBit = static_cast<uint8_t>(1u << scheduled.face);
+
+			slot.renderedFaceHashes[scheduled.face] = slot.faceHashes[scheduled.face];
+			slot.renderedFaces |= faceBit;
+			slot.dirtyFaces &= static_cast<uint8_t>(~faceBit);
+		}
+
+		m_renderedFaceCount += static_cast<uint32_t>(m_scheduledFaces.size());
+		m_scheduledFaces.clear();
     }
 
 	glm::mat4 ShadowMapRenderSystem::getFaceViewMatrix(uint32_t faceIndex) {
@@ -385,7 +763,8 @@ namespace PXTEngine {
 			.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
 			.build();
 
-		// Create descriptor set for each face of the cube map
+		// Create descriptor set for each face of the cube map array
+		m_shadowMapDebugDescriptorSets.resize(m_debugImageDescriptorInfos.size());
 		for (int i = 0; i < m_debugImageDescriptorInfos.size(); i++) {
 			m_descriptorAllocator->allocate(debugSetLayout->getDescriptorSetLayout(), m_shadowMapDebugDescriptorSets[i]);
 			DescriptorWriter(m_context, *debugSetLayout)
@@ -399,12 +778,37 @@ namespace PXTEngine {
 	}
 
 	void ShadowMapRenderSystem::updateShadowCubeMapDebugWindow() {
-		ImTextureID cube_posx = (ImTextureID)m_shadowMapDebugDescriptorSets[0];
-		ImTextureID cube_negx = (ImTextureID)m_shadowMapDebugDescriptorSets[1];
-		ImTextureID cube_posy = (ImTextureID)m_shadowMapDebugDescriptorSets[3]; // swap negative and positive y because vulkan :)
-		ImTextureID cube_negy = (ImTextureID)m_shadowMapDebugDescriptorSets[2];
-		ImTextureID cube_posz = (ImTextureID)m_shadowMapDebugDescriptorSets[4];
-		ImTextureID cube_negz = (ImTextureID)m_shadowMapDebugDescriptorSets[5];
+		ImGui::Begin("Shadow Cube Map Debug");
+
+		// shadows tolerate coarser geometry than the main view
+		ImGui::SliderInt("Shadow LOD Bias", &m_lodBias, 0, 3);
+		ImGui::Combo("PCF Quality", &m_shadowQuality, "Low (1 tap)\0Medium (8 taps)\0High (16 taps)\0");
+
+		// re-render only the faces whose light or casters changed, at most the budget per frame
+		ImGui::Checkbox("Cache Shadow Faces", &m_isCachingEnabled);
+		ImGui::SliderInt("Face Budget", &m_faceBudget, 1, static_cast<int>(MAX_SHADOWED_LIGHTS * 6));
+		ImGui::Text("Rendered %u faces, %u frames without rendering", m_renderedFaceCount, m_cachedFrameCount);
+
+		for (uint32_t slot = 0; slot < MAX_SHADOWED_LIGHTS; slot++) {
+			const ShadowSlot& shadowSlot = m_slots[slot];
+			if (shadowSlot.lightIndex < 0) {
+				ImGui::Text("Slot %u: free", slot);
+			} else {
+				ImGui::Text("Slot %u: light %d, contribution %.2f, %d/6 faces rendered, %d dirty", slot,
+					shadowSlot.lightIndex, shadowSlot.contribution, std::popcount(shadowSlot.renderedFaces),
+					std::popcount(shadowSlot.dirtyFaces));
+			}
+		}
+
+		ImGui::SliderInt("Debug Slot", &m_debugSlot, 0, static_cast<int>(MAX_SHADOWED_LIGHTS) - 1);
+
+		const uint32_t firstLayer = static_cast<uint32_t>(m_debugSlot) * 6;
+		ImTextureID cube_posx = (ImTextureID)m_shadowMapDebugDescriptorSets[firstLayer + 0];
+		ImTextureID cube_negx = (ImTextureID)m_shadowMapDebugDescriptorSets[firstLayer + 1];
+		ImTextureID cube_posy = (ImTextureID)m_shadowMapDebugDescriptorSets[firstLayer + 3]; // swap negative and positive y because vulkan :)
+		ImTextureID cube_negy = (ImTextureID)m_shadowMapDebugDescriptorSets[firstLayer + 2];
+		ImTextureID cube_posz = (ImTextureID)m_shadowMapDebugDescriptorSets[firstLayer + 4];
+		ImTextureID cube_negz = (ImTextureID)m_shadowMapDebugDescriptorSets[firstLayer + 5];
 
 		/* Render the shadow cube map textures flat out in this format (with y mirrored):
 		//       +----+
@@ -416,8 +820,6 @@ namespace PXTEngine {
 				 +----+
 		*/
 
-		ImGui::Begin("Shadow Cube Map Debug");
-
 		ImVec2 faceSize = ImVec2(128, 128);
 		float spacing = ImGui::GetStyle().ItemSpacing.x;
 		float totalMiddleRowWidth = faceSize.x * 4 + spacing * 3;
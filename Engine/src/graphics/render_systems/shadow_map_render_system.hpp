@@ -2,53 +2,186 @@
 
 #include "core/memory.hpp"
 #include "graphics/pipeline.hpp"
+#include "graphics/parallel_command_recorder.hpp"
+#include "graphics/pipeline_compiler.hpp"
 #include "graphics/renderer.hpp"
 #include "graphics/swap_chain.hpp"
 #include "graphics/context/context.hpp"
 #include "graphics/frame_info.hpp"
+#include "graphics/render_queue.hpp"
 #include "graphics/resources/vk_buffer.hpp"
 #include "graphics/resources/cube_map.hpp"
+#include "graphics/resources/vk_mesh.hpp"
 #include "graphics/descriptors/descriptors.hpp"
 #include "graphics/render_pass.hpp"
+#include "scene/frustum_culler.hpp"
+
+#include <array>
+#include <vector>
 
 namespace PXTEngine {
+
+	/**
+	 * @class ShadowMapRenderSystem
+	 *
+	 * @brief Point light shadows in a depth cube map array, one cube (slot) per shadowed light.
+	 *
+	 * The lights with the largest estimated screen contribution get a slot, up to MAX_SHADOWED_LIGHTS.
+	 * Every frame the faces whose content changed (light moved, caster moved, entered or left the face)
+	 * are marked dirty and at most m_faceBudget of them are rendered, the most important first:
+	 * faces never rendered since their light took the slot, then by light contribution, by how recently
+	 * the light moved and by how long the face has been waiting. A light casts shadows once all the
+	 * faces of its slot have been rendered; the position.w of the light holds its slot, or -1.
+	 */
     class ShadowMapRenderSystem {
     public:
+		static constexpr uint32_t MAX_SHADOWED_LIGHTS = 4; // mirrored in shadow_ubo.glsl
+
         ShadowMapRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, DescriptorSetLayout& setLayout);
         ~ShadowMapRenderSystem();
 
         ShadowMapRenderSystem(const ShadowMapRenderSystem&) = delete;
         ShadowMapRenderSystem& operator=(const ShadowMapRenderSystem&) = delete;
 
-		void update(FrameInfo& frameInfo, GlobalUbo& ubo);
-        void render(FrameInfo& frameInfo, Renderer& renderer);
+		/**
+		 * @brief Assigns the shadow slots, finds the dirty faces, schedules the faces of the frame
+		 * and writes one shadow instance per object and scheduled face it touches.
+		 *
+		 * @param frameInfo The frame info.
+		 * @param ubo The global ubo, receives the shadow projection range and quality.
+		 * @param lights Every point light of the scene. Receives the shadow slot of every light.
+		 * @param culler The culler, with the renderables of the frame gathered.
+		 * @param cameraFrustum The camera frustum, lights whose range is out of it get no slot.
+		 */
+		void update(FrameInfo& frameInfo, GlobalUbo& ubo, std::vector<PointLight>& lights,
+			const FrustumCuller& culler, const Frustum& cameraFrustum);
+
+		/**
+		 * @brief Renders the scheduled faces in a single layered render pass over the cube array.
+		 * Every object is drawn once per slot, instanced over the scheduled faces it touches; the vertex
+		 * shader routes each instance to its layer with gl_Layer. The other faces keep their content.
+		 * Nothing is recorded when no face was scheduled. The cube array must be in
+		 * VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, the caller transitions it.
+		 *
+		 * @param frameInfo The frame info.
+		 * @param renderer The renderer, begins and ends the pass.
+		 * @param recorder When set, the draws are split over its threads into secondary buffers.
+		 */
+        void render(FrameInfo& frameInfo, Renderer& renderer, ParallelCommandRecorder* recorder = nullptr);
+
+		/**
+		 * @brief True if the last update scheduled at least one face.
+		 */
+		bool isShadowMapDirty() const { return !m_scheduledFaces.empty(); }
+
         void updateUi();
 
-		FrameBuffer& getCubeFaceFramebuffer(uint32_t face_index) const { return *m_cubeFramebuffers[face_index]; }
+		FrameBuffer& getFramebuffer() const { return *m_framebuffer; }
 		VkExtent2D getExtent() const { return { m_shadowMapSize, m_shadowMapSize }; }
 		VkDescriptorImageInfo getShadowMapImageInfo() const { return m_shadowMapDescriptorInfo; }
-        std::array<VkDescriptorImageInfo, 6> getDebugShadowMapImageInfos() const { return m_debugImageDescriptorInfos; }
+		Shared<VulkanImage> getShadowMapImage() const { return m_shadowCubeMap; }
+		uint32_t getShadowMapLayerCount() const { return m_shadowCubeMap->getLayerCount(); }
+
+		/**
+		 * @brief Visible and culled draws summed over the faces scheduled by the last update.
+		 */
+		FrustumCuller::Stats getCullingStats() const { return m_cullingStats; }
+		const RenderQueue::Stats& getQueueStats() const { return m_queue.getStats(); }
 
     private:
+		/**
+		 * @struct ShadowDraw
+		 *
+		 * @brief One object drawn to instanceCount faces of a slot, its instances are contiguous in the instance buffer.
+		 */
+		struct ShadowDraw {
+			uint32_t meshIndex = 0;
+			uint32_t firstIndex = 0;
+			uint32_t indexCount = 0;
+			uint32_t firstInstance = 0;
+			uint32_t instanceCount = 0;
+		};
+
+		/**
+		 * @struct ShadowSlot
+		 *
+		 * @brief A cube of the array and the light rendered into it.
+		 * A face is dirty when its content hash differs from the hash it was rendered with.
+		 */
+		struct ShadowSlot {
+			int lightIndex = -1; // index in the light list, -1 when the slot is free
+			glm::vec3 lightPosition{ 0.0f };
+			float contribution = 0.0f;
+			uint32_t lastMoveFrame = 0;
+
+			// bit i set when the renderable touches face i, indexed like the culler renderables
+			std::vector<uint8_t> faceMasks;
+
+			std::array<size_t, 6> faceHashes{};
+			std::array<size_t, 6> renderedFaceHashes{};
+			std::array<uint32_t, 6> dirtySinceFrame{};
+			uint8_t dirtyFaces = 0;
+			uint8_t renderedFaces = 0; // faces rendered at least once since the light took the slot
+		};
+
+		/**
+		 * @struct ScheduledFace
+		 *
+		 * @brief A face rendered this frame.
+		 */
+		struct ScheduledFace {
+			uint32_t slot = 0;
+			uint32_t face = 0;
+		};
+
         void createUniformBuffers();
 		void createDescriptorSets(DescriptorSetLayout& setLayout);
+		void ensureInstanceCapacity(int frameIndex, uint32_t instanceCount);
         void createRenderPass();
         void createOffscreenFrameBuffers();
         void createPipelineLayout(DescriptorSetLayout& setLayout);
         void createPipeline();
 
+		void assignSlots(const std::vector<PointLight>& lights, const glm::vec3& cameraPosition, const Frustum& cameraFrustum);
+		void updateDirtyFaces(FrameInfo& frameInfo, const FrustumCuller& culler, const std::array<glm::mat4, 6>& faceViewProjections);
+		void scheduleFaces();
+		void writeInstances(FrameInfo& frameInfo, const FrustumCuller& culler);
+
         void createDebugDescriptorSets();
         void updateShadowCubeMapDebugWindow();
 
         glm::mat4 getFaceViewMatrix(uint32_t faceIndex);
         
-        const uint32_t m_shadowMapSize{ 4096 };
+		// 4 slots of 2048^2 D32 faces take as much memory as the former single 4096^2 cube
+        const uint32_t m_shadowMapSize{ 2048 };
 
 		// Defines the depth range used for the shadow maps
         // This should be kept as small as possible for precision
 		float zNear{ 0.1f };
         float zFar{ 50.0f };
 
+		// number of LODs to step down from the screen-space selection for shadow casters
+		int m_lodBias = 1;
+		// PCF taps of the material shader lookup: 0 = 1 hardware PCF tap, 1 = 8 Poisson taps, 2 = 16 Poisson taps
+		int m_shadowQuality = 1;
+		// maximum number of cube faces rendered per frame
+		int m_faceBudget = 6;
+		// when disabled every face of every slot is dirty every frame, the budget still applies
+		bool m_isCachingEnabled = true;
+
+		std::array<ShadowSlot, MAX_SHADOWED_LIGHTS> m_slots{};
+		std::vector<ScheduledFace> m_scheduledFaces;
+		uint32_t m_frameCounter = 0;
+
+		FrustumCuller::Stats m_cullingStats{};
+		uint32_t m_renderedFaceCount = 0;
+		uint32_t m_cachedFrameCount = 0;
+
+		// draws of the frame, sorted by mesh so that each mesh is bound once
+		std::vector<Shared<VulkanMesh>> m_drawMeshes;
+		std::vector<ShadowDraw> m_draws;
+		RenderQueue m_queue; // the payloads index m_draws, the mesh fields m_drawMeshes
+
         Context& m_context;
 
 		Shared<DescriptorAllocatorGrowable> m_descriptorAllocator;
@@ -56,20 +189,25 @@ namespace PXTEngine {
         std::array<Unique<VulkanBuffer>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_lightUniformBuffers;
         std::array<VkDescriptorSet, SwapChain::MAX_FRAMES_IN_FLIGHT> m_lightDescriptorSets;
 
+		Unique<DescriptorSetLayout> m_instanceDescriptorSetLayout{};
+		std::array<Unique<VulkanBuffer>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_instanceBuffers;
+		std::array<VkDescriptorSet, SwapChain::MAX_FRAMES_IN_FLIGHT> m_instanceDescriptorSets{};
+
         Shared<CubeMap> m_shadowCubeMap;
 		VkDescriptorImageInfo m_shadowMapDescriptorInfo{ VK_NULL_HANDLE };
-		std::array<VkDescriptorImageInfo, 6> m_debugImageDescriptorInfos;
-		std::array<VkDescriptorSet, 6> m_shadowMapDebugDescriptorSets;
+		VkSampler m_debugSampler = VK_NULL_HANDLE;
+		// one per layer (slot * 6 + face) of the cube array
+		std::vector<VkDescriptorImageInfo> m_debugImageDescriptorInfos;
+		std::vector<VkDescriptorSet> m_shadowMapDebugDescriptorSets;
+		int m_debugSlot = 0;
 
 		Unique<RenderPass> m_renderPass = nullptr;
-		// The framebuffer used for the offscreen render pass. They are created from the 
-		// shadowCubeMap image views (see createOffscreenFrameBuffers)
-        std::array<Unique<FrameBuffer>, 6> m_cubeFramebuffers;
-		Shared<VulkanImage> m_depthStencilImageFb;
-        VkFormat m_offscreenDepthFormat{ VK_FORMAT_UNDEFINED };
-		VkFormat m_offscreenColorFormat{ VK_FORMAT_R32_SFLOAT };
-
-        Unique<Pipeline> m_pipeline;
+		// The layered depth only framebuffer used for the offscreen render pass, created from the
+		// shadowCubeMap layered view (see createOffscreenFrameBuffers)
+        Unique<FrameBuffer> m_framebuffer;
+        VkFormat m_shadowMapFormat{ VK_FORMAT_UNDEFINED };
+
+        PendingPipeline m_pipeline;
         VkPipelineLayout m_pipelineLayout;
     };
-}
\ No newline at end of file
+}
@@ -78,8 +78,7 @@ namespace PXTEngine {
             {VK_SHADER_STAGE_FRAGMENT_BIT, SPV_SHADERS_PATH + "skybox.frag.spv"}
         };
 
-        m_pipeline = createUnique<Pipeline>(
-            m_context,
+        m_pipeline = m_context.getPipelineCompiler().compile(
             shaderFilePaths,
             pipelineConfig
         ); 
@@ -2,6 +2,7 @@
 
 #include "graphics/context/context.hpp"
 #include "graphics/pipeline.hpp"
+#include "graphics/pipeline_compiler.hpp"
 #include "graphics/resources/vk_skybox.hpp"
 #include "graphics/descriptors/descriptors.hpp"
 #include "graphics/frame_info.hpp"
@@ -37,7 +38,7 @@ namespace PXTEngine {
         Context& m_context;
         Shared<VulkanSkybox> m_skybox;
 
-        Unique<Pipeline> m_pipeline;
+        PendingPipeline m_pipeline;
         VkPipelineLayout m_pipelineLayout;
     };
 
@@ -58,7 +58,7 @@ namespace PXTEngine {
 		initInfo.Queue = m_context.getGraphicsQueue();
 		initInfo.RenderPass = renderPass;
 		initInfo.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
-		initInfo.PipelineCache = VK_NULL_HANDLE;
+		initInfo.PipelineCache = m_context.getPipelineCache();
 		initInfo.DescriptorPool = m_imGuiPool->getDescriptorPool();
 		initInfo.Allocator = nullptr;
 		initInfo.MinImageCount = SwapChain::MAX_FRAMES_IN_FLIGHT;
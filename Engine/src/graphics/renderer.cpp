@@ -22,7 +22,6 @@ namespace PXTEngine {
             extent = m_window.getExtent();
             glfwWaitEvents();
         }
-        vkDeviceWaitIdle(m_context.getDevice());
 
         if (m_swapChain == nullptr) {
             m_swapChain = createUnique<SwapChain>(m_context, extent);
@@ -33,6 +32,10 @@ namespace PXTEngine {
             if (!oldSwapChain->compareSwapFormats(*m_swapChain.get())) {
                 throw std::runtime_error("Swap chain image (format, color space, or size) has changed, not handled yet!");
             }
+
+            // the frames in flight may still render to its framebuffers and present its images;
+            // its present semaphores are its own, the new swap chain never signals them
+            m_context.getDeletionQueue().push(std::move(oldSwapChain));
         }
     }
 
@@ -76,6 +79,9 @@ namespace PXTEngine {
 
         m_isFrameStarted = true;
 
+        // the fence of the frame slot has been waited on, the objects it retired can go
+        m_context.getDeletionQueue().beginFrame(SwapChain::MAX_FRAMES_IN_FLIGHT);
+
         auto commandBuffer = getCurrentCommandBuffer();
 
         VkCommandBufferBeginInfo beginInfo{};
@@ -144,7 +150,8 @@ namespace PXTEngine {
         vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
     }
 
-    void Renderer::beginRenderPass(VkCommandBuffer commandBuffer, RenderPass& renderPass, FrameBuffer& frameBuffer, VkExtent2D extent) {
+    void Renderer::beginRenderPass(VkCommandBuffer commandBuffer, RenderPass& renderPass, FrameBuffer& frameBuffer, VkExtent2D extent,
+        VkSubpassContents contents) {
         PXT_ASSERT(m_isFrameStarted, "Can't begin render pass when frame is not in progress.");
         PXT_ASSERT(commandBuffer == getCurrentCommandBuffer(), "Can't begin render pass on command buffer from a different frame.");
 
@@ -156,28 +163,37 @@ namespace PXTEngine {
 		renderPassInfo.renderArea.offset = { 0, 0 };
 		renderPassInfo.renderArea.extent = extent;
 
+		// the depth attachment comes after the color one, when there is one
 		std::array<VkClearValue, 2> clearValues{};
-		clearValues[0].color = { 1.0f, 1.0f, 1.0f, 1.0f };
-		clearValues[1].depthStencil = { 1.0f, 0 };
+		uint32_t clearValueCount = 0;
+		if (frameBuffer.hasColorAttachment()) {
+			clearValues[clearValueCount++].color = { 1.0f, 1.0f, 1.0f, 1.0f };
+		}
+		clearValues[clearValueCount++].depthStencil = { 1.0f, 0 };
 
-		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+		renderPassInfo.clearValueCount = clearValueCount;
 		renderPassInfo.pClearValues = clearValues.data();
 
-		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-        VkViewport viewport{};
-        viewport.x = 0.0f;
-        viewport.y = 0.0f;
-        viewport.width = static_cast<float>(extent.width);
-        viewport.height = static_cast<float>(extent.height);
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
-        VkRect2D scissor{ {0, 0}, extent };
-        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+
+        // only vkCmdExecuteCommands can be recorded in a pass made of secondary buffers
+        if (contents == VK_SUBPASS_CONTENTS_INLINE) {
+            VkViewport viewport{};
+            viewport.x = 0.0f;
+            viewport.y = 0.0f;
+            viewport.width = static_cast<float>(extent.width);
+            viewport.height = static_cast<float>(extent.height);
+            viewport.minDepth = 0.0f;
+            viewport.maxDepth = 1.0f;
+            VkRect2D scissor{ {0, 0}, extent };
+            vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+            vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+        }
 
         // renderPass begins, so the image will be transitioned to the initial layout
-		frameBuffer.getColorAttachment()->setImageLayout(renderPass.getColorAttachmentInitialLayout());
+        if (frameBuffer.hasColorAttachment()) {
+            frameBuffer.getColorAttachment()->setImageLayout(renderPass.getColorAttachmentInitialLayout());
+        }
 
         if (frameBuffer.hasDepthAttachment()) {
             frameBuffer.getDepthAttachment()->setImageLayout(renderPass.getDepthAttachmentInitialLayout());
@@ -191,7 +207,9 @@ namespace PXTEngine {
         vkCmdEndRenderPass(commandBuffer);
 
 		// After the render pass ends, the image will be transitioned to the final layout
-        frameBuffer.getColorAttachment()->setImageLayout(renderPass.getColorAttachmentFinalLayout());
+        if (frameBuffer.hasColorAttachment()) {
+            frameBuffer.getColorAttachment()->setImageLayout(renderPass.getColorAttachmentFinalLayout());
+        }
 
         if (frameBuffer.hasDepthAttachment()) {
             frameBuffer.getDepthAttachment()->setImageLayout(renderPass.getDepthAttachmentFinalLayout());
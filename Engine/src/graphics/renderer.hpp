@@ -127,10 +127,13 @@ namespace PXTEngine {
         * @brief Begins a render pass.
         *
         * @param commandBuffer The command buffer to record the render pass into.
+        * @param contents VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS when the pass is recorded by a
+        * ParallelCommandRecorder, the viewport and scissor are then left to the secondary buffers.
         *
         * @throws std::runtime_error if called when frame is not in progress or command buffer is from a different frame.
         */
-        void beginRenderPass(VkCommandBuffer commandBuffer, RenderPass& renderPass, FrameBuffer& frameBuffer, VkExtent2D extent);
+        void beginRenderPass(VkCommandBuffer commandBuffer, RenderPass& renderPass, FrameBuffer& frameBuffer, VkExtent2D extent,
+            VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
 
         /**
          * @brief Ends the current render pass.
@@ -2,12 +2,14 @@
 
 
 namespace PXTEngine {
-	CubeMap::CubeMap(Context& context, const uint32_t size, const VkFormat format, const VkImageUsageFlags usageFlags)
+	CubeMap::CubeMap(Context& context, const uint32_t size, const VkFormat format, const VkImageUsageFlags usageFlags,
+		const uint32_t cubeCount)
 		: VulkanImage(context, {}, Buffer()), m_imageFormat(format), m_usageFlags(usageFlags),
-		  m_size(size) {
-		for (int i = 0; i < 6; i++) {
-			m_cubeFaceViews[i] = VK_NULL_HANDLE;
-		}
+		  m_size(size), m_cubeCount(cubeCount) {
+		m_cubeFaceViews.resize(getLayerCount(), VK_NULL_HANDLE);
+
+		m_isDepth = format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_D32_SFLOAT ||
+			format == VK_FORMAT_X8_D24_UNORM_PACK32;
 
 		createImage();
 		createImageViews();
@@ -18,6 +20,7 @@ namespace PXTEngine {
 		for (auto& imageView : m_cubeFaceViews) {
 			vkDestroyImageView(m_context.getDevice(), imageView, nullptr);
 		}
+		vkDestroyImageView(m_context.getDevice(), m_layeredImageView, nullptr);
 	}
 
 	void CubeMap::createImage() {
@@ -28,7 +31,7 @@ namespace PXTEngine {
 		imageCreateInfo.format = m_imageFormat;
 		imageCreateInfo.extent = { m_size, m_size, 1 };
 		imageCreateInfo.mipLevels = 1;
-		imageCreateInfo.arrayLayers = 6;
+		imageCreateInfo.arrayLayers = getLayerCount();
 		imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 		imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
 		imageCreateInfo.usage = m_usageFlags;
@@ -44,26 +47,30 @@ namespace PXTEngine {
 		// Create image view
 		VkImageViewCreateInfo viewInfo = {};
 		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_CUBE;
+		viewInfo.viewType = m_cubeCount > 1 ? VK_IMAGE_VIEW_TYPE_CUBE_ARRAY : VK_IMAGE_VIEW_TYPE_CUBE;
 		viewInfo.format = m_imageFormat;
 		viewInfo.components = { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G,
 								VK_COMPONENT_SWIZZLE_B, VK_COMPONENT_SWIZZLE_A };
-		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.aspectMask = m_isDepth ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
 		viewInfo.subresourceRange.baseMipLevel = 0;
 		viewInfo.subresourceRange.levelCount = 1.0; 
 		viewInfo.subresourceRange.baseArrayLayer = 0;
-		viewInfo.subresourceRange.layerCount = 6;
+		viewInfo.subresourceRange.layerCount = getLayerCount();
 		viewInfo.image = m_vkImage;
 		
-		// this is the image view for the whole cube map
+		// this is the image view for the whole cube map (or cube map array)
 		m_imageView = m_context.createImageView(viewInfo);
 
+		// the same layers as an array, for layered framebuffers
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+		m_layeredImageView = m_context.createImageView(viewInfo);
+
 		// now we create the image views for each face of the cube map
 		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
 		viewInfo.subresourceRange.layerCount = 1;
 		viewInfo.image = m_vkImage;
 
-		for (uint32_t i = 0; i < 6; i++)
+		for (uint32_t i = 0; i < getLayerCount(); i++)
 		{
 			viewInfo.subresourceRange.baseArrayLayer = i;
 			m_cubeFaceViews[i] = m_context.createImageView(viewInfo);
@@ -86,7 +93,18 @@ namespace PXTEngine {
 		sampler.maxLod = 1.0f;
 		sampler.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
 
-		m_sampler = m_context.createSampler(sampler);
+		if (m_isDepth) {
+			// hardware PCF: the reference is compared to the 4 nearest texels and the results filtered,
+			// the reference passes when it is not farther than the stored depth
+			sampler.compareEnable = VK_TRUE;
+			sampler.compareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+			sampler.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+			sampler.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			sampler.addressModeV = sampler.addressModeU;
+			sampler.addressModeW = sampler.addressModeU;
+		}
+
+		m_sampler = m_context.getSampler(sampler);
 	}
 
 	
@@ -2,23 +2,46 @@
 
 #include "graphics/resources/vk_image.hpp"
 
-#include <array>
+#include <vector>
 
 namespace PXTEngine {
 
+	/**
+	 * @class CubeMap
+	 *
+	 * @brief 6 layer cube compatible image with a cube view, a view per face and a layered view.
+	 * Depth formats get a depth aspect and a compare enabled sampler, for samplerCubeShadow lookups.
+	 * With more than one cube the image holds 6 layers per cube and the cube view is a cube array
+	 * view (samplerCubeArray), which requires the imageCubeArray device feature.
+	 */
 	class CubeMap : public VulkanImage {
 	public:
 		CubeMap(Context& context, 
 				uint32_t size, 
 				VkFormat format,
-				VkImageUsageFlags usageFlags);
+				VkImageUsageFlags usageFlags,
+				uint32_t cubeCount = 1);
 
 		~CubeMap() override;
 
+		/**
+		 * @brief 2D view of a single face, faceIndex is the array layer (cube * 6 + face).
+		 */
 		VkImageView getFaceImageView(uint32_t faceIndex) const { return m_cubeFaceViews[faceIndex]; }
 
+		/**
+		 * @brief 2D array view of all the faces, to render all the faces in a single layered pass.
+		 */
+		VkImageView getLayeredImageView() const { return m_layeredImageView; }
+
+		bool isDepth() const { return m_isDepth; }
+		uint32_t getCubeCount() const { return m_cubeCount; }
+		uint32_t getLayerCount() const { return m_cubeCount * 6; }
+
 	private:
 		uint32_t m_size; // Size of the cube map faces
+		uint32_t m_cubeCount;
+		bool m_isDepth = false;
 
 		void createImage();
 		void createImageViews();
@@ -27,6 +50,7 @@ namespace PXTEngine {
 		VkFormat m_imageFormat;
 		VkImageUsageFlags m_usageFlags;
 
-		std::array<VkImageView, 6> m_cubeFaceViews;
+		std::vector<VkImageView> m_cubeFaceViews;
+		VkImageView m_layeredImageView = VK_NULL_HANDLE;
 	};
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "graphics/resources/material_registry.hpp"
 
+#include "scene/ecs/component.hpp"
+
 namespace PXTEngine {
 
 	MaterialRegistry::MaterialRegistry(Context& context, TextureRegistry& textureRegistry)
@@ -25,6 +27,20 @@ namespace PXTEngine {
 		return it != m_idToIndex.end() ? it->second : 0;
 	}
 
+	void MaterialRegistry::trackMaterialComponents(Scene& scene) {
+		scene.getEntitiesWith<MaterialComponent>().each([this](auto entity, auto& materialComponent) {
+			materialComponent.materialIndex = getIndex(materialComponent.material->id);
+		});
+
+		scene.onComponentAdded<MaterialComponent>().connect<&MaterialRegistry::resolveMaterialIndex>(*this);
+		scene.onComponentReplaced<MaterialComponent>().connect<&MaterialRegistry::resolveMaterialIndex>(*this);
+	}
+
+	void MaterialRegistry::resolveMaterialIndex(entt::registry& registry, entt::entity entity) {
+		auto& materialComponent = registry.get<MaterialComponent>(entity);
+		materialComponent.materialIndex = getIndex(materialComponent.material->id);
+	}
+
 	VkDescriptorSet MaterialRegistry::getDescriptorSet() {
 		return m_materialDescriptorSet;
 	}
@@ -38,6 +54,11 @@ namespace PXTEngine {
 			.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, 1)
 			.build();
 
+		for (const uint32_t textureIndex : m_textureReferences) {
+			m_textureRegistry.release(textureIndex);
+		}
+		m_textureReferences.clear();
+
 		std::vector<MaterialData> materialsData;
 		for (const auto& material : m_materials) {
 			materialsData.push_back(getMaterialData(material));
@@ -79,15 +100,23 @@ namespace PXTEngine {
 	}
 
 	MaterialData MaterialRegistry::getMaterialData(Shared<Material> material) {
+		// the slots stay valid as long as the buffer holds them, even if a texture is removed
+		auto acquireTexture = [this](const Shared<Image>& image) {
+			const uint32_t index = m_textureRegistry.acquire(image->id);
+			m_textureReferences.push_back(index);
+			return static_cast<int>(index);
+		};
+
 		MaterialData data;
 		data.albedoColor = material->getAlbedoColor();
 		data.emissiveColor = material->getEmissiveColor();
-		data.albedoMapIndex = m_textureRegistry.getIndex(material->getAlbedoMap()->id);
-		data.normalMapIndex = m_textureRegistry.getIndex(material->getNormalMap()->id);
-		data.ambientOcclusionMapIndex = m_textureRegistry.getIndex(material->getAmbientOcclusionMap()->id);
-		data.metallicMapIndex = m_textureRegistry.getIndex(material->getMetallicMap()->id);
-		data.roughnessMapIndex = m_textureRegistry.getIndex(material->getRoughnessMap()->id);
-		data.emissiveMapIndex = m_textureRegistry.getIndex(material->getEmissiveMap()->id);
+		data.albedoMapIndex = acquireTexture(material->getAlbedoMap());
+		data.normalMapIndex = acquireTexture(material->getNormalMap());
+		data.ambientOcclusionMapIndex = acquireTexture(material->getAmbientOcclusionMap());
+		data.metallicMapIndex = acquireTexture(material->getMetallicMap());
+		data.roughnessMapIndex = acquireTexture(material->getRoughnessMap());
+		data.emissiveMapIndex = acquireTexture(material->getEmissiveMap());
+		data.alphaCutoff = material->getAlphaCutoff();
 		return data;
 	}
 }
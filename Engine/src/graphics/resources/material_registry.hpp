@@ -6,6 +6,7 @@
 #include "graphics/descriptors/descriptors.hpp"
 #include "graphics/resources/vk_buffer.hpp"
 #include "graphics/resources/texture_registry.hpp"
+#include "scene/scene.hpp"
 
 #include <vector>
 #include <unordered_map>
@@ -21,6 +22,7 @@ namespace PXTEngine {
 	 * @note The alignas(16) specifier is crucial. It ensures that the struct's size is a multiple
 	 * of 16 bytes, matching the std430 layout rules for SSBOs in GLSL. This prevents memory 
 	 * alignment issues on the GPU when accessing an array of these structs.
+	 * Mirrored in material/material_data.glsl.
 	 */
 	struct alignas(16) MaterialData {
 		glm::vec4 albedoColor;
@@ -31,6 +33,7 @@ namespace PXTEngine {
 		int metallicMapIndex;
 		int roughnessMapIndex;
 		int emissiveMapIndex;
+		float alphaCutoff;
 	};
 
 	/**
@@ -69,6 +72,22 @@ namespace PXTEngine {
 		 */
 		uint32_t getIndex(const ResourceId& id) const;
 
+		/**
+		 * @brief Retrieves a registered material by its index.
+		 */
+		const Shared<Material>& getMaterial(uint32_t index) const { return m_materials[index]; }
+
+		uint32_t getMaterialCount() const { return static_cast<uint32_t>(m_materials.size()); }
+
+		/**
+		 * @brief Resolves the material index of the MaterialComponents of the scene and keeps it
+		 * up to date when a MaterialComponent is added or replaced, so the renderers never look it up per frame.
+		 * Must be called once every material has been added.
+		 *
+		 * @param scene The scene whose MaterialComponents are tracked.
+		 */
+		void trackMaterialComponents(Scene& scene);
+
 		/**
 		 * @brief Gets the Vulkan descriptor set used for the materials.
 		 *
@@ -101,6 +120,8 @@ namespace PXTEngine {
 		 */
 		MaterialData getMaterialData(Shared<Material> material);
 
+		void resolveMaterialIndex(entt::registry& registry, entt::entity entity);
+
 		Context& m_context;
 		TextureRegistry& m_textureRegistry;
 		Shared<DescriptorAllocatorGrowable> m_descriptorAllocator;
@@ -108,6 +129,9 @@ namespace PXTEngine {
 		std::vector<Shared<Material>> m_materials;
 		std::unordered_map<ResourceId, uint32_t> m_idToIndex;
 
+		// the texture slots acquired by the MaterialData of the buffer, released when it is rebuilt
+		std::vector<uint32_t> m_textureReferences;
+
 		Unique<VulkanBuffer> m_materialsGpuBuffer = nullptr;
 		VkDescriptorSet m_materialDescriptorSet = VK_NULL_HANDLE;
 		Shared<DescriptorSetLayout> m_materialDescriptorSetLayout = nullptr;
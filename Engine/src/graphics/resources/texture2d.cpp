@@ -17,7 +17,12 @@ namespace PXTEngine {
 	: VulkanImage(context, info, buffer) {
 		createTextureImage(info, buffer);
 		createTextureImageView();
-		createTextureSampler();
+		setSamplerInfo(getDefaultSamplerInfo(context));
+	}
+
+	void Texture2D::setSamplerInfo(const VkSamplerCreateInfo& samplerInfo) {
+		m_samplerInfo = samplerInfo;
+		createSampler(m_samplerInfo);
 	}
 
 	void Texture2D::createTextureImage(const ImageInfo& info, const Buffer& buffer) {
@@ -130,7 +135,7 @@ namespace PXTEngine {
 		m_imageView = m_context.createImageView(viewInfo);
 	}
 
-	void Texture2D::createTextureSampler() {
+	VkSamplerCreateInfo Texture2D::getDefaultSamplerInfo(Context& context) {
 		VkSamplerCreateInfo samplerInfo{};
 		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
 
@@ -153,7 +158,7 @@ namespace PXTEngine {
 		// enable anisotropic filtering, which improves texture quality at oblique angles.
 		// https://en.wikipedia.org/wiki/Anisotropic_filtering
 		samplerInfo.anisotropyEnable = VK_TRUE;
-		samplerInfo.maxAnisotropy = m_context.getPhysicalDeviceProperties().limits.maxSamplerAnisotropy;
+		samplerInfo.maxAnisotropy = context.getPhysicalDeviceProperties().limits.maxSamplerAnisotropy;
 
 		// which color to use when sampling outside the image borders (only if address mode is clamp to border)
 		samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
@@ -173,8 +178,6 @@ namespace PXTEngine {
 		samplerInfo.minLod = 0.0f;
 		samplerInfo.maxLod = 0.0f;
 
-		if (vkCreateSampler(m_context.getDevice(), &samplerInfo, nullptr, &m_sampler) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create texture sampler!");
-		}
+		return samplerInfo;
 	}
 }
\ No newline at end of file
@@ -9,8 +9,9 @@ namespace PXTEngine {
 	 * @class Texture2D
 	 * @brief Represents a Vulkan Texture and its associated resources.
 	 *
-	 * This class encapsulates the creation and management of a Vulkan texture, including its view and sampler.
+	 * This class encapsulates the creation and management of a Vulkan texture, including its view.
 	 * It extends the Image class to provide specific functionality for 2D textures.
+	 * The texture holds the description of its sampler, the sampler itself is shared through the SamplerCache.
 	 */
 	class Texture2D : public VulkanImage {
 	public:
@@ -18,6 +19,19 @@ namespace PXTEngine {
 
 		Texture2D(Context& context, const ImageInfo& info, const Buffer& buffer);
 
+		/**
+		 * @brief The sampler description of the textures: trilinear, repeating, with the max anisotropy of the device.
+		 */
+		static VkSamplerCreateInfo getDefaultSamplerInfo(Context& context);
+
+		const VkSamplerCreateInfo& getSamplerInfo() const { return m_samplerInfo; }
+
+		/**
+		 * @brief Changes how the texture is sampled, the new sampler comes from the sampler cache.
+		 * The descriptor of the texture registry is written when the texture is added, set it before.
+		 */
+		void setSamplerInfo(const VkSamplerCreateInfo& samplerInfo);
+
 	private:
 
 		/**
@@ -44,11 +58,7 @@ namespace PXTEngine {
 		 */
 		void createTextureImageView();
 
-		/**
-		 * @brief Creates a texture sampler.
-		 *
-		 * A texture sampler is a set of parameters that control how textures are read and sampled by the GPU.
-		 */
-		void createTextureSampler();
+		// A texture sampler is a set of parameters that control how textures are read and sampled by the GPU.
+		VkSamplerCreateInfo m_samplerInfo{};
 	};
 }
\ No newline at end of file
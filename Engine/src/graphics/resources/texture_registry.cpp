@@ -1,16 +1,34 @@
 #include "graphics/resources/texture_registry.hpp"
 
+#include "core/diagnostics.hpp"
+
+#include <algorithm>
+#include <ranges>
+#include <stdexcept>
+
 namespace PXTEngine {
 
 	TextureRegistry::TextureRegistry(Context& context)
 		: m_context(context) {
 		m_textureDescriptorSet = VK_NULL_HANDLE;
 		m_textureDescriptorSetLayout = nullptr;
-		m_descriptorAllocator = nullptr;
-	}
+		m_freeIndices = createShared<std::vector<uint32_t>>();
 
-	void TextureRegistry::setDescriptorAllocator(Shared<DescriptorAllocatorGrowable> descriptorAllocator) {
-		m_descriptorAllocator = descriptorAllocator;
+		// a combined image sampler counts both as a sampled image and as a sampler
+		VkPhysicalDeviceVulkan12Properties vulkan12Props{};
+		vulkan12Props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+		VkPhysicalDeviceProperties2 deviceProps2{};
+		deviceProps2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		deviceProps2.pNext = &vulkan12Props;
+		vkGetPhysicalDeviceProperties2(m_context.getPhysicalDevice(), &deviceProps2);
+
+		m_capacity = std::min({
+			MAX_TEXTURES,
+			vulkan12Props.maxPerStageDescriptorUpdateAfterBindSampledImages,
+			vulkan12Props.maxPerStageDescriptorUpdateAfterBindSamplers,
+			vulkan12Props.maxDescriptorSetUpdateAfterBindSampledImages,
+			vulkan12Props.maxDescriptorSetUpdateAfterBindSamplers
+		});
 	}
 
 	uint32_t TextureRegistry::add(const Shared<Image>& image) {
@@ -20,13 +38,84 @@ namespace PXTEngine {
 			return 0;
 		}
 
-		const auto index = static_cast<uint32_t>(m_textures.size());
-		m_textures.push_back(image);
+		if (auto it = m_idToIndex.find(image->id); it != m_idToIndex.end()) {
+			return it->second;
+		}
+
+		uint32_t index;
+		if (!m_freeIndices->empty()) {
+			index = m_freeIndices->back();
+			m_freeIndices->pop_back();
+			m_textures[index] = image;
+			m_referenceCounts[index] = 0;
+		} else {
+			if (m_textures.size() >= m_capacity) {
+				throw std::runtime_error("failed to add texture, the texture heap is full!");
+			}
+
+			index = static_cast<uint32_t>(m_textures.size());
+			m_textures.push_back(image);
+			m_referenceCounts.push_back(0);
+		}
+
 		m_idToIndex[image->id] = index;
 
+		// the slot is not used by the frames in flight, it is written in place
+		if (m_textureDescriptorSet != VK_NULL_HANDLE) {
+			writeDescriptor(index);
+		}
+
 		return index;
 	}
 
+	void TextureRegistry::remove(const ResourceId& id) {
+		auto it = m_idToIndex.find(id);
+		if (it == m_idToIndex.end()) {
+			return;
+		}
+
+		const uint32_t index = it->second;
+		PXT_ASSERT(index != 0, "The fallback texture can not be removed");
+
+		m_idToIndex.erase(it);
+
+		// the materials still referencing the slot keep sampling the texture, it goes with their last reference
+		if (m_referenceCounts[index] == 0) {
+			retireSlot(index);
+		}
+	}
+
+	uint32_t TextureRegistry::acquire(const ResourceId& id) {
+		const uint32_t index = getIndex(id);
+		if (index != 0) {
+			m_referenceCounts[index]++;
+		}
+
+		return index;
+	}
+
+	void TextureRegistry::release(const uint32_t index) {
+		if (index == 0) return;
+
+		PXT_ASSERT(m_referenceCounts[index] > 0, "Texture slot released more times than it was acquired");
+
+		// a removed texture is no longer mapped to its slot
+		auto it = m_idToIndex.find(m_textures[index]->id);
+		const bool isRemoved = it == m_idToIndex.end() || it->second != index;
+
+		if (--m_referenceCounts[index] == 0 && isRemoved) {
+			retireSlot(index);
+		}
+	}
+
+	void TextureRegistry::retireSlot(const uint32_t index) {
+		// the descriptor is left as is, nothing samples the slot once the frames in flight retire
+		m_context.getDeletionQueue().push(
+			[freeIndices = m_freeIndices, index, texture = std::move(m_textures[index])]() {
+				freeIndices->push_back(index);
+			});
+	}
+
 	uint32_t TextureRegistry::getIndex(const ResourceId& id) const {
 		auto it = m_idToIndex.find(id);
 		return it != m_idToIndex.end() ? it->second : 0;
@@ -42,24 +131,39 @@ namespace PXTEngine {
 
 	void TextureRegistry::createDescriptorSet() {
 		m_textureDescriptorSetLayout = DescriptorSetLayout::Builder(m_context)
-			.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, static_cast<uint32_t>(m_textures.size()))
+			.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, m_capacity)
+			.setBindingFlags(0, VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+								VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+								VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT)
+			.setLayoutFlags(VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT)
 			.build();
 
-		std::vector<VkDescriptorImageInfo> imageInfos;
-		for (const auto& image : m_textures) {
-			const auto texture = std::static_pointer_cast<Texture2D>(image);
+		// update after bind sets can only be allocated from a pool created for them
+		m_descriptorPool = DescriptorPool::Builder(m_context)
+			.addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_capacity)
+			.setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT)
+			.setMaxSets(1)
+			.build();
 
-			VkDescriptorImageInfo imageInfo{};
-			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = texture->getImageView();
-			imageInfo.sampler = texture->getImageSampler();
-			imageInfos.push_back(imageInfo);
+		if (!m_descriptorPool->allocateDescriptorSet(m_textureDescriptorSetLayout->getDescriptorSetLayout(), m_textureDescriptorSet)) {
+			throw std::runtime_error("failed to allocate texture descriptor set!");
 		}
 
-		m_descriptorAllocator->allocate(m_textureDescriptorSetLayout->getDescriptorSetLayout(), m_textureDescriptorSet);
+		for (const auto& index : m_idToIndex | std::views::values) {
+			writeDescriptor(index);
+		}
+	}
+
+	void TextureRegistry::writeDescriptor(const uint32_t index) {
+		const auto texture = std::static_pointer_cast<Texture2D>(m_textures[index]);
+
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfo.imageView = texture->getImageView();
+		imageInfo.sampler = texture->getImageSampler();
 
 		DescriptorWriter(m_context, *m_textureDescriptorSetLayout)
-			.writeImages(0, imageInfos.data(), static_cast<uint32_t>(imageInfos.size()))
+			.writeImageAt(0, index, &imageInfo)
 			.updateSet(m_textureDescriptorSet);
 	}
 }
@@ -15,30 +15,62 @@ namespace PXTEngine {
 	 * @class TextureRegistry
 	 *
 	 * @brief Manages a collection of textures and their binding to GPU descriptor sets.
+	 *
+	 * The textures live in a bindless heap: a single descriptor array of fixed capacity, created
+	 * with update after bind so that a texture registered at runtime only writes its own slot,
+	 * even while the set is bound by the frames in flight. Removed textures free their slot
+	 * once those frames retire (see DeletionQueue), the next registered texture reuses it.
+	 * The materials hold their texture slots through acquire and release: a slot that is still
+	 * referenced outlives the removal of its texture, so a material never samples a reused slot.
 	 */
 	class TextureRegistry {
 	public:
-		explicit TextureRegistry(Context& context);
+		// capacity of the heap, clamped to the update after bind limits of the device
+		static constexpr uint32_t MAX_TEXTURES = 4096;
 
-		/**
-		 * @brief Sets the descriptor allocator for the registry.
-		 *
-		 * @param descriptorAllocator Shared pointer to a growable descriptor allocator.
-		 */
-		void setDescriptorAllocator(Shared<DescriptorAllocatorGrowable> descriptorAllocator);
+		explicit TextureRegistry(Context& context);
 
 		/**
 		 * @brief Adds a texture to the registry.
 		 *
 		 * Only 2D textures (Texture2D) are supported. 
 		 * If the provided image is not a Texture2D, the function returns 0.
+		 * Once the descriptor set is created, the texture descriptor is written in place.
 		 *
 		 * @param image Shared pointer to the image.
 		 *
 		 * @return Index of the added texture if valid, otherwise 0.
+		 * @throws std::runtime_error if the heap is full.
 		 */
 		uint32_t add(const Shared<Image>& image);
 
+		/**
+		 * @brief Removes a texture from the registry.
+		 *
+		 * The slot, and the texture, are kept until their last reference is released and the frames
+		 * in flight retire, they may still sample it. Index 0 is the fallback of getIndex and is never removed.
+		 *
+		 * @param id Resource ID of the texture.
+		 */
+		void remove(const ResourceId& id);
+
+		/**
+		 * @brief Gets the index of a texture like getIndex and keeps its slot until release is called,
+		 * for the indices stored on the GPU (e.g. in MaterialData).
+		 *
+		 * @param id Resource ID of the texture.
+		 *
+		 * @return Index if found, otherwise 0.
+		 */
+		uint32_t acquire(const ResourceId& id);
+
+		/**
+		 * @brief Releases a slot returned by acquire, a removed texture frees its slot with its last reference.
+		 *
+		 * @param index Index returned by acquire.
+		 */
+		void release(uint32_t index);
+
 		/**
 		 * @brief Gets the index of a texture in the registry by its resource ID.
 		 *
@@ -49,7 +81,11 @@ namespace PXTEngine {
 		[[nodiscard]] uint32_t getIndex(const ResourceId& id) const;
 
 		uint32_t getTextureCount() const {
-			return static_cast<uint32_t>(m_textures.size());
+			return static_cast<uint32_t>(m_idToIndex.size());
+		}
+
+		uint32_t getCapacity() const {
+			return m_capacity;
 		}
 
 		/**
@@ -67,19 +103,35 @@ namespace PXTEngine {
 		VkDescriptorSetLayout getDescriptorSetLayout();
 
 		/**
-		 * @brief Creates a Vulkan descriptor set for all registered textures.
+		 * @brief Creates the bindless descriptor set of the textures.
 		 *
-		 * This function constructs a descriptor set layout with a combined image sampler binding,
-		 * prepares image info for each texture, allocates the descriptor set, and writes all image bindings to it.
+		 * This function constructs a descriptor set layout with a partially bound, update after bind,
+		 * combined image sampler array of getCapacity() elements, allocates the set from a dedicated
+		 * update after bind pool and writes the textures registered so far to it.
 		 */
 		void createDescriptorSet();
 
 	private:
+		/**
+		 * @brief Writes the descriptor of the texture at the given slot of the heap.
+		 */
+		void writeDescriptor(uint32_t index);
+
+		/**
+		 * @brief Returns the slot of a removed texture to the free list once the frames in flight retire.
+		 */
+		void retireSlot(uint32_t index);
+
+		// indexed by slot, null for the free slots
 		std::vector<Shared<Image>> m_textures;
+		std::vector<uint32_t> m_referenceCounts;
 		std::unordered_map<ResourceId, uint32_t> m_idToIndex;
+		// shared with the deletion queue entries that release the slots
+		Shared<std::vector<uint32_t>> m_freeIndices;
+		uint32_t m_capacity = MAX_TEXTURES;
 
 		Context& m_context;
-		Shared<DescriptorAllocatorGrowable> m_descriptorAllocator;
+		Unique<DescriptorPool> m_descriptorPool;
 		Shared<DescriptorSetLayout> m_textureDescriptorSetLayout;
 		VkDescriptorSet m_textureDescriptorSet;
 	};
@@ -34,8 +34,22 @@ namespace PXTEngine {
 		m_context.createImageWithInfo(imageInfo, memoryFlags, m_vkImage, m_imageMemory);
 	}
 
+	VulkanImage::VulkanImage(Context& context, const VkImageCreateInfo& imageInfo, VkDeviceMemory memory, VkDeviceSize memoryOffset)
+	: VulkanImage(context, ImageInfo(imageInfo.extent.width, imageInfo.extent.height, 4), Buffer()) {
+		m_imageFormat = imageInfo.format;
+
+		if (vkCreateImage(m_context.getDevice(), &imageInfo, nullptr, &m_vkImage) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create image!");
+		}
+
+		// m_imageMemory stays null, the memory belongs to the caller
+		if (vkBindImageMemory(m_context.getDevice(), m_vkImage, memory, memoryOffset) != VK_SUCCESS) {
+			throw std::runtime_error("failed to bind image memory!");
+		}
+	}
+
 	VulkanImage::~VulkanImage() {
-		vkDestroySampler(m_context.getDevice(), m_sampler, nullptr);
+		// the sampler belongs to the sampler cache
 		vkDestroyImageView(m_context.getDevice(), m_imageView, nullptr);
 
 		vkDestroyImage(m_context.getDevice(), m_vkImage, nullptr);
@@ -53,11 +67,7 @@ namespace PXTEngine {
 	}
 
 	VulkanImage& VulkanImage::createSampler(const VkSamplerCreateInfo& samplerInfo) {
-		if (m_sampler != VK_NULL_HANDLE) {
-			vkDestroySampler(m_context.getDevice(), m_sampler, nullptr);
-		}
-
-		m_sampler = m_context.createSampler(samplerInfo);
+		m_sampler = m_context.getSampler(samplerInfo);
 
 		return *this;
 	}
@@ -51,6 +51,12 @@ namespace PXTEngine {
 		VulkanImage(Context& context, const ImageInfo& info, const Buffer& buffer);
 		VulkanImage(Context& context, const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags memoryFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
+		/**
+		 * @brief Creates the image over memory it does not own (e.g. aliased with other images),
+		 * the memory must outlive the image.
+		 */
+		VulkanImage(Context& context, const VkImageCreateInfo& imageInfo, VkDeviceMemory memory, VkDeviceSize memoryOffset);
+
 		~VulkanImage() override;
 
 		VulkanImage(const VulkanImage&) = delete;
@@ -95,6 +101,9 @@ namespace PXTEngine {
 		void setImageLayout(const VkImageLayout newLayout) { m_currentLayout = newLayout; }
 
 		VulkanImage& createImageView(const VkImageViewCreateInfo& viewInfo);
+		/**
+		 * @brief Sets the sampler of the image, shared with every image sampled the same way (see SamplerCache).
+		 */
 		VulkanImage& createSampler(const VkSamplerCreateInfo& samplerInfo);
 
 		/**
@@ -135,7 +144,8 @@ namespace PXTEngine {
 		VkDeviceMemory m_imageMemory; // the memory occupied by the image
 		VkImageView m_imageView; // an abstraction to view the same raw image in different "ways"
 		VkSampler m_sampler; // an abstraction (and tool) to help fragment shader pick the right color and
-									// apply useful transformations (e.g. bilinear filtering, anisotropic filtering etc.)
+									// apply useful transformations (e.g. bilinear filtering, anisotropic filtering etc.),
+									// shared through the sampler cache
 
 		VkImageLayout m_currentLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 	};
@@ -3,20 +3,33 @@
 #include "application.hpp"
 #include "core/diagnostics.hpp"
 
+#include <algorithm>
+
 namespace PXTEngine {
 
     Unique<VulkanMesh> VulkanMesh::create(std::vector<Mesh::Vertex>& vertices, 
-        std::vector<uint32_t>& indices) {
+        std::vector<uint32_t>& indices, std::vector<Lod> lods) {
         Context& context = Application::get().getContext();
 
-        return createUnique<VulkanMesh>(context, vertices, indices);
+        return createUnique<VulkanMesh>(context, vertices, indices, std::move(lods));
     }
 
     VulkanMesh::VulkanMesh(Context& context, std::vector<Mesh::Vertex>& vertices, 
-        std::vector<uint32_t>& indices)
-        : m_context(context) {
+        std::vector<uint32_t>& indices, std::vector<Lod> lods)
+        : m_context(context), m_lods(std::move(lods)) {
+        if (m_lods.empty()) {
+            m_lods.push_back({0, static_cast<uint32_t>(indices.size()), 0.0f});
+        }
+
+        // CPU side geometry data kept after upload, used for culling and LOD selection
+        m_bounds = computeBounds(vertices);
+        m_occluderGeometry = buildOccluderGeometry(vertices, indices, m_lods.back());
+
         createVertexBuffers(vertices);
         createIndexBuffers(indices);
+
+        // the BLAS and the ray tracing shaders only see the full resolution mesh
+        m_indexCount = m_lods[0].indexCount;
     }
 
     VulkanMesh::~VulkanMesh() = default;
@@ -53,6 +66,34 @@ namespace PXTEngine {
         );
 
         m_context.copyBuffer(stagingBuffer.getBuffer(), m_vertexBuffer->getBuffer(), bufferSize);
+
+        std::vector<glm::vec4> positions(m_vertexCount);
+        for (uint32_t i = 0; i < m_vertexCount; i++) {
+            positions[i] = vertices[i].position;
+        }
+
+        VulkanBuffer positionStagingBuffer{
+            m_context,
+            sizeof(glm::vec4),
+            m_vertexCount,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        };
+
+        positionStagingBuffer.map();
+        positionStagingBuffer.writeToBuffer((void*) positions.data());
+
+        m_positionBuffer = createUnique<VulkanBuffer>(
+            m_context,
+            sizeof(glm::vec4),
+            m_vertexCount,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        );
+
+        m_context.copyBuffer(positionStagingBuffer.getBuffer(), m_positionBuffer->getBuffer(),
+            sizeof(glm::vec4) * m_vertexCount);
     }
 
     void VulkanMesh::createIndexBuffers(std::vector<uint32_t>& indices) {
@@ -97,6 +138,16 @@ namespace PXTEngine {
         }
     }
 
+    void VulkanMesh::draw(VkCommandBuffer commandBuffer, uint32_t lodIndex) {
+        if (!m_hasIndexBuffer) {
+            draw(commandBuffer);
+            return;
+        }
+
+        const Lod& lod = m_lods[std::min(lodIndex, static_cast<uint32_t>(m_lods.size()) - 1)];
+        vkCmdDrawIndexed(commandBuffer, lod.indexCount, 1, lod.firstIndex, 0, 0);
+    }
+
     void VulkanMesh::bind(VkCommandBuffer commandBuffer) {
         VkBuffer buffers[] = {m_vertexBuffer->getBuffer()};
         VkDeviceSize offsets[] = {0};
@@ -107,6 +158,16 @@ namespace PXTEngine {
         }
     }
 
+    void VulkanMesh::bindPositions(VkCommandBuffer commandBuffer) {
+        VkBuffer buffers[] = {m_positionBuffer->getBuffer()};
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+
+        if (m_hasIndexBuffer) {
+            vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+        }
+    }
+
     std::vector<VkVertexInputBindingDescription> VulkanMesh::getVertexBindingDescriptions() {
         std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
         bindingDescriptions[0].binding = 0;
@@ -125,4 +186,20 @@ namespace PXTEngine {
 
         return attributeDescriptions;
     }
+
+    std::vector<VkVertexInputBindingDescription> VulkanMesh::getPositionBindingDescriptions() {
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+        bindingDescriptions[0].binding = 0;
+        bindingDescriptions[0].stride = sizeof(glm::vec4);
+        bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        return bindingDescriptions;
+    }
+
+    std::vector<VkVertexInputAttributeDescription> VulkanMesh::getPositionAttributeDescriptions() {
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
+        attributeDescriptions.emplace_back(0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, 0);
+
+        return attributeDescriptions;
+    }
 }
\ No newline at end of file
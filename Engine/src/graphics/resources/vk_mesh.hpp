@@ -31,9 +31,24 @@ namespace PXTEngine {
          */
         static std::vector<VkVertexInputAttributeDescription> getVertexAttributeDescriptions();
 
-        static Unique<VulkanMesh> create(std::vector<Mesh::Vertex>& vertices, std::vector<uint32_t>& indices);
+        /**
+         * @brief Vertex input of the position-only stream, bound with bindPositions.
+         */
+        static std::vector<VkVertexInputBindingDescription> getPositionBindingDescriptions();
+        static std::vector<VkVertexInputAttributeDescription> getPositionAttributeDescriptions();
 
-        VulkanMesh(Context& context, std::vector<Mesh::Vertex>& vertices, std::vector<uint32_t>& indices);
+        /**
+         * @brief Creates a mesh from vertex and index data.
+         *
+         * @param vertices The vertex buffer data.
+         * @param indices The index buffer data, containing every LOD one after the other.
+         * @param lods The LOD ranges of the index buffer. If empty the whole buffer is a single LOD.
+         */
+        static Unique<VulkanMesh> create(std::vector<Mesh::Vertex>& vertices, std::vector<uint32_t>& indices,
+            std::vector<Lod> lods = {});
+
+        VulkanMesh(Context& context, std::vector<Mesh::Vertex>& vertices, std::vector<uint32_t>& indices,
+            std::vector<Lod> lods = {});
 
         ~VulkanMesh() override;
 
@@ -46,6 +61,14 @@ namespace PXTEngine {
          * @param commandBuffer The Vulkan command buffer.
          */
         void bind(VkCommandBuffer commandBuffer);
+
+        /**
+         * @brief Binds the position-only vertex stream and the index buffer, for depth-only passes.
+         * The positions are the same values as the full vertices, so the depth matches bit for bit.
+         *
+         * @param commandBuffer The Vulkan command buffer.
+         */
+        void bindPositions(VkCommandBuffer commandBuffer);
         
         /**
          * @brief Draws the model using the bound buffers.
@@ -54,14 +77,37 @@ namespace PXTEngine {
          */
         void draw(VkCommandBuffer commandBuffer);
 
+        /**
+         * @brief Draws a single LOD of the model using the bound buffers.
+         *
+         * @param commandBuffer The Vulkan command buffer.
+         * @param lodIndex The LOD to draw, clamped to the available ones.
+         */
+        void draw(VkCommandBuffer commandBuffer, uint32_t lodIndex);
+
         const uint32_t getVertexCount() const override {
 			return m_vertexCount;
         }
 
+        /**
+         * @brief Returns the index count of LOD 0, the only one used for ray tracing.
+         */
         const uint32_t getIndexCount() const override {
 			return m_indexCount;
         }
 
+        const std::vector<Lod>& getLods() const override {
+            return m_lods;
+        }
+
+        const Bounds& getBounds() const override {
+            return m_bounds;
+        }
+
+        const OccluderGeometry& getOccluderGeometry() const override {
+            return m_occluderGeometry;
+        }
+
 		VkDeviceAddress getVertexBufferDeviceAddress() const {
             return m_vertexBuffer->getDeviceAddress();
 		}
@@ -76,7 +122,7 @@ namespace PXTEngine {
 
     private:
         /**
-         * @brief Creates and allocates vertex buffers.
+         * @brief Creates and allocates the vertex buffer and the position-only vertex buffer.
          */
         void createVertexBuffers(std::vector<Mesh::Vertex>& vertices);
 
@@ -90,10 +136,15 @@ namespace PXTEngine {
 		float m_tilingFactor = 1.0f;
 
         Unique<VulkanBuffer> m_vertexBuffer;
+        Unique<VulkanBuffer> m_positionBuffer; // positions only, a quarter of the vertex fetch for depth passes
         uint32_t m_vertexCount;
 
         bool m_hasIndexBuffer = false;
         Unique<VulkanBuffer> m_indexBuffer;
         uint32_t m_indexCount;
+
+        std::vector<Lod> m_lods;
+        Bounds m_bounds;
+        OccluderGeometry m_occluderGeometry;
     };
 }
@@ -0,0 +1,155 @@
+#include "graphics/shader_library.hpp"
+
+#include "core/platform.hpp"
+
+#include <stdexcept>
+
+#ifdef PXT_PLATFORM_WINDOWS
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace PXTEngine {
+
+#ifdef PXT_PLATFORM_WINDOWS
+	MappedFile::MappedFile(const std::string& filePath) {
+		HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			throw std::runtime_error("failed to open file: " + filePath);
+		}
+		m_fileHandle = file;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+			CloseHandle(file);
+			throw std::runtime_error("failed to read file: " + filePath);
+		}
+		m_size = static_cast<size_t>(size.QuadPart);
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		m_data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (m_data == nullptr) {
+			if (mapping) CloseHandle(mapping);
+			CloseHandle(file);
+			throw std::runtime_error("failed to map file: " + filePath);
+		}
+		m_mappingHandle = mapping;
+	}
+
+	MappedFile::~MappedFile() {
+		UnmapViewOfFile(m_data);
+		CloseHandle(m_mappingHandle);
+		CloseHandle(m_fileHandle);
+	}
+#else
+	MappedFile::MappedFile(const std::string& filePath) {
+		int file = open(filePath.c_str(), O_RDONLY);
+		if (file < 0) {
+			throw std::runtime_error("failed to open file: " + filePath);
+		}
+
+		struct stat fileStat{};
+		if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+			close(file);
+			throw std::runtime_error("failed to read file: " + filePath);
+		}
+		m_size = static_cast<size_t>(fileStat.st_size);
+
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+		// the mapping stays valid once the descriptor is closed
+		close(file);
+
+		if (data == MAP_FAILED) {
+			throw std::runtime_error("failed to map file: " + filePath);
+		}
+		m_data = data;
+	}
+
+	MappedFile::~MappedFile() {
+		munmap(const_cast<void*>(m_data), m_size);
+	}
+#endif
+
+	/**
+	 * @brief 64 bit FNV-1a hash of the SPIR-V words, mixed with the size.
+	 */
+	static uint64_t hashSpirv(const MappedFile& file) {
+		uint64_t hash = 14695981039346656037ull;
+
+		const auto* bytes = static_cast<const uint8_t*>(file.getData());
+		for (size_t i = 0; i < file.getSize(); i++) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+
+		return hash ^ (static_cast<uint64_t>(file.getSize()) << 32);
+	}
+
+	ShaderModule::ShaderModule(VkDevice device, Unique<MappedFile> file, bool isInline)
+		: m_device(device) {
+		VkShaderModuleCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		createInfo.codeSize = file->getSize();
+		// mappings are page aligned, as required for the SPIR-V words
+		createInfo.pCode = static_cast<const uint32_t*>(file->getData());
+
+		if (isInline) {
+			m_inlineInfo = createInfo;
+			m_file = std::move(file);
+			return;
+		}
+
+		if (vkCreateShaderModule(m_device, &createInfo, nullptr, &m_module) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create shader module!");
+		}
+	}
+
+	ShaderModule::~ShaderModule() {
+		if (m_module != VK_NULL_HANDLE) {
+			vkDestroyShaderModule(m_device, m_module, nullptr);
+		}
+	}
+
+	void ShaderModule::fillStageInfo(VkPipelineShaderStageCreateInfo& stageInfo) const {
+		if (m_module != VK_NULL_HANDLE) {
+			stageInfo.module = m_module;
+			return;
+		}
+
+		// no module object, the create info chained to the stage carries the code
+		stageInfo.module = VK_NULL_HANDLE;
+		stageInfo.pNext = &m_inlineInfo;
+	}
+
+	ShaderLibrary::ShaderLibrary(VkDevice device, bool isInlineSpirvSupported)
+		: m_device(device), m_isInlineSpirvSupported(isInlineSpirvSupported) {}
+
+	Shared<ShaderModule> ShaderLibrary::load(const std::string& filePath) {
+		auto file = createUnique<MappedFile>(filePath);
+		const uint64_t hash = hashSpirv(*file);
+
+		std::lock_guard lock(m_mutex);
+
+		if (auto it = m_modules.find(hash); it != m_modules.end()) {
+			if (Shared<ShaderModule> module = it->second.lock()) {
+				return module;
+			}
+		}
+
+		// forget the modules no pipeline holds anymore
+		std::erase_if(m_modules, [](const auto& entry) { return entry.second.expired(); });
+
+		auto module = createShared<ShaderModule>(m_device, std::move(file), m_isInlineSpirvSupported);
+		m_modules[hash] = module;
+
+		return module;
+	}
+}
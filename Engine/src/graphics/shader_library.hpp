@@ -0,0 +1,102 @@
+#pragma once
+
+#include "core/memory.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace PXTEngine {
+
+	/**
+	 * @class MappedFile
+	 *
+	 * @brief Read only memory mapping of a whole file.
+	 */
+	class MappedFile {
+	public:
+		explicit MappedFile(const std::string& filePath);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const void* getData() const { return m_data; }
+		size_t getSize() const { return m_size; }
+
+	private:
+		const void* m_data = nullptr;
+		size_t m_size = 0;
+
+		// platform handles of the mapping
+		void* m_fileHandle = nullptr;
+		void* m_mappingHandle = nullptr;
+	};
+
+	/**
+	 * @class ShaderModule
+	 *
+	 * @brief A SPIR-V binary shared by every pipeline stage that uses it.
+	 *
+	 * When the device accepts SPIR-V inline in the pipeline creation (VK_KHR_maintenance5 or
+	 * VK_EXT_graphics_pipeline_library), no VkShaderModule is created: the module keeps the file
+	 * mapped and chains its code to the shader stage create info instead.
+	 */
+	class ShaderModule {
+	public:
+		ShaderModule(VkDevice device, Unique<MappedFile> file, bool isInline);
+		~ShaderModule();
+
+		ShaderModule(const ShaderModule&) = delete;
+		ShaderModule& operator=(const ShaderModule&) = delete;
+
+		/**
+		 * @brief Points the stage create info to this module, the module must outlive the pipeline creation.
+		 */
+		void fillStageInfo(VkPipelineShaderStageCreateInfo& stageInfo) const;
+
+	private:
+		VkDevice m_device;
+
+		VkShaderModule m_module = VK_NULL_HANDLE;
+
+		// inline SPIR-V only
+		Unique<MappedFile> m_file;
+		VkShaderModuleCreateInfo m_inlineInfo{};
+	};
+
+	/**
+	 * @class ShaderLibrary
+	 *
+	 * @brief Loads the .spv files for the pipelines, one ShaderModule per distinct SPIR-V binary.
+	 *
+	 * The files are memory mapped and the modules are keyed by a hash of their content, so every
+	 * pipeline stage using the same binary shares one module. The modules are reference counted:
+	 * pipelines keep theirs alive, a module is destroyed with the last pipeline that uses it.
+	 * It can be used from several threads at once.
+	 */
+	class ShaderLibrary {
+	public:
+		ShaderLibrary(VkDevice device, bool isInlineSpirvSupported);
+
+		ShaderLibrary(const ShaderLibrary&) = delete;
+		ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+		/**
+		 * @brief Returns the module of the SPIR-V file, creating it if no pipeline holds it yet.
+		 */
+		Shared<ShaderModule> load(const std::string& filePath);
+
+		bool isInlineSpirvUsed() const { return m_isInlineSpirvSupported; }
+
+	private:
+		VkDevice m_device;
+		bool m_isInlineSpirvSupported;
+
+		std::mutex m_mutex;
+		std::unordered_map<uint64_t, std::weak_ptr<ShaderModule>> m_modules;
+	};
+}
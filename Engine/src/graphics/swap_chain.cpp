@@ -31,7 +31,13 @@ namespace PXTEngine {
         createRenderPass();
         createDepthResources();
         createFramebuffers();
-        createSyncObjects();
+
+        if (m_oldSwapChain == nullptr) {
+            createSyncObjects();
+        } else {
+            takeSyncObjects(*m_oldSwapChain);
+        }
+        createPresentSemaphores();
     }
 
     SwapChain::~SwapChain() {
@@ -58,9 +64,12 @@ namespace PXTEngine {
 
         vkDestroyRenderPass(m_context.getDevice(), m_renderPass, nullptr);
 
-        // cleanup synchronization objects
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            vkDestroySemaphore(m_context.getDevice(), m_renderFinishedSemaphores[i], nullptr);
+        for (VkSemaphore semaphore : m_renderFinishedSemaphores) {
+            vkDestroySemaphore(m_context.getDevice(), semaphore, nullptr);
+        }
+
+        // cleanup synchronization objects, none when they were handed over to the next swap chain
+        for (size_t i = 0; i < m_inFlightFences.size(); i++) {
             vkDestroySemaphore(m_context.getDevice(), m_imageAvailableSemaphores[i], nullptr);
             vkDestroyFence(m_context.getDevice(), m_inFlightFences[i], nullptr);
         }
@@ -99,7 +108,8 @@ namespace PXTEngine {
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers = buffers;
 
-        VkSemaphore signalSemaphores[] = {m_renderFinishedSemaphores[m_currentFrame]};
+        // the semaphore of the image, the present waiting on it is over once the image is acquired again
+        VkSemaphore signalSemaphores[] = {m_renderFinishedSemaphores[*imageIndex]};
         submitInfo.signalSemaphoreCount = 1;
         submitInfo.pSignalSemaphores = signalSemaphores;
 
@@ -342,7 +352,6 @@ namespace PXTEngine {
 
     void SwapChain::createSyncObjects() {
         m_imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-        m_renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
         m_inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
         m_imagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
 
@@ -356,8 +365,6 @@ namespace PXTEngine {
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
             if (vkCreateSemaphore(m_context.getDevice(), &semaphoreInfo, nullptr,
                                   &m_imageAvailableSemaphores[i]) != VK_SUCCESS ||
-                vkCreateSemaphore(m_context.getDevice(), &semaphoreInfo, nullptr,
-                                  &m_renderFinishedSemaphores[i]) != VK_SUCCESS ||
                 vkCreateFence(m_context.getDevice(), &fenceInfo, nullptr, &m_inFlightFences[i]) !=
                     VK_SUCCESS) {
                 throw std::runtime_error("failed to create synchronization objects for a frame!");
@@ -365,6 +372,30 @@ namespace PXTEngine {
         }
     }
 
+    void SwapChain::takeSyncObjects(SwapChain& previous) {
+        m_imageAvailableSemaphores = std::move(previous.m_imageAvailableSemaphores);
+        m_inFlightFences = std::move(previous.m_inFlightFences);
+        m_currentFrame = previous.m_currentFrame;
+
+        previous.m_imageAvailableSemaphores.clear();
+        previous.m_inFlightFences.clear();
+
+        m_imagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
+    }
+
+    void SwapChain::createPresentSemaphores() {
+        m_renderFinishedSemaphores.resize(imageCount());
+
+        VkSemaphoreCreateInfo semaphoreInfo = {};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        for (VkSemaphore& semaphore : m_renderFinishedSemaphores) {
+            if (vkCreateSemaphore(m_context.getDevice(), &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create the present semaphores of the swap chain!");
+            }
+        }
+    }
+
     VkSurfaceFormatKHR SwapChain::chooseSwapSurfaceFormat(
         const std::vector<VkSurfaceFormatKHR> &availableFormats) {
         // Common & Desirable: sRGB 8-bit per channel (B8G8R8A8_SRGB or R8G8B8A8_SRGB).
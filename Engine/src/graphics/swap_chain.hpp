@@ -222,6 +222,25 @@ namespace PXTEngine {
          */
         void createSyncObjects();
 
+        /**
+         * @brief Takes over the synchronization objects of the previous swap chain.
+         *
+         * The frame slots keep their fences and their index across a recreation, so the renderer
+         * and the DeletionQueue stay in step with them.
+         *
+         * @param previous The swap chain being replaced, left without synchronization objects.
+         */
+        void takeSyncObjects(SwapChain& previous);
+
+        /**
+         * @brief Creates the semaphores the presentation of every image waits on.
+         *
+         * They belong to the images rather than to the frame slots: the frame fences do not cover the
+         * presentation, but an image is only acquired again once its previous present is over. They
+         * are destroyed with the swap chain, never handed over.
+         */
+        void createPresentSemaphores();
+
         /**
          * @brief Chooses the optimal surface format for the swap chain.
          * 
@@ -280,7 +299,7 @@ namespace PXTEngine {
         Shared<SwapChain> m_oldSwapChain;
 
         std::vector<VkSemaphore> m_imageAvailableSemaphores;
-        std::vector<VkSemaphore> m_renderFinishedSemaphores;
+        std::vector<VkSemaphore> m_renderFinishedSemaphores; // by image
         std::vector<VkFence> m_inFlightFences;
         std::vector<VkFence> m_imagesInFlight;
     };
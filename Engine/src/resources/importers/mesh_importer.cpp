@@ -2,20 +2,21 @@
 
 #include "core/constants.hpp"
 #include "core/memory.hpp"
+#include "core/diagnostics.hpp"
 #include "graphics/resources/vk_mesh.hpp"
+#include "resources/importers/mesh_optimizer.hpp"
 #include "resources/types/material.hpp"
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
 
+#include <algorithm>
 #include <unordered_map>
 #include <vector>
 
 namespace PXTEngine {
 
-	Shared<Mesh> MeshImporter::importObj(ResourceManager& rm, const std::filesystem::path& filePath,
-        ResourceInfo* resourceInfo) {
-
+	MeshImporter::MeshData MeshImporter::loadObj(const std::filesystem::path& filePath) {
 	    std::vector<Mesh::Vertex> vertices{};  // List of vertices in the model.
 	    std::vector<uint32_t> indices{}; // List of indices for indexed rendering.
 
@@ -108,6 +109,82 @@ namespace PXTEngine {
             v2.tangent = tangent4;
         }
 
-		return VulkanMesh::create(vertices, indices);
+		return { std::move(vertices), std::move(indices) };
+	}
+
+	Shared<Mesh> MeshImporter::importObj(ResourceManager& rm, const std::filesystem::path& filePath,
+        ResourceInfo* resourceInfo) {
+
+		MeshInfo meshInfo;
+		if (resourceInfo != nullptr) {
+			if (const auto* info = dynamic_cast<MeshInfo*>(resourceInfo)) {
+				meshInfo = *info;
+			} else {
+				throw std::runtime_error("MeshImporter - Invalid resourceInfo type: not MeshInfo");
+			}
+		}
+
+		MeshData mesh = loadObj(filePath);
+		std::vector<Mesh::Vertex>& vertices = mesh.vertices;
+		std::vector<uint32_t>& indices = mesh.indices;
+
+		// Build the LOD chain, every LOD is simplified from the previous one
+		const Bounds bounds = Mesh::computeBounds(vertices);
+
+		std::vector<std::vector<uint32_t>> lodIndices{ indices };
+		std::vector<float> lodErrors{ 0.0f };
+
+		for (uint32_t lod = 1; lod < meshInfo.maxLodCount; lod++) {
+			const std::vector<uint32_t>& source = lodIndices.back();
+			const size_t targetIndexCount = static_cast<size_t>(source.size() / 3 * meshInfo.lodReductionRatio) * 3;
+
+			float error = 0.0f;
+			std::vector<uint32_t> simplified = MeshOptimizer::simplify(source, vertices, targetIndexCount,
+				meshInfo.lodMaxError * bounds.sphere.radius, &error);
+
+			// stop when simplification stalls, a LOD that barely differs only costs memory
+			if (simplified.empty() || simplified.size() > source.size() * 9 / 10) {
+				break;
+			}
+
+			lodErrors.push_back(std::max(error, lodErrors.back()));
+			lodIndices.push_back(std::move(simplified));
+		}
+
+		// Reorder for post-transform cache reuse, then overdraw, then linear vertex fetch.
+		// Vertex attributes are final at this point, only the ordering changes.
+		const auto cacheStatsBefore = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+
+		for (auto& lod : lodIndices) {
+			MeshOptimizer::optimizeVertexCache(lod, vertices.size());
+			MeshOptimizer::optimizeOverdraw(lod, vertices);
+		}
+
+		const auto cacheStatsAfter = MeshOptimizer::analyzeVertexCache(lodIndices[0], vertices.size());
+
+		// LODs are stored one after the other in a single index buffer
+		std::vector<Mesh::Lod> lods;
+		indices.clear();
+		for (size_t lod = 0; lod < lodIndices.size(); lod++) {
+			lods.push_back({
+				static_cast<uint32_t>(indices.size()),
+				static_cast<uint32_t>(lodIndices[lod].size()),
+				lodErrors[lod]
+			});
+			indices.insert(indices.end(), lodIndices[lod].begin(), lodIndices[lod].end());
+		}
+
+		MeshOptimizer::optimizeVertexFetch(vertices, indices);
+
+		PXT_LOG("[MeshImporter] {}: {} vertices, {} triangles, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+			filePath.filename().string(), vertices.size(), lods[0].indexCount / 3,
+			cacheStatsBefore.acmr, cacheStatsAfter.acmr, cacheStatsBefore.atvr, cacheStatsAfter.atvr);
+
+		for (size_t lod = 1; lod < lods.size(); lod++) {
+			PXT_LOG("[MeshImporter] {}: LOD {} - {} triangles, error {:.5f}",
+				filePath.filename().string(), lod, lods[lod].indexCount / 3, lods[lod].error);
+		}
+
+		return VulkanMesh::create(vertices, indices, std::move(lods));
 	}
 }
\ No newline at end of file
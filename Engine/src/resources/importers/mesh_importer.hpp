@@ -6,12 +6,27 @@
 
 #include <filesystem>
 #include <optional>
+#include <vector>
 
 namespace PXTEngine {
 
 	class MeshImporter {
 	public:
+		/**
+		 * @brief The welded vertices and the triangle list of a loaded file, before any optimization.
+		 */
+		struct MeshData {
+			std::vector<Mesh::Vertex> vertices;
+			std::vector<uint32_t> indices;
+		};
+
 		static Shared<Mesh> importObj(ResourceManager& rm, const std::filesystem::path& filePath,
 			ResourceInfo* resourceInfo = nullptr);
+
+		/**
+		 * @brief Loads an OBJ file, welds its identical vertices and computes their tangents.
+		 * Runs on the CPU only, importObj builds the LODs and the GPU mesh from it.
+		 */
+		static MeshData loadObj(const std::filesystem::path& filePath);
 	};
 }
@@ -0,0 +1,731 @@
+#include "resources/importers/mesh_optimizer.hpp"
+
+#include "core/diagnostics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace PXTEngine {
+
+	namespace {
+		/**
+		 * @brief Vertex -> triangles adjacency in compressed (offsets + flat list) form.
+		 */
+		struct TriangleAdjacency {
+			std::vector<uint32_t> offsets;
+			std::vector<uint32_t> triangles;
+		};
+
+		TriangleAdjacency buildTriangleAdjacency(const std::vector<uint32_t>& indices, size_t vertexCount) {
+			TriangleAdjacency adjacency;
+			adjacency.offsets.assign(vertexCount + 1, 0);
+			adjacency.triangles.resize(indices.size());
+
+			for (uint32_t index : indices) {
+				adjacency.offsets[index + 1]++;
+			}
+
+			std::partial_sum(adjacency.offsets.begin(), adjacency.offsets.end(), adjacency.offsets.begin());
+
+			std::vector<uint32_t> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); i++) {
+				adjacency.triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+
+			return adjacency;
+		}
+
+		/**
+		 * @brief Symmetric 4x4 error quadric, only the upper triangle is stored.
+		 * Planes are area weighted, the accumulated weight normalizes the error back to
+		 * a squared distance.
+		 */
+		struct Quadric {
+			double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+			double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+			double a22 = 0.0, a23 = 0.0;
+			double a33 = 0.0;
+			double weight = 0.0;
+
+			static Quadric fromPlane(const glm::vec3& n, double d, double weight) {
+				Quadric q;
+				q.a00 = weight * n.x * n.x; q.a01 = weight * n.x * n.y; q.a02 = weight * n.x * n.z; q.a03 = weight * n.x * d;
+				q.a11 = weight * n.y * n.y; q.a12 = weight * n.y * n.z; q.a13 = weight * n.y * d;
+				q.a22 = weight * n.z * n.z; q.a23 = weight * n.z * d;
+				q.a33 = weight * d * d;
+				q.weight = weight;
+				return q;
+			}
+
+			Quadric& operator+=(const Quadric& o) {
+				a00 += o.a00; a01 += o.a01; a02 += o.a02; a03 += o.a03;
+				a11 += o.a11; a12 += o.a12; a13 += o.a13;
+				a22 += o.a22; a23 += o.a23;
+				a33 += o.a33;
+				weight += o.weight;
+				return *this;
+			}
+
+			double evaluate(const glm::vec3& p) const {
+				if (weight == 0.0) {
+					return 0.0;
+				}
+
+				const double x = p.x, y = p.y, z = p.z;
+				const double error = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x
+					+ a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y
+					+ a22 * z * z + 2.0 * a23 * z
+					+ a33;
+
+				return std::abs(error) / weight;
+			}
+		};
+
+		/**
+		 * @brief A candidate half-edge collapse: vertex `from` is moved onto vertex `to`.
+		 */
+		struct Collapse {
+			uint32_t from;
+			uint32_t to;
+			double cost;
+		};
+
+		glm::vec3 triangleNormal(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2) {
+			return glm::cross(p1 - p0, p2 - p0);
+		}
+	}
+
+	MeshOptimizer::VertexCacheStats MeshOptimizer::analyzeVertexCache(const std::vector<uint32_t>& indices,
+		size_t vertexCount, uint32_t cacheSize) {
+		VertexCacheStats stats{};
+
+		if (indices.empty()) {
+			return stats;
+		}
+
+		// FIFO cache: a vertex is resident if it was inserted less than cacheSize insertions ago
+		std::vector<uint32_t> insertedAt(vertexCount, 0);
+		std::vector<bool> referenced(vertexCount, false);
+		uint32_t timestamp = cacheSize + 1;
+		uint32_t uniqueVertices = 0;
+
+		for (uint32_t index : indices) {
+			if (timestamp - insertedAt[index] > cacheSize) {
+				insertedAt[index] = timestamp++;
+				stats.vertexTransforms++;
+			}
+
+			if (!referenced[index]) {
+				referenced[index] = true;
+				uniqueVertices++;
+			}
+		}
+
+		stats.acmr = static_cast<float>(stats.vertexTransforms) / static_cast<float>(indices.size() / 3);
+		stats.atvr = static_cast<float>(stats.vertexTransforms) / static_cast<float>(uniqueVertices);
+
+		return stats;
+	}
+
+	void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize) {
+		PXT_PROFILE_FN();
+		PXT_ASSERT(indices.size() % 3 == 0, "Index buffer is not a triangle list");
+
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0) {
+			return;
+		}
+
+		TriangleAdjacency adjacency = buildTriangleAdjacency(indices, vertexCount);
+
+		// number of not yet emitted triangles using each vertex
+		std::vector<uint32_t> liveTriangles(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++) {
+			liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+		}
+
+		std::vector<uint32_t> cacheTime(vertexCount, 0);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<uint32_t> deadEndStack;
+		std::vector<uint32_t> candidates;
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+
+		uint32_t timestamp = cacheSize + 1;
+		size_t inputCursor = 0;
+
+		// picks a vertex whose triangles are still pending when the current fan is exhausted,
+		// first from the recently used vertices, then in input order
+		auto skipDeadEnd = [&]() -> int64_t {
+			while (!deadEndStack.empty()) {
+				uint32_t vertex = deadEndStack.back();
+				deadEndStack.pop_back();
+
+				if (liveTriangles[vertex] > 0) {
+					return vertex;
+				}
+			}
+
+			while (inputCursor < vertexCount) {
+				if (liveTriangles[inputCursor] > 0) {
+					return static_cast<int64_t>(inputCursor);
+				}
+				inputCursor++;
+			}
+
+			return -1;
+		};
+
+		// picks the candidate that will still be in cache after emitting all of its triangles
+		// and that entered the cache the earliest; any live candidate beats a dead-end search
+		auto nextVertex = [&]() -> int64_t {
+			int64_t best = -1;
+			int64_t bestPriority = -1;
+
+			for (uint32_t vertex : candidates) {
+				if (liveTriangles[vertex] == 0) {
+					continue;
+				}
+
+				int64_t priority = 0;
+				if (timestamp - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize) {
+					priority = timestamp - cacheTime[vertex];
+				}
+
+				if (priority > bestPriority) {
+					bestPriority = priority;
+					best = vertex;
+				}
+			}
+
+			return best >= 0 ? best : skipDeadEnd();
+		};
+
+		int64_t fanning = 0;
+		while (fanning >= 0) {
+			candidates.clear();
+
+			const uint32_t fanVertex = static_cast<uint32_t>(fanning);
+			for (uint32_t t = adjacency.offsets[fanVertex]; t < adjacency.offsets[fanVertex + 1]; t++) {
+				const uint32_t triangle = adjacency.triangles[t];
+				if (emitted[triangle]) {
+					continue;
+				}
+
+				for (uint32_t corner = 0; corner < 3; corner++) {
+					const uint32_t vertex = indices[triangle * 3 + corner];
+
+					result.push_back(vertex);
+					deadEndStack.push_back(vertex);
+					candidates.push_back(vertex);
+					liveTriangles[vertex]--;
+
+					if (timestamp - cacheTime[vertex] > cacheSize) {
+						cacheTime[vertex] = timestamp++;
+					}
+				}
+
+				emitted[triangle] = true;
+			}
+
+			fanning = nextVertex();
+		}
+
+		PXT_ASSERT(result.size() == indices.size(), "Vertex cache optimization lost triangles");
+
+		indices = std::move(result);
+	}
+
+	void MeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Mesh::Vertex>& vertices,
+		float threshold, uint32_t cacheSize) {
+		PXT_PROFILE_FN();
+
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount < 2) {
+			return;
+		}
+
+		// Split into clusters at hard boundaries: triangles where every vertex misses the cache,
+		// reordering whole clusters there does not change the cache behaviour inside them.
+		std::vector<uint32_t> clusterStarts;
+		{
+			std::vector<uint32_t> insertedAt(vertices.size(), 0);
+			uint32_t timestamp = cacheSize + 1;
+
+			for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+				uint32_t misses = 0;
+				for (uint32_t corner = 0; corner < 3; corner++) {
+					const uint32_t vertex = indices[triangle * 3 + corner];
+					if (timestamp - insertedAt[vertex] > cacheSize) {
+						insertedAt[vertex] = timestamp++;
+						misses++;
+					}
+				}
+
+				if (misses == 3) {
+					clusterStarts.push_back(static_cast<uint32_t>(triangle));
+				}
+			}
+		}
+
+		if (clusterStarts.size() < 2) {
+			return;
+		}
+
+		struct Cluster {
+			uint32_t firstTriangle;
+			uint32_t triangleCount;
+			glm::vec3 centroid{0.0f};
+			glm::vec3 normal{0.0f};
+			float sortKey = 0.0f;
+		};
+
+		std::vector<Cluster> clusters;
+		clusters.reserve(clusterStarts.size());
+
+		glm::vec3 meshCentroid{0.0f};
+		float meshArea = 0.0f;
+
+		for (size_t c = 0; c < clusterStarts.size(); c++) {
+			Cluster cluster{};
+			cluster.firstTriangle = clusterStarts[c];
+			cluster.triangleCount = (c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : static_cast<uint32_t>(triangleCount))
+				- cluster.firstTriangle;
+
+			float clusterArea = 0.0f;
+			for (uint32_t t = cluster.firstTriangle; t < cluster.firstTriangle + cluster.triangleCount; t++) {
+				const glm::vec3 p0 = vertices[indices[t * 3 + 0]].position;
+				const glm::vec3 p1 = vertices[indices[t * 3 + 1]].position;
+				const glm::vec3 p2 = vertices[indices[t * 3 + 2]].position;
+
+				// length of the cross product is twice the triangle area
+				const glm::vec3 areaNormal = glm::cross(p1 - p0, p2 - p0);
+				const float area = glm::length(areaNormal);
+
+				cluster.centroid += (p0 + p1 + p2) * (area / 3.0f);
+				cluster.normal += areaNormal;
+				clusterArea += area;
+			}
+
+			meshCentroid += cluster.centroid;
+			meshArea += clusterArea;
+
+			cluster.centroid = clusterArea > 0.0f ? cluster.centroid / clusterArea : glm::vec3(0.0f);
+			const float normalLength = glm::length(cluster.normal);
+			cluster.normal = normalLength > 0.0f ? cluster.normal / normalLength : glm::vec3(0.0f);
+
+			clusters.push_back(cluster);
+		}
+
+		meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : glm::vec3(0.0f);
+
+		// clusters facing away from the mesh center are more likely to occlude the others
+		for (Cluster& cluster : clusters) {
+			cluster.sortKey = glm::dot(cluster.centroid - meshCentroid, cluster.normal);
+		}
+
+		std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+			return a.sortKey > b.sortKey;
+		});
+
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+		for (const Cluster& cluster : clusters) {
+			auto begin = indices.begin() + cluster.firstTriangle * 3;
+			result.insert(result.end(), begin, begin + cluster.triangleCount * 3);
+		}
+
+		const VertexCacheStats before = analyzeVertexCache(indices, vertices.size(), cacheSize);
+		const VertexCacheStats after = analyzeVertexCache(result, vertices.size(), cacheSize);
+
+		if (after.acmr <= before.acmr * threshold) {
+			indices = std::move(result);
+		}
+	}
+
+	void MeshOptimizer::optimizeVertexFetch(std::vector<Mesh::Vertex>& vertices, std::vector<uint32_t>& indices) {
+		PXT_PROFILE_FN();
+
+		constexpr uint32_t unmapped = ~0u;
+		std::vector<uint32_t> remap(vertices.size(), unmapped);
+
+		std::vector<Mesh::Vertex> result;
+		result.reserve(vertices.size());
+
+		for (uint32_t& index : indices) {
+			if (remap[index] == unmapped) {
+				remap[index] = static_cast<uint32_t>(result.size());
+				result.push_back(vertices[index]);
+			}
+
+			index = remap[index];
+		}
+
+		vertices = std::move(result);
+	}
+
+	std::vector<uint32_t> MeshOptimizer::simplify(const std::vector<uint32_t>& indices,
+		const std::vector<Mesh::Vertex>& vertices, size_t targetIndexCount, float targetError, float* resultError) {
+		PXT_PROFILE_FN();
+		PXT_ASSERT(indices.size() % 3 == 0, "Index buffer is not a triangle list");
+
+		const size_t vertexCount = vertices.size();
+		std::vector<uint32_t> result = indices;
+
+		auto position = [&](uint32_t vertex) { return glm::vec3(vertices[vertex].position); };
+
+		// Vertices sharing a position with another vertex sit on an attribute seam,
+		// moving them would tear the surface open.
+		std::vector<uint32_t> positionId(vertexCount);
+		std::vector<bool> locked(vertexCount, false);
+		{
+			std::unordered_map<glm::vec3, uint32_t> firstWithPosition;
+			std::vector<uint32_t> sharedCount;
+
+			for (size_t v = 0; v < vertexCount; v++) {
+				auto [it, inserted] = firstWithPosition.try_emplace(position(static_cast<uint32_t>(v)),
+					static_cast<uint32_t>(sharedCount.size()));
+				if (inserted) {
+					sharedCount.push_back(0);
+				}
+				positionId[v] = it->second;
+				sharedCount[it->second]++;
+			}
+
+			for (size_t v = 0; v < vertexCount; v++) {
+				locked[v] = sharedCount[positionId[v]] > 1;
+			}
+		}
+
+		// Edges used by a single triangle are on an open border, lock their vertices too
+		{
+			std::unordered_map<uint64_t, uint32_t> edgeUses;
+			auto edgeKey = [&](uint32_t a, uint32_t b) {
+				uint64_t pa = positionId[a], pb = positionId[b];
+				return pa < pb ? (pa << 32) | pb : (pb << 32) | pa;
+			};
+
+			for (size_t i = 0; i < result.size(); i += 3) {
+				for (uint32_t e = 0; e < 3; e++) {
+					edgeUses[edgeKey(result[i + e], result[i + (e + 1) % 3])]++;
+				}
+			}
+
+			for (size_t i = 0; i < result.size(); i += 3) {
+				for (uint32_t e = 0; e < 3; e++) {
+					const uint32_t a = result[i + e];
+					const uint32_t b = result[i + (e + 1) % 3];
+					if (edgeUses[edgeKey(a, b)] == 1) {
+						locked[a] = true;
+						locked[b] = true;
+					}
+				}
+			}
+		}
+
+		// Area weighted plane quadrics
+		std::vector<Quadric> quadrics(vertexCount);
+		for (size_t i = 0; i < result.size(); i += 3) {
+			const glm::vec3 p0 = position(result[i + 0]);
+			const glm::vec3 normal = triangleNormal(p0, position(result[i + 1]), position(result[i + 2]));
+			const float area = glm::length(normal);
+			if (area == 0.0f) {
+				continue;
+			}
+
+			const glm::vec3 n = normal / area;
+			const Quadric q = Quadric::fromPlane(n, -glm::dot(n, p0), area);
+			for (uint32_t corner = 0; corner < 3; corner++) {
+				quadrics[result[i + corner]] += q;
+			}
+		}
+
+		const double maxCost = static_cast<double>(targetError) * static_cast<double>(targetError);
+		double worstCost = 0.0;
+
+		std::vector<uint32_t> remap(vertexCount);
+		std::vector<bool> touched(vertexCount);
+		std::vector<Collapse> collapses;
+
+		// Every pass collapses a set of independent edges, cheapest first
+		while (result.size() > targetIndexCount) {
+			collapses.clear();
+			for (size_t i = 0; i < result.size(); i += 3) {
+				for (uint32_t e = 0; e < 3; e++) {
+					const uint32_t a = result[i + e];
+					const uint32_t b = result[i + (e + 1) % 3];
+
+					Quadric q = quadrics[a];
+					q += quadrics[b];
+
+					if (!locked[a]) collapses.push_back({a, b, q.evaluate(position(b))});
+					if (!locked[b]) collapses.push_back({b, a, q.evaluate(position(a))});
+				}
+			}
+
+			std::stable_sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) {
+				return x.cost < y.cost;
+			});
+
+			const TriangleAdjacency adjacency = buildTriangleAdjacency(result, vertexCount);
+			std::iota(remap.begin(), remap.end(), 0u);
+			std::fill(touched.begin(), touched.end(), false);
+
+			size_t indexCount = result.size();
+			uint32_t collapsed = 0;
+
+			for (const Collapse& collapse : collapses) {
+				if (collapse.cost > maxCost || indexCount <= targetIndexCount) {
+					break;
+				}
+
+				if (touched[collapse.from] || touched[collapse.to]) {
+					continue;
+				}
+
+				// reject collapses that flip a surviving triangle
+				bool flips = false;
+				uint32_t removedTriangles = 0;
+				for (uint32_t t = adjacency.offsets[collapse.from]; t < adjacency.offsets[collapse.from + 1]; t++) {
+					const uint32_t triangle = adjacency.triangles[t];
+					uint32_t corners[3];
+					for (uint32_t corner = 0; corner < 3; corner++) {
+						corners[corner] = remap[result[triangle * 3 + corner]];
+					}
+
+					if (corners[0] == corners[1] || corners[1] == corners[2] || corners[2] == corners[0]) {
+						continue;
+					}
+
+					if (corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to) {
+						removedTriangles++;
+						continue;
+					}
+
+					const glm::vec3 before = triangleNormal(position(corners[0]), position(corners[1]), position(corners[2]));
+					for (uint32_t& corner : corners) {
+						if (corner == collapse.from) corner = collapse.to;
+					}
+					const glm::vec3 after = triangleNormal(position(corners[0]), position(corners[1]), position(corners[2]));
+
+					if (glm::dot(before, after) <= 0.0f) {
+						flips = true;
+						break;
+					}
+				}
+
+				if (flips) {
+					continue;
+				}
+
+				remap[collapse.from] = collapse.to;
+				quadrics[collapse.to] += quadrics[collapse.from];
+				touched[collapse.from] = true;
+				touched[collapse.to] = true;
+
+				worstCost = std::max(worstCost, collapse.cost);
+				indexCount -= removedTriangles * 3;
+				collapsed++;
+			}
+
+			if (collapsed == 0) {
+				break;
+			}
+
+			size_t write = 0;
+			for (size_t i = 0; i < result.size(); i += 3) {
+				const uint32_t a = remap[result[i + 0]];
+				const uint32_t b = remap[result[i + 1]];
+				const uint32_t c = remap[result[i + 2]];
+
+				if (a != b && b != c && c != a) {
+					result[write++] = a;
+					result[write++] = b;
+					result[write++] = c;
+				}
+			}
+			result.resize(write);
+		}
+
+		if (resultError != nullptr) {
+			*resultError = static_cast<float>(std::sqrt(std::max(worstCost, 0.0)));
+		}
+
+		return result;
+	}
+
+	Mesh::MeshletData MeshOptimizer::buildMeshlets(const std::vector<uint32_t>& indices,
+		const std::vector<Mesh::Vertex>& vertices, uint32_t maxVertices, uint32_t maxTriangles) {
+		PXT_PROFILE_FN();
+		PXT_ASSERT(maxVertices >= 3 && maxVertices <= 256, "Meshlet vertex limit must be in [3, 256]");
+		PXT_ASSERT(maxTriangles >= 1, "Meshlet triangle limit must be at least 1");
+
+		Mesh::MeshletData data;
+
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0) {
+			return data;
+		}
+
+		const TriangleAdjacency adjacency = buildTriangleAdjacency(indices, vertices.size());
+
+		constexpr int32_t notInMeshlet = -1;
+		std::vector<int32_t> localIndex(vertices.size(), notInMeshlet);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<uint32_t> meshletVertices;
+
+		Mesh::Meshlet current{};
+		size_t emittedCount = 0;
+		size_t nextSeed = 0;
+
+		auto newVertexCount = [&](uint32_t triangle) {
+			const uint32_t a = indices[triangle * 3 + 0];
+			const uint32_t b = indices[triangle * 3 + 1];
+			const uint32_t c = indices[triangle * 3 + 2];
+
+			uint32_t count = 0;
+			count += localIndex[a] == notInMeshlet;
+			count += localIndex[b] == notInMeshlet && b != a;
+			count += localIndex[c] == notInMeshlet && c != a && c != b;
+			return count;
+		};
+
+		auto computeBounds = [&](Mesh::Meshlet& meshlet) {
+			glm::vec3 minimum{ std::numeric_limits<float>::max() };
+			glm::vec3 maximum{ std::numeric_limits<float>::lowest() };
+			for (uint32_t v = 0; v < meshlet.vertexCount; v++) {
+				const glm::vec3 p = vertices[data.vertices[meshlet.vertexOffset + v]].position;
+				minimum = glm::min(minimum, p);
+				maximum = glm::max(maximum, p);
+			}
+
+			const glm::vec3 center = (minimum + maximum) * 0.5f;
+			float radius = 0.0f;
+			for (uint32_t v = 0; v < meshlet.vertexCount; v++) {
+				const glm::vec3 p = vertices[data.vertices[meshlet.vertexOffset + v]].position;
+				radius = std::max(radius, glm::length(p - center));
+			}
+			meshlet.boundingSphere = glm::vec4(center, radius);
+
+			// normal cone: average facing direction and the widest deviation from it
+			std::vector<glm::vec3> normals;
+			normals.reserve(meshlet.triangleCount);
+			glm::vec3 axis{ 0.0f };
+			for (uint32_t t = 0; t < meshlet.triangleCount; t++) {
+				glm::vec3 p[3];
+				for (uint32_t corner = 0; corner < 3; corner++) {
+					const uint8_t local = data.triangles[meshlet.triangleOffset + t * 3 + corner];
+					p[corner] = vertices[data.vertices[meshlet.vertexOffset + local]].position;
+				}
+
+				const glm::vec3 normal = triangleNormal(p[0], p[1], p[2]);
+				const float length = glm::length(normal);
+				if (length > 0.0f) {
+					normals.push_back(normal / length);
+					axis += normal / length;
+				}
+			}
+
+			const float axisLength = glm::length(axis);
+			float minDot = 1.0f;
+			if (axisLength > 0.0f) {
+				axis /= axisLength;
+				for (const glm::vec3& normal : normals) {
+					minDot = std::min(minDot, glm::dot(normal, axis));
+				}
+			}
+
+			// a cone wider than ~84 degrees never culls anything, a cutoff of 1 disables the test
+			const float cutoff = (axisLength == 0.0f || minDot <= 0.1f) ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+			meshlet.cone = glm::vec4(axis, cutoff);
+		};
+
+		auto flush = [&]() {
+			if (current.triangleCount == 0) {
+				return;
+			}
+
+			computeBounds(current);
+			data.meshlets.push_back(current);
+
+			for (uint32_t vertex : meshletVertices) {
+				localIndex[vertex] = notInMeshlet;
+			}
+			meshletVertices.clear();
+
+			// keep every meshlet triangle list 4 byte aligned for 32 bit loads on the GPU
+			while (data.triangles.size() % 4 != 0) {
+				data.triangles.push_back(0);
+			}
+
+			current = {};
+			current.vertexOffset = static_cast<uint32_t>(data.vertices.size());
+			current.triangleOffset = static_cast<uint32_t>(data.triangles.size());
+		};
+
+		auto append = [&](uint32_t triangle) {
+			for (uint32_t corner = 0; corner < 3; corner++) {
+				const uint32_t vertex = indices[triangle * 3 + corner];
+				if (localIndex[vertex] == notInMeshlet) {
+					localIndex[vertex] = static_cast<int32_t>(current.vertexCount++);
+					data.vertices.push_back(vertex);
+					meshletVertices.push_back(vertex);
+				}
+				data.triangles.push_back(static_cast<uint8_t>(localIndex[vertex]));
+			}
+
+			current.triangleCount++;
+			emitted[triangle] = true;
+			emittedCount++;
+		};
+
+		while (emittedCount < triangleCount) {
+			// grow the meshlet with the connected triangle sharing the most vertices
+			int64_t best = -1;
+			uint32_t bestShared = 0;
+
+			for (uint32_t vertex : meshletVertices) {
+				for (uint32_t t = adjacency.offsets[vertex]; t < adjacency.offsets[vertex + 1]; t++) {
+					const uint32_t triangle = adjacency.triangles[t];
+					if (emitted[triangle]) {
+						continue;
+					}
+
+					const uint32_t added = newVertexCount(triangle);
+					if (current.vertexCount + added > maxVertices) {
+						continue;
+					}
+
+					const uint32_t shared = 3 - added;
+					if (best < 0 || shared > bestShared || (shared == bestShared && triangle < best)) {
+						best = triangle;
+						bestShared = shared;
+					}
+				}
+			}
+
+			// nothing connected fits, start a new meshlet from the first pending triangle
+			if (best < 0) {
+				flush();
+
+				while (emitted[nextSeed]) {
+					nextSeed++;
+				}
+				best = static_cast<int64_t>(nextSeed);
+			}
+
+			append(static_cast<uint32_t>(best));
+
+			if (current.triangleCount == maxTriangles) {
+				flush();
+			}
+		}
+
+		flush();
+
+		return data;
+	}
+}
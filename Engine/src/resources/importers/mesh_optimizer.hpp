@@ -0,0 +1,119 @@
+#pragma once
+
+#include "resources/types/mesh.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace PXTEngine {
+
+	/**
+	 * @class MeshOptimizer
+	 *
+	 * @brief CPU-side post-import processing for indexed triangle meshes.
+	 *
+	 * The passes are meant to be run in this order after welding:
+	 * optimizeVertexCache -> optimizeOverdraw -> optimizeVertexFetch.
+	 * Every pass preserves triangle winding and only reorders data, so the rendered
+	 * result is identical to the input mesh.
+	 */
+	class MeshOptimizer {
+	public:
+		/**
+		 * @struct VertexCacheStats
+		 *
+		 * @brief Post-transform cache statistics of an index buffer.
+		 * ACMR: average cache miss ratio (transformed vertices per triangle, 0.5 - 3.0).
+		 * ATVR: average transform to vertex ratio (transformed vertices per unique vertex, >= 1.0).
+		 */
+		struct VertexCacheStats {
+			uint32_t vertexTransforms = 0;
+			float acmr = 0.0f;
+			float atvr = 0.0f;
+		};
+
+		static constexpr uint32_t DEFAULT_CACHE_SIZE = 16;
+		static constexpr uint32_t MAX_MESHLET_VERTICES = 64;
+		static constexpr uint32_t MAX_MESHLET_TRIANGLES = 124;
+		static constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+
+		/**
+		 * @brief Simulates a FIFO post-transform cache over the index buffer.
+		 *
+		 * @param indices Triangle list index buffer.
+		 * @param vertexCount Number of vertices referenced by the index buffer.
+		 * @param cacheSize Number of entries in the simulated cache.
+		 * @return The cache statistics of the index buffer.
+		 */
+		static VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount,
+			uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+
+		/**
+		 * @brief Reorders triangles for post-transform cache locality (Tipsify, Sander et al. 2007).
+		 *
+		 * @param indices Triangle list index buffer, reordered in place.
+		 * @param vertexCount Number of vertices referenced by the index buffer.
+		 * @param cacheSize Number of entries in the targeted cache.
+		 */
+		static void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount,
+			uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+
+		/**
+		 * @brief Reorders the clusters produced by optimizeVertexCache so that triangles
+		 * facing outwards are drawn first, reducing overdraw from any view direction.
+		 *
+		 * Clusters are split at hard cache boundaries only; if the new order degrades
+		 * the ACMR by more than the given threshold the input order is kept.
+		 *
+		 * @param indices Cache optimized index buffer, reordered in place.
+		 * @param vertices Vertex buffer referenced by the indices.
+		 * @param threshold Maximum allowed ACMR ratio (new / old).
+		 * @param cacheSize Number of entries in the targeted cache.
+		 */
+		static void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Mesh::Vertex>& vertices,
+			float threshold = DEFAULT_OVERDRAW_THRESHOLD, uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+
+		/**
+		 * @brief Reorders vertices in the order they are first referenced by the index buffer
+		 * and remaps the indices accordingly. Unreferenced vertices are dropped.
+		 *
+		 * @param vertices Vertex buffer, rewritten in fetch order.
+		 * @param indices Index buffer, remapped in place.
+		 */
+		static void optimizeVertexFetch(std::vector<Mesh::Vertex>& vertices, std::vector<uint32_t>& indices);
+
+		/**
+		 * @brief Simplifies the mesh with quadric error metric edge collapses (Garland-Heckbert).
+		 *
+		 * Collapses are half-edge collapses onto existing vertices, so the vertex buffer is shared
+		 * with the source mesh and only a new index buffer is produced. Vertices on open borders
+		 * and on attribute seams (same position, different normal/uv) are never moved.
+		 *
+		 * @param indices Source triangle list index buffer.
+		 * @param vertices Vertex buffer referenced by the indices.
+		 * @param targetIndexCount Index count to stop at.
+		 * @param targetError Maximum geometric error, in model space units.
+		 * @param resultError Optional output of the geometric error of the result, in model space units.
+		 * @return The simplified index buffer.
+		 */
+		static std::vector<uint32_t> simplify(const std::vector<uint32_t>& indices, const std::vector<Mesh::Vertex>& vertices,
+			size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+		/**
+		 * @brief Partitions the mesh into meshlets with bounding spheres and normal cones.
+		 *
+		 * Meshlets are grown greedily from the triangle order of the index buffer, preferring
+		 * triangles that share the most vertices with the current meshlet. Ties are broken by
+		 * triangle order, so the result only depends on the input. Not run at import yet, the meshes
+		 * will be clustered once a cluster culling pass consumes the meshlets.
+		 *
+		 * @param indices Triangle list index buffer, ideally already cache optimized.
+		 * @param vertices Vertex buffer referenced by the indices.
+		 * @param maxVertices Maximum number of vertices per meshlet (at most 256).
+		 * @param maxTriangles Maximum number of triangles per meshlet.
+		 * @return The meshlets and their vertex and triangle lists.
+		 */
+		static Mesh::MeshletData buildMeshlets(const std::vector<uint32_t>& indices, const std::vector<Mesh::Vertex>& vertices,
+			uint32_t maxVertices = MAX_MESHLET_VERTICES, uint32_t maxTriangles = MAX_MESHLET_TRIANGLES);
+	};
+}
@@ -11,7 +11,9 @@ namespace PXTEngine {
         const Shared<Image>& roughnessMap,
         const Shared<Image>& ambientOcclusionMap,
         const glm::vec4& emissiveColor,
-        const Shared<Image>& emissiveMap)
+        const Shared<Image>& emissiveMap,
+        AlphaMode alphaMode,
+        float alphaCutoff)
         : m_albedoColor(albedoColor),
         m_albedoMap(albedoMap),
         m_normalMap(normalMap),
@@ -19,7 +21,9 @@ namespace PXTEngine {
         m_roughnessMap(roughnessMap),
         m_ambientOcclusionMap(ambientOcclusionMap),
         m_emissiveColor(emissiveColor),
-        m_emissiveMap(emissiveMap) {}
+        m_emissiveMap(emissiveMap),
+        m_alphaMode(alphaMode),
+        m_alphaCutoff(alphaCutoff) {}
 
     Material::Type Material::getStaticType() {
         return Type::Material;
@@ -37,6 +41,8 @@ namespace PXTEngine {
     Shared<Image> Material::getAmbientOcclusionMap() const { return m_ambientOcclusionMap; }
     const glm::vec4& Material::getEmissiveColor() const { return m_emissiveColor; }
     Shared<Image> Material::getEmissiveMap() const { return m_emissiveMap; }
+    Material::AlphaMode Material::getAlphaMode() const { return m_alphaMode; }
+    float Material::getAlphaCutoff() const { return m_alphaCutoff; }
 
     // -------- Builder Implementation --------
 
@@ -80,6 +86,12 @@ namespace PXTEngine {
         return *this;
     }
 
+    Material::Builder& Material::Builder::setAlphaMode(AlphaMode mode, float alphaCutoff) {
+        m_alphaMode = mode;
+        m_alphaCutoff = alphaCutoff;
+        return *this;
+    }
+
     Shared<Material> Material::Builder::build() {
         if (!m_albedoMap) m_albedoMap = ResourceManager::defaultMaterial->getAlbedoMap();
         if (!m_normalMap) m_normalMap = ResourceManager::defaultMaterial->getNormalMap();
@@ -96,7 +108,9 @@ namespace PXTEngine {
             m_roughnessMap,
             m_ambientOcclusionMap,
             m_emissiveColor,
-            m_emissiveMap
+            m_emissiveMap,
+            m_alphaMode,
+            m_alphaCutoff
         );
     }
 }
\ No newline at end of file
@@ -21,6 +21,15 @@ namespace PXTEngine {
 	 */
     class Material : public Resource {
     public:
+        /**
+         * @brief How the albedo alpha is used: ignored, or compared to the alpha cutoff to cut out
+         * the fragments below it.
+         */
+        enum class AlphaMode {
+            Opaque,
+            Mask
+        };
+
         class Builder {
         public:
             Builder& setAlbedoColor(const glm::vec4& color);
@@ -31,6 +40,7 @@ namespace PXTEngine {
             Builder& setAmbientOcclusionMap(Shared<Image> map);
             Builder& setEmissiveColor(const glm::vec4& color);
             Builder& setEmissiveMap(Shared<Image> map);
+            Builder& setAlphaMode(AlphaMode mode, float alphaCutoff = 0.5f);
             Shared<Material> build();
 
         protected:
@@ -42,6 +52,8 @@ namespace PXTEngine {
             Shared<Image> m_ambientOcclusionMap{ nullptr };
             glm::vec4 m_emissiveColor{ 0.0f };
             Shared<Image> m_emissiveMap{ nullptr };
+            AlphaMode m_alphaMode = AlphaMode::Opaque;
+            float m_alphaCutoff = 0.5f;
         };
 
         Material(
@@ -52,7 +64,9 @@ namespace PXTEngine {
             const Shared<Image>& roughnessMap,
             const Shared<Image>& ambientOcclusionMap,
             const glm::vec4& emissiveColor,
-            const Shared<Image>& emissiveMap
+            const Shared<Image>& emissiveMap,
+            AlphaMode alphaMode = AlphaMode::Opaque,
+            float alphaCutoff = 0.5f
         );
 
         static Type getStaticType();
@@ -66,6 +80,8 @@ namespace PXTEngine {
         Shared<Image> getAmbientOcclusionMap() const;
         const glm::vec4& getEmissiveColor() const;
         Shared<Image> getEmissiveMap() const;
+        AlphaMode getAlphaMode() const;
+        float getAlphaCutoff() const;
 
     protected:
         glm::vec4 m_albedoColor{ 1.0f };
@@ -76,5 +92,7 @@ namespace PXTEngine {
         Shared<Image> m_ambientOcclusionMap{ nullptr };
         glm::vec4 m_emissiveColor{ 0.0f };
         Shared<Image> m_emissiveMap{ nullptr };
+        AlphaMode m_alphaMode = AlphaMode::Opaque;
+        float m_alphaCutoff = 0.5f;
     };
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "resources/types/mesh.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace PXTEngine {
+
+	Bounds Mesh::computeBounds(const std::vector<Vertex>& vertices) {
+		Bounds bounds;
+		if (vertices.empty()) {
+			return bounds;
+		}
+
+		for (const auto& vertex : vertices) {
+			bounds.box.expand(glm::vec3(vertex.position));
+		}
+
+		bounds.sphere.center = bounds.box.center();
+		for (const auto& vertex : vertices) {
+			bounds.sphere.radius = std::max(bounds.sphere.radius, glm::length(glm::vec3(vertex.position) - bounds.sphere.center));
+		}
+
+		return bounds;
+	}
+
+	Mesh::OccluderGeometry Mesh::buildOccluderGeometry(const std::vector<Vertex>& vertices,
+		const std::vector<uint32_t>& indices, const Lod& lod) {
+		OccluderGeometry geometry;
+		geometry.indices.reserve(lod.indexCount);
+
+		constexpr uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+		std::vector<uint32_t> remap(vertices.size(), UNUSED);
+
+		for (uint32_t i = lod.firstIndex; i < lod.firstIndex + lod.indexCount; i++) {
+			const uint32_t index = indices[i];
+			if (remap[index] == UNUSED) {
+				remap[index] = static_cast<uint32_t>(geometry.positions.size());
+				geometry.positions.push_back(glm::vec3(vertices[index].position));
+			}
+			geometry.indices.push_back(remap[index]);
+		}
+
+		return geometry;
+	}
+
+	uint32_t Mesh::selectLod(const BoundingSphere& worldSphere, float scale, const glm::vec3& eye, float projectionScale,
+		float errorThreshold, uint32_t lodBias) const {
+		const std::vector<Lod>& lods = getLods();
+		if (lods.size() <= 1) {
+			return 0;
+		}
+
+		const uint32_t lastLod = static_cast<uint32_t>(lods.size()) - 1;
+
+		// distance to the closest point of the bounding sphere, the viewer inside it always gets LOD 0
+		const float distance = glm::length(worldSphere.center - eye) - worldSphere.radius;
+
+		uint32_t lod = 0;
+		if (distance > 0.0f) {
+			const float errorToScreen = scale * projectionScale / distance;
+
+			while (lod < lastLod && lods[lod + 1].error * errorToScreen <= errorThreshold) {
+				lod++;
+			}
+		}
+
+		return std::min(lod + lodBias, lastLod);
+	}
+}
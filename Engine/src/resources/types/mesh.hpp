@@ -3,6 +3,7 @@
 #include "core/memory.hpp"
 #include "resources/resource.hpp"
 #include "utils/hash_func.hpp"
+#include "utils/bounds.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -21,6 +22,9 @@ namespace PXTEngine {
 	 * This struct can be used to store metadata or other relevant information about the mesh.
 	 */
 	struct MeshInfo : public ResourceInfo {
+		uint32_t maxLodCount = 4;		// LOD 0 included, 1 disables the LOD chain
+		float lodReductionRatio = 0.5f; // target triangle ratio between two consecutive LODs
+		float lodMaxError = 0.02f;		// maximum simplification error, relative to the mesh bounding radius
 	};
 
 	/**
@@ -51,9 +55,101 @@ namespace PXTEngine {
             }
         };
 
+        /**
+         * @struct Lod
+         *
+         * @brief A level of detail as a range of the mesh index buffer.
+         * All the LODs of a mesh share the same vertex buffer.
+         */
+        struct Lod {
+            uint32_t firstIndex = 0;
+            uint32_t indexCount = 0;
+            float error = 0.0f;     // simplification error in model space units
+        };
+
+        /**
+         * @struct Meshlet
+         *
+         * @brief A cluster of up to 64 vertices and 124 triangles, laid out for std430.
+         * Local triangle indices are 8 bit, stored 3 per triangle in the meshlet triangle list.
+         * Built by MeshOptimizer::buildMeshlets, meshes do not store them until a cluster culling pass consumes them.
+         */
+        struct alignas(16) Meshlet {
+            glm::vec4 boundingSphere{}; // xyz center, w radius (model space)
+            glm::vec4 cone{};           // xyz axis, w cutoff; the cluster is backfacing when
+                                        // dot(center - eye, axis) >= cutoff * |center - eye| + radius
+            uint32_t vertexOffset = 0;  // first entry in the meshlet vertex list
+            uint32_t triangleOffset = 0;// first byte in the meshlet triangle list
+            uint32_t vertexCount = 0;
+            uint32_t triangleCount = 0;
+        };
+
+        /**
+         * @struct MeshletData
+         *
+         * @brief Meshlets of a mesh together with their vertex and local triangle lists.
+         */
+        struct MeshletData {
+            std::vector<Meshlet> meshlets;
+            std::vector<uint32_t> vertices;  // indices into the mesh vertex buffer
+            std::vector<uint8_t> triangles;  // meshlet local indices, 3 per triangle
+        };
+
+        /**
+         * @struct OccluderGeometry
+         *
+         * @brief Compacted positions and triangles of a LOD, kept on the CPU for software occlusion culling.
+         */
+        struct OccluderGeometry {
+            std::vector<glm::vec3> positions;
+            std::vector<uint32_t> indices;
+        };
+
+        static constexpr float DEFAULT_LOD_ERROR_THRESHOLD = 1.0f / 540.0f; // ~1 pixel at 1080p
+
         virtual const uint32_t getVertexCount() const = 0;
         virtual const uint32_t getIndexCount() const  = 0;
 
+        /**
+         * @brief Returns the LOD chain, LOD 0 being the full resolution mesh.
+         */
+        virtual const std::vector<Lod>& getLods() const = 0;
+
+        /**
+         * @brief Returns the model space bounding box and sphere, computed at import.
+         */
+        virtual const Bounds& getBounds() const = 0;
+
+        /**
+         * @brief Returns the occluder geometry, built from the coarsest LOD.
+         */
+        virtual const OccluderGeometry& getOccluderGeometry() const = 0;
+
+        /**
+         * @brief Computes the bounding box of the vertices and the sphere centered in it.
+         */
+        static Bounds computeBounds(const std::vector<Vertex>& vertices);
+
+        /**
+         * @brief Copies the positions referenced by a LOD and remaps its indices to them.
+         */
+        static OccluderGeometry buildOccluderGeometry(const std::vector<Vertex>& vertices,
+            const std::vector<uint32_t>& indices, const Lod& lod);
+
+        /**
+         * @brief Picks the coarsest LOD whose simplification error projects below the threshold.
+         *
+         * @param worldSphere World space bounding sphere of the mesh.
+         * @param scale Largest axis scale of the model matrix.
+         * @param eye World space position of the viewer.
+         * @param projectionScale Vertical projection scale (projection[1][1]).
+         * @param errorThreshold Maximum error in viewport half-height units.
+         * @param lodBias Number of LODs to step down after the selection.
+         * @return The selected LOD index.
+         */
+        uint32_t selectLod(const BoundingSphere& worldSphere, float scale, const glm::vec3& eye, float projectionScale,
+            float errorThreshold = DEFAULT_LOD_ERROR_THRESHOLD, uint32_t lodBias = 0) const;
+
         static Type getStaticType() { return Type::Mesh; }
     };
 }
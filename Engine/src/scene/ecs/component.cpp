@@ -84,6 +84,30 @@ namespace PXTEngine
 		};
 	}
 
+	float TransformComponent::maxScale() const {
+		return glm::max(glm::abs(scale.x), glm::max(glm::abs(scale.y), glm::abs(scale.z)));
+	}
+
+	// --- WorldBoundsComponent ---
+	bool WorldBoundsComponent::update(TransformComponent& transform, const MeshComponent& meshComponent) {
+		const Mesh* mesh = meshComponent.mesh.get();
+
+		if (mesh == m_mesh && transform.translation == m_translation
+			&& transform.scale == m_scale && transform.rotation == m_rotation) {
+			return false;
+		}
+
+		m_mesh = mesh;
+		m_translation = transform.translation;
+		m_scale = transform.scale;
+		m_rotation = transform.rotation;
+
+		bounds = mesh != nullptr ? mesh->getBounds().transform(transform.mat4(), transform.maxScale()) : Bounds{};
+		version++;
+
+		return true;
+	}
+
 	// --- CameraComponent ---
 	CameraComponent::CameraComponent()
 		: isMainCamera(true)
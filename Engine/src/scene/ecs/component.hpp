@@ -53,6 +53,10 @@ namespace PXTEngine
 		float tilingFactor = 1.0f;
 		glm::vec3 tint{ 1.0f };
 
+		// index of the material in the MaterialRegistry, resolved when the component is added
+		// or replaced (see MaterialRegistry::trackMaterialComponents)
+		uint32_t materialIndex = 0;
+
 		MaterialComponent();
 
 		MaterialComponent(const MaterialComponent&) = default;
@@ -137,6 +141,11 @@ namespace PXTEngine
 		glm::mat4 mat4();
 		glm::mat3 normalMatrix();
 
+		/**
+		 * @brief Largest absolute axis scale, used to scale bounding spheres to world space
+		 */
+		float maxScale() const;
+
 		TransformComponent() = default;
 		TransformComponent(const TransformComponent&) = default;
 		
@@ -165,6 +174,51 @@ namespace PXTEngine
 		MeshComponent(const Shared<Mesh>& mesh) : mesh(mesh) {}
 	};
 
+	/**
+	 * @brief Marks a mesh entity as an occluder for the software occlusion culler.
+	 *
+	 * The occluder is rasterized from the coarsest LOD of the entity mesh, or from the proxy mesh if set,
+	 * with the entity transform. Proxies must stay inside the rendered mesh, a proxy sticking out of it
+	 * hides objects that are actually visible. Large, simple meshes (walls, floors, buildings) make good occluders.
+	 */
+	struct OccluderComponent {
+		Shared<Mesh> proxy = nullptr;
+
+		OccluderComponent() = default;
+		OccluderComponent(const OccluderComponent&) = default;
+
+		OccluderComponent(const Shared<Mesh>& proxy) : proxy(proxy) {}
+	};
+
+	/**
+	 * @brief World space bounds of a mesh entity, cached from the mesh bounds and the transform.
+	 *
+	 * Added and refreshed by Scene::onUpdate for every entity with a TransformComponent and a MeshComponent;
+	 * the bounds are recomputed only when the transform or the mesh changed.
+	 */
+	struct WorldBoundsComponent {
+		Bounds bounds;
+		// incremented every time the bounds are recomputed, lets systems detect moved entities
+		uint32_t version = 0;
+
+		WorldBoundsComponent() = default;
+		WorldBoundsComponent(const WorldBoundsComponent&) = default;
+
+		/**
+		 * @brief Recomputes the world bounds if the transform or the mesh changed since the last call
+		 *
+		 * @return true if the bounds were recomputed
+		 */
+		bool update(TransformComponent& transform, const MeshComponent& meshComponent);
+
+	private:
+		// state the bounds were computed from
+		const Mesh* m_mesh = nullptr;
+		glm::vec3 m_translation{};
+		glm::vec3 m_scale{};
+		glm::vec3 m_rotation{};
+	};
+
 	class Script; // Forward declaration of Script class			
 	struct ScriptComponent {
 		Script* script = nullptr;
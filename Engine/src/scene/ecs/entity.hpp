@@ -65,6 +65,19 @@ namespace PXTEngine {
             return m_scene->m_registry.emplace<Component>(m_enttEntity, std::forward<Args>(args)...);
         }
 
+        /**
+         * @brief Replace a component of entity, listeners of Scene::onComponentReplaced are notified
+         * 
+         * @tparam Component type
+         * @return Reference to the new component
+         */
+        template <typename Component, typename... Args>
+        Component& replace(Args&&... args) {
+            PXT_ASSERT(has<Component>(), "Entity does not have component");
+
+            return m_scene->m_registry.replace<Component>(m_enttEntity, std::forward<Args>(args)...);
+        }
+
         /**
          * @brief Remove a component from entity
          * 
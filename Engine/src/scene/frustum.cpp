@@ -0,0 +1,135 @@
+#include "scene/frustum.hpp"
+
+#include "core/platform.hpp"
+
+#include <cmath>
+
+#if defined(PXT_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace PXTEngine {
+
+	Frustum Frustum::fromMatrix(const glm::mat4& viewProjection) {
+		// glm is column major, row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+		const glm::mat4 m = glm::transpose(viewProjection);
+
+		const glm::vec4 planes[6] = {
+			m[3] + m[0], // left
+			m[3] - m[0], // right
+			m[3] + m[1], // bottom (top with a flipped y)
+			m[3] - m[1], // top
+			m[2],        // near, z >= 0
+			m[3] - m[2], // far
+		};
+
+		Frustum frustum;
+		for (int i = 0; i < PLANE_COUNT; i++) {
+			if (i >= 6) {
+				// padding plane 0 * p + 1 >= 0, always inside
+				frustum.m_distance[i] = 1.0f;
+				continue;
+			}
+
+			const float length = glm::length(glm::vec3(planes[i]));
+			const glm::vec4 plane = length > 0.0f ? planes[i] / length : planes[i];
+
+			frustum.m_normalX[i] = plane.x;
+			frustum.m_normalY[i] = plane.y;
+			frustum.m_normalZ[i] = plane.z;
+			frustum.m_distance[i] = plane.w;
+		}
+
+		return frustum;
+	}
+
+#if defined(PXT_SIMD_SSE2)
+
+	bool Frustum::intersects(const BoundingSphere& sphere) const {
+		const __m128 cx = _mm_set1_ps(sphere.center.x);
+		const __m128 cy = _mm_set1_ps(sphere.center.y);
+		const __m128 cz = _mm_set1_ps(sphere.center.z);
+		const __m128 radius = _mm_set1_ps(sphere.radius);
+
+		__m128 outside = _mm_setzero_ps();
+		for (int i = 0; i < PLANE_COUNT; i += 4) {
+			// dot(n, c) + d + r
+			__m128 distance = _mm_load_ps(&m_distance[i]);
+			distance = _mm_add_ps(distance, _mm_mul_ps(_mm_load_ps(&m_normalX[i]), cx));
+			distance = _mm_add_ps(distance, _mm_mul_ps(_mm_load_ps(&m_normalY[i]), cy));
+			distance = _mm_add_ps(distance, _mm_mul_ps(_mm_load_ps(&m_normalZ[i]), cz));
+			distance = _mm_add_ps(distance, radius);
+
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+		}
+
+		return _mm_movemask_ps(outside) == 0;
+	}
+
+	bool Frustum::intersects(const BoundingBox& box) const {
+		const glm::vec3 center = box.center();
+		const glm::vec3 extents = box.extents();
+
+		const __m128 cx = _mm_set1_ps(center.x);
+		const __m128 cy = _mm_set1_ps(center.y);
+		const __m128 cz = _mm_set1_ps(center.z);
+		const __m128 ex = _mm_set1_ps(extents.x);
+		const __m128 ey = _mm_set1_ps(extents.y);
+		const __m128 ez = _mm_set1_ps(extents.z);
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+
+		__m128 outside = _mm_setzero_ps();
+		for (int i = 0; i < PLANE_COUNT; i += 4) {
+			const __m128 nx = _mm_load_ps(&m_normalX[i]);
+			const __m128 ny = _mm_load_ps(&m_normalY[i]);
+			const __m128 nz = _mm_load_ps(&m_normalZ[i]);
+
+			// signed distance of the center plus the projected half size of the box on the normal
+			__m128 distance = _mm_load_ps(&m_distance[i]);
+			distance = _mm_add_ps(distance, _mm_mul_ps(nx, cx));
+			distance = _mm_add_ps(distance, _mm_mul_ps(ny, cy));
+			distance = _mm_add_ps(distance, _mm_mul_ps(nz, cz));
+			distance = _mm_add_ps(distance, _mm_mul_ps(_mm_andnot_ps(signMask, nx), ex));
+			distance = _mm_add_ps(distance, _mm_mul_ps(_mm_andnot_ps(signMask, ny), ey));
+			distance = _mm_add_ps(distance, _mm_mul_ps(_mm_andnot_ps(signMask, nz), ez));
+
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+		}
+
+		return _mm_movemask_ps(outside) == 0;
+	}
+
+#else
+
+	bool Frustum::intersects(const BoundingSphere& sphere) const {
+		for (int i = 0; i < PLANE_COUNT; i++) {
+			const float distance = m_normalX[i] * sphere.center.x + m_normalY[i] * sphere.center.y
+				+ m_normalZ[i] * sphere.center.z + m_distance[i];
+
+			if (distance < -sphere.radius) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool Frustum::intersects(const BoundingBox& box) const {
+		const glm::vec3 center = box.center();
+		const glm::vec3 extents = box.extents();
+
+		for (int i = 0; i < PLANE_COUNT; i++) {
+			const float distance = m_normalX[i] * center.x + m_normalY[i] * center.y + m_normalZ[i] * center.z + m_distance[i];
+			const float radius = std::abs(m_normalX[i]) * extents.x + std::abs(m_normalY[i]) * extents.y
+				+ std::abs(m_normalZ[i]) * extents.z;
+
+			if (distance + radius < 0.0f) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+#endif
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "utils/bounds.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+namespace PXTEngine {
+
+	/**
+	 * @class Frustum
+	 *
+	 * @brief View frustum as 6 inward facing planes, stored as structure of arrays so that
+	 * 4 planes are tested at once with SIMD. The 2 padding planes always pass.
+	 */
+	class Frustum {
+	public:
+		/**
+		 * @brief Extracts the frustum planes from a view projection matrix (Gribb-Hartmann),
+		 * for a [0, 1] clip space depth range.
+		 *
+		 * @param viewProjection The projection * view matrix.
+		 * @return The frustum in the space the view matrix transforms from.
+		 */
+		static Frustum fromMatrix(const glm::mat4& viewProjection);
+
+		/**
+		 * @brief Tests if a sphere is at least partially inside the frustum.
+		 */
+		bool intersects(const BoundingSphere& sphere) const;
+
+		/**
+		 * @brief Tests if a box is at least partially inside the frustum.
+		 * Boxes crossing the frustum corners outside of it can pass, the test is conservative.
+		 */
+		bool intersects(const BoundingBox& box) const;
+
+		/**
+		 * @brief Sphere test first, box test only for the spheres that pass.
+		 */
+		bool intersects(const Bounds& bounds) const {
+			return intersects(bounds.sphere) && intersects(bounds.box);
+		}
+
+		/**
+		 * @brief Returns plane i (0 to 5) as (normal, d), for uploading to shaders.
+		 */
+		glm::vec4 getPlane(int i) const {
+			return { m_normalX[i], m_normalY[i], m_normalZ[i], m_distance[i] };
+		}
+
+	private:
+		static constexpr int PLANE_COUNT = 8; // 6 planes padded to two SIMD batches
+
+		// plane i is dot(normal, p) + d >= 0 for the points inside
+		alignas(16) float m_normalX[PLANE_COUNT]{};
+		alignas(16) float m_normalY[PLANE_COUNT]{};
+		alignas(16) float m_normalZ[PLANE_COUNT]{};
+		alignas(16) float m_distance[PLANE_COUNT]{};
+	};
+}
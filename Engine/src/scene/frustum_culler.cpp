@@ -0,0 +1,72 @@
+#include "scene/frustum_culler.hpp"
+
+#include "core/diagnostics.hpp"
+#include "scene/ecs/component.hpp"
+
+#include <algorithm>
+
+namespace PXTEngine {
+
+	void FrustumCuller::gather(Scene& scene) {
+		m_entities.clear();
+		m_bounds.clear();
+
+		scene.getEntitiesWith<MeshComponent, WorldBoundsComponent>().each(
+			[this](auto entity, auto&, auto& worldBounds) {
+				m_entities.push_back(entity);
+				m_bounds.push_back(worldBounds.bounds);
+			});
+	}
+
+	FrustumCuller::Stats FrustumCuller::cull(const Frustum& frustum, std::vector<entt::entity>& visibleEntities) const {
+
+		visibleEntities.clear();
+
+		const size_t count = m_entities.size();
+		std::vector<uint8_t> isVisible(count, 0);
+
+		// each chunk writes a disjoint range of the flags, no synchronization needed
+		const auto chunkCount = static_cast<uint32_t>((count + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+		m_jobSystem.parallelFor(chunkCount, [&](uint32_t chunk) {
+			const size_t end = std::min(count, (chunk + 1) * CHUNK_SIZE);
+			for (size_t i = chunk * CHUNK_SIZE; i < end; i++) {
+				isVisible[i] = frustum.intersects(m_bounds[i]) ? 1 : 0;
+			}
+		});
+
+		for (size_t i = 0; i < count; i++) {
+			if (isVisible[i]) {
+				visibleEntities.push_back(m_entities[i]);
+			}
+		}
+
+		Stats stats;
+		stats.visible = static_cast<uint32_t>(visibleEntities.size());
+		stats.culled = static_cast<uint32_t>(count) - stats.visible;
+
+		return stats;
+	}
+
+	void FrustumCuller::cull(std::span<const Frustum> frusta, std::vector<uint8_t>& visibilityMasks) const {
+		PXT_ASSERT(frusta.size() <= 8, "A visibility mask holds at most 8 frusta");
+
+		const size_t count = m_entities.size();
+		visibilityMasks.assign(count, 0);
+
+		const auto chunkCount = static_cast<uint32_t>((count + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+		m_jobSystem.parallelFor(chunkCount, [&](uint32_t chunk) {
+			const size_t end = std::min(count, (chunk + 1) * CHUNK_SIZE);
+			for (size_t i = chunk * CHUNK_SIZE; i < end; i++) {
+				uint8_t mask = 0;
+				for (size_t f = 0; f < frusta.size(); f++) {
+					if (frusta[f].intersects(m_bounds[i])) {
+						mask |= static_cast<uint8_t>(1u << f);
+					}
+				}
+				visibilityMasks[i] = mask;
+			}
+		});
+	}
+}
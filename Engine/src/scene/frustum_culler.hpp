@@ -0,0 +1,71 @@
+#pragma once
+
+#include "core/job_system.hpp"
+#include "scene/frustum.hpp"
+#include "scene/scene.hpp"
+
+#include <entt/entt.hpp>
+
+#include <span>
+#include <vector>
+
+namespace PXTEngine {
+
+	/**
+	 * @class FrustumCuller
+	 *
+	 * @brief Culls the renderable entities of a scene against view frusta.
+	 *
+	 * The renderables (entities with a MeshComponent and a WorldBoundsComponent) are gathered once
+	 * per frame into flat arrays, then every pass culls them against its own frustum.
+	 * Culling runs in parallel over chunks of renderables on the job system, the visible list keeps
+	 * the gather order.
+	 */
+	class FrustumCuller {
+	public:
+		struct Stats {
+			uint32_t visible = 0;
+			uint32_t culled = 0;
+		};
+
+		explicit FrustumCuller(JobSystem& jobSystem) : m_jobSystem(jobSystem) {}
+
+		/**
+		 * @brief Collects the renderables and their world bounds, call after Scene::onUpdate.
+		 */
+		void gather(Scene& scene);
+
+		/**
+		 * @brief Culls the gathered renderables against the frustum.
+		 *
+		 * @param frustum The frustum to test against.
+		 * @param visibleEntities Output list of the visible entities, cleared first.
+		 * @return The visible and culled counts.
+		 */
+		Stats cull(const Frustum& frustum, std::vector<entt::entity>& visibleEntities) const;
+
+		/**
+		 * @brief Culls the gathered renderables against up to 8 frusta in one pass over the bounds.
+		 *
+		 * @param frusta The frusta to test against.
+		 * @param visibilityMasks Output, bit i is set when the renderable is visible in frustum i.
+		 * Indexed like getRenderables().
+		 */
+		void cull(std::span<const Frustum> frusta, std::vector<uint8_t>& visibilityMasks) const;
+
+		uint32_t getRenderableCount() const { return static_cast<uint32_t>(m_entities.size()); }
+
+		/**
+		 * @brief The gathered renderables, for the passes that cull on the GPU.
+		 */
+		const std::vector<entt::entity>& getRenderables() const { return m_entities; }
+
+	private:
+		static constexpr size_t CHUNK_SIZE = 256;
+
+		JobSystem& m_jobSystem;
+
+		std::vector<entt::entity> m_entities;
+		std::vector<Bounds> m_bounds;
+	};
+}
@@ -0,0 +1,360 @@
+#include "scene/occlusion_culler.hpp"
+
+#include "core/platform.hpp"
+#include "scene/ecs/component.hpp"
+#include "scene/frustum.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(PXT_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace PXTEngine {
+
+	OcclusionCuller::OcclusionCuller(JobSystem& jobSystem, uint32_t width, uint32_t height)
+		: m_jobSystem(jobSystem) {
+		m_width = std::max(TILE_WIDTH, (width + TILE_WIDTH - 1) / TILE_WIDTH * TILE_WIDTH);
+		m_height = std::max(BAND_HEIGHT, (height + BAND_HEIGHT - 1) / BAND_HEIGHT * BAND_HEIGHT);
+		m_tileCountX = m_width / TILE_WIDTH;
+
+		m_depth.assign(static_cast<size_t>(m_width) * m_height, 1.0f);
+		m_tileMaxDepth.assign(static_cast<size_t>(m_tileCountX) * (m_height / TILE_HEIGHT), 1.0f);
+	}
+
+	void OcclusionCuller::render(Scene& scene, const glm::mat4& viewProjection) {
+		m_viewProjection = viewProjection;
+		m_triangles.clear();
+		m_occluderCount = 0;
+
+		const Frustum frustum = Frustum::fromMatrix(viewProjection);
+
+		// transform and clip the occluders on this thread, the triangle list stays small since
+		// occluders are coarse; every band then walks the whole list and skips by the screen bounds
+		scene.getEntitiesWith<OccluderComponent, MeshComponent, TransformComponent, WorldBoundsComponent>().each(
+			[&](auto entity, auto& occluder, auto& meshComponent, auto& transform, auto& worldBounds) {
+				const Shared<Mesh>& mesh = occluder.proxy ? occluder.proxy : meshComponent.mesh;
+				if (!mesh || !frustum.intersects(worldBounds.bounds)) {
+					return;
+				}
+
+				const Mesh::OccluderGeometry& geometry = mesh->getOccluderGeometry();
+				const glm::mat4 modelViewProjection = viewProjection * transform.mat4();
+
+				m_clipPositions.resize(geometry.positions.size());
+				for (size_t i = 0; i < geometry.positions.size(); i++) {
+					m_clipPositions[i] = modelViewProjection * glm::vec4(geometry.positions[i], 1.0f);
+				}
+
+				for (size_t i = 0; i + 2 < geometry.indices.size(); i += 3) {
+					clipAndAddTriangle(m_clipPositions[geometry.indices[i + 0]],
+						m_clipPositions[geometry.indices[i + 1]], m_clipPositions[geometry.indices[i + 2]]);
+				}
+
+				m_occluderCount++;
+			});
+
+		// each band writes a disjoint range of rows and tiles, no synchronization needed
+		m_jobSystem.parallelFor(m_height / BAND_HEIGHT, [this](uint32_t band) {
+			rasterizeBand(band);
+		});
+	}
+
+	void OcclusionCuller::clipAndAddTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+		// trivially reject the triangles outside of one of the side or far planes
+		if ((a.x > a.w && b.x > b.w && c.x > c.w) || (a.x < -a.w && b.x < -b.w && c.x < -c.w) ||
+			(a.y > a.w && b.y > b.w && c.y > c.w) || (a.y < -a.w && b.y < -b.w && c.y < -c.w) ||
+			(a.z > a.w && b.z > b.w && c.z > c.w)) {
+			return;
+		}
+
+		const bool isInside[3] = { a.z >= 0.0f, b.z >= 0.0f, c.z >= 0.0f };
+		if (isInside[0] && isInside[1] && isInside[2]) {
+			addTriangle(a, b, c);
+			return;
+		}
+
+		// clip against the near plane (z >= 0 in clip space), the polygon has at most 4 vertices
+		const glm::vec4 input[3] = { a, b, c };
+		glm::vec4 polygon[4];
+		int count = 0;
+
+		for (int i = 0; i < 3; i++) {
+			const int next = (i + 1) % 3;
+
+			if (isInside[i]) {
+				polygon[count++] = input[i];
+			}
+
+			if (isInside[i] != isInside[next]) {
+				const float t = input[i].z / (input[i].z - input[next].z);
+				polygon[count++] = glm::mix(input[i], input[next], t);
+			}
+		}
+
+		for (int i = 2; i < count; i++) {
+			addTriangle(polygon[0], polygon[i - 1], polygon[i]);
+		}
+	}
+
+	void OcclusionCuller::addTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+		const glm::vec4 clip[3] = { a, b, c };
+
+		ScreenTriangle triangle;
+		for (int i = 0; i < 3; i++) {
+			const glm::vec3 ndc = glm::vec3(clip[i]) / clip[i].w;
+			triangle.vertices[i] = {
+				(ndc.x * 0.5f + 0.5f) * static_cast<float>(m_width),
+				(ndc.y * 0.5f + 0.5f) * static_cast<float>(m_height),
+				ndc.z
+			};
+		}
+
+		glm::vec3& v0 = triangle.vertices[0];
+		glm::vec3& v1 = triangle.vertices[1];
+		glm::vec3& v2 = triangle.vertices[2];
+
+		// occluders are rasterized double sided, the winding is made counter clockwise
+		float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+		if (std::abs(area) < 1e-6f) {
+			return;
+		}
+
+		if (area < 0.0f) {
+			std::swap(v1, v2);
+		}
+
+		triangle.min = glm::min(glm::vec2(v0), glm::min(glm::vec2(v1), glm::vec2(v2)));
+		triangle.max = glm::max(glm::vec2(v0), glm::max(glm::vec2(v1), glm::vec2(v2)));
+
+		if (triangle.max.x <= 0.0f || triangle.max.y <= 0.0f ||
+			triangle.min.x >= static_cast<float>(m_width) || triangle.min.y >= static_cast<float>(m_height)) {
+			return;
+		}
+
+		m_triangles.push_back(triangle);
+	}
+
+	void OcclusionCuller::rasterizeBand(uint32_t band) {
+		const uint32_t rowBegin = band * BAND_HEIGHT;
+		const uint32_t rowEnd = rowBegin + BAND_HEIGHT;
+
+		std::fill(m_depth.begin() + static_cast<size_t>(rowBegin) * m_width,
+			m_depth.begin() + static_cast<size_t>(rowEnd) * m_width, 1.0f);
+
+		for (const ScreenTriangle& triangle : m_triangles) {
+			if (triangle.max.y <= static_cast<float>(rowBegin) || triangle.min.y >= static_cast<float>(rowEnd)) {
+				continue;
+			}
+
+			rasterizeTriangle(triangle, rowBegin, rowEnd);
+		}
+
+		updateTiles(rowBegin, rowEnd);
+	}
+
+	void OcclusionCuller::rasterizeTriangle(const ScreenTriangle& triangle, uint32_t rowBegin, uint32_t rowEnd) {
+		const glm::vec3& v0 = triangle.vertices[0];
+		const glm::vec3& v1 = triangle.vertices[1];
+		const glm::vec3& v2 = triangle.vertices[2];
+
+		// edge functions a * x + b * y + c, positive inside
+		const glm::vec3 edgeA{ v0.y - v1.y, v1.y - v2.y, v2.y - v0.y };
+		const glm::vec3 edgeB{ v1.x - v0.x, v2.x - v1.x, v0.x - v2.x };
+		const glm::vec3 edgeC{
+			-(edgeA.x * v0.x + edgeB.x * v0.y),
+			-(edgeA.y * v1.x + edgeB.y * v1.y),
+			-(edgeA.z * v2.x + edgeB.z * v2.y)
+		};
+
+		// depth plane; a pixel stores the farthest depth of the triangle over its area so that the
+		// occluder is never nearer than it really is
+		const float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+		const float dzdx = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+		const float dzdy = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+		const float depthOffset = 0.5f * (std::abs(dzdx) + std::abs(dzdy));
+		const float maxDepth = std::max(v0.z, std::max(v1.z, v2.z));
+
+		// columns start on a multiple of 4, the width is a multiple of the tile width
+		const uint32_t xBegin = static_cast<uint32_t>(std::max(0.0f, std::floor(triangle.min.x))) & ~3u;
+		const uint32_t xEnd = static_cast<uint32_t>(std::min(static_cast<float>(m_width), std::ceil(triangle.max.x)));
+		const uint32_t yBegin = std::max(rowBegin, static_cast<uint32_t>(std::max(0.0f, std::floor(triangle.min.y))));
+		const uint32_t yEnd = std::min(rowEnd, static_cast<uint32_t>(std::min(static_cast<float>(m_height), std::ceil(triangle.max.y))));
+
+#if defined(PXT_SIMD_SSE2)
+		const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		const __m128 a0 = _mm_set1_ps(edgeA.x);
+		const __m128 a1 = _mm_set1_ps(edgeA.y);
+		const __m128 a2 = _mm_set1_ps(edgeA.z);
+		const __m128 step0 = _mm_set1_ps(edgeA.x * 4.0f);
+		const __m128 step1 = _mm_set1_ps(edgeA.y * 4.0f);
+		const __m128 step2 = _mm_set1_ps(edgeA.z * 4.0f);
+		const __m128 depthStep = _mm_set1_ps(dzdx * 4.0f);
+		const __m128 maxDepthVector = _mm_set1_ps(maxDepth);
+		const __m128 zero = _mm_setzero_ps();
+
+		for (uint32_t y = yBegin; y < yEnd; y++) {
+			const float py = static_cast<float>(y) + 0.5f;
+			const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(xBegin)), laneOffsets);
+
+			__m128 e0 = _mm_add_ps(_mm_mul_ps(a0, px), _mm_set1_ps(edgeB.x * py + edgeC.x));
+			__m128 e1 = _mm_add_ps(_mm_mul_ps(a1, px), _mm_set1_ps(edgeB.y * py + edgeC.y));
+			__m128 e2 = _mm_add_ps(_mm_mul_ps(a2, px), _mm_set1_ps(edgeB.z * py + edgeC.z));
+			__m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(dzdx), _mm_sub_ps(px, _mm_set1_ps(v0.x))),
+				_mm_set1_ps(v0.z + dzdy * (py - v0.y) + depthOffset));
+
+			float* row = &m_depth[static_cast<size_t>(y) * m_width];
+			for (uint32_t x = xBegin; x < xEnd; x += 4) {
+				const __m128 inside = _mm_and_ps(_mm_cmpge_ps(e0, zero),
+					_mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+
+				if (_mm_movemask_ps(inside) != 0) {
+					const __m128 current = _mm_loadu_ps(row + x);
+					const __m128 nearest = _mm_min_ps(current, _mm_min_ps(depth, maxDepthVector));
+					_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+				}
+
+				e0 = _mm_add_ps(e0, step0);
+				e1 = _mm_add_ps(e1, step1);
+				e2 = _mm_add_ps(e2, step2);
+				depth = _mm_add_ps(depth, depthStep);
+			}
+		}
+#else
+		for (uint32_t y = yBegin; y < yEnd; y++) {
+			const float py = static_cast<float>(y) + 0.5f;
+			float* row = &m_depth[static_cast<size_t>(y) * m_width];
+
+			for (uint32_t x = xBegin; x < xEnd; x++) {
+				const float px = static_cast<float>(x) + 0.5f;
+
+				if (edgeA.x * px + edgeB.x * py + edgeC.x < 0.0f ||
+					edgeA.y * px + edgeB.y * py + edgeC.y < 0.0f ||
+					edgeA.z * px + edgeB.z * py + edgeC.z < 0.0f) {
+					continue;
+				}
+
+				const float depth = v0.z + dzdx * (px - v0.x) + dzdy * (py - v0.y) + depthOffset;
+				row[x] = std::min(row[x], std::min(depth, maxDepth));
+			}
+		}
+#endif
+	}
+
+	void OcclusionCuller::updateTiles(uint32_t rowBegin, uint32_t rowEnd) {
+		for (uint32_t tileY = rowBegin / TILE_HEIGHT; tileY < rowEnd / TILE_HEIGHT; tileY++) {
+			for (uint32_t tileX = 0; tileX < m_tileCountX; tileX++) {
+				float maxDepth = 0.0f;
+
+				for (uint32_t y = tileY * TILE_HEIGHT; y < (tileY + 1) * TILE_HEIGHT; y++) {
+					const float* row = &m_depth[static_cast<size_t>(y) * m_width + tileX * TILE_WIDTH];
+					for (uint32_t x = 0; x < TILE_WIDTH; x++) {
+						maxDepth = std::max(maxDepth, row[x]);
+					}
+				}
+
+				m_tileMaxDepth[static_cast<size_t>(tileY) * m_tileCountX + tileX] = maxDepth;
+			}
+		}
+	}
+
+	bool OcclusionCuller::isVisible(const BoundingBox& box) const {
+		if (box.isEmpty()) {
+			return true;
+		}
+
+		glm::vec2 screenMin{ std::numeric_limits<float>::max() };
+		glm::vec2 screenMax{ std::numeric_limits<float>::lowest() };
+		float nearestDepth = 1.0f;
+
+		for (int i = 0; i < 8; i++) {
+			const glm::vec3 corner{
+				(i & 1) ? box.max.x : box.min.x,
+				(i & 2) ? box.max.y : box.min.y,
+				(i & 4) ? box.max.z : box.min.z
+			};
+
+			const glm::vec4 clip = m_viewProjection * glm::vec4(corner, 1.0f);
+			if (clip.z < 0.0f || clip.w <= 0.0f) {
+				return true; // crosses the near plane
+			}
+
+			const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+			screenMin = glm::min(screenMin, glm::vec2(ndc));
+			screenMax = glm::max(screenMax, glm::vec2(ndc));
+			nearestDepth = std::min(nearestDepth, ndc.z);
+		}
+
+		const glm::vec2 size{ static_cast<float>(m_width), static_cast<float>(m_height) };
+		screenMin = glm::clamp((screenMin * 0.5f + 0.5f) * size, glm::vec2(0.0f), size);
+		screenMax = glm::clamp((screenMax * 0.5f + 0.5f) * size, glm::vec2(0.0f), size);
+
+		// every pixel the rectangle touches, off screen boxes are left to frustum culling
+		const uint32_t xBegin = static_cast<uint32_t>(std::floor(screenMin.x));
+		const uint32_t yBegin = static_cast<uint32_t>(std::floor(screenMin.y));
+		const uint32_t xEnd = static_cast<uint32_t>(std::ceil(screenMax.x));
+		const uint32_t yEnd = static_cast<uint32_t>(std::ceil(screenMax.y));
+		if (xBegin >= xEnd || yBegin >= yEnd) {
+			return true;
+		}
+
+		for (uint32_t tileY = yBegin / TILE_HEIGHT; tileY <= (yEnd - 1) / TILE_HEIGHT; tileY++) {
+			for (uint32_t tileX = xBegin / TILE_WIDTH; tileX <= (xEnd - 1) / TILE_WIDTH; tileX++) {
+				// all the pixels of the tile are nearer than the box
+				if (nearestDepth > m_tileMaxDepth[static_cast<size_t>(tileY) * m_tileCountX + tileX]) {
+					continue;
+				}
+
+				const uint32_t tileXBegin = std::max(xBegin, tileX * TILE_WIDTH);
+				const uint32_t tileXEnd = std::min(xEnd, (tileX + 1) * TILE_WIDTH);
+				const uint32_t tileYBegin = std::max(yBegin, tileY * TILE_HEIGHT);
+				const uint32_t tileYEnd = std::min(yEnd, (tileY + 1) * TILE_HEIGHT);
+
+				for (uint32_t y = tileYBegin; y < tileYEnd; y++) {
+					const float* row = &m_depth[static_cast<size_t>(y) * m_width];
+					for (uint32_t x = tileXBegin; x < tileXEnd; x++) {
+						if (row[x] >= nearestDepth) {
+							return true;
+						}
+					}
+				}
+			}
+		}
+
+		return false;
+	}
+
+	OcclusionCuller::Stats OcclusionCuller::cull(Scene& scene, std::vector<entt::entity>& entities) const {
+		auto view = scene.getEntitiesWith<WorldBoundsComponent>();
+
+		const size_t count = entities.size();
+		std::vector<uint8_t> isEntityVisible(count, 0);
+
+		const auto chunkCount = static_cast<uint32_t>((count + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+		m_jobSystem.parallelFor(chunkCount, [&](uint32_t chunk) {
+			const size_t end = std::min(count, (chunk + 1) * CHUNK_SIZE);
+			for (size_t i = chunk * CHUNK_SIZE; i < end; i++) {
+				isEntityVisible[i] = isVisible(view.get<WorldBoundsComponent>(entities[i]).bounds.box) ? 1 : 0;
+			}
+		});
+
+		size_t visibleCount = 0;
+		for (size_t i = 0; i < count; i++) {
+			if (isEntityVisible[i]) {
+				entities[visibleCount++] = entities[i];
+			}
+		}
+		entities.resize(visibleCount);
+
+		Stats stats;
+		stats.occluders = m_occluderCount;
+		stats.triangles = static_cast<uint32_t>(m_triangles.size());
+		stats.visible = static_cast<uint32_t>(visibleCount);
+		stats.occluded = static_cast<uint32_t>(count - visibleCount);
+
+		return stats;
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "core/job_system.hpp"
+#include "scene/scene.hpp"
+#include "utils/bounds.hpp"
+
+#include <entt/entt.hpp>
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace PXTEngine {
+
+	/**
+	 * @class OcclusionCuller
+	 *
+	 * @brief Software occlusion culling, entirely on the CPU.
+	 *
+	 * The occluders (entities with an OccluderComponent) are rasterized into a low resolution depth buffer,
+	 * 4 pixels at a time with SIMD, in horizontal bands processed in parallel on the job system. Every 8x4 pixel tile keeps
+	 * the farthest depth of its pixels, so most occluded entities are rejected with a few tile reads.
+	 * Entities are tested with the screen rectangle and the nearest depth of their world bounding box.
+	 *
+	 * Occluder coverage is sampled at the pixel centers: an entity only visible through a sub-pixel gap
+	 * along the edge of an occluder can be culled.
+	 */
+	class OcclusionCuller {
+	public:
+		struct Stats {
+			uint32_t occluders = 0;
+			uint32_t triangles = 0;	// rasterized, after near plane clipping
+			uint32_t visible = 0;
+			uint32_t occluded = 0;
+		};
+
+		static constexpr uint32_t TILE_WIDTH = 8;
+		static constexpr uint32_t TILE_HEIGHT = 4;
+
+		/**
+		 * @param jobSystem The workers the bands and the entity tests are run on.
+		 * @param width Depth buffer width, rounded up to a multiple of the tile width.
+		 * @param height Depth buffer height, rounded up to a multiple of the band height.
+		 */
+		explicit OcclusionCuller(JobSystem& jobSystem, uint32_t width = 256, uint32_t height = 128);
+
+		/**
+		 * @brief Clears the depth buffer and rasterizes the occluders in the frustum.
+		 * Call after Scene::onUpdate, the occluder world bounds must be up to date.
+		 *
+		 * @param scene The scene to take the occluders from.
+		 * @param viewProjection The camera projection * view matrix.
+		 */
+		void render(Scene& scene, const glm::mat4& viewProjection);
+
+		/**
+		 * @brief Tests a world space box against the occluders of the last render.
+		 * Boxes crossing the near plane are always visible.
+		 */
+		bool isVisible(const BoundingBox& box) const;
+
+		/**
+		 * @brief Removes the occluded entities from the list, the others keep their order.
+		 * The entities must have a WorldBoundsComponent, e.g. the output of a FrustumCuller.
+		 *
+		 * @return The occluder counts of the last render and the visible and occluded counts.
+		 */
+		Stats cull(Scene& scene, std::vector<entt::entity>& entities) const;
+
+		uint32_t getWidth() const { return m_width; }
+		uint32_t getHeight() const { return m_height; }
+
+		/**
+		 * @brief The depth buffer, row major, 1.0 where no occluder was rasterized.
+		 */
+		const std::vector<float>& getDepthBuffer() const { return m_depth; }
+
+	private:
+		JobSystem& m_jobSystem;
+
+		struct ScreenTriangle {
+			glm::vec3 vertices[3];	// x, y in pixels, z depth; counter clockwise in screen space
+			glm::vec2 min;			// screen bounds, to skip the bands the triangle does not touch
+			glm::vec2 max;
+		};
+
+		void clipAndAddTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+		void addTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+		void rasterizeBand(uint32_t band);
+		void rasterizeTriangle(const ScreenTriangle& triangle, uint32_t rowBegin, uint32_t rowEnd);
+		void updateTiles(uint32_t rowBegin, uint32_t rowEnd);
+
+		static constexpr uint32_t BAND_HEIGHT = 16; // rows rasterized by one task, multiple of the tile height
+		static constexpr size_t CHUNK_SIZE = 256;
+
+		uint32_t m_width;
+		uint32_t m_height;
+		uint32_t m_tileCountX;
+
+		glm::mat4 m_viewProjection{ 1.0f };
+
+		std::vector<float> m_depth;			// nearest occluder depth per pixel
+		std::vector<float> m_tileMaxDepth;	// farthest pixel depth per tile
+		std::vector<ScreenTriangle> m_triangles;
+		std::vector<glm::vec4> m_clipPositions;
+
+		uint32_t m_occluderCount = 0;
+	};
+}
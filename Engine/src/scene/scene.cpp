@@ -5,6 +5,8 @@
 #include "scene/ecs/entity.hpp"
 #include "scene/script/script.hpp"
 
+#include <vector>
+
 namespace PXTEngine {
 
     Entity Scene::createEntity(const std::string& name) {
@@ -47,6 +49,8 @@ namespace PXTEngine {
             scriptComponent.script->m_entity = Entity{ entity, this };
             scriptComponent.script->onCreate();
         });
+
+        updateWorldBounds();
     }
 
     void Scene::onUpdate(float delta) {
@@ -55,5 +59,24 @@ namespace PXTEngine {
             scriptComponent.script->onUpdate(delta);
             
         });
+
+        updateWorldBounds();
+    }
+
+    void Scene::updateWorldBounds() {
+        // the view can't be modified while iterating it, collect the new entities first
+        std::vector<entt::entity> newEntities;
+        for (auto entity : m_registry.view<TransformComponent, MeshComponent>(entt::exclude<WorldBoundsComponent>)) {
+            newEntities.push_back(entity);
+        }
+
+        for (auto entity : newEntities) {
+            m_registry.emplace<WorldBoundsComponent>(entity);
+        }
+
+        m_registry.view<TransformComponent, MeshComponent, WorldBoundsComponent>().each(
+            [](auto entity, auto& transform, auto& meshComponent, auto& worldBounds) {
+                worldBounds.update(transform, meshComponent);
+            });
     }
 }
\ No newline at end of file
@@ -46,12 +46,14 @@ namespace PXTEngine {
         /**
          * @brief Called when the scene starts.
          * 
-         * Initializes scripts attached to entities.
+         * Initializes scripts attached to entities and computes the world bounds of mesh entities.
          */
         void onStart();
         
         /**
          * @brief Called every frame to update the scene.
+         *
+         * Runs the scripts, then refreshes the world bounds of the entities they moved.
          * @param delta Time elapsed since the last update.
          */
         void onUpdate(float delta);
@@ -66,6 +68,24 @@ namespace PXTEngine {
             return m_registry.view<T...>();
         }
 
+        /**
+         * @brief Sink of the signal emitted when a component of type T is added to an entity.
+         * Listeners are called as void(entt::registry&, entt::entity).
+         */
+        template <typename T>
+        auto onComponentAdded() {
+            return m_registry.on_construct<T>();
+        }
+
+        /**
+         * @brief Sink of the signal emitted when a component of type T is replaced (see Entity::replace).
+         * Listeners are called as void(entt::registry&, entt::entity).
+         */
+        template <typename T>
+        auto onComponentReplaced() {
+            return m_registry.on_update<T>();
+        }
+
         /**
          * @brief Gets the entity designated as the main camera.
          * @return The main camera entity or an empty entity if none exist.
@@ -79,6 +99,11 @@ namespace PXTEngine {
         Shared<Environment> getEnvironment() const { return m_environment; }
 
     private:
+        /**
+         * @brief Adds the world bounds to new mesh entities and refreshes the ones whose transform changed.
+         */
+        void updateWorldBounds();
+
         std::unordered_map<UUID, entt::entity> m_entityMap;
         
         // The entity registry for managing components.
@@ -0,0 +1,79 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <limits>
+
+namespace PXTEngine {
+
+	/**
+	 * @struct BoundingBox
+	 *
+	 * @brief Axis aligned bounding box. A default constructed box is empty (min > max).
+	 */
+	struct BoundingBox {
+		glm::vec3 min{ std::numeric_limits<float>::max() };
+		glm::vec3 max{ std::numeric_limits<float>::lowest() };
+
+		bool isEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+		glm::vec3 center() const { return (min + max) * 0.5f; }
+		glm::vec3 extents() const { return (max - min) * 0.5f; }
+
+		void expand(const glm::vec3& point) {
+			min = glm::min(min, point);
+			max = glm::max(max, point);
+		}
+
+		/**
+		 * @brief Returns the box enclosing this box transformed by the given affine matrix (Arvo's method).
+		 */
+		BoundingBox transform(const glm::mat4& matrix) const {
+			if (isEmpty()) {
+				return *this;
+			}
+
+			const glm::vec3 newCenter = glm::vec3(matrix * glm::vec4(center(), 1.0f));
+			const glm::mat3 absolute{ glm::abs(glm::vec3(matrix[0])), glm::abs(glm::vec3(matrix[1])), glm::abs(glm::vec3(matrix[2])) };
+			const glm::vec3 newExtents = absolute * extents();
+
+			return { newCenter - newExtents, newCenter + newExtents };
+		}
+	};
+
+	/**
+	 * @struct BoundingSphere
+	 *
+	 * @brief Bounding sphere given by center and radius.
+	 */
+	struct BoundingSphere {
+		glm::vec3 center{ 0.0f };
+		float radius = 0.0f;
+
+		/**
+		 * @brief Returns the sphere transformed by the given affine matrix.
+		 *
+		 * @param matrix The transform.
+		 * @param maxScale The largest axis scale of the transform.
+		 */
+		BoundingSphere transform(const glm::mat4& matrix, float maxScale) const {
+			return { glm::vec3(matrix * glm::vec4(center, 1.0f)), radius * maxScale };
+		}
+	};
+
+	/**
+	 * @struct Bounds
+	 *
+	 * @brief Box and sphere bounding the same geometry, the sphere is centered in the box.
+	 */
+	struct Bounds {
+		BoundingBox box;
+		BoundingSphere sphere;
+
+		Bounds transform(const glm::mat4& matrix, float maxScale) const {
+			return { box.transform(matrix), sphere.transform(matrix, maxScale) };
+		}
+	};
+}
@@ -0,0 +1,81 @@
+#include "test.hpp"
+
+#include "scene/camera.hpp"
+#include "scene/frustum.hpp"
+
+#include <cmath>
+
+using namespace PXTEngine;
+
+namespace {
+	/**
+	 * @brief A 90 degrees square frustum looking down +z: |x| <= z - z0, |y| <= z - z0 and 0.1 <= z - z0 <= 100.
+	 */
+	Frustum makeFrustum(const glm::vec3& position = glm::vec3(0.0f)) {
+		Camera camera;
+		camera.setPerspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+		camera.setViewDirection(position, { 0.0f, 0.0f, 1.0f });
+
+		return Frustum::fromMatrix(camera.getProjectionMatrix() * camera.getViewMatrix());
+	}
+}
+
+PXT_TEST(frustumPlanesAreNormalized) {
+	const Frustum frustum = makeFrustum();
+
+	for (int i = 0; i < 6; i++) {
+		PXT_CHECK(std::abs(glm::length(glm::vec3(frustum.getPlane(i))) - 1.0f) < 1e-4f);
+	}
+}
+
+PXT_TEST(frustumCullsSpheresOutsideOfEveryPlane) {
+	const Frustum frustum = makeFrustum();
+
+	PXT_CHECK(frustum.intersects(BoundingSphere{ { 0.0f, 0.0f, 10.0f }, 1.0f }));
+
+	PXT_CHECK(!frustum.intersects(BoundingSphere{ { 0.0f, 0.0f, -10.0f }, 1.0f }));	// behind the near plane
+	PXT_CHECK(!frustum.intersects(BoundingSphere{ { 0.0f, 0.0f, 200.0f }, 1.0f }));	// beyond the far plane
+	PXT_CHECK(!frustum.intersects(BoundingSphere{ { 20.0f, 0.0f, 10.0f }, 1.0f }));
+	PXT_CHECK(!frustum.intersects(BoundingSphere{ { -20.0f, 0.0f, 10.0f }, 1.0f }));
+	PXT_CHECK(!frustum.intersects(BoundingSphere{ { 0.0f, 20.0f, 10.0f }, 1.0f }));
+	PXT_CHECK(!frustum.intersects(BoundingSphere{ { 0.0f, -20.0f, 10.0f }, 1.0f }));
+}
+
+PXT_TEST(frustumKeepsSpheresCrossingAPlane) {
+	const Frustum frustum = makeFrustum();
+
+	// the center is outside, 0.35 from the side plane
+	PXT_CHECK(frustum.intersects(BoundingSphere{ { 10.5f, 0.0f, 10.0f }, 1.0f }));
+	PXT_CHECK(frustum.intersects(BoundingSphere{ { 0.0f, 0.0f, 100.5f }, 1.0f }));
+}
+
+PXT_TEST(frustumCullsBoxes) {
+	const Frustum frustum = makeFrustum();
+
+	PXT_CHECK(frustum.intersects(BoundingBox{ { -1.0f, -1.0f, 9.0f }, { 1.0f, 1.0f, 11.0f } }));
+	PXT_CHECK(!frustum.intersects(BoundingBox{ { 19.0f, -1.0f, 9.0f }, { 21.0f, 1.0f, 11.0f } }));
+	PXT_CHECK(!frustum.intersects(BoundingBox{ { -1.0f, -1.0f, -11.0f }, { 1.0f, 1.0f, -9.0f } }));
+
+	// crossing the near plane
+	PXT_CHECK(frustum.intersects(BoundingBox{ { -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } }));
+}
+
+PXT_TEST(frustumTestsTheBoxOfTheSpheresThatPass) {
+	const Frustum frustum = makeFrustum();
+
+	// a thin box left of the frustum, its sphere is large enough to reach into it
+	Bounds bounds;
+	bounds.box = { { -30.0f, -1.0f, 9.0f }, { -20.0f, 1.0f, 11.0f } };
+	bounds.sphere = { { -25.0f, 0.0f, 10.0f }, 20.0f };
+
+	PXT_CHECK(frustum.intersects(bounds.sphere));
+	PXT_CHECK(!frustum.intersects(bounds.box));
+	PXT_CHECK(!frustum.intersects(bounds));
+}
+
+PXT_TEST(frustumFollowsTheView) {
+	const Frustum frustum = makeFrustum({ 100.0f, 0.0f, 0.0f });
+
+	PXT_CHECK(frustum.intersects(BoundingSphere{ { 100.0f, 0.0f, 10.0f }, 1.0f }));
+	PXT_CHECK(!frustum.intersects(BoundingSphere{ { 0.0f, 0.0f, 10.0f }, 1.0f }));
+}
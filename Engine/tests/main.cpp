@@ -0,0 +1,46 @@
+#include "test.hpp"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+namespace PXTEngine::Test {
+
+	namespace {
+		int s_failureCount = 0;
+	}
+
+	std::vector<TestCase>& getTests() {
+		static std::vector<TestCase> tests;
+		return tests;
+	}
+
+	void fail(const char* expression, const char* file, int line) {
+		std::cerr << "  " << file << ":" << line << ": check failed: " << expression << "\n";
+		s_failureCount++;
+	}
+}
+
+int main() {
+	using namespace PXTEngine::Test;
+
+	int failedTestCount = 0;
+
+	for (const TestCase& test : getTests()) {
+		const int failuresBefore = s_failureCount;
+
+		try {
+			test.function();
+		} catch (const std::exception& e) {
+			fail(e.what(), test.name, 0);
+		}
+
+		const bool isPassed = s_failureCount == failuresBefore;
+		std::cout << (isPassed ? "[ PASS ] " : "[ FAIL ] ") << test.name << "\n";
+		failedTestCount += isPassed ? 0 : 1;
+	}
+
+	std::cout << getTests().size() - failedTestCount << "/" << getTests().size() << " tests passed\n";
+
+	return failedTestCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,164 @@
+#include "test.hpp"
+
+#include "resources/importers/mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+using namespace PXTEngine;
+
+namespace {
+	struct GridMesh {
+		std::vector<Mesh::Vertex> vertices;
+		std::vector<uint32_t> indices;
+	};
+
+	/**
+	 * @brief A flat grid of size x size quads, two triangles each, in row order.
+	 */
+	GridMesh makeGrid(uint32_t size) {
+		GridMesh grid;
+
+		for (uint32_t y = 0; y <= size; y++) {
+			for (uint32_t x = 0; x <= size; x++) {
+				Mesh::Vertex vertex;
+				vertex.position = { static_cast<float>(x), static_cast<float>(y), 0.0f, 1.0f };
+				vertex.normal = { 0.0f, 0.0f, 1.0f, 0.0f };
+				grid.vertices.push_back(vertex);
+			}
+		}
+
+		for (uint32_t y = 0; y < size; y++) {
+			for (uint32_t x = 0; x < size; x++) {
+				const uint32_t corner = y * (size + 1) + x;
+				grid.indices.insert(grid.indices.end(), { corner, corner + 1, corner + size + 2 });
+				grid.indices.insert(grid.indices.end(), { corner, corner + size + 2, corner + size + 1 });
+			}
+		}
+
+		return grid;
+	}
+
+	using Triangle = std::array<uint32_t, 3>;
+
+	/**
+	 * @brief The triangles of the meshlets with the mesh vertex indices, in the winding they were given.
+	 */
+	std::vector<Triangle> getMeshletTriangles(const Mesh::MeshletData& data) {
+		std::vector<Triangle> triangles;
+
+		for (const Mesh::Meshlet& meshlet : data.meshlets) {
+			for (uint32_t t = 0; t < meshlet.triangleCount; t++) {
+				Triangle triangle;
+				for (uint32_t corner = 0; corner < 3; corner++) {
+					const uint8_t local = data.triangles[meshlet.triangleOffset + t * 3 + corner];
+					triangle[corner] = data.vertices[meshlet.vertexOffset + local];
+				}
+				triangles.push_back(triangle);
+			}
+		}
+
+		return triangles;
+	}
+
+	std::vector<Triangle> getTriangles(const std::vector<uint32_t>& indices) {
+		std::vector<Triangle> triangles;
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			triangles.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+		}
+		return triangles;
+	}
+}
+
+PXT_TEST(meshletsOfAnEmptyMeshAreEmpty) {
+	const Mesh::MeshletData data = MeshOptimizer::buildMeshlets({}, {});
+
+	PXT_CHECK(data.meshlets.empty());
+	PXT_CHECK(data.vertices.empty());
+	PXT_CHECK(data.triangles.empty());
+}
+
+PXT_TEST(meshletsRespectTheVertexAndTriangleLimits) {
+	const GridMesh grid = makeGrid(40);
+	const Mesh::MeshletData data = MeshOptimizer::buildMeshlets(grid.indices, grid.vertices);
+
+	PXT_CHECK(!data.meshlets.empty());
+
+	for (const Mesh::Meshlet& meshlet : data.meshlets) {
+		PXT_CHECK(meshlet.triangleCount >= 1);
+		PXT_CHECK(meshlet.vertexCount <= MeshOptimizer::MAX_MESHLET_VERTICES);
+		PXT_CHECK(meshlet.triangleCount <= MeshOptimizer::MAX_MESHLET_TRIANGLES);
+		PXT_CHECK(meshlet.triangleOffset % 4 == 0);
+
+		// every local index points into the meshlet, every meshlet vertex is listed once
+		for (uint32_t i = 0; i < meshlet.triangleCount * 3; i++) {
+			PXT_CHECK(data.triangles[meshlet.triangleOffset + i] < meshlet.vertexCount);
+		}
+
+		std::vector<uint32_t> meshletVertices(data.vertices.begin() + meshlet.vertexOffset,
+			data.vertices.begin() + meshlet.vertexOffset + meshlet.vertexCount);
+		std::sort(meshletVertices.begin(), meshletVertices.end());
+		PXT_CHECK(std::adjacent_find(meshletVertices.begin(), meshletVertices.end()) == meshletVertices.end());
+	}
+}
+
+PXT_TEST(meshletsCoverEveryTriangleOnce) {
+	const GridMesh grid = makeGrid(40);
+	const Mesh::MeshletData data = MeshOptimizer::buildMeshlets(grid.indices, grid.vertices);
+
+	std::vector<Triangle> meshletTriangles = getMeshletTriangles(data);
+	std::vector<Triangle> meshTriangles = getTriangles(grid.indices);
+	std::sort(meshletTriangles.begin(), meshletTriangles.end());
+	std::sort(meshTriangles.begin(), meshTriangles.end());
+
+	PXT_CHECK(meshletTriangles == meshTriangles);
+}
+
+PXT_TEST(meshletsFollowCustomLimits) {
+	const GridMesh grid = makeGrid(4);
+
+	const Mesh::MeshletData single = MeshOptimizer::buildMeshlets(grid.indices, grid.vertices, 3, 1);
+	PXT_CHECK(single.meshlets.size() == grid.indices.size() / 3);
+
+	const Mesh::MeshletData small = MeshOptimizer::buildMeshlets(grid.indices, grid.vertices, 8, 4);
+	for (const Mesh::Meshlet& meshlet : small.meshlets) {
+		PXT_CHECK(meshlet.vertexCount <= 8);
+		PXT_CHECK(meshlet.triangleCount <= 4);
+	}
+}
+
+PXT_TEST(meshletBoundsContainTheirVertices) {
+	const GridMesh grid = makeGrid(20);
+	const Mesh::MeshletData data = MeshOptimizer::buildMeshlets(grid.indices, grid.vertices);
+
+	for (const Mesh::Meshlet& meshlet : data.meshlets) {
+		const glm::vec3 center = glm::vec3(meshlet.boundingSphere);
+
+		for (uint32_t v = 0; v < meshlet.vertexCount; v++) {
+			const glm::vec3 position = grid.vertices[data.vertices[meshlet.vertexOffset + v]].position;
+			PXT_CHECK(glm::length(position - center) <= meshlet.boundingSphere.w + 1e-4f);
+		}
+
+		// a flat grid faces +z everywhere
+		PXT_CHECK(meshlet.cone.z > 0.99f);
+	}
+}
+
+PXT_TEST(meshletsAreDeterministic) {
+	const GridMesh grid = makeGrid(30);
+	const Mesh::MeshletData first = MeshOptimizer::buildMeshlets(grid.indices, grid.vertices);
+	const Mesh::MeshletData second = MeshOptimizer::buildMeshlets(grid.indices, grid.vertices);
+
+	PXT_CHECK(first.vertices == second.vertices);
+	PXT_CHECK(first.triangles == second.triangles);
+	PXT_CHECK(first.meshlets.size() == second.meshlets.size());
+
+	for (size_t i = 0; i < std::min(first.meshlets.size(), second.meshlets.size()); i++) {
+		PXT_CHECK(first.meshlets[i].vertexOffset == second.meshlets[i].vertexOffset);
+		PXT_CHECK(first.meshlets[i].triangleOffset == second.meshlets[i].triangleOffset);
+		PXT_CHECK(first.meshlets[i].vertexCount == second.meshlets[i].vertexCount);
+		PXT_CHECK(first.meshlets[i].triangleCount == second.meshlets[i].triangleCount);
+		PXT_CHECK(first.meshlets[i].boundingSphere == second.meshlets[i].boundingSphere);
+	}
+}
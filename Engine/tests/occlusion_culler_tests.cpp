@@ -0,0 +1,145 @@
+#include "test.hpp"
+
+#include "core/job_system.hpp"
+#include "scene/camera.hpp"
+#include "scene/ecs/entity.hpp"
+#include "scene/occlusion_culler.hpp"
+
+#include <algorithm>
+
+using namespace PXTEngine;
+
+namespace {
+	/**
+	 * @brief A mesh holding only the geometry the occlusion culler reads.
+	 */
+	class OccluderMesh : public Mesh {
+	public:
+		OccluderMesh(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices) {
+			m_geometry = { positions, indices };
+
+			std::vector<Vertex> vertices;
+			for (const glm::vec3& position : positions) {
+				vertices.push_back({ glm::vec4(position, 1.0f) });
+			}
+			m_bounds = computeBounds(vertices);
+		}
+
+		const uint32_t getVertexCount() const override { return static_cast<uint32_t>(m_geometry.positions.size()); }
+		const uint32_t getIndexCount() const override { return static_cast<uint32_t>(m_geometry.indices.size()); }
+		const std::vector<Lod>& getLods() const override { return m_lods; }
+		const Bounds& getBounds() const override { return m_bounds; }
+		const OccluderGeometry& getOccluderGeometry() const override { return m_geometry; }
+
+		Type getType() const override { return Type::Mesh; }
+
+	private:
+		OccluderGeometry m_geometry;
+		Bounds m_bounds;
+		std::vector<Lod> m_lods;
+	};
+
+	JobSystem& getJobSystem() {
+		static JobSystem jobSystem;
+		return jobSystem;
+	}
+
+	/**
+	 * @brief A 90 degrees square view looking down +z from the origin.
+	 */
+	glm::mat4 getViewProjection() {
+		Camera camera;
+		camera.setPerspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+		camera.setViewDirection(glm::vec3(0.0f), { 0.0f, 0.0f, 1.0f });
+
+		return camera.getProjectionMatrix() * camera.getViewMatrix();
+	}
+
+	BoundingBox makeBox(const glm::vec3& center, float halfSize) {
+		return { center - glm::vec3(halfSize), center + glm::vec3(halfSize) };
+	}
+
+	/**
+	 * @brief Adds a square wall of the given half size facing the camera at depth z.
+	 */
+	Entity addWall(Scene& scene, float halfSize, float z) {
+		const std::vector<glm::vec3> positions = {
+			{ -halfSize, -halfSize, z }, { halfSize, -halfSize, z }, { halfSize, halfSize, z }, { -halfSize, halfSize, z }
+		};
+
+		Entity wall = scene.createEntity("Wall");
+		wall.add<TransformComponent>();
+		wall.add<MeshComponent>(createShared<OccluderMesh>(positions, std::vector<uint32_t>{ 0, 1, 2, 0, 2, 3 }));
+		wall.add<OccluderComponent>();
+
+		return wall;
+	}
+
+	Entity addBox(Scene& scene, const glm::vec3& center) {
+		const std::vector<glm::vec3> positions = {
+			center - glm::vec3(1.0f), center + glm::vec3(1.0f)
+		};
+
+		Entity box = scene.createEntity("Box");
+		box.add<TransformComponent>();
+		box.add<MeshComponent>(createShared<OccluderMesh>(positions, std::vector<uint32_t>{}));
+
+		return box;
+	}
+}
+
+PXT_TEST(occlusionCullerRoundsTheDepthBufferSize) {
+	const OcclusionCuller culler(getJobSystem(), 100, 50);
+
+	PXT_CHECK(culler.getWidth() == 104);
+	PXT_CHECK(culler.getHeight() == 64);
+	PXT_CHECK(culler.getDepthBuffer().size() == 104u * 64u);
+}
+
+PXT_TEST(occlusionCullerKeepsEverythingWithoutOccluders) {
+	Scene scene;
+	OcclusionCuller culler(getJobSystem());
+	culler.render(scene, getViewProjection());
+
+	const auto& depth = culler.getDepthBuffer();
+	PXT_CHECK(std::all_of(depth.begin(), depth.end(), [](float value) { return value == 1.0f; }));
+	PXT_CHECK(culler.isVisible(makeBox({ 0.0f, 0.0f, 50.0f }, 1.0f)));
+}
+
+PXT_TEST(occlusionCullerHidesBoxesBehindAnOccluder) {
+	Scene scene;
+	addWall(scene, 5.0f, 10.0f);
+	scene.onStart();
+
+	OcclusionCuller culler(getJobSystem());
+	culler.render(scene, getViewProjection());
+
+	PXT_CHECK(!culler.isVisible(makeBox({ 0.0f, 0.0f, 20.0f }, 1.0f)));
+
+	PXT_CHECK(culler.isVisible(makeBox({ 0.0f, 0.0f, 5.0f }, 1.0f)));		// in front of the wall
+	PXT_CHECK(culler.isVisible(makeBox({ 15.0f, 0.0f, 20.0f }, 1.0f)));	// beside it
+	PXT_CHECK(culler.isVisible(makeBox({ 10.0f, 0.0f, 20.0f }, 1.0f)));	// partially behind it
+	PXT_CHECK(culler.isVisible(makeBox({ 0.0f, 0.0f, 0.0f }, 1.0f)));		// crossing the near plane
+}
+
+PXT_TEST(occlusionCullerRemovesOccludedEntitiesInOrder) {
+	Scene scene;
+	addWall(scene, 5.0f, 10.0f);
+
+	const Entity front = addBox(scene, { 0.0f, 0.0f, 5.0f });
+	const Entity hidden = addBox(scene, { 0.0f, 0.0f, 20.0f });
+	const Entity beside = addBox(scene, { 15.0f, 0.0f, 20.0f });
+	scene.onStart();
+
+	OcclusionCuller culler(getJobSystem());
+	culler.render(scene, getViewProjection());
+
+	std::vector<entt::entity> entities = { beside, hidden, front };
+	const OcclusionCuller::Stats stats = culler.cull(scene, entities);
+
+	PXT_CHECK(stats.occluders == 1);
+	PXT_CHECK(stats.triangles == 2);
+	PXT_CHECK(stats.visible == 2);
+	PXT_CHECK(stats.occluded == 1);
+	PXT_CHECK(entities == std::vector<entt::entity>({ beside, front }));
+}
@@ -0,0 +1,137 @@
+#include "test.hpp"
+
+#include "graphics/render_graph.hpp"
+
+#include <cstdint>
+
+using namespace PXTEngine;
+
+// The graphs below only use imported buffers, they are compiled without a device. The image layouts
+// and the transient memory need one, they are not covered here.
+
+namespace {
+	VkBuffer makeBuffer(uint64_t handle) {
+		return reinterpret_cast<VkBuffer>(static_cast<uintptr_t>(handle));
+	}
+
+	void noExecute(FrameInfo&) {}
+
+	void addWritePass(RenderGraph& graph, const std::string& name, RenderGraph::BufferHandle buffer,
+		RenderGraph::BufferUsage usage) {
+		graph.addPass(name, [&](RenderGraph::PassBuilder& builder) { builder.write(buffer, usage); }, noExecute);
+	}
+
+	void addReadPass(RenderGraph& graph, const std::string& name, RenderGraph::BufferHandle buffer,
+		RenderGraph::BufferUsage usage) {
+		graph.addPass(name, [&](RenderGraph::PassBuilder& builder) { builder.read(buffer, usage).setSideEffect(); },
+			noExecute);
+	}
+}
+
+PXT_TEST(renderGraphCullsPassesWithoutOutputs) {
+	RenderGraph graph;
+	const auto unused = graph.importBuffer("Unused", makeBuffer(1));
+	const auto intermediate = graph.importBuffer("Intermediate", makeBuffer(2));
+	const auto output = graph.importBuffer("Output", makeBuffer(3));
+	graph.markOutput(output);
+
+	addWritePass(graph, "Write Unused", unused, RenderGraph::BufferUsage::StorageCompute);
+	addWritePass(graph, "Write Intermediate", intermediate, RenderGraph::BufferUsage::StorageCompute);
+	graph.addPass("Write Output", [&](RenderGraph::PassBuilder& builder) {
+		builder.read(intermediate, RenderGraph::BufferUsage::StorageCompute);
+		builder.write(output, RenderGraph::BufferUsage::StorageCompute);
+	}, noExecute);
+	graph.addPass("Side Effect", [](RenderGraph::PassBuilder& builder) { builder.setSideEffect(); }, noExecute);
+
+	graph.compile();
+
+	PXT_CHECK(graph.getStats().passCount == 4);
+	PXT_CHECK(graph.getStats().culledPassCount == 1);
+	PXT_CHECK(graph.exportGraphviz().find("Write Unused\\n(culled)") != std::string::npos);
+}
+
+PXT_TEST(renderGraphWaitsForWritesBeforeReads) {
+	RenderGraph graph;
+	const auto buffer = graph.importBuffer("Draws", makeBuffer(1));
+
+	// the first write waits for whatever used the buffer before the graph saw it
+	addWritePass(graph, "Cull", buffer, RenderGraph::BufferUsage::StorageCompute);
+	addReadPass(graph, "Draw", buffer, RenderGraph::BufferUsage::IndirectRead);
+
+	graph.compile();
+
+	PXT_CHECK(graph.getStats().culledPassCount == 0);
+	PXT_CHECK(graph.getStats().bufferBarrierCount == 2);
+	PXT_CHECK(graph.getStats().barrierBatchCount == 2);
+	PXT_CHECK(graph.getStats().imageBarrierCount == 0);
+}
+
+PXT_TEST(renderGraphSkipsBarriersBetweenReadsOfTheSameStages) {
+	RenderGraph graph;
+	const auto buffer = graph.importBuffer("Lights", makeBuffer(1));
+
+	addWritePass(graph, "Write", buffer, RenderGraph::BufferUsage::StorageCompute);
+	addReadPass(graph, "First Read", buffer, RenderGraph::BufferUsage::StorageCompute);
+	addReadPass(graph, "Second Read", buffer, RenderGraph::BufferUsage::StorageCompute);
+	// a new stage must still be made visible
+	addReadPass(graph, "Indirect Read", buffer, RenderGraph::BufferUsage::IndirectRead);
+
+	graph.compile();
+
+	PXT_CHECK(graph.getStats().bufferBarrierCount == 3);
+}
+
+PXT_TEST(renderGraphWaitsForReadsBeforeWrites) {
+	RenderGraph graph;
+	const auto buffer = graph.importBuffer("Counters", makeBuffer(1));
+
+	addWritePass(graph, "Write", buffer, RenderGraph::BufferUsage::StorageCompute);
+	addReadPass(graph, "Read", buffer, RenderGraph::BufferUsage::StorageCompute);
+	graph.addPass("Clear", [&](RenderGraph::PassBuilder& builder) {
+		builder.write(buffer, RenderGraph::BufferUsage::TransferDst).setSideEffect();
+	}, noExecute);
+
+	graph.compile();
+
+	PXT_CHECK(graph.getStats().bufferBarrierCount == 3);
+}
+
+PXT_TEST(renderGraphKeepsImportedStatesBetweenFrames) {
+	RenderGraph graph;
+	const VkBuffer buffer = makeBuffer(1);
+
+	auto handle = graph.importBuffer("History", buffer);
+	graph.addPass("Write", [&](RenderGraph::PassBuilder& builder) {
+		builder.write(handle, RenderGraph::BufferUsage::StorageCompute).setSideEffect();
+	}, noExecute);
+	graph.compile();
+
+	// the write of the previous frame must be made visible to the next read
+	graph.reset();
+	handle = graph.importBuffer("History", buffer);
+	addReadPass(graph, "Read", handle, RenderGraph::BufferUsage::StorageCompute);
+	graph.compile();
+	PXT_CHECK(graph.getStats().bufferBarrierCount == 1);
+
+	// it was already made visible to the same stages
+	graph.reset();
+	handle = graph.importBuffer("History", buffer);
+	addReadPass(graph, "Read Again", handle, RenderGraph::BufferUsage::StorageCompute);
+	graph.compile();
+	PXT_CHECK(graph.getStats().bufferBarrierCount == 0);
+}
+
+PXT_TEST(renderGraphExportsPassesAndResources) {
+	RenderGraph graph;
+	const auto buffer = graph.importBuffer("Draws", makeBuffer(1));
+	graph.markOutput(buffer);
+
+	addWritePass(graph, "Cull", buffer, RenderGraph::BufferUsage::StorageCompute);
+	graph.compile();
+
+	const std::string dot = graph.exportGraphviz();
+	PXT_CHECK(dot.starts_with("digraph RenderGraph {"));
+	PXT_CHECK(dot.find("label=\"Cull\\n0 image, 1 buffer barriers\"") != std::string::npos);
+	PXT_CHECK(dot.find("label=\"Draws\", peripheries=2") != std::string::npos);
+	PXT_CHECK(dot.find("pass0 -> resource0 [color=red];") != std::string::npos);
+}
@@ -0,0 +1,158 @@
+#include "test.hpp"
+
+#include "core/job_system.hpp"
+#include "graphics/render_queue.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace PXTEngine;
+
+namespace {
+	JobSystem& getJobSystem() {
+		static JobSystem jobSystem;
+		return jobSystem;
+	}
+
+	/**
+	 * @brief Pushes count items with random keys drawn from keyCount values, the payload is the push order.
+	 */
+	std::vector<RenderQueue::Item> pushRandomItems(RenderQueue& queue, uint32_t count, uint32_t keyCount, uint32_t seed) {
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<uint32_t> keyDistribution(0, keyCount - 1);
+
+		std::vector<RenderQueue::Item> items;
+		for (uint32_t i = 0; i < count; i++) {
+			// spread the keys over every field so that every radix digit is exercised
+			const uint32_t value = keyDistribution(random);
+			const uint64_t key = RenderQueue::makeKey(value % 3, value % 7, value % 251, value % 1021, value % 4099);
+
+			queue.push(key, i);
+			items.push_back({ key, i });
+		}
+
+		return items;
+	}
+
+	/**
+	 * @brief The queue must match a stable sort by key: same keys, and the payloads of equal keys in push order.
+	 */
+	bool isSortedLike(const RenderQueue& queue, std::vector<RenderQueue::Item> expected) {
+		std::stable_sort(expected.begin(), expected.end(),
+			[](const RenderQueue::Item& a, const RenderQueue::Item& b) { return a.key < b.key; });
+
+		const auto& items = queue.getItems();
+		if (items.size() != expected.size()) return false;
+
+		for (size_t i = 0; i < items.size(); i++) {
+			if (items[i].key != expected[i].key || items[i].payload != expected[i].payload) return false;
+		}
+
+		return true;
+	}
+}
+
+PXT_TEST(renderQueueSortsEmptyAndSingleItemQueues) {
+	RenderQueue queue(getJobSystem());
+
+	queue.sort();
+	PXT_CHECK(queue.getSize() == 0);
+
+	queue.push(42, 7);
+	queue.sort();
+	PXT_CHECK(queue.getSize() == 1);
+	PXT_CHECK(queue.getItems()[0].key == 42);
+	PXT_CHECK(queue.getItems()[0].payload == 7);
+}
+
+PXT_TEST(renderQueueSortsByKey) {
+	RenderQueue queue(getJobSystem());
+	const auto items = pushRandomItems(queue, 1000, 1u << 20, 1);
+
+	queue.sort();
+	PXT_CHECK(isSortedLike(queue, items));
+}
+
+PXT_TEST(renderQueueKeepsPushOrderOfEqualKeys) {
+	RenderQueue queue(getJobSystem());
+	const auto items = pushRandomItems(queue, 1000, 4, 2);
+
+	queue.sort();
+	PXT_CHECK(isSortedLike(queue, items));
+}
+
+PXT_TEST(renderQueueSortsLargeQueuesOnSeveralThreads) {
+	// above the parallel threshold, with few keys so that the chunks share digits
+	RenderQueue queue(getJobSystem());
+	const auto items = pushRandomItems(queue, 100000, 64, 3);
+
+	queue.sort();
+	PXT_CHECK(isSortedLike(queue, items));
+}
+
+PXT_TEST(renderQueueKeepsEqualKeysSorted) {
+	RenderQueue queue(getJobSystem());
+	for (uint32_t i = 0; i < 100; i++) {
+		queue.push(RenderQueue::makeKey(1, 2, 3, 4, 5), i);
+	}
+
+	queue.sort();
+
+	bool isInPushOrder = true;
+	for (uint32_t i = 0; i < queue.getSize(); i++) {
+		isInPushOrder &= queue.getItems()[i].payload == i;
+	}
+	PXT_CHECK(isInPushOrder);
+}
+
+PXT_TEST(renderQueueKeyFieldsRoundTrip) {
+	const uint64_t key = RenderQueue::makeKey(5, 200, 60000, 1234, 99999);
+
+	PXT_CHECK(RenderQueue::getPass(key) == 5);
+	PXT_CHECK(RenderQueue::getPipeline(key) == 200);
+	PXT_CHECK(RenderQueue::getMaterial(key) == 60000);
+	PXT_CHECK(RenderQueue::getMesh(key) == 1234);
+
+	// the pass is the most significant field, the depth the least
+	PXT_CHECK(RenderQueue::makeKey(1, 0, 0, 0, 0) > RenderQueue::makeKey(0, 255, 65535, 65535, 1000000));
+	PXT_CHECK(RenderQueue::makeKey(0, 0, 0, 0, 2) > RenderQueue::makeKey(0, 0, 0, 0, 1));
+}
+
+PXT_TEST(renderQueueQuantizesDepthMonotonically) {
+	PXT_CHECK(RenderQueue::quantizeDepth(-1.0f) == 0);
+	PXT_CHECK(RenderQueue::quantizeDepth(0.0f) == 0);
+	PXT_CHECK(RenderQueue::quantizeDepth(1.0f) < RenderQueue::quantizeDepth(2.0f));
+	PXT_CHECK(RenderQueue::quantizeDepth(RenderQueue::MAX_SORT_DISTANCE) == RenderQueue::quantizeDepth(1e9f));
+}
+
+PXT_TEST(renderQueueRecordsOnlyChangedBinds) {
+	RenderQueue queue(getJobSystem());
+
+	// two pipelines, the first with two materials sharing a mesh
+	queue.push(RenderQueue::makeKey(0, 0, 0, 0, 0), 0);
+	queue.push(RenderQueue::makeKey(0, 0, 0, 0, 1), 1);
+	queue.push(RenderQueue::makeKey(0, 0, 1, 0, 0), 2);
+	queue.push(RenderQueue::makeKey(0, 1, 1, 0, 0), 3);
+	queue.sort();
+
+	uint32_t pipelineBinds = 0, materialBinds = 0, meshBinds = 0, draws = 0;
+
+	RenderQueue::RecordCallbacks callbacks;
+	callbacks.bindPipeline = [&](const RenderQueue::Item&) { pipelineBinds++; };
+	callbacks.bindMaterial = [&](const RenderQueue::Item&) { materialBinds++; };
+	callbacks.bindMesh = [&](const RenderQueue::Item&) { meshBinds++; };
+	callbacks.draw = [&](const RenderQueue::Item&) { draws++; };
+
+	queue.record(callbacks);
+	queue.clear();
+
+	PXT_CHECK(draws == 4);
+	PXT_CHECK(pipelineBinds == 2);
+	PXT_CHECK(materialBinds == 3); // a new pipeline rebinds the material
+	PXT_CHECK(meshBinds == 2);
+
+	const RenderQueue::Stats& stats = queue.getStats();
+	PXT_CHECK(stats.draws == draws && stats.pipelineBinds == pipelineBinds &&
+		stats.materialBinds == materialBinds && stats.meshBinds == meshBinds);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+namespace PXTEngine::Test {
+
+	struct TestCase {
+		const char* name;
+		void (*function)();
+	};
+
+	/**
+	 * @brief Every test registered with PXT_TEST, in registration order.
+	 */
+	std::vector<TestCase>& getTests();
+
+	/**
+	 * @brief Reports a failed check, the test keeps running so that every failure is listed.
+	 */
+	void fail(const char* expression, const char* file, int line);
+
+	struct Registrar {
+		Registrar(const char* name, void (*function)()) {
+			getTests().push_back({ name, function });
+		}
+	};
+}
+
+/**
+ * @brief Defines a test function run by PXT_Engine_Tests.
+ */
+#define PXT_TEST(name) \
+	static void name(); \
+	static const PXTEngine::Test::Registrar name##Registrar(#name, name); \
+	static void name()
+
+#define PXT_CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			PXTEngine::Test::fail(#condition, __FILE__, __LINE__); \
+		} \
+	} while (0)
@@ -1,5 +1,6 @@
 #version 460
 #extension GL_GOOGLE_include_directive : require
+#extension GL_ARB_shader_viewport_layer_array : require
 
 #include "ubo/shadow_ubo.glsl"
 
@@ -8,22 +9,27 @@ layout(location = 1) in vec4 normal;
 layout(location = 2) in vec4 tangent;
 layout(location = 3) in vec4 uv;
 
-layout(location = 0) out vec3 fragPosWorld;
-layout(location = 1) out vec3 fragLightPos;
-
-layout(push_constant) uniform Push {
-  // it will be modified to translate the object to the light position (i think so?)
+// std430 layout shared with ShadowInstanceData in shadow_map_render_system.cpp
+struct ShadowInstance {
   mat4 modelMatrix;
-  // it will be modified to render the different faces
-  mat4 cubeFaceView;
-} push;
+  uint layer; // slot * 6 + face
+};
 
+// one instance per object and scheduled cube face it touches, indexed with the instance index
+layout(set = 1, binding = 0) readonly buffer ShadowInstances {
+  ShadowInstance instances[];
+};
 
 void main() {
-  vec4 posWorld = push.modelMatrix * position;
-  vec4 posWorldFromLight = ubo.lightOriginModel * posWorld;
-  gl_Position = ubo.projection * push.cubeFaceView * posWorldFromLight;
+  ShadowInstance instance = instances[gl_InstanceIndex];
+
+  uint slot = instance.layer / 6;
+  uint face = instance.layer % 6;
+
+  vec4 posWorld = instance.modelMatrix * position;
+  vec4 posWorldFromLight = vec4(posWorld.xyz - ubo.lightPositions[slot].xyz, 1.0);
+  gl_Position = ubo.projection * ubo.faceViews[face] * posWorldFromLight;
 
-  fragPosWorld = posWorld.xyz;
-  fragLightPos = ubo.pointLights[0].position.xyz;
+  // route the instance to the layer of its slot and face
+  gl_Layer = int(instance.layer);
 }
\ No newline at end of file
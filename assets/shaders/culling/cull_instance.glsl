@@ -0,0 +1,24 @@
+#ifndef _CULL_INSTANCE_
+#define _CULL_INSTANCE_
+
+// std430 layout shared with GpuCullingSystem::CullInstance
+struct CullInstance {
+	vec4 sphere;		// world center, radius
+	vec4 boxMin;		// world AABB, w unused
+	vec4 boxMax;
+	uint firstIndex;
+	uint indexCount;
+	uint batchIndex;
+	uint commandOffset;	// first draw command of the batch
+};
+
+// VkDrawIndexedIndirectCommand
+struct DrawCommand {
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	int vertexOffset;
+	uint firstInstance;
+};
+
+#endif
@@ -6,6 +6,16 @@
 #include "material/surface_normal.glsl"
 #include "lighting/blinn_phong_lighting.glsl"
 
+#define LIGHT_CLUSTER_SET 2
+#include "lighting/light_clusters.glsl"
+
+#define MATERIAL_SET 3
+#include "material/material_data.glsl"
+
+#define DEBUG_ALBEDO_MAP 0x1u
+#define DEBUG_NORMAL_MAP 0x2u
+#define DEBUG_AO_MAP 0x4u
+
 layout(location = 0) in vec3 fragPosWorld;
 layout(location = 1) in vec3 fragNormalWorld;
 layout(location = 2) in vec2 fragUV;
@@ -18,20 +28,19 @@ layout(set = 1, binding = 0) uniform sampler2D textures[];
 layout(push_constant) uniform Push {
 	mat4 modelMatrix;
 	mat4 normalMatrix;
-    vec4 color;
+	vec4 tint;
 	int enableWireframe;
 	int enableNormalsColor;
-	int textureIndex;
-	int normalMapIndex;
-	int ambientOcclusionMapIndex;
+	uint materialIndex;
 	float tilingFactor;
+	uint enabledMaps;		// DEBUG_*_MAP bits, mirrored in debug_render_system.cpp
 } push;
 
 /*
  * Applies ambient occlusion to the given color using the ambient occlusion map.
  */
-void applyAmbientOcclusion(inout vec3 color, vec2 texCoords) {
-    float ao = texture(textures[push.ambientOcclusionMapIndex], texCoords).r;
+void applyAmbientOcclusion(inout vec3 color, vec2 texCoords, int ambientOcclusionMapIndex) {
+    float ao = texture(textures[ambientOcclusionMapIndex], texCoords).r;
     color *= ao;
 }
 
@@ -42,12 +51,14 @@ void main() {
         return;
     }
 
+    MaterialData material = materials[push.materialIndex];
+
     vec2 texCoords = fragUV * push.tilingFactor;
 
     vec3 surfaceNormal = normalize(fragNormalWorld);
 
-    if (push.normalMapIndex != -1) {
-        surfaceNormal = calculateSurfaceNormal(textures[push.normalMapIndex], texCoords, fragTBN);
+    if ((push.enabledMaps & DEBUG_NORMAL_MAP) != 0u) {
+        surfaceNormal = calculateSurfaceNormal(textures[material.normalMapIndex], texCoords, fragTBN);
     }
 
     if (push.enableNormalsColor == 1) {
@@ -58,23 +69,32 @@ void main() {
     vec3 cameraPosWorld = ubo.inverseViewMatrix[3].xyz;
     vec3 viewDirection = normalize(cameraPosWorld - fragPosWorld);
 
-    vec3 diffuseLight, specularLight;
+    vec3 diffuseLight = ubo.ambientLightColor.xyz * ubo.ambientLightColor.w;
+    vec3 specularLight = vec3(0.0);
     float shininess = 1.0;
     float specularIntensity = 0.0;
-    computeBlinnPhongLighting(surfaceNormal, viewDirection, fragPosWorld, 
-        shininess, specularIntensity, diffuseLight, specularLight);
+
+    uint clusterIndex = getClusterIndex(gl_FragCoord.xy, fragPosWorld);
+    uint clusterLightCount = clusterLightCounts[clusterIndex];
+    uint listOffset = clusterIndex * MAX_LIGHTS_PER_CLUSTER;
+
+    for (uint i = 0; i < clusterLightCount; i++) {
+        addBlinnPhongLight(lights[clusterLightIndices[listOffset + i]], surfaceNormal, viewDirection, fragPosWorld,
+            shininess, specularIntensity, 1.0, diffuseLight, specularLight);
+    }
 
     vec3 imageColor = vec3(1.0, 1.0, 1.0); // Default color
-    if (push.textureIndex != -1) {
-        imageColor = texture(textures[push.textureIndex], texCoords).rgb;
+    if ((push.enabledMaps & DEBUG_ALBEDO_MAP) != 0u) {
+        imageColor = texture(textures[material.albedoMapIndex], texCoords).rgb;
     }
 
     // we need to add control coefficients to regulate both terms (diffuse/specular)
     // for now we use fragColor for both which is ideal for metallic objects
-    vec3 baseColor = (diffuseLight * push.color.rgb + specularLight * push.color.rgb) * imageColor;
+    vec3 color = material.albedoColor.rgb * push.tint.rgb;
+    vec3 baseColor = (diffuseLight * color + specularLight * color) * imageColor;
 
-    if (push.ambientOcclusionMapIndex != -1) {
-        applyAmbientOcclusion(baseColor, texCoords);
+    if ((push.enabledMaps & DEBUG_AO_MAP) != 0u) {
+        applyAmbientOcclusion(baseColor, texCoords, material.ambientOcclusionMapIndex);
     }
 
     outColor = vec4(baseColor, 1.0);
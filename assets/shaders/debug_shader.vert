@@ -17,13 +17,12 @@ layout(location = 3) out mat3 fragTBN;
 layout(push_constant) uniform Push {
 	mat4 modelMatrix;
 	mat4 normalMatrix;
-	vec4 color;
+	vec4 tint;
 	int enableWireframe;
 	int enableNormalsColor;
-	int textureIndex;
-	int normalMapIndex;
-	int ambientOcclusionMapIndex;
+	uint materialIndex;
 	float tilingFactor;
+	uint enabledMaps;		// DEBUG_*_MAP bits, mirrored in debug_render_system.cpp
 } push;
 
 
@@ -4,10 +4,42 @@
 #include "../common/math.glsl"
 #include "../ubo/global_ubo.glsl"
 
+/*
+ * Adds the diffuse and specular lighting of a point light (Blinn-Phong model).
+ *
+ * The visibility scales the contribution, e.g. with the shadow factor of the light.
+ */
+void addBlinnPhongLight(PointLight light, vec3 surfaceNormal, vec3 viewDirection, vec3 worldPosition,
+	float shininess, float specularIntensity, float visibility, inout vec3 diffuseLight, inout vec3 specularLight) {
+
+    vec3 vectorToLight = light.position.xyz - worldPosition;
+    float distanceSquared = dot(vectorToLight, vectorToLight);
+
+    // fade the falloff to zero at the light radius, so the lights culled by range leave no seam
+    float radius = pointLightRadius(light);
+    float distanceRatio = distanceSquared / (radius * radius);
+    float window = saturate(1.0 - distanceRatio * distanceRatio);
+    float attenuation = window * window / distanceSquared;
+    vec3 directionToLight = normalize(vectorToLight);
+    float cosAngleIncidence = max(dot(surfaceNormal, directionToLight), 0.0);
+    vec3 lightColor = light.color.xyz * light.color.w * attenuation * visibility;
+
+    // Diffuse component
+    diffuseLight += lightColor * cosAngleIncidence;
+
+    // Specular component (Blinn-Phong)
+    vec3 halfAngle = normalize(directionToLight + viewDirection);
+    float blinnTerm = saturate(dot(surfaceNormal, halfAngle));
+    blinnTerm = pow(blinnTerm, shininess);
+
+    specularLight += lightColor * blinnTerm * specularIntensity;
+}
+
 /*
  * Compute diffuse and specular lighting (Blinn-Phong model).
  *
- * Calculates the total diffuse and specular contributions from all active point lights.
+ * Calculates the total diffuse and specular contributions from the point lights of the global ubo,
+ * the rasterized passes light with the clustered light lists instead (see light_clusters.glsl).
  * Uses Blinn-Phong reflection for specular highlights.
  */
 void computeBlinnPhongLighting(vec3 surfaceNormal, vec3 viewDirection, vec3 worldPosition,
@@ -17,22 +49,8 @@ void computeBlinnPhongLighting(vec3 surfaceNormal, vec3 viewDirection, vec3 worl
     specularLight = vec3(0.0);
 
     for (int i = 0; i < ubo.numLights; i++) {
-        PointLight light = ubo.pointLights[i];
-        vec3 vectorToLight = light.position.xyz - worldPosition;
-        float attenuation = 1.0 / dot(vectorToLight, vectorToLight);
-        vec3 directionToLight = normalize(vectorToLight);
-        float cosAngleIncidence = max(dot(surfaceNormal, directionToLight), 0.0);
-        vec3 lightColor = light.color.xyz * light.color.w * attenuation;
-
-        // Diffuse component
-        diffuseLight += lightColor * cosAngleIncidence;
-
-        // Specular component (Blinn-Phong)
-        vec3 halfAngle = normalize(directionToLight + viewDirection);
-        float blinnTerm = saturate(dot(surfaceNormal, halfAngle));
-        blinnTerm = pow(blinnTerm, shininess);
-
-        specularLight += lightColor * blinnTerm * specularIntensity;
+        addBlinnPhongLight(ubo.pointLights[i], surfaceNormal, viewDirection, worldPosition,
+            shininess, specularIntensity, 1.0, diffuseLight, specularLight);
     }
 }
 
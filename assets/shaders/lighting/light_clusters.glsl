@@ -0,0 +1,80 @@
+#ifndef _LIGHT_CLUSTERS_
+#define _LIGHT_CLUSTERS_
+
+#include "point_light.glsl"
+
+// Clustered lighting: the view frustum is split in CLUSTER_COUNT_X * CLUSTER_COUNT_Y screen tiles
+// and CLUSTER_COUNT_Z exponential depth slices, light_culling.comp lists the lights of every cluster.
+// Define LIGHT_CLUSTER_SET before the include to pick the descriptor set of the cluster data.
+
+// mirrored in LightClusterSystem
+#define CLUSTER_COUNT_X 16
+#define CLUSTER_COUNT_Y 9
+#define CLUSTER_COUNT_Z 24
+#define CLUSTER_COUNT (CLUSTER_COUNT_X * CLUSTER_COUNT_Y * CLUSTER_COUNT_Z)
+#define MAX_LIGHTS_PER_CLUSTER 128
+
+#ifndef LIGHT_CLUSTER_SET
+#error "LIGHT_CLUSTER_SET must be defined before including light_clusters.glsl"
+#endif
+
+// the binning pass writes the lists, the fragment shaders only read them
+#ifndef LIGHT_CLUSTER_ACCESS
+#define LIGHT_CLUSTER_ACCESS readonly
+#endif
+
+// std140 layout shared with ClusterUniforms in light_cluster_system.cpp
+layout(set = LIGHT_CLUSTER_SET, binding = 0) uniform ClusterUniforms {
+    mat4 view;
+    vec4 projection;    // x, y: projection scale, z, w: near and far planes of the slices
+    vec2 viewportSize;
+    uint lightCount;
+    float sliceScale;   // CLUSTER_COUNT_Z / log(far / near)
+} clusters;
+
+layout(set = LIGHT_CLUSTER_SET, binding = 1) readonly buffer Lights {
+    PointLight lights[];
+};
+
+layout(set = LIGHT_CLUSTER_SET, binding = 2) LIGHT_CLUSTER_ACCESS buffer ClusterLightCounts {
+    uint clusterLightCounts[];
+};
+
+// MAX_LIGHTS_PER_CLUSTER entries per cluster, starting at clusterIndex * MAX_LIGHTS_PER_CLUSTER
+layout(set = LIGHT_CLUSTER_SET, binding = 3) LIGHT_CLUSTER_ACCESS buffer ClusterLightIndices {
+    uint clusterLightIndices[];
+};
+
+uint flattenClusterIndex(uvec3 cluster) {
+    return cluster.x + CLUSTER_COUNT_X * (cluster.y + CLUSTER_COUNT_Y * cluster.z);
+}
+
+/*
+ * View depth where the given slice begins, slice CLUSTER_COUNT_Z is the far plane.
+ */
+float clusterSliceDepth(uint slice) {
+    return clusters.projection.z * pow(clusters.projection.w / clusters.projection.z, float(slice) / CLUSTER_COUNT_Z);
+}
+
+/*
+ * Index of the cluster containing the fragment.
+ *
+ * @param fragCoord The window coordinates of the fragment (gl_FragCoord.xy).
+ * @param worldPosition The world position of the fragment.
+ */
+uint getClusterIndex(vec2 fragCoord, vec3 worldPosition) {
+    vec2 tile = fragCoord / clusters.viewportSize * vec2(CLUSTER_COUNT_X, CLUSTER_COUNT_Y);
+
+    float viewDepth = (clusters.view * vec4(worldPosition, 1.0)).z;
+    float slice = log(max(viewDepth, clusters.projection.z) / clusters.projection.z) * clusters.sliceScale;
+
+    uvec3 cluster = uvec3(
+        min(uint(tile.x), CLUSTER_COUNT_X - 1),
+        min(uint(tile.y), CLUSTER_COUNT_Y - 1),
+        min(uint(slice), CLUSTER_COUNT_Z - 1)
+    );
+
+    return flattenClusterIndex(cluster);
+}
+
+#endif
@@ -2,8 +2,19 @@
 #define _POINT_LIGHT_
 
 struct PointLight {
-    vec4 position;  // .xyz = world position, .w = unused
+    vec4 position;  // .xyz = world position, .w = shadow cube slot, negative without shadows
     vec4 color;     // .xyz = RGB color, .w = intensity
 };
 
+// light level under which a point light is considered out of range, bounds the light in clustered shading
+#define LIGHT_ATTENUATION_CUTOFF (1.0 / 256.0)
+
+/*
+ * Distance at which the inverse square falloff of the light reaches LIGHT_ATTENUATION_CUTOFF.
+ */
+float pointLightRadius(PointLight light) {
+    float peak = light.color.w * max(light.color.x, max(light.color.y, light.color.z));
+    return sqrt(max(peak, 0.0) / LIGHT_ATTENUATION_CUTOFF);
+}
+
 #endif
\ No newline at end of file
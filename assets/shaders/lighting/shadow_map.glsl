@@ -3,45 +3,94 @@
 
 #include "../ubo/global_ubo.glsl"
 
-#define SHADOW_BIAS 0.005
-#define SHADOW_BIAS_MIN 0.0005
+#define SHADOW_NORMAL_OFFSET 0.02
 #define SHADOW_OPACITY 0.4
-#define PCF_RADIUS 0.003
+#define SHADOW_FILTER_RADIUS 0.004 // disk radius per unit of distance from the light
+
+const vec2 POISSON_DISK[16] = vec2[](
+    vec2(-0.94201624, -0.39906216), vec2( 0.94558609, -0.76890725),
+    vec2(-0.09418410, -0.92938870), vec2( 0.34495938,  0.29387760),
+    vec2(-0.91588581,  0.45771432), vec2(-0.81544232, -0.87912464),
+    vec2(-0.38277543,  0.27676845), vec2( 0.97484398,  0.75648379),
+    vec2( 0.44323325, -0.97511554), vec2( 0.53742981, -0.47373420),
+    vec2(-0.26496911, -0.41893023), vec2( 0.79197514,  0.19090188),
+    vec2(-0.24188840,  0.99706507), vec2(-0.81409955,  0.91437590),
+    vec2( 0.19984126,  0.78641367), vec2( 0.14383161, -0.14100790)
+);
+
+/*
+ * Depth stored in the cube map for a light to fragment vector: the view depth of a face
+ * is the largest component of the vector, projected like the shadow pass projection.
+ */
+float cubeFaceDepth(vec3 lightVec) {
+    vec3 absVec = abs(lightVec);
+    float viewDepth = max(absVec.x, max(absVec.y, absVec.z));
+    float n = ubo.shadowNear;
+    float f = ubo.shadowFar;
+    return min(f / (f - n) * (1.0 - n / viewDepth), 1.0);
+}
 
 /*
- * Computes the shadow factor for the fragment based on the distance to the light source
+ * Per pixel rotation of the sample disk, trades banding for noise
+ */
+float interleavedGradientNoise(vec2 pixel) {
+    return fract(52.9829189 * fract(dot(pixel, vec2(0.06711056, 0.00583715))));
+}
+
+/*
+ * Computes the shadow factor of a point light for the fragment, from the cube of its
+ * slot in the depth-only cube map array. Lights without a slot are not shadowed.
  *
- * Determines whether the fragment is in shadow by comparing the distance from
- * the fragment to the light against the sampled depth from the cube map.
- * A bias is applied to avoid shadow acne artifacts.
+ * Every lookup is compared by the sampler (hardware PCF, bilinear weighted).
+ * Low quality takes a single lookup, medium and high take 8 or 16 lookups of a
+ * Poisson disk rotated per pixel, placed on the plane orthogonal to the light vector.
+ * The fragment is moved along its normal, more at grazing angles, against shadow acne;
+ * the slope scaled depth bias of the shadow pass does the rest.
+ * The pixel (gl_FragCoord.xy, or the texel of a compute pass) seeds the disk rotation.
  */
-float computeShadowFactor(samplerCube shadowCubeMap, vec3 surfaceNormal, vec3 fragPosWorld) {
-    vec3 lightVec = fragPosWorld - ubo.pointLights[0].position.xyz;
-    vec3 lightDir = normalize(lightVec);
-    float bias = max(SHADOW_BIAS * (1.0 - dot(surfaceNormal, lightDir)), SHADOW_BIAS_MIN);
-    float dist = length(lightVec);
-
-    float shadow = 0.0;
-
-    int totalSamples = 0;
-    float sampledDist = 0.0;
-
-    for (int x = -1; x <= 1; ++x) {
-        for (int y = -1; y <= 1; ++y) {
-            for (int z = -1; z <= 1; ++z) {
-                vec3 offset = vec3(x, y, z);
-                vec3 offsetDir = normalize(lightVec + (offset * PCF_RADIUS));
-                sampledDist = texture(shadowCubeMap, offsetDir).r;
-                if (dist > sampledDist + bias) {
-                    shadow += 1.0;
-                }
-                totalSamples++;
-            }
-        }
+float computeShadowFactor(samplerCubeArrayShadow shadowCubeMaps, PointLight light, vec3 surfaceNormal, vec3 fragPosWorld,
+    vec2 pixel) {
+    float slot = light.position.w;
+    if (slot < 0.0) {
+        return 1.0;
+    }
+
+    vec3 lightPos = light.position.xyz;
+    vec3 lightDir = normalize(fragPosWorld - lightPos);
+    float normalOffset = SHADOW_NORMAL_OFFSET * (1.0 - max(dot(surfaceNormal, -lightDir), 0.0));
+    vec3 lightVec = fragPosWorld + surfaceNormal * normalOffset - lightPos;
+
+    float depth = cubeFaceDepth(lightVec);
+
+    if (ubo.shadowQuality <= 0) {
+        float lit = texture(shadowCubeMaps, vec4(lightVec, slot), depth);
+        return mix(SHADOW_OPACITY, 1.0, lit);
+    }
+
+    int sampleCount = ubo.shadowQuality == 1 ? 8 : 16;
+
+    // tangent frame around the light vector
+    vec3 axis = normalize(lightVec);
+    vec3 up = abs(axis.y) < 0.999 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0);
+    vec3 tangent = normalize(cross(up, axis));
+    vec3 bitangent = cross(axis, tangent);
+
+    float angle = interleavedGradientNoise(pixel) * 6.28318530718;
+    float s = sin(angle);
+    float c = cos(angle);
+    mat2 rotation = mat2(c, s, -s, c);
+
+    float radius = SHADOW_FILTER_RADIUS * length(lightVec);
+
+    float lit = 0.0;
+    for (int i = 0; i < sampleCount; i++) {
+        // with 8 taps, every other point keeps the disk evenly covered
+        vec2 offset = rotation * POISSON_DISK[i * (16 / sampleCount)] * radius;
+        vec3 sampleVec = lightVec + tangent * offset.x + bitangent * offset.y;
+        lit += texture(shadowCubeMaps, vec4(sampleVec, slot), cubeFaceDepth(sampleVec));
     }
 
-    float shadowFactor = 1.0 - (shadow / float(totalSamples));
-    return mix(SHADOW_OPACITY, 1.0, shadowFactor); // soft blend
+    return mix(SHADOW_OPACITY, 1.0, lit / float(sampleCount)); // soft blend
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,95 @@
+#ifndef _GBUFFER_
+#define _GBUFFER_
+
+// The G-buffer of the deferred path is a single R32G32B32A32_UINT target (see DeferredRenderSystem):
+//   x = albedo.rgb, ambient occlusion (unorm 4x8)
+//   y = world normal, octahedral encoding (snorm 2x16)
+//   z = shininess, specular intensity (half 2x16)
+//   w = emissive radiance, added after the lighting (rgb9e5 shared exponent)
+// The depth attachment gives the position back.
+
+struct GBufferSurface {
+    vec3 albedo;
+    float ambientOcclusion;
+    vec3 normal;
+    float shininess;
+    float specularIntensity;
+    vec3 emissive;
+};
+
+vec2 octahedralWrap(vec2 v) {
+    return (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+/*
+ * Maps a unit vector on the octahedron unfolded in [-1, 1]^2.
+ */
+vec2 encodeOctahedral(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    return n.z >= 0.0 ? n.xy : octahedralWrap(n.xy);
+}
+
+vec3 decodeOctahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+const float RGB9E5_MAX = 65408.0; // 511 / 512 * 2^16
+
+/*
+ * Packs a non negative color with 9 bit mantissas and a shared 5 bit exponent
+ * (see VK_FORMAT_E5B9G9R9_UFLOAT_PACK32).
+ */
+uint packRGB9E5(vec3 color) {
+    color = clamp(color, 0.0, RGB9E5_MAX);
+
+    float maxChannel = max(color.r, max(color.g, color.b));
+    if (maxChannel <= 0.0) {
+        return 0u;
+    }
+
+    int exponent = max(-16, int(floor(log2(maxChannel)))) + 16;
+    // rounding the largest channel up can overflow its mantissa, the exponent takes the carry
+    if (floor(maxChannel / exp2(float(exponent - 24)) + 0.5) >= 512.0) {
+        exponent++;
+    }
+
+    uvec3 mantissas = uvec3(floor(color / exp2(float(exponent - 24)) + 0.5));
+    return mantissas.r | (mantissas.g << 9) | (mantissas.b << 18) | (uint(exponent) << 27);
+}
+
+vec3 unpackRGB9E5(uint packed) {
+    uvec3 mantissas = uvec3(packed, packed >> 9, packed >> 18) & 0x1FFu;
+    return vec3(mantissas) * exp2(float(packed >> 27) - 24.0);
+}
+
+uvec4 packGBuffer(GBufferSurface surface) {
+    return uvec4(
+        packUnorm4x8(vec4(surface.albedo, surface.ambientOcclusion)),
+        packSnorm2x16(encodeOctahedral(surface.normal)),
+        packHalf2x16(vec2(surface.shininess, surface.specularIntensity)),
+        packRGB9E5(surface.emissive)
+    );
+}
+
+GBufferSurface unpackGBuffer(uvec4 texel) {
+    GBufferSurface surface;
+
+    vec4 albedoOcclusion = unpackUnorm4x8(texel.x);
+    surface.albedo = albedoOcclusion.rgb;
+    surface.ambientOcclusion = albedoOcclusion.a;
+
+    surface.normal = decodeOctahedral(unpackSnorm2x16(texel.y));
+
+    vec2 specular = unpackHalf2x16(texel.z);
+    surface.shininess = specular.x;
+    surface.specularIntensity = specular.y;
+
+    surface.emissive = unpackRGB9E5(texel.w);
+
+    return surface;
+}
+
+#endif
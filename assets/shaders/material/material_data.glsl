@@ -0,0 +1,28 @@
+#ifndef _MATERIAL_DATA_
+#define _MATERIAL_DATA_
+
+// The materials of the MaterialRegistry, indexed by MaterialComponent::materialIndex.
+// Define MATERIAL_SET before the include to pick the descriptor set of the buffer.
+
+#ifndef MATERIAL_SET
+#error "MATERIAL_SET must be defined before including material_data.glsl"
+#endif
+
+// std430 layout shared with MaterialData in material_registry.hpp
+struct MaterialData {
+	vec4 albedoColor;
+	vec4 emissiveColor;		// rgb color, a intensity
+	int albedoMapIndex;
+	int normalMapIndex;
+	int ambientOcclusionMapIndex;
+	int metallicMapIndex;
+	int roughnessMapIndex;
+	int emissiveMapIndex;
+	float alphaCutoff;
+};
+
+layout(set = MATERIAL_SET, binding = 0) readonly buffer Materials {
+	MaterialData materials[];
+};
+
+#endif
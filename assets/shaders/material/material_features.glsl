@@ -0,0 +1,20 @@
+#ifndef _MATERIAL_FEATURES_
+#define _MATERIAL_FEATURES_
+
+// Feature bits of the material permutations, mirrored in MaterialRenderSystem::MaterialFeature.
+// The material pipelines are specialized per combination: the branches on a missing feature are
+// removed by the driver, with their texture fetches.
+#define MATERIAL_FEATURE_ALBEDO_MAP     0x1u
+#define MATERIAL_FEATURE_NORMAL_MAP     0x2u
+#define MATERIAL_FEATURE_AO_MAP         0x4u
+#define MATERIAL_FEATURE_EMISSIVE       0x8u
+#define MATERIAL_FEATURE_ALPHA_MASK     0x10u
+
+// every feature when not specialized
+layout(constant_id = 1) const uint MATERIAL_FEATURES = 0xFFFFFFFFu;
+
+bool hasMaterialFeature(uint feature) {
+    return (MATERIAL_FEATURES & feature) != 0u;
+}
+
+#endif
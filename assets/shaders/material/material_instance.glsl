@@ -0,0 +1,19 @@
+#ifndef _MATERIAL_INSTANCE_
+#define _MATERIAL_INSTANCE_
+
+// std430 layout shared with MaterialInstanceData in material_render_system.cpp,
+// the material itself is read from material_data.glsl
+struct MaterialInstance {
+	mat4 modelMatrix;
+	mat4 normalMatrix;
+	vec3 tint;
+	uint materialIndex;
+	float tilingFactor;
+};
+
+// indexed with the instance index, set as firstInstance by direct and indirect draws
+layout(set = 3, binding = 0) readonly buffer MaterialInstances {
+	MaterialInstance instances[];
+};
+
+#endif
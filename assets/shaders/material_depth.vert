@@ -0,0 +1,19 @@
+#version 460
+#extension GL_GOOGLE_include_directive : require
+
+#include "ubo/global_ubo.glsl"
+#include "material/material_instance.glsl"
+
+// Depth pre-pass of the materials, from the position-only vertex stream. The position is
+// computed exactly like material_shader.vert, so the material pass can test with EQUAL.
+
+layout(location = 0) in vec4 position;
+
+invariant gl_Position;
+
+void main() {
+	MaterialInstance instance = instances[gl_InstanceIndex];
+
+	vec4 positionWorld = instance.modelMatrix * position;
+	gl_Position = ubo.projectionMatrix * ubo.viewMatrix * positionWorld;
+}
@@ -0,0 +1,58 @@
+#version 460
+#extension GL_EXT_nonuniform_qualifier : enable
+#extension GL_GOOGLE_include_directive : require
+
+#include "ubo/global_ubo.glsl"
+#include "material/surface_normal.glsl"
+#include "material/material_instance.glsl"
+#include "material/material_features.glsl"
+
+#define MATERIAL_SET 5
+#include "material/material_data.glsl"
+#include "material/gbuffer.glsl"
+
+// Geometry pass of the deferred path: the surface is stored, deferred_lighting.comp shades it.
+
+layout(location = 0) in vec3 fragPosWorld;
+layout(location = 1) in vec3 fragNormalWorld;
+layout(location = 2) in vec2 fragUV;
+layout(location = 3) in mat3 fragTBN;
+layout(location = 6) flat in uint fragInstanceIndex;
+
+layout(location = 0) out uvec4 outGBuffer;
+
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+void main() {
+    // multi draw indirect can mix instances in a subgroup, the texture indices are non uniform
+    MaterialInstance instance = instances[fragInstanceIndex];
+    MaterialData material = materials[instance.materialIndex];
+
+    vec4 color = material.albedoColor * vec4(instance.tint, 1.0);
+    vec2 texCoords = fragUV * instance.tilingFactor;
+
+    vec4 imageColor = hasMaterialFeature(MATERIAL_FEATURE_ALBEDO_MAP)
+        ? texture(textures[nonuniformEXT(material.albedoMapIndex)], texCoords)
+        : vec4(1.0);
+
+    if (hasMaterialFeature(MATERIAL_FEATURE_ALPHA_MASK) && imageColor.a * color.a < material.alphaCutoff) {
+        discard;
+    }
+
+    GBufferSurface surface;
+    surface.albedo = color.rgb * imageColor.rgb;
+    surface.ambientOcclusion = hasMaterialFeature(MATERIAL_FEATURE_AO_MAP)
+        ? texture(textures[nonuniformEXT(material.ambientOcclusionMapIndex)], texCoords).r
+        : 1.0;
+    surface.normal = hasMaterialFeature(MATERIAL_FEATURE_NORMAL_MAP)
+        ? calculateSurfaceNormal(textures[nonuniformEXT(material.normalMapIndex)], texCoords, fragTBN)
+        : normalize(fragNormalWorld);
+    surface.shininess = 1.0;
+    surface.specularIntensity = 0.0;
+    surface.emissive = hasMaterialFeature(MATERIAL_FEATURE_EMISSIVE)
+        ? texture(textures[nonuniformEXT(material.emissiveMapIndex)], texCoords).rgb
+            * material.emissiveColor.rgb * material.emissiveColor.a
+        : vec3(0.0);
+
+    outGBuffer = packGBuffer(surface);
+}
@@ -4,13 +4,22 @@
 
 #include "ubo/global_ubo.glsl"
 #include "material/surface_normal.glsl"
+#include "material/material_instance.glsl"
+#include "material/material_features.glsl"
+
+#define MATERIAL_SET 5
+#include "material/material_data.glsl"
 #include "lighting/blinn_phong_lighting.glsl"
 #include "lighting/shadow_map.glsl"
 
+#define LIGHT_CLUSTER_SET 4
+#include "lighting/light_clusters.glsl"
+
 layout(location = 0) in vec3 fragPosWorld;
 layout(location = 1) in vec3 fragNormalWorld;
 layout(location = 2) in vec2 fragUV;
 layout(location = 3) in mat3 fragTBN;
+layout(location = 6) flat in uint fragInstanceIndex;
 
 layout(location = 0) out vec4 outColor;
 
@@ -18,51 +27,71 @@ layout(location = 0) out vec4 outColor;
 // #include "ubo/global_ubo.glsl"
 // layout(set = 0, binding = 0) uniform _ubo { GlobalUbo ubo; };
 layout(set = 1, binding = 0) uniform sampler2D textures[];
-layout(set = 2, binding = 0) uniform samplerCube shadowCubeMap;
-
-layout(push_constant) uniform Push {
-    mat4 modelMatrix;
-    mat4 normalMatrix;
-    vec4 color;
-    float specularIntensity;
-    float shininess;
-    int textureIndex;
-    int normalMapIndex;
-    int ambientOcclusionMapIndex;
-    int metallicMapIndex;
-	int roughnessMapIndex;
-    float tilingFactor;
-} push;
+// one cube per shadowed light, indexed by PointLight.position.w
+layout(set = 2, binding = 0) uniform samplerCubeArrayShadow shadowCubeMaps;
 
 /*
  * Applies ambient occlusion to the given color using the ambient occlusion map.
  */
-void applyAmbientOcclusion(inout vec3 color, vec2 texCoords) {
-    float ao = texture(textures[push.ambientOcclusionMapIndex], texCoords).r;
+void applyAmbientOcclusion(inout vec3 color, vec2 texCoords, int ambientOcclusionMapIndex) {
+    float ao = texture(textures[nonuniformEXT(ambientOcclusionMapIndex)], texCoords).r;
     color *= ao;
 }
 
 void main() {
-    vec2 texCoords = fragUV * push.tilingFactor;
+    // multi draw indirect can mix instances in a subgroup, the texture indices are non uniform
+    MaterialInstance instance = instances[fragInstanceIndex];
+    MaterialData material = materials[instance.materialIndex];
+
+    vec4 color = material.albedoColor * vec4(instance.tint, 1.0);
+    vec2 texCoords = fragUV * instance.tilingFactor;
+
+    vec4 imageColor = hasMaterialFeature(MATERIAL_FEATURE_ALBEDO_MAP)
+        ? texture(textures[nonuniformEXT(material.albedoMapIndex)], texCoords)
+        : vec4(1.0);
 
-    vec3 surfaceNormal = calculateSurfaceNormal(textures[push.normalMapIndex], texCoords, fragTBN);
+    if (hasMaterialFeature(MATERIAL_FEATURE_ALPHA_MASK) && imageColor.a * color.a < material.alphaCutoff) {
+        discard;
+    }
+
+    vec3 surfaceNormal = hasMaterialFeature(MATERIAL_FEATURE_NORMAL_MAP)
+        ? calculateSurfaceNormal(textures[nonuniformEXT(material.normalMapIndex)], texCoords, fragTBN)
+        : normalize(fragNormalWorld);
 
     vec3 cameraPosWorld = ubo.inverseViewMatrix[3].xyz;
     vec3 viewDirection = normalize(cameraPosWorld - fragPosWorld);
 
-    vec3 diffuseLight, specularLight;
-    computeBlinnPhongLighting(surfaceNormal, viewDirection, fragPosWorld, 
-        push.shininess, push.specularIntensity, diffuseLight, specularLight);
+    // every light is attenuated by its own shadow, the ambient term is not shadowed
+    vec3 diffuseLight = ubo.ambientLightColor.xyz * ubo.ambientLightColor.w;
+    vec3 specularLight = vec3(0.0);
+    float shininess = 1.0;
+    float specularIntensity = 0.0;
+
+    // only the lights whose range reaches the cluster of the fragment
+    uint clusterIndex = getClusterIndex(gl_FragCoord.xy, fragPosWorld);
+    uint clusterLightCount = clusterLightCounts[clusterIndex];
+    uint listOffset = clusterIndex * MAX_LIGHTS_PER_CLUSTER;
+
+    for (uint i = 0; i < clusterLightCount; i++) {
+        PointLight light = lights[clusterLightIndices[listOffset + i]];
+        float shadow = computeShadowFactor(shadowCubeMaps, light, surfaceNormal, fragPosWorld, gl_FragCoord.xy);
 
-    vec3 imageColor = texture(textures[push.textureIndex], texCoords).rgb;
+        addBlinnPhongLight(light, surfaceNormal, viewDirection, fragPosWorld,
+            shininess, specularIntensity, shadow, diffuseLight, specularLight);
+    }
 
     // we need to add control coefficients to regulate both terms (diffuse/specular)
     // for now we use fragColor for both which is ideal for metallic objects
-    vec3 baseColor = (diffuseLight * push.color.rgb + specularLight * push.color.rgb) * imageColor;
+    vec3 baseColor = (diffuseLight * color.rgb + specularLight * color.rgb) * imageColor.rgb;
 
-    applyAmbientOcclusion(baseColor, texCoords);
+    if (hasMaterialFeature(MATERIAL_FEATURE_AO_MAP)) {
+        applyAmbientOcclusion(baseColor, texCoords, material.ambientOcclusionMapIndex);
+    }
 
-    float shadow = computeShadowFactor(shadowCubeMap, surfaceNormal, fragPosWorld);
+    if (hasMaterialFeature(MATERIAL_FEATURE_EMISSIVE)) {
+        vec3 emissive = texture(textures[nonuniformEXT(material.emissiveMapIndex)], texCoords).rgb;
+        baseColor += emissive * material.emissiveColor.rgb * material.emissiveColor.a;
+    }
 
-    outColor = vec4(baseColor * shadow, 1.0);
+    outColor = vec4(baseColor, 1.0);
 }
@@ -3,6 +3,8 @@
 
 #include "ubo/global_ubo.glsl"
 #include "material/surface_normal.glsl"
+#include "material/material_instance.glsl"
+#include "material/material_features.glsl"
 
 layout(location = 0) in vec4 position;
 layout(location = 1) in vec4 normal;
@@ -13,30 +15,25 @@ layout(location = 0) out vec3 fragPosWorld;
 layout(location = 1) out vec3 fragNormalWorld;
 layout(location = 2) out vec2 fragUV;
 layout(location = 3) out mat3 fragTBN;
+layout(location = 6) flat out uint fragInstanceIndex;
 
-layout(push_constant) uniform Push {
-	mat4 modelMatrix;
-	mat4 normalMatrix;
-	vec4 color;
-	float specularIntensity;
-	float shininess;
-	int textureIndex;
-	int normalMapIndex;
-	int ambientOcclusionMapIndex;
-	int metallicMapIndex;
-	int roughnessMapIndex;
-	float tilingFactor;
-} push;
-
+// matches material_depth.vert bit for bit, the material pass tests EQUAL after the depth pre-pass
+invariant gl_Position;
 
 void main() {
-	vec4 positionWorld = push.modelMatrix * position;
+	MaterialInstance instance = instances[gl_InstanceIndex];
+
+	vec4 positionWorld = instance.modelMatrix * position;
 	gl_Position = ubo.projectionMatrix * ubo.viewMatrix * positionWorld;
 
-	mat3 TBN = calculateTBN(normal, tangent, mat3(push.normalMatrix));
+	// the tangent frame is only used to apply the normal map
+	mat3 TBN = hasMaterialFeature(MATERIAL_FEATURE_NORMAL_MAP)
+		? calculateTBN(normal, tangent, mat3(instance.normalMatrix))
+		: mat3(1.0);
  
 	fragPosWorld = positionWorld.xyz;
-	fragNormalWorld = vec3(normal);
+	fragNormalWorld = normalize(mat3(instance.normalMatrix) * normal.xyz);
 	fragUV = uv.xy;
 	fragTBN = TBN;
+	fragInstanceIndex = gl_InstanceIndex;
 }
\ No newline at end of file
@@ -15,6 +15,9 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
     uint frameCount;
     uint ptAccumulationCount;
     bool accumulationEnabled;
+    float shadowNear;
+    float shadowFar;
+    int shadowQuality;
 } ubo;
 
 #endif
\ No newline at end of file
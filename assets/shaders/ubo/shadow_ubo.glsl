@@ -1,17 +1,15 @@
 #ifndef _SHADOW_UBO_
 #define _SHADOW_UBO_
 
-#include "../lighting/point_light.glsl"
-
-layout(constant_id = 0) const int MAX_LIGHTS = 10;
+// mirrored in ShadowMapRenderSystem::MAX_SHADOWED_LIGHTS
+#define MAX_SHADOWED_LIGHTS 4
 
 layout(set = 0, binding = 0) uniform ShadowUbo {
 	mat4 projection;
-	// this is a matrix that translates model coordinates to light coordinates
-	mat4 lightOriginModel; // we could consider passing this as push constants in the future? (i think no, because we will have too many lights :(  )
-	PointLight pointLights[MAX_LIGHTS];
-	int numLights;
-	uint time;
+	// view matrix of each cube face, indexed by the face of the instance
+	mat4 faceViews[6];
+	// world position of the light of each slot of the cube map array
+	vec4 lightPositions[MAX_SHADOWED_LIGHTS];
 } ubo;
 
 #endif
\ No newline at end of file